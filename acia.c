@@ -0,0 +1,277 @@
+/********************************************************************
+ * acia.c
+ *
+ *  Module that implements the MOS 6551 ACIA serial port (ACIA_ENABLE=1).
+ *
+ *  The ACIA registers are at 0xFF04 to 0xFF07, as on the Dragon 64.
+ *  Received characters come from the mini UART receive ring, and
+ *  transmitted characters go to its transmit ring, both filled and
+ *  emptied by the mini UART interrupt handler. Each character takes
+ *  the time of its start, data, parity and stop bits at the baud rate
+ *  of the control register, counted in emulated CPU cycles by
+ *  acia_advance(), so Dragon software sees the timing of the real
+ *  device whatever the mini UART line rate is.
+ *
+ *  A character is only moved into the receive data register after the
+ *  previous one was read, so characters wait in the mini UART ring
+ *  instead of overrunning the ACIA. The overrun status bit is never set.
+ *
+ *  The IRQ output is a level that follows the receive data register
+ *  full and transmit data register empty conditions, and it is
+ *  shared with the PIA IRQ lines through cpu_irq_source().
+ *
+ *  October 19, 2026
+ *
+ *******************************************************************/
+
+#include    <stdint.h>
+
+#include    "cpu.h"
+#include    "mem.h"
+#include    "auxuart.h"
+#include    "acia.h"
+
+/* -----------------------------------------
+   Local definitions
+----------------------------------------- */
+#define     ACIA_DATA               0xff04
+#define     ACIA_STATUS             0xff05
+#define     ACIA_COMMAND            0xff06
+#define     ACIA_CONTROL            0xff07
+
+#define     STAT_OVERRUN            0x04
+#define     STAT_RDRF               0x08        // Receive data register full
+#define     STAT_TDRE               0x10        // Transmit data register empty
+#define     STAT_IRQ                0x80
+
+#define     CMD_DTR                 0x01        // Receiver and transmitter enabled
+#define     CMD_RX_IRQ_DIS          0x02
+#define     CMD_TX_MASK             0x0c
+#define     CMD_TX_IRQ              0x04        // Transmit IRQ enabled, RTS low
+#define     CMD_PARITY              0x20
+#define     CMD_RESET_MASK          0xe0        // Bits kept by a programmed reset
+
+#define     CTRL_BAUD_MASK          0x0f
+#define     CTRL_WORD_MASK          0x60
+#define     CTRL_WORD_SHIFT         5
+#define     CTRL_STOP_BITS          0x80
+
+#define     ACIA_EXTERNAL_BAUD      115200      // 1.8432MHz crystal / 16 at baud selection 0
+
+/* -----------------------------------------
+   Module static functions
+----------------------------------------- */
+static uint8_t io_handler_acia(uint16_t address, uint8_t data, mem_operation_t op) SECTION_HOT;
+static void    acia_timing(void);
+static void    acia_irq(void) SECTION_HOT;
+
+/* -----------------------------------------
+   Module globals
+----------------------------------------- */
+static const int baud_rate[16] =
+{
+    ACIA_EXTERNAL_BAUD, 50, 75, 110, 135, 150, 300, 600,
+    1200, 1800, 2400, 3600, 4800, 7200, 9600, 19200,
+};
+
+static uint8_t  acia_status;
+static uint8_t  acia_command;
+static uint8_t  acia_control;
+static uint8_t  rx_data;
+static uint8_t  tx_data;
+
+static int      tx_pending;         // Transmit data register holds a character
+static int      rx_cycles;          // Cycles until the next character can be received
+static int      tx_cycles;          // Cycles until the pending character is sent
+static int      char_cycles;        // CPU cycles of one character
+
+/*------------------------------------------------
+ * acia_init()
+ *
+ *  Initialize the ACIA module to its hardware reset state,
+ *  and register its IO handler.
+ *
+ *  param:  Nothing
+ *  return: Nothing
+ */
+void acia_init(void)
+{
+    acia_status = STAT_TDRE;
+    acia_command = CMD_RX_IRQ_DIS;
+    acia_control = 0;
+    rx_data = 0;
+    tx_data = 0;
+
+    tx_pending = 0;
+    rx_cycles = 0;
+    tx_cycles = 0;
+
+    acia_timing();
+
+    mem_define_io(ACIA_DATA, ACIA_CONTROL, io_handler_acia);
+}
+
+/*------------------------------------------------
+ * acia_advance()
+ *
+ *  Advance the ACIA character timing by the CPU cycles of a block,
+ *  send a transmitted character that is due and receive the next
+ *  character from the mini UART.
+ *  Must be called after every cpu_run_block().
+ *
+ *  param:  CPU cycles of the block
+ *  return: Nothing
+ */
+void acia_advance(int cycles)
+{
+    if ( rx_cycles > 0 )
+        rx_cycles -= cycles;
+
+    if ( tx_pending )
+    {
+        tx_cycles -= cycles;
+
+        /* A full transmit ring keeps the character pending
+         * and retries it after the next block
+         */
+        if ( tx_cycles <= 0 && bcm2835_auxuart_tx_byte(tx_data) )
+        {
+            tx_pending = 0;
+            acia_status |= STAT_TDRE;
+            acia_irq();
+        }
+    }
+
+    if ( rx_cycles <= 0 &&
+         (acia_command & CMD_DTR) &&
+         !(acia_status & STAT_RDRF) &&
+         bcm2835_auxuart_rx_byte(&rx_data) )
+    {
+        rx_cycles = char_cycles;
+        acia_status |= STAT_RDRF;
+        acia_irq();
+    }
+}
+
+/*------------------------------------------------
+ * io_handler_acia()
+ *
+ *  IO call-back handler for the ACIA registers.
+ *
+ *  param:  Call address, data byte for write operation, and operation type
+ *  return: Status or data byte
+ */
+static uint8_t io_handler_acia(uint16_t address, uint8_t data, mem_operation_t op)
+{
+    switch ( address )
+    {
+        case ACIA_DATA:
+            if ( op == MEM_WRITE )
+            {
+                /* The character is sent one character time after it
+                 * is written, which also paces back to back writes
+                 */
+                tx_data = data;
+                tx_pending = 1;
+                tx_cycles = char_cycles;
+                acia_status &= ~STAT_TDRE;
+            }
+            else
+            {
+                data = rx_data;
+                acia_status &= ~(STAT_RDRF | STAT_OVERRUN);
+            }
+            acia_irq();
+            break;
+
+        case ACIA_STATUS:
+            if ( op == MEM_WRITE )
+            {
+                /* Programmed reset
+                 */
+                acia_command &= CMD_RESET_MASK;
+                acia_status &= ~STAT_OVERRUN;
+                acia_timing();
+                acia_irq();
+            }
+            else
+            {
+                data = acia_status;
+            }
+            break;
+
+        case ACIA_COMMAND:
+            if ( op == MEM_WRITE )
+            {
+                acia_command = data;
+                acia_timing();
+                acia_irq();
+            }
+            else
+            {
+                data = acia_command;
+            }
+            break;
+
+        case ACIA_CONTROL:
+            if ( op == MEM_WRITE )
+            {
+                acia_control = data;
+                acia_timing();
+            }
+            else
+            {
+                data = acia_control;
+            }
+            break;
+    }
+
+    return data;
+}
+
+/*------------------------------------------------
+ * acia_timing()
+ *
+ *  Calculate the CPU cycles of one character from the
+ *  baud rate, word length, parity and stop bits.
+ *
+ *  param:  Nothing
+ *  return: Nothing
+ */
+static void acia_timing(void)
+{
+    int     bits;
+
+    /* Start bit, 8 to 5 data bits and the stop bits
+     */
+    bits = 1 + (8 - ((acia_control & CTRL_WORD_MASK) >> CTRL_WORD_SHIFT));
+    bits += (acia_control & CTRL_STOP_BITS) ? 2 : 1;
+
+    if ( acia_command & CMD_PARITY )
+        bits++;
+
+    char_cycles = (CPU_CLOCK_HZ * bits) / baud_rate[acia_control & CTRL_BAUD_MASK];
+}
+
+/*------------------------------------------------
+ * acia_irq()
+ *
+ *  Update the IRQ status bit and the ACIA IRQ line of the CPU.
+ *
+ *  param:  Nothing
+ *  return: Nothing
+ */
+static void acia_irq(void)
+{
+    int     irq;
+
+    irq = ((acia_status & STAT_RDRF) && !(acia_command & CMD_RX_IRQ_DIS)) ||
+          ((acia_status & STAT_TDRE) && (acia_command & CMD_TX_MASK) == CMD_TX_IRQ);
+
+    if ( irq )
+        acia_status |= STAT_IRQ;
+    else
+        acia_status &= ~STAT_IRQ;
+
+    cpu_irq_source(CPU_IRQ_ACIA, irq);
+}
@@ -0,0 +1,439 @@
+/********************************************************************
+ * audio.c
+ *
+ *  Band-limited DAC audio module (AUDIO_BLEP=1).
+ *
+ *  Writes to the 6-bit DAC are not sent to the DAC when they are
+ *  executed, because the emulator runs the CPU in bursts and then
+ *  waits, which puts the writes at the wrong real time. Instead each
+ *  write becomes a step at its emulated cycle time, converted to a
+ *  PCM sample position in 16.16 fixed point. The step is added to a
+ *  delta buffer as a band-limited impulse taken from the polyphase
+ *  kernel phase that matches the sub-sample position, and the delta
+ *  buffer is integrated into PCM samples once no later step can
+ *  change them. Samples are queued in a ring buffer that audio_output()
+ *  sends to the DAC at the sample rate of the system timer.
+ *
+ *  DAC writes of a CPU block are queued with their cycle offset in the
+ *  block, taken from cpu_get_cycles(), and turned into steps in order
+ *  when the block ends. In recompiled ROM blocks the clock includes the
+ *  writing instruction, so each write is stamped at the end of its own
+ *  instruction. The C core runs one instruction per block and the ARM
+ *  assembly core ends a block after an IO access, so there the clock
+ *  does not move during the block, the write is in the last instruction,
+ *  and it is stamped at the end of the block.
+ *
+ *  The kernel loop is selected at build time. Hosted x86 builds, the
+ *  libretro core and host tools, add a step with SSE2, eight taps at a
+ *  time. Other targets, including the RPi, use the scalar loop, as the
+ *  ARM1176 has no NEON unit.
+ *
+ *  October 19, 2026
+ *
+ *******************************************************************/
+
+#include    <stdint.h>
+#include    <string.h>
+
+#include    "cpu.h"
+#include    "rpi.h"
+#include    "audio.h"
+
+#if defined(__SSE2__) && !defined(AUDIO_PORTABLE)
+#include    <emmintrin.h>
+#endif
+
+/* Kernel generated by tools/blepgen.c
+ */
+#include    "dragon/blep.h"
+
+/* -----------------------------------------
+   Local definitions
+----------------------------------------- */
+#define     AUDIO_FRAC_BITS         16                  // Sample position fraction
+#define     AUDIO_PHASE_SHIFT       (AUDIO_FRAC_BITS - 5)   // Fraction to kernel phase, 32 phases
+#define     AUDIO_CYCLE_STEP        ((uint32_t)(((uint64_t) AUDIO_SAMPLE_RATE << AUDIO_FRAC_BITS) / CPU_CLOCK_HZ))
+
+#define     AUDIO_RING_SAMPLES      2048                // PCM ring buffer, a power of 2
+#define     AUDIO_RING_MASK         (AUDIO_RING_SAMPLES - 1)
+
+#define     AUDIO_PERIOD_US         (1000000 / AUDIO_SAMPLE_RATE)
+#define     AUDIO_PERIOD_REM        (1000000 % AUDIO_SAMPLE_RATE)
+#define     AUDIO_RESYNC_US         100000              // Output late by this much restarts the sample clock
+
+#define     AUDIO_LEVEL_MAX         ((1 << AUDIO_DAC_BITS) - 1)
+
+#define     AUDIO_DAC_WRITES        16                  // DAC writes queued in one CPU block
+
+#if ((AUDIO_PHASES << AUDIO_PHASE_SHIFT) != (1 << AUDIO_FRAC_BITS))
+#error "AUDIO_PHASE_SHIFT does not match AUDIO_PHASES"
+#endif
+
+#if defined(__SSE2__) && !defined(AUDIO_PORTABLE)
+#define     AUDIO_SSE2              1
+#else
+#define     AUDIO_SSE2              0
+#endif
+
+/* The SSE2 loop multiplies 16-bit steps and kernel taps, eight at a time
+ */
+#if (AUDIO_SSE2==1) && (((AUDIO_LEVEL_MAX << AUDIO_PCM_SHIFT) > 32767) || (AUDIO_TAPS % 8))
+#error "SSE2 step loop needs 16-bit steps and a multiple of 8 taps"
+#endif
+
+/* -----------------------------------------
+   Module static functions
+----------------------------------------- */
+static void audio_add_step(int delta) SECTION_HOT;
+static void audio_end_samples(int count) SECTION_HOT;
+static void audio_move(int cycles) SECTION_HOT;
+
+/* -----------------------------------------
+   Module globals
+----------------------------------------- */
+static int32_t      delta_buffer[AUDIO_TAPS] CACHE_ALIGNED;
+static uint32_t     sample_time = 0;            // Current position from delta_buffer[0], 16.16
+static int32_t      accumulator = 0;            // Integrated delta buffer, PCM << AUDIO_KERNEL_BITS
+
+static int          dac_level = 0;              // Level of the last step
+static uint32_t     block_start = 0;            // CPU cycle clock at the start of the current block
+
+static struct
+{
+    int     offset;                             // Cycles from the block start, 0 for the block end
+    int     level;
+} dac_writes[AUDIO_DAC_WRITES];
+static int          dac_write_count = 0;        // DAC writes queued in the current block
+
+static int16_t      pcm_ring[AUDIO_RING_SAMPLES];
+static int          pcm_head = 0;               // Next sample to write
+static int          pcm_tail = 0;               // Next sample to send
+
+static int          output_enabled = 1;         // DAC is routed to the audio output
+static uint32_t     output_time;                // System timer time of the next sample
+static uint32_t     output_frac;                // Sample period remainder, in 1/AUDIO_SAMPLE_RATE micro-seconds
+
+/*------------------------------------------------
+ * audio_init()
+ *
+ *  Initialize the audio module and start the
+ *  output sample clock.
+ *
+ *  param:  Nothing
+ *  return: Nothing
+ */
+void audio_init(void)
+{
+    memset(delta_buffer, 0, sizeof(delta_buffer));
+    sample_time = 0;
+    accumulator = 0;
+
+    dac_level = 0;
+    block_start = cpu_get_cycles();
+    dac_write_count = 0;
+
+    pcm_head = 0;
+    pcm_tail = 0;
+
+    output_time = rpi_system_timer();
+    output_frac = 0;
+}
+
+/*------------------------------------------------
+ * audio_dac_write()
+ *
+ *  Queue a DAC write of the current CPU block with its cycle offset.
+ *  Called from the PIA DAC IO handler instead of rpi_write_dac().
+ *  When the queue is full the last write takes the new level.
+ *
+ *  param:  DAC level 0 to 63
+ *  return: Nothing
+ */
+void audio_dac_write(int level)
+{
+    if ( dac_write_count == AUDIO_DAC_WRITES )
+        dac_write_count--;
+
+    dac_writes[dac_write_count].offset = (int)(cpu_get_cycles() - block_start);
+    dac_writes[dac_write_count].level = level;
+    dac_write_count++;
+}
+
+/*------------------------------------------------
+ * audio_enable()
+ *
+ *  Enable or disable sending PCM samples to the DAC.
+ *  The DAC is shared with the joystick comparator, so PCM samples
+ *  must not be sent while the audio multiplexer selects a joystick
+ *  and the Dragon software uses the DAC for its conversion.
+ *  The sample clock keeps running while disabled.
+ *
+ *  param:  1- enable, 0- disable
+ *  return: Nothing
+ */
+void audio_enable(int enable)
+{
+    output_enabled = enable;
+}
+
+/*------------------------------------------------
+ * audio_advance()
+ *
+ *  Advance the audio clock by the CPU cycles of a block, and add
+ *  the steps of the DAC writes made during the block at their cycle
+ *  offsets. A write without an offset in the block is at its end.
+ *  Must be called after every cpu_run_block().
+ *
+ *  param:  CPU cycles of the block
+ *  return: Nothing
+ */
+void audio_advance(int cycles)
+{
+    int     i, offset, done = 0;
+
+    for ( i = 0; i < dac_write_count; i++ )
+    {
+        offset = dac_writes[i].offset;
+        if ( offset <= 0 || offset > cycles )
+            offset = cycles;
+
+        if ( offset > done )
+        {
+            audio_move(offset - done);
+            done = offset;
+        }
+
+        if ( dac_writes[i].level != dac_level )
+        {
+            audio_add_step((dac_writes[i].level - dac_level) << AUDIO_PCM_SHIFT);
+            dac_level = dac_writes[i].level;
+        }
+    }
+
+    if ( cycles > done )
+        audio_move(cycles - done);
+
+    dac_write_count = 0;
+    block_start = cpu_get_cycles();
+}
+
+/*------------------------------------------------
+ * audio_output()
+ *
+ *  Send queued PCM samples to the DAC for as long as their output time
+ *  has passed on the system timer. The last level is held when the ring
+ *  buffer is empty, and samples are dropped when output is disabled.
+ *  Should be called from the main loop as often as possible.
+ *
+ *  param:  Nothing
+ *  return: Number of samples still queued
+ */
+int audio_output(void)
+{
+    uint32_t    now;
+    int         level;
+
+    now = rpi_system_timer();
+
+    /* Restart the sample clock after the emulation was
+     * stopped, for example by the loader
+     */
+    if ( (int32_t)(now - output_time) > AUDIO_RESYNC_US )
+    {
+        output_time = now;
+        output_frac = 0;
+    }
+
+    while ( (int32_t)(now - output_time) >= 0 && pcm_tail != pcm_head )
+    {
+        level = (pcm_ring[pcm_tail & AUDIO_RING_MASK] + (1 << (AUDIO_PCM_SHIFT - 1))) >> AUDIO_PCM_SHIFT;
+        if ( level < 0 )
+            level = 0;
+        else if ( level > AUDIO_LEVEL_MAX )
+            level = AUDIO_LEVEL_MAX;
+
+        if ( output_enabled )
+            rpi_write_dac(level);
+        pcm_tail++;
+
+        output_time += AUDIO_PERIOD_US;
+        output_frac += AUDIO_PERIOD_REM;
+        if ( output_frac >= AUDIO_SAMPLE_RATE )
+        {
+            output_frac -= AUDIO_SAMPLE_RATE;
+            output_time++;
+        }
+    }
+
+    return (pcm_head - pcm_tail);
+}
+
+/*------------------------------------------------
+ * audio_read()
+ *
+ *  Read queued PCM samples instead of sending them to the DAC,
+ *  for a host front-end that plays the stream itself.
+ *  Samples are in DAC level << AUDIO_PCM_SHIFT units. While output is
+ *  disabled the last enabled sample is repeated, as the DAC would hold it.
+ *
+ *  param:  Sample buffer and its length in samples
+ *  return: Number of samples read
+ */
+int audio_read(int16_t *buffer, int count)
+{
+    static int16_t  held_sample = 0;
+
+    int     i;
+
+    for ( i = 0; i < count && pcm_tail != pcm_head; i++ )
+    {
+        if ( output_enabled )
+            held_sample = pcm_ring[pcm_tail & AUDIO_RING_MASK];
+
+        buffer[i] = held_sample;
+        pcm_tail++;
+    }
+
+    return i;
+}
+
+/*------------------------------------------------
+ * audio_get_state()
+ *
+ *  Get the resampler state and the PCM ring buffer position.
+ *
+ *  param:  Pointer to audio state data structure
+ *  return: Nothing
+ */
+void audio_get_state(audio_state_t *audio_state)
+{
+    memcpy(audio_state->delta_buffer, delta_buffer, sizeof(delta_buffer));
+    audio_state->sample_time = sample_time;
+    audio_state->accumulator = accumulator;
+    audio_state->dac_level = dac_level;
+    audio_state->block_start = block_start;
+    audio_state->pcm_head = pcm_head;
+    audio_state->pcm_tail = pcm_tail;
+}
+
+/*------------------------------------------------
+ * audio_set_state()
+ *
+ *  Set the resampler state from a state saved by audio_get_state().
+ *  Samples queued after the state was saved are dropped.
+ *
+ *  param:  Pointer to audio state data structure
+ *  return: Nothing
+ */
+void audio_set_state(audio_state_t *audio_state)
+{
+    memcpy(delta_buffer, audio_state->delta_buffer, sizeof(delta_buffer));
+    sample_time = audio_state->sample_time;
+    accumulator = audio_state->accumulator;
+    dac_level = audio_state->dac_level;
+    block_start = audio_state->block_start;
+    dac_write_count = 0;
+    pcm_head = audio_state->pcm_head;
+    pcm_tail = audio_state->pcm_tail;
+}
+
+/*------------------------------------------------
+ * audio_add_step()
+ *
+ *  Add a band-limited step at the current sample time
+ *  to the delta buffer. Completed samples were already moved out,
+ *  so the step is always within the first sample of the buffer.
+ *
+ *  param:  Step size in PCM units
+ *  return: Nothing
+ */
+static void audio_add_step(int delta)
+{
+    const int16_t  *kernel;
+    int             i;
+#if (AUDIO_SSE2==1)
+    __m128i         step, taps, low, high, sum;
+#endif
+
+    kernel = blep_kernel[(sample_time >> AUDIO_PHASE_SHIFT) & (AUDIO_PHASES - 1)];
+
+#if (AUDIO_SSE2==1)
+    /* The low and high halves of the 16x16 bit products
+     * interleave into eight 32-bit products
+     */
+    step = _mm_set1_epi16((int16_t) delta);
+
+    for ( i = 0; i < AUDIO_TAPS; i += 8 )
+    {
+        taps = _mm_loadu_si128((const __m128i *) &kernel[i]);
+        low = _mm_mullo_epi16(taps, step);
+        high = _mm_mulhi_epi16(taps, step);
+
+        sum = _mm_loadu_si128((__m128i *) &delta_buffer[i]);
+        sum = _mm_add_epi32(sum, _mm_unpacklo_epi16(low, high));
+        _mm_storeu_si128((__m128i *) &delta_buffer[i], sum);
+
+        sum = _mm_loadu_si128((__m128i *) &delta_buffer[i + 4]);
+        sum = _mm_add_epi32(sum, _mm_unpackhi_epi16(low, high));
+        _mm_storeu_si128((__m128i *) &delta_buffer[i + 4], sum);
+    }
+#else
+    for ( i = 0; i < AUDIO_TAPS; i++ )
+        delta_buffer[i] += delta * kernel[i];
+#endif
+}
+
+/*------------------------------------------------
+ * audio_move()
+ *
+ *  Move the audio clock forward by CPU cycles and complete
+ *  the PCM samples before the new time.
+ *
+ *  param:  CPU cycles
+ *  return: Nothing
+ */
+static void audio_move(int cycles)
+{
+    sample_time += (uint32_t) cycles * AUDIO_CYCLE_STEP;
+
+    if ( (sample_time >> AUDIO_FRAC_BITS) > 0 )
+        audio_end_samples(sample_time >> AUDIO_FRAC_BITS);
+}
+
+/*------------------------------------------------
+ * audio_end_samples()
+ *
+ *  Integrate completed samples from the delta buffer into the
+ *  PCM ring buffer, and move the rest of the delta buffer to its start.
+ *  Samples past the end of the delta buffer hold the level.
+ *  When the ring buffer is full the oldest samples are dropped.
+ *
+ *  param:  Number of completed samples
+ *  return: Nothing
+ */
+static void audio_end_samples(int count)
+{
+    int     i;
+
+    for ( i = 0; i < count; i++ )
+    {
+        if ( i < AUDIO_TAPS )
+            accumulator += delta_buffer[i];
+
+        if ( (pcm_head - pcm_tail) >= AUDIO_RING_SAMPLES )
+            pcm_tail++;
+
+        pcm_ring[pcm_head & AUDIO_RING_MASK] = (int16_t)(accumulator >> AUDIO_KERNEL_BITS);
+        pcm_head++;
+    }
+
+    for ( i = 0; i < AUDIO_TAPS; i++ )
+    {
+        if ( (i + count) < AUDIO_TAPS )
+            delta_buffer[i] = delta_buffer[i + count];
+        else
+            delta_buffer[i] = 0;
+    }
+
+    sample_time -= (uint32_t) count << AUDIO_FRAC_BITS;
+}
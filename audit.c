@@ -0,0 +1,208 @@
+/********************************************************************
+ * audit.c
+ *
+ *  Timing drift auditor module.
+ *
+ *  audit_frame() is called once per rendered frame with the emulated
+ *  CPU cycles of the frame. It reads the system timer once, and the
+ *  unsigned difference from the previous read is correct across the
+ *  32-bit timer wrap, about every 71 minutes, for frames shorter than
+ *  that. Totals are kept in 64-bit counters so they do not wrap in the
+ *  life of a unit. The drift is only computed every AUDIT_CHECK_FRAMES
+ *  frames, which keeps the per frame cost to a few instructions.
+ *
+ *  A frame overruns when its real time is longer than its emulated time.
+ *  Every whole frame period of an overrun is counted as a lost frame.
+ *
+ *  October 19, 2026
+ *
+ *******************************************************************/
+
+#include    <stdint.h>
+
+#include    "cpu.h"
+#include    "printf.h"
+#include    "rpi.h"
+#include    "log.h"
+#include    "audit.h"
+
+/* -----------------------------------------
+   Local definitions
+----------------------------------------- */
+#define     AUDIT_FRAC_BITS         16          // Micro-seconds per cycle fraction
+#define     AUDIT_US_PER_CYCLE      ((uint32_t)((1000000ULL << AUDIT_FRAC_BITS) / CPU_CLOCK_HZ))
+
+/* -----------------------------------------
+   Module static functions
+----------------------------------------- */
+static void     audit_check(void);
+static int32_t  audit_drift_ppm(void);
+
+/* -----------------------------------------
+   Module globals
+----------------------------------------- */
+static uint32_t     last_time;                  // System timer at the end of the last frame
+static uint64_t     total_cycles = 0;           // Emulated CPU cycles since boot
+static uint64_t     total_real_us = 0;          // Real micro-seconds since boot
+static uint32_t     frames = 0;
+static uint32_t     lost_frames = 0;
+static uint32_t     worst_overrun_us = 0;
+static uint32_t     worst_frame_us = 0;
+static int          check_countdown = AUDIT_CHECK_FRAMES;
+static int          drift_alarm = 0;            // Drift is past the threshold
+
+/*------------------------------------------------
+ * audit_init()
+ *
+ *  Start the auditor time base.
+ *
+ *  param:  Nothing
+ *  return: Nothing
+ */
+void audit_init(void)
+{
+    last_time = rpi_system_timer();
+}
+
+/*------------------------------------------------
+ * audit_resync()
+ *
+ *  Restart the time base without counting the time since
+ *  the last frame, after the emulation was stopped on purpose,
+ *  for example by the loader.
+ *
+ *  param:  Nothing
+ *  return: Nothing
+ */
+void audit_resync(void)
+{
+    last_time = rpi_system_timer();
+}
+
+/*------------------------------------------------
+ * audit_frame()
+ *
+ *  Account for one emulated frame.
+ *  Call once per rendered frame.
+ *
+ *  param:  Emulated CPU cycles of the frame
+ *  return: Nothing
+ */
+void audit_frame(int cycles)
+{
+    uint32_t    now, real_us, emulated_us, overrun_us;
+
+    now = rpi_system_timer();
+    real_us = now - last_time;
+    last_time = now;
+
+    total_cycles += (uint32_t) cycles;
+    total_real_us += real_us;
+    frames++;
+
+    if ( real_us > worst_frame_us )
+        worst_frame_us = real_us;
+
+    emulated_us = (uint32_t)(((uint64_t) cycles * AUDIT_US_PER_CYCLE) >> AUDIT_FRAC_BITS);
+    if ( real_us > emulated_us )
+    {
+        overrun_us = real_us - emulated_us;
+        if ( overrun_us >= AUDIT_FRAME_US )
+            lost_frames += overrun_us / AUDIT_FRAME_US;
+
+        if ( overrun_us > worst_overrun_us )
+        {
+            worst_overrun_us = overrun_us;
+            if ( overrun_us >= AUDIT_FRAME_US )
+                LOG2(LOG_AUDIT_OVERRUN, frames, overrun_us);
+        }
+    }
+
+    if ( --check_countdown == 0 )
+    {
+        check_countdown = AUDIT_CHECK_FRAMES;
+        audit_check();
+    }
+}
+
+/*------------------------------------------------
+ * audit_report()
+ *
+ *  Print the auditor totals on the serial console.
+ *  printf() is built without 'long long' support, so the
+ *  totals are printed in milli-seconds.
+ *
+ *  param:  Nothing
+ *  return: Nothing
+ */
+void audit_report(void)
+{
+    printf("Timing audit\n");
+    printf("  frames         %10u\n", frames);
+    printf("  emulated mS    %10u\n", (uint32_t)((total_cycles * 1000) / CPU_CLOCK_HZ));
+    printf("  real mS        %10u\n", (uint32_t)(total_real_us / 1000));
+    printf("  drift ppm      %10d\n", (int) audit_drift_ppm());
+    printf("  worst frame uS %10u\n", worst_frame_us);
+    printf("  worst overrun  %10u\n", worst_overrun_us);
+    printf("  lost frames    %10u\n", lost_frames);
+}
+
+/*------------------------------------------------
+ * audit_check()
+ *
+ *  Log a drift event when the drift crosses the threshold,
+ *  and when it returns to below half of the threshold.
+ *
+ *  param:  Nothing
+ *  return: Nothing
+ */
+static void audit_check(void)
+{
+    int32_t     drift;
+
+    drift = audit_drift_ppm();
+    if ( drift < 0 )
+        drift = -drift;
+
+    if ( !drift_alarm && drift > AUDIT_DRIFT_PPM )
+    {
+        drift_alarm = 1;
+        LOG2(LOG_AUDIT_DRIFT, audit_drift_ppm(), frames);
+    }
+    else if ( drift_alarm && drift < (AUDIT_DRIFT_PPM / 2) )
+    {
+        drift_alarm = 0;
+        LOG2(LOG_AUDIT_DRIFT_OK, audit_drift_ppm(), frames);
+    }
+}
+
+/*------------------------------------------------
+ * audit_drift_ppm()
+ *
+ *  Drift of real time from emulated time since boot.
+ *  A positive drift means the emulation runs slower than real time.
+ *
+ *  param:  Nothing
+ *  return: Drift in parts per million
+ */
+static int32_t audit_drift_ppm(void)
+{
+    uint64_t    emulated_us;
+    int64_t     drift;
+
+    /* Divide by emulated milli-seconds so the products
+     * do not overflow in months of run time
+     */
+    emulated_us = (total_cycles * 1000000) / CPU_CLOCK_HZ;
+    if ( emulated_us < 1000 )
+        return 0;
+
+    drift = ((int64_t) total_real_us - (int64_t) emulated_us) * 1000 / (int64_t)(emulated_us / 1000);
+
+    if ( drift > INT32_MAX )
+        return INT32_MAX;
+    else if ( drift < -INT32_MAX )
+        return -INT32_MAX;
+
+    return (int32_t) drift;
+}
@@ -9,7 +9,10 @@
  *      https://elinux.org/BCM2835_datasheet_errata
  *
  *  TODO Add hardware flow control
- *  TODO Add option for a transmit interrupt-driven Auxiliary-UART
+ *
+ *  The receive and transmit circular buffers have one writer and
+ *  one reader each, the interrupt handler and the main code, so they
+ *  use free running indexes and no shared count.
  *
  */
 
@@ -39,9 +42,11 @@
 
 #define     UART_RX_INT_ENA             0x00000001
 #define     UART_TX_INT_ENA             0x00000002
+#define     UART_INT_LINE_ENA           0x0000000c      // Required for interrupts, see errata
 #define     UART_IRQ_PEND               0x00000001
 
-#define     SER_IN                      256             // Circular input buffer size
+#define     SER_IN                      1024            // Circular input buffer size, a power of 2
+#define     SER_OUT                     1024            // Circular output buffer size, a power of 2
 
 /* -----------------------------------------
    Types and data structures
@@ -61,13 +66,19 @@ static auxiliary_uart1_regs_t       *pUART1 = (auxiliary_uart1_regs_t*)BCM2835_A
 static uint16_t  rx_timeout = 0;
 static uint16_t  tx_timeout = 0;
 static int       irq_enabled = 0;
+static int       tx_irq_enabled = 0;
 
 /* Serial circular receive buffer
  */
-volatile static uint8_t recv_buffer[SER_IN];
-volatile static int     recv_cnt;
-volatile static int     recv_wr_ptr;
-volatile static int     recv_rd_ptr;
+volatile static uint8_t  recv_buffer[SER_IN];
+volatile static uint32_t recv_wr_ptr;
+volatile static uint32_t recv_rd_ptr;
+
+/* Serial circular transmit buffer
+ */
+volatile static uint8_t  xmit_buffer[SER_OUT];
+volatile static uint32_t xmit_wr_ptr;
+volatile static uint32_t xmit_rd_ptr;
 
 /*------------------------------------------------
  * bcm2835_auxuart_init()
@@ -121,13 +132,15 @@ int bcm2835_auxuart_init(baud_t baud_rate, uint32_t rx_tout, uint32_t tx_tout, u
     rx_timeout = rx_tout * 1000;
     tx_timeout = tx_tout * 1000;
 
-    /* Configure receive interrupts if required
+    /* Configure receive and transmit interrupts if required.
+     * The transmit interrupt is enabled when there is data to send.
      */
-    if ( configuration & AUXUART_ENA_RX_IRQ )
+    if ( configuration & (AUXUART_ENA_RX_IRQ | AUXUART_ENA_TX_IRQ) )
     {
-        recv_cnt = 0;
         recv_wr_ptr = 0;
         recv_rd_ptr = 0;
+        xmit_wr_ptr = 0;
+        xmit_rd_ptr = 0;
 
         /* Setup interrupt controller
          */
@@ -137,13 +150,17 @@ int bcm2835_auxuart_init(baud_t baud_rate, uint32_t rx_tout, uint32_t tx_tout, u
          */
         dmb();
 
-        pUART1->aux_mu_ier_reg |= UART_RX_INT_ENA;
+        if ( configuration & AUXUART_ENA_RX_IRQ )
+            pUART1->aux_mu_ier_reg |= (UART_RX_INT_ENA | UART_INT_LINE_ENA);
+        else
+            pUART1->aux_mu_ier_reg |= UART_INT_LINE_ENA;
 
         dmb();
 
         irq_enable(IRQ_AUX_SERDEV);
 
         irq_enabled = 1;
+        tx_irq_enabled = (configuration & AUXUART_ENA_TX_IRQ) ? 1 : 0;
     }
 
     return 1;
@@ -177,7 +194,10 @@ void bcm2835_auxuart_close(void)
 
         dmb();
 
-        pUART1->aux_mu_ier_reg &= ~UART_RX_INT_ENA;
+        pUART1->aux_mu_ier_reg &= ~(UART_RX_INT_ENA | UART_TX_INT_ENA | UART_INT_LINE_ENA);
+
+        irq_enabled = 0;
+        tx_irq_enabled = 0;
     }
 }
 
@@ -193,29 +213,17 @@ void bcm2835_auxuart_close(void)
  */
 int bcm2835_auxuart_rx_data(uint8_t *buffer, int count)
 {
-    int     rxCount;
     int     i;
 
-    if ( recv_cnt == 0 )
-        return 0;
-
-    /* figure out how many bytes to transfer
-     */
-    rxCount = (count < recv_cnt) ? count : recv_cnt;
-
     /* transfer data to caller's buffer
      */
-    for ( i = 0; i < rxCount; i++ )
+    for ( i = 0; i < count && recv_rd_ptr != recv_wr_ptr; i++ )
     {
-        buffer[i] = recv_buffer[recv_rd_ptr++];
-
-        if ( recv_rd_ptr == SER_IN )
-            recv_rd_ptr = 0;
-
-        recv_cnt--;
+        buffer[i] = recv_buffer[recv_rd_ptr % SER_IN];
+        recv_rd_ptr++;
     }
 
-    return rxCount;
+    return i;
 }
 
 /*------------------------------------------------
@@ -230,15 +238,11 @@ int bcm2835_auxuart_rx_data(uint8_t *buffer, int count)
  */
 int bcm2835_auxuart_rx_byte(uint8_t *byte)
 {
-    if ( recv_cnt == 0 )
+    if ( recv_rd_ptr == recv_wr_ptr )
         return 0;
 
-    *byte = recv_buffer[recv_rd_ptr++];
-
-    if ( recv_rd_ptr == SER_IN )
-        recv_rd_ptr = 0;
-
-    recv_cnt--;
+    *byte = recv_buffer[recv_rd_ptr % SER_IN];
+    recv_rd_ptr++;
 
     return 1;
 }
@@ -266,10 +270,42 @@ int bcm2835_auxuart_tx_data(uint8_t *buffer, int count)
     return count;
 }
 
+/*------------------------------------------------
+ * bcm2835_auxuart_tx_byte()
+ *
+ *  Add a byte to the Tx circular buffer without waiting.
+ *  *** Requires interrupt driven transmitter ***
+ *
+ * param:  Byte to send
+ * return: 1- if successful, 0- buffer is full
+ *
+ */
+int bcm2835_auxuart_tx_byte(uint8_t byte)
+{
+    if ( (xmit_wr_ptr - xmit_rd_ptr) >= SER_OUT )
+        return 0;
+
+    xmit_buffer[xmit_wr_ptr % SER_OUT] = byte;
+    xmit_wr_ptr++;
+
+    /* Interrupts are masked so the handler cannot disable
+     * the transmit interrupt after it is enabled here
+     */
+    disable();
+    dmb();
+    pUART1->aux_mu_ier_reg |= UART_TX_INT_ENA;
+    dmb();
+    enable();
+
+    return 1;
+}
+
 /*------------------------------------------------
  * bcm2835_auxuart_putchr()
  *
  *  Send a character/byte to UART transmitter.
+ *  With an interrupt driven transmitter the byte is added
+ *  to the Tx circular buffer, waiting while it is full.
  *
  * param:  Character/byte to send
  * return: none
@@ -277,6 +313,16 @@ int bcm2835_auxuart_tx_data(uint8_t *buffer, int count)
  */
 void bcm2835_auxuart_putchr(uint8_t byte)
 {
+    if ( tx_irq_enabled )
+    {
+        while ( !bcm2835_auxuart_tx_byte(byte) )
+        {
+            /* Wait for the Tx buffer to drain */
+        }
+
+        return;
+    }
+
     while ( !(pUART1->aux_mu_lsr_reg & UART_TX_EMPTY) )
     {
         /* Wait for Tx to be ready for byte */
@@ -355,10 +401,38 @@ int bcm2835_auxuart_ischar(void)
     return ready;
 }
 
+/*------------------------------------------------
+ * bcm2835_auxuart_tx_ready()
+ *
+ *  Check if the transmitter can accept a character/byte
+ *  without waiting
+ *
+ * param:  none
+ * return: 1- transmitter can accept a byte, 0- otherwise
+ *
+ */
+int bcm2835_auxuart_tx_ready(void)
+{
+    int     ready;
+
+    if ( tx_irq_enabled )
+        return ((xmit_wr_ptr - xmit_rd_ptr) < SER_OUT);
+
+    ready = (pUART1->aux_mu_lsr_reg & UART_TX_EMPTY) ? 1 : 0;
+
+    dmb();
+
+    return ready;
+}
+
 /*------------------------------------------------
  * bcm2835_auxuart_isr()
  *
- *  Character/byte receiver interrupt handler.
+ *  Character/byte receiver and transmitter interrupt handler.
+ *  Moves all received bytes from the Rx FIFO to the Rx circular buffer,
+ *  dropping them when it is full, and fills the Tx FIFO from the Tx
+ *  circular buffer. The transmit interrupt is disabled when the Tx
+ *  circular buffer is empty.
  *  Assumes Auxiliary UART (UART1) is fully configured.
  *
  *  TODO Declare as 'naked' because registers are saved at the handler stub.
@@ -375,17 +449,28 @@ void bcm2835_auxuart_isr(void)
 
     /* Handle the interrupt request
      */
-    if ( (pAux->aux_irq & UART_IRQ_PEND) &&
-         (pUART1->aux_mu_lsr_reg & UART_RX_READY) )
+    if ( pAux->aux_irq & UART_IRQ_PEND )
     {
-        byte = (uint8_t)(pUART1->aux_mu_io_reg & 0x000000ff);
-        if ( recv_cnt < SER_IN )
+        while ( pUART1->aux_mu_lsr_reg & UART_RX_READY )
+        {
+            byte = (uint8_t)(pUART1->aux_mu_io_reg & 0x000000ff);
+            if ( (recv_wr_ptr - recv_rd_ptr) < SER_IN )
+            {
+                recv_buffer[recv_wr_ptr % SER_IN] = byte;
+                recv_wr_ptr++;
+            }
+        }
+
+        if ( tx_irq_enabled )
         {
-            recv_buffer[recv_wr_ptr] = byte;
-            recv_cnt++;
-            recv_wr_ptr++;
-            if ( recv_wr_ptr == SER_IN )
-                recv_wr_ptr = 0;
+            while ( (pUART1->aux_mu_lsr_reg & UART_TX_EMPTY) && xmit_rd_ptr != xmit_wr_ptr )
+            {
+                pUART1->aux_mu_io_reg = (uint32_t) xmit_buffer[xmit_rd_ptr % SER_OUT];
+                xmit_rd_ptr++;
+            }
+
+            if ( xmit_rd_ptr == xmit_wr_ptr )
+                pUART1->aux_mu_ier_reg &= ~UART_TX_INT_ENA;
         }
     }
 
@@ -0,0 +1,447 @@
+/********************************************************************
+ * bench.c
+ *
+ *  Benchmark module (BENCH=1).
+ *
+ *  The storage benchmark separates the costs of loading a file from
+ *  the SD card: raw block reads of one and of several blocks per SD
+ *  command, which show the card, SPI clock and per-command delays,
+ *  the FAT chain walk, directory parsing, and fat32_fread() with
+ *  buffers of different sizes. Every operation is timed with the
+ *  system timer, and results are printed as KB/s and as a latency
+ *  histogram with power of two micro-second buckets.
+ *
+ *  The VDG benchmark times vdg_render() in every supported video mode,
+ *  with text, random and all-zero video RAM, and prints micro-seconds
+ *  per frame and the share of a 20mS frame. The VDG state and video RAM
+ *  of the running Dragon program are saved and restored around it.
+ *
+ *  October 19, 2026
+ *
+ *******************************************************************/
+
+#include    <stdint.h>
+#include    <string.h>
+
+#include    "printf.h"
+#include    "rpi.h"
+#include    "mem.h"
+#include    "vdg.h"
+#include    "bench.h"
+
+/* -----------------------------------------
+   Local definitions
+----------------------------------------- */
+#define     BENCH_BUCKETS           16          // Latency buckets <16uS, <32uS ... >=256mS
+#define     BENCH_BUCKET_SHIFT      4           // First bucket limit 1 << 4 micro-seconds
+
+#define     BENCH_SECTOR            512
+#define     BENCH_RAW_BLOCKS        512         // Blocks read by every raw read test, 256KB
+#define     BENCH_BUFFER_SIZE       (32*1024)   // Largest read
+#define     BENCH_FILE_BYTES        (64*1024)   // Bytes read by every fat32_fread() test
+#define     BENCH_DIR_ENTRIES       256
+#define     BENCH_REPEAT            4           // Repeats of the chain walk and directory tests
+
+#define     BENCH_VIDEO_BASE        0x0400      // Video RAM of the VDG test patterns
+#define     BENCH_VIDEO_BYTES       6144        // Largest video mode
+#define     BENCH_FRAMES            100         // vdg_render() calls per mode and pattern
+#define     BENCH_FRAME_TIME        (1000000 / VDG_REFRESH_RATE)
+
+typedef enum
+{
+    PATTERN_TEXT,
+    PATTERN_RANDOM,
+    PATTERN_ZERO,
+    PATTERNS
+} bench_pattern_t;
+
+/* SAM and PIA mode settings of a video mode, the PIA mode
+ * is PIA1 port B bits 3 to 7 as passed to vdg_set_mode_pia()
+ */
+typedef struct
+{
+    const char *name;
+    int         sam_mode;
+    uint8_t     pia_mode;
+} bench_video_mode_t;
+
+typedef struct
+{
+    uint32_t    count;
+    uint32_t    total;
+    uint32_t    min;
+    uint32_t    max;
+    uint32_t    bucket[BENCH_BUCKETS];
+} bench_stats_t;
+
+/* -----------------------------------------
+   Module static functions
+----------------------------------------- */
+static void bench_stats_clear(bench_stats_t *stats);
+static void bench_stats_add(bench_stats_t *stats, uint32_t time);
+static void bench_stats_print(bench_stats_t *stats, uint32_t bytes);
+static uint32_t bench_kb_per_sec(uint32_t bytes, uint32_t time);
+static void bench_video_fill(bench_pattern_t pattern);
+
+/* -----------------------------------------
+   Module globals
+----------------------------------------- */
+static uint8_t      bench_buffer[BENCH_BUFFER_SIZE];
+static dir_entry_t  bench_dir_list[BENCH_DIR_ENTRIES];
+static bench_stats_t stats;
+
+static int          raw_blocks_per_read[] = { 1, 8, 64 };
+static int          fread_sizes[] = { 1, 64, 512, 4096, 32768 };
+static int          dir_entries[] = { 16, 64, 256 };
+
+static uint8_t      video_ram_save[BENCH_VIDEO_BYTES];
+
+/* Video modes that vdg_render() supports. Alpha internal mode
+ * renders semigraphics-4 characters too, which the random pattern has.
+ */
+static bench_video_mode_t video_modes[] =
+{
+    { "ALPHA/SG4", 0, 0x00 },
+    { "SG8",       2, 0x00 },
+    { "SG12",      4, 0x00 },
+    { "G1C",       1, 0x10 },
+    { "G1R",       1, 0x12 },
+    { "G2C",       2, 0x14 },
+    { "G2R",       3, 0x16 },
+    { "G3C",       4, 0x18 },
+    { "G3R",       5, 0x1a },
+    { "G6C",       6, 0x1c },
+    { "G6R",       6, 0x1e },
+};
+
+static const char  *pattern_names[PATTERNS] = { "text", "random", "zero" };
+
+/*------------------------------------------------
+ * bench_storage()
+ *
+ *  Run the storage benchmark on a file and print the results.
+ *  The directory test parses the root directory, so the caller
+ *  must re-read its current directory afterwards.
+ *
+ *  param:  Directory entry of the file to read
+ *  return: Nothing
+ */
+void bench_storage(dir_entry_t *file)
+{
+    uint32_t    start, time;
+    uint32_t    lba;
+    int         i, j, count, bytes;
+
+    printf("Storage benchmark: '%s' %d bytes, %s\n", file->lfn, file->file_size,
+            (file->is_contiguous ? "contiguous" : "FAT chain"));
+
+    /* Raw block reads from the start of the card,
+     * the same blocks for every read size
+     */
+    for ( i = 0; i < sizeof(raw_blocks_per_read) / sizeof(int); i++ )
+    {
+        bench_stats_clear(&stats);
+
+        for ( lba = 0; lba < BENCH_RAW_BLOCKS; lba += raw_blocks_per_read[i] )
+        {
+            start = rpi_system_timer();
+            if ( rpi_sd_read_block(lba, bench_buffer, raw_blocks_per_read[i] * BENCH_SECTOR) != SD_OK )
+            {
+                printf("  raw read failed at LBA %u\n", lba);
+                return;
+            }
+            bench_stats_add(&stats, rpi_system_timer() - start);
+        }
+
+        printf("  raw read %2d block(s)    ", raw_blocks_per_read[i]);
+        bench_stats_print(&stats, BENCH_RAW_BLOCKS * BENCH_SECTOR);
+    }
+
+    /* FAT chain walk, a contiguous exFAT file has no chain
+     */
+    if ( file->is_contiguous )
+    {
+        printf("  FAT chain walk          none, file is contiguous\n");
+    }
+    else
+    {
+        bench_stats_clear(&stats);
+        count = 0;
+
+        for ( i = 0; i < BENCH_REPEAT; i++ )
+        {
+            start = rpi_system_timer();
+            count = fat32_chain_length(file->cluster_chain_head);
+            bench_stats_add(&stats, rpi_system_timer() - start);
+        }
+
+        printf("  FAT chain walk %5d cl ", count);
+        bench_stats_print(&stats, 0);
+        if ( stats.total )
+            printf("                          %u clusters/s\n", (uint32_t)((uint64_t) count * BENCH_REPEAT * 1000000 / stats.total));
+    }
+
+    /* Directory parsing
+     */
+    for ( i = 0; i < sizeof(dir_entries) / sizeof(int); i++ )
+    {
+        bench_stats_clear(&stats);
+        count = 0;
+
+        for ( j = 0; j < BENCH_REPEAT; j++ )
+        {
+            start = rpi_system_timer();
+            count = fat32_parse_dir(0, bench_dir_list, dir_entries[i]);
+            bench_stats_add(&stats, rpi_system_timer() - start);
+        }
+
+        if ( count <= 0 )
+        {
+            printf("  directory parse failed\n");
+            break;
+        }
+
+        printf("  dir parse %3d/%3d ent   ", count, dir_entries[i]);
+        bench_stats_print(&stats, 0);
+        time = (stats.total * 10) / (BENCH_REPEAT * count);
+        printf("                          %u.%u uS/entry\n", time / 10, time % 10);
+    }
+
+    /* File reads through fat32_fread()
+     */
+    for ( i = 0; i < sizeof(fread_sizes) / sizeof(int); i++ )
+    {
+        bench_stats_clear(&stats);
+        bytes = 0;
+
+        if ( !fat32_fopen(file) )
+        {
+            printf("  fat32_fopen() failed\n");
+            return;
+        }
+
+        while ( bytes < BENCH_FILE_BYTES )
+        {
+            start = rpi_system_timer();
+            count = fat32_fread(bench_buffer, fread_sizes[i]);
+            time = rpi_system_timer() - start;
+
+            if ( count <= 0 )
+                break;
+
+            bench_stats_add(&stats, time);
+            bytes += count;
+        }
+
+        fat32_fclose();
+
+        if ( count < 0 )
+        {
+            printf("  fat32_fread() failed\n");
+            return;
+        }
+
+        printf("  fread %5d bytes       ", fread_sizes[i]);
+        bench_stats_print(&stats, bytes);
+    }
+}
+
+/*------------------------------------------------
+ * bench_vdg()
+ *
+ *  Run the VDG render benchmark and print the results.
+ *  The VDG mode, video RAM offset and video RAM contents
+ *  are restored afterwards.
+ *
+ *  param:  Nothing
+ *  return: Nothing
+ */
+void bench_vdg(void)
+{
+    vdg_state_t vdg_state;
+    uint32_t    start, time, share;
+    int         mode, pattern, frame;
+
+    vdg_get_state(&vdg_state);
+    memcpy(video_ram_save, mem_get_map() + BENCH_VIDEO_BASE, BENCH_VIDEO_BYTES);
+
+    printf("VDG render benchmark: %d frames, frame time %u uS\n", BENCH_FRAMES, BENCH_FRAME_TIME);
+
+    /* Mode changes are not logged in the middle of the results
+     */
+    vdg_set_mode_log(0);
+    vdg_set_video_offset(BENCH_VIDEO_BASE >> 9);
+
+    for ( mode = 0; mode < sizeof(video_modes) / sizeof(bench_video_mode_t); mode++ )
+    {
+        vdg_set_mode_sam(video_modes[mode].sam_mode);
+        vdg_set_mode_pia(video_modes[mode].pia_mode);
+
+        for ( pattern = 0; pattern < PATTERNS; pattern++ )
+        {
+            bench_video_fill(pattern);
+
+            /* The first frame after a mode change
+             * also sets the frame buffer resolution
+             */
+            vdg_render();
+
+            bench_stats_clear(&stats);
+
+            for ( frame = 0; frame < BENCH_FRAMES; frame++ )
+            {
+                start = rpi_system_timer();
+                vdg_render();
+                bench_stats_add(&stats, rpi_system_timer() - start);
+            }
+
+            time = stats.total / stats.count;
+            share = (stats.total * 1000) / (stats.count * BENCH_FRAME_TIME);
+
+            printf("  %-9s %-6s %6u uS/frame %3u.%u%%  min %u max %u\n",
+                    video_modes[mode].name, pattern_names[pattern], time,
+                    share / 10, share % 10, stats.min, stats.max);
+        }
+    }
+
+    memcpy(mem_get_map() + BENCH_VIDEO_BASE, video_ram_save, BENCH_VIDEO_BYTES);
+    vdg_set_state(&vdg_state);
+    vdg_render();
+
+    vdg_set_mode_log(1);
+}
+
+/*------------------------------------------------
+ * bench_video_fill()
+ *
+ *  Fill the benchmark video RAM with a test pattern.
+ *  The text pattern is upper case characters and spaces,
+ *  the random pattern also has inverse and semigraphics characters.
+ *
+ *  param:  Pattern
+ *  return: Nothing
+ */
+static void bench_video_fill(bench_pattern_t pattern)
+{
+    uint8_t    *video_ram;
+    uint32_t    random;
+    int         i;
+
+    video_ram = mem_get_map() + BENCH_VIDEO_BASE;
+    random = 12345;
+
+    for ( i = 0; i < BENCH_VIDEO_BYTES; i++ )
+    {
+        switch ( pattern )
+        {
+            case PATTERN_TEXT:
+                video_ram[i] = ((i % 7) == 6) ? 0x60 : (0x41 + (i % 26));
+                break;
+
+            case PATTERN_RANDOM:
+                random = random * 1103515245 + 12345;
+                video_ram[i] = (uint8_t)(random >> 16);
+                break;
+
+            default:
+                video_ram[i] = 0;
+        }
+    }
+}
+
+/*------------------------------------------------
+ * bench_stats_clear()
+ *
+ *  Clear operation time statistics.
+ *
+ *  param:  Statistics
+ *  return: Nothing
+ */
+static void bench_stats_clear(bench_stats_t *stats)
+{
+    memset(stats, 0, sizeof(bench_stats_t));
+    stats->min = 0xffffffff;
+}
+
+/*------------------------------------------------
+ * bench_stats_add()
+ *
+ *  Add an operation time to the statistics.
+ *
+ *  param:  Statistics, operation time in micro-seconds
+ *  return: Nothing
+ */
+static void bench_stats_add(bench_stats_t *stats, uint32_t time)
+{
+    int     bucket;
+
+    stats->count++;
+    stats->total += time;
+
+    if ( time < stats->min )
+        stats->min = time;
+    if ( time > stats->max )
+        stats->max = time;
+
+    for ( bucket = 0; bucket < (BENCH_BUCKETS - 1); bucket++ )
+    {
+        if ( time < (1U << (bucket + BENCH_BUCKET_SHIFT)) )
+            break;
+    }
+
+    stats->bucket[bucket]++;
+}
+
+/*------------------------------------------------
+ * bench_stats_print()
+ *
+ *  Print operation count, throughput and latency, and on a second line
+ *  the non-empty latency buckets by their upper limit.
+ *
+ *  param:  Statistics, bytes transferred or 0 to omit the throughput
+ *  return: Nothing
+ */
+static void bench_stats_print(bench_stats_t *stats, uint32_t bytes)
+{
+    int     bucket;
+
+    if ( stats->count == 0 )
+    {
+        printf("no operations\n");
+        return;
+    }
+
+    printf("%6u ops", stats->count);
+    if ( bytes )
+        printf(" %6u KB/s", bench_kb_per_sec(bytes, stats->total));
+    printf("  uS min %u avg %u max %u\n", stats->min, stats->total / stats->count, stats->max);
+
+    printf("                          ");
+    for ( bucket = 0; bucket < BENCH_BUCKETS; bucket++ )
+    {
+        if ( stats->bucket[bucket] == 0 )
+            continue;
+
+        if ( bucket < (BENCH_BUCKETS - 1) )
+            printf(" <%u:%u", (1U << (bucket + BENCH_BUCKET_SHIFT)), stats->bucket[bucket]);
+        else
+            printf(" >=%u:%u", (1U << (bucket - 1 + BENCH_BUCKET_SHIFT)), stats->bucket[bucket]);
+    }
+    printf("\n");
+}
+
+/*------------------------------------------------
+ * bench_kb_per_sec()
+ *
+ *  Throughput in KB per second.
+ *
+ *  param:  Bytes transferred, time in micro-seconds
+ *  return: KB/s
+ */
+static uint32_t bench_kb_per_sec(uint32_t bytes, uint32_t time)
+{
+    if ( time == 0 )
+        time = 1;
+
+    return (uint32_t)(((uint64_t) bytes * 1000000) / 1024 / time);
+}
@@ -0,0 +1,85 @@
+/********************************************************************
+ * boot.c
+ *
+ *  Boot timeline module.
+ *
+ *  Each boot phase records one system timer read when it ends.
+ *  A phase that was not reached, for example when a boot step
+ *  is skipped, is printed without a time.
+ *
+ *  October 19, 2026
+ *
+ *******************************************************************/
+
+#include    <stdint.h>
+
+#include    "printf.h"
+#include    "rpi.h"
+#include    "boot.h"
+
+/* -----------------------------------------
+   Module globals
+----------------------------------------- */
+static uint32_t     boot_time[BOOT_PHASES];
+static int          boot_marked[BOOT_PHASES];
+
+static const char  *phase_names[BOOT_PHASES] =
+{
+    "kernel entry",
+    "uart",
+    "spi0",
+    "avr reset",
+    "gpio",
+    "rom load",
+    "sam, pia",
+    "frame buffer",
+    "cpu",
+    "first frame",
+    "frames",
+};
+
+/*------------------------------------------------
+ * boot_mark()
+ *
+ *  Record the end of a boot phase.
+ *
+ *  param:  Boot phase
+ *  return: Nothing
+ */
+void boot_mark(boot_phase_t phase)
+{
+    boot_time[phase] = rpi_system_timer();
+    boot_marked[phase] = 1;
+}
+
+/*------------------------------------------------
+ * boot_report()
+ *
+ *  Print the boot timeline on the serial console.
+ *  Times are micro-seconds since power-on, durations
+ *  are from the end of the previous phase that was reached.
+ *
+ *  param:  Nothing
+ *  return: Nothing
+ */
+void boot_report(void)
+{
+    uint32_t    previous;
+    int         phase;
+
+    printf("Boot timeline        time uS   phase uS\n");
+
+    previous = 0;
+
+    for ( phase = 0; phase < BOOT_PHASES; phase++ )
+    {
+        if ( !boot_marked[phase] )
+        {
+            printf("  %-15s %10s %10s\n", phase_names[phase], "-", "-");
+            continue;
+        }
+
+        printf("  %-15s %10u %10u\n", phase_names[phase], boot_time[phase], boot_time[phase] - previous);
+        previous = boot_time[phase];
+    }
+}
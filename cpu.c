@@ -20,6 +20,8 @@
 #include    "mc6809e.h"
 #include    "mem.h"
 #include    "cpu.h"
+#include    "trace.h"
+#include    "section.h"
 
 /* -----------------------------------------
    Local definitions
@@ -61,6 +63,101 @@
 #define     GET_REG_LOW(r)          ((uint8_t)r)
 #define     SIG_EXTEND(b)           ((((uint8_t)b) & 0x80) ? (((uint16_t)b) | 0xff00):((uint16_t)b))
 
+/* Op-code execution functions are always in-lined so that a call
+ * with a constant op-code compiles to the single case it executes.
+ */
+#define     CPU_INLINE              __attribute__((always_inline))
+
+/* Block execution
+ */
+#define     CPU_BLOCK               1000        // Maximum instructions per block
+#define     CPU_IDLE_CYCLES         2           // Cycles of a block that did not execute instructions
+
+/* Recompiled ROM blocks (CPU_ROM_RECOMP=1) execute several instructions
+ * per call, so they are not used when tracing single instructions
+ */
+#if (CPU_ROM_RECOMP==1 && CPU_TRACE==0)
+#define     CPU_RECOMP_BLOCKS       1
+#else
+#define     CPU_RECOMP_BLOCKS       0
+#endif
+
+/* BASIC's character fetch routine is executed natively, and for the same
+ * reason is not used when tracing single instructions
+ */
+#if (CPU_TRACE==0)
+#define     CPU_NATIVE_BLOCKS       1
+#else
+#define     CPU_NATIVE_BLOCKS       0
+#endif
+
+/* BASIC character fetch routine in direct page RAM, copied there from
+ * the ROM at start-up. GETNCH increments the text pointer CHARAD, which
+ * is the operand of its own LDA, and GETCCH only reloads the character.
+ * Both continue in the ROM at BROMHK, which skips spaces and sets
+ * CC for the digit tests of the caller.
+ */
+#define     GETNCH                  0x009f
+#define     GETCCH                  0x00a5
+#define     CHARAD                  0x00a6
+#define     GETNCH_JMP              0x00a8      // JMP >BROMHK after the LDA operand
+#define     BROMHK                  0xbb26
+
+#define     GETNCH_INC_CYCLES       9           // INC direct 6, BNE 3
+#define     GETNCH_INCH_CYCLES      6           // INC direct
+#define     GETNCH_LDA_CYCLES       14          // LDA extended 5, JMP extended 4, CMPA 2, BHS 3
+#define     GETNCH_SPACE_CYCLES     8           // CMPA 2, BNE 3, JMP direct 3
+#define     GETNCH_DIGIT_CYCLES     9           // CMPA 2, BNE 3, SUBA 2, SUBA 2
+#define     GETNCH_RTS_CYCLES       5
+
+/* Binary trace records (CPU_TRACE=2) are written by cpu_run(),
+ * so the ARM assembly core is not used when tracing to binary
+ */
+#if (CPU_ARM_CORE==1 && CPU_TRACE!=2)
+#define     CPU_ARM_BLOCKS          1
+#else
+#define     CPU_ARM_BLOCKS          0
+#endif
+
+/* Binary trace of serviced interrupts
+ */
+#if (CPU_TRACE==2)
+#define     TRACE_INTERRUPT(f)      (trace_record.flags = (f))
+#else
+#define     TRACE_INTERRUPT(f)
+#endif
+
+/* ARM assembly core (cpu_arm.S) block execution
+ */
+#define     CPU_ARM_IO_PAGE         0xff00      // Op-codes fetched from IO addresses are executed by cpu_run()
+
+#define     CPU_ARM_EXIT_OK         0           // Instruction count done or block ended on IO access
+#define     CPU_ARM_EXIT_FALLBACK   1           // Op-code at PC must be executed by cpu_run()
+#define     CPU_ARM_EXIT_EXCEPTION  2           // Illegal indexing mode
+
+/* ARM assembly core register context,
+ * field offsets must match the CTX_* definitions in cpu_arm.S
+ */
+typedef struct
+{
+    uint32_t    pc;
+    uint32_t    acc_d;
+    uint32_t    x;
+    uint32_t    y;
+    uint32_t    u;
+    uint32_t    s;
+    uint32_t    dpcc;               // DP in bits 15..8, CC in bits 7..0
+    uint8_t    *memory;             // Memory image from mem_get_map()
+    uint32_t    instructions;       // In: maximum to execute, out: executed
+    uint32_t    cycles;             // Out: CPU cycles of executed instructions
+    uint32_t    exit_reason;        // Out: CPU_ARM_EXIT_*
+} cpu_arm_context_t;
+
+/* Recompiled ROM block function (tools/recomp.c),
+ * returns the number of instructions executed
+ */
+typedef int (*rom_block_t)(int *cycles);
+
 /* -----------------------------------------
    Module static functions
 ----------------------------------------- */
@@ -69,65 +166,90 @@
  * These functions manipulate global variable,
  * CPU registers and CC flags.
  */
-static uint8_t adc(uint8_t acc, uint8_t byte);
-static uint8_t add(uint8_t acc, uint8_t byte);
-static void    addd(uint16_t word);
-static uint8_t and(uint8_t acc, uint8_t byte);
-static void    andcc(uint8_t byte);
-static uint8_t asl(uint8_t byte);
-static uint8_t asr(uint8_t byte);
-static void    bit(uint8_t acc, uint8_t byte);
-static uint8_t clr(void);
-static void    cmp(uint8_t arg, uint8_t byte);
-static void    cmp16(uint16_t arg, uint16_t word);
-static uint8_t com(uint8_t byte);
-static void    cwai(uint8_t byte);
-static void    daa(void);
-static uint8_t dec(uint8_t byte);
-static uint8_t eor(uint8_t acc, uint8_t byte);
-static void    exg(uint8_t regs);
-static uint8_t inc(uint8_t byte);
-static uint8_t lsr(uint8_t byte);
-static uint8_t neg(uint8_t byte);
-static uint8_t or(uint8_t acc, uint8_t byte);
-static void    orcc(uint8_t byte);
-static void    pshs(uint8_t push_list, int *cycles);
-static void    pshu(uint8_t push_list, int *cycles);
-static void    puls(uint8_t pull_list, int *cycles);
-static void    pulu(uint8_t pull_list, int *cycles);
-static uint8_t rol(uint8_t byte);
-static uint8_t ror(uint8_t byte);
-static void    rti(int *cycles);
-static uint8_t sbc(uint8_t acc, uint8_t byte);
-static void    sex(void);
-static uint8_t sub(uint8_t acc, uint8_t byte);
-static void    subd(uint16_t word);
-static void    swi(int swi_id);
-static void    tfr(uint8_t regs);
-static void    tst(uint8_t byte);
+static uint8_t adc(uint8_t acc, uint8_t byte) SECTION_HOT;
+static uint8_t add(uint8_t acc, uint8_t byte) SECTION_HOT;
+static void    addd(uint16_t word) SECTION_HOT;
+static uint8_t and(uint8_t acc, uint8_t byte) SECTION_HOT;
+static void    andcc(uint8_t byte) SECTION_HOT;
+static uint8_t asl(uint8_t byte) SECTION_HOT;
+static uint8_t asr(uint8_t byte) SECTION_HOT;
+static void    bit(uint8_t acc, uint8_t byte) SECTION_HOT;
+static uint8_t clr(void) SECTION_HOT;
+static void    cmp(uint8_t arg, uint8_t byte) SECTION_HOT;
+static void    cmp16(uint16_t arg, uint16_t word) SECTION_HOT;
+static uint8_t com(uint8_t byte) SECTION_HOT;
+static void    cwai(uint8_t byte) SECTION_HOT;
+static void    daa(void) SECTION_HOT;
+static uint8_t dec(uint8_t byte) SECTION_HOT;
+static uint8_t eor(uint8_t acc, uint8_t byte) SECTION_HOT;
+static void    exg(uint8_t regs) SECTION_HOT;
+static uint8_t inc(uint8_t byte) SECTION_HOT;
+static uint8_t lsr(uint8_t byte) SECTION_HOT;
+static uint8_t neg(uint8_t byte) SECTION_HOT;
+static uint8_t or(uint8_t acc, uint8_t byte) SECTION_HOT;
+static void    orcc(uint8_t byte) SECTION_HOT;
+static void    pshs(uint8_t push_list, int *cycles) SECTION_HOT;
+static void    pshu(uint8_t push_list, int *cycles) SECTION_HOT;
+static void    puls(uint8_t pull_list, int *cycles) SECTION_HOT;
+static void    pulu(uint8_t pull_list, int *cycles) SECTION_HOT;
+static uint8_t rol(uint8_t byte) SECTION_HOT;
+static uint8_t ror(uint8_t byte) SECTION_HOT;
+static void    rti(int *cycles) SECTION_HOT;
+static uint8_t sbc(uint8_t acc, uint8_t byte) SECTION_HOT;
+static void    sex(void) SECTION_HOT;
+static uint8_t sub(uint8_t acc, uint8_t byte) SECTION_HOT;
+static void    subd(uint16_t word) SECTION_HOT;
+static void    swi(int swi_id) SECTION_HOT;
+static void    tfr(uint8_t regs) SECTION_HOT;
+static void    tst(uint8_t byte) SECTION_HOT;
 
 /* CPU op-code support functions
  */
-static void     branch(int instruction, int long_short, uint16_t effective_address, int *cycles);
-static void     do_branch(int long_short, uint16_t effective_address, int *cycles);
-static int      get_eff_addr(int op_code, int *cycles, int *bytes);
-static uint16_t read_register(int reg);
-static void     write_register(int reg, uint16_t data);
+static inline void exec_op_code(int op_code, int eff_addr, int *cycles) CPU_INLINE;
+static inline void exec_op_code10(int op_code, int eff_addr, int *cycles) CPU_INLINE;
+static inline void exec_op_code11(int op_code, int eff_addr, int *cycles) CPU_INLINE;
+static void     branch(int instruction, int long_short, uint16_t effective_address, int *cycles) SECTION_HOT;
+static void     do_branch(int long_short, uint16_t effective_address, int *cycles) SECTION_HOT;
+static int      get_eff_addr(int op_code, int *cycles, int *bytes) SECTION_HOT;
+static uint16_t read_register(int reg) SECTION_HOT;
+static void     write_register(int reg, uint16_t data) SECTION_HOT;
 
 /* Condition code register CC functions
  */
-static void    eval_cc_c(uint16_t value);
-static void    eval_cc_c16(uint32_t value);
-static void    eval_cc_z(uint16_t value);
-static void    eval_cc_z16(uint32_t value);
-static void    eval_cc_n(uint16_t value);
-static void    eval_cc_n16(uint32_t value);
-static void    eval_cc_v(uint8_t val1, uint8_t val2, uint16_t result);
-static void    eval_cc_v16(uint16_t val1, uint16_t val2, uint32_t result);
-static void    eval_cc_h(uint8_t val1, uint8_t val2, uint8_t result);
+static void    eval_cc_c(uint16_t value) SECTION_HOT;
+static void    eval_cc_c16(uint32_t value) SECTION_HOT;
+static void    eval_cc_z(uint16_t value) SECTION_HOT;
+static void    eval_cc_z16(uint32_t value) SECTION_HOT;
+static void    eval_cc_n(uint16_t value) SECTION_HOT;
+static void    eval_cc_n16(uint32_t value) SECTION_HOT;
+static void    eval_cc_v(uint8_t val1, uint8_t val2, uint16_t result) SECTION_HOT;
+static void    eval_cc_v16(uint16_t val1, uint16_t val2, uint32_t result) SECTION_HOT;
+static void    eval_cc_h(uint8_t val1, uint8_t val2, uint8_t result) SECTION_HOT;
+
+static uint8_t get_cc(void) SECTION_HOT;
+static void    set_cc(uint8_t value) SECTION_HOT;
+
+/* Block execution
+ */
+static inline int cpu_run_required(void);
+#if (CPU_ARM_BLOCKS==1)
+static int     run_arm_block(int instructions) SECTION_HOT;
+#endif
+#if (CPU_RECOMP_BLOCKS==1 || CPU_NATIVE_BLOCKS==1)
+static int     run_rom_blocks(int instructions) SECTION_HOT;
+static int     run_getnch(int *cycles) SECTION_HOT;
+#endif
 
-static uint8_t get_cc(void);
-static void    set_cc(uint8_t value);
+/* Binary trace
+ */
+#if (CPU_TRACE==2)
+static void    trace_start(void);
+static void    trace_end(int eff_addr, int cycles);
+#endif
+
+/* ARM assembly core (cpu_arm.S)
+ */
+extern void    cpu_arm_run(cpu_arm_context_t *context);
 
 
 /* -----------------------------------------
@@ -136,7 +258,7 @@ static void    set_cc(uint8_t value);
 
 /* MC6809E register file
  */
-static cpu_state_t cpu;
+static cpu_state_t cpu SECTION_HOT_BSS;
 static struct cc_t
 {
     int c;
@@ -147,10 +269,46 @@ static struct cc_t
     int h;
     int f;
     int e;
-} cc;
+} cc SECTION_HOT_BSS;
 
 #define     d       ((uint16_t)(((uint16_t)cpu.a << 8) + cpu.b))    // Accumulator D
 
+/* Trace record of the instruction being executed
+ */
+#if (CPU_TRACE==2)
+static trace_record_t trace_record;
+#endif
+
+/* Recompiled ROM blocks and PC lookup table,
+ * generated at build time by tools/recomp
+ */
+#if (CPU_RECOMP_BLOCKS==1)
+#include    "dragon/recomp.h"
+#endif
+
+/* Recompiled ROM blocks and the native character fetch routine
+ * are used, changed by per-title profiles
+ */
+static int     rom_blocks_enabled = 1;
+
+/* Cycles of the current block's native instructions,
+ * for cpu_get_cycles() during the block
+ */
+static int     block_cycles = 0;
+
+#if (CPU_NATIVE_BLOCKS==1)
+/* Code of the character fetch routine, the LDA operand
+ * bytes at CHARAD are not compared
+ */
+static const uint8_t getnch_code[] = { 0x0c, 0xa7, 0x26, 0x02, 0x0c, 0xa6, 0xb6 };
+static const uint8_t getnch_jmp_code[] = { 0x7e, 0xbb, 0x26 };
+static const uint8_t bromhk_code[] =
+{
+    0x81, 0x3a, 0x24, 0x0a, 0x81, 0x20, 0x26, 0x02,
+    0x0e, 0x9f, 0x80, 0x30, 0x80, 0xd0, 0x39
+};
+#endif
+
 /*------------------------------------------------
  * cpu_init()
  *
@@ -186,6 +344,7 @@ int cpu_init(int address)
     cpu.int_latch = 0;
     cpu.cpu_state = CPU_HALTED;
     cpu.exception_line_num = -1;
+    cpu.cycle_clock = 0;
 
     /* Check start address and update PC
      */
@@ -252,14 +411,31 @@ void cpu_firq(int state)
 /*------------------------------------------------
  * cpu_irq()
  *
- *  Assert IRQ state
+ *  Assert IRQ state of the PIA field sync interrupt
  *
  *  param:  0- clear, 1- asserted
  *  return: Nothing
  */
 void cpu_irq(int state)
 {
-    cpu.irq_asserted = state;
+    cpu_irq_source(CPU_IRQ_PIA, state);
+}
+
+/*------------------------------------------------
+ * cpu_irq_source()
+ *
+ *  Assert IRQ state of one of the devices that share the IRQ line.
+ *  The line is asserted while any device asserts it.
+ *
+ *  param:  Device, CPU_IRQ_*, and 0- clear, 1- asserted
+ *  return: Nothing
+ */
+void cpu_irq_source(int source, int state)
+{
+    if ( state )
+        cpu.irq_asserted |= source;
+    else
+        cpu.irq_asserted &= ~source;
 }
 
 /*------------------------------------------------
@@ -278,8 +454,6 @@ cpu_run_state_t cpu_run(void)
     int         cycles;
     int         bytes;
     int         eff_addr;
-    uint8_t     operand8;
-    uint16_t    operand16;
 
     int  intr_latch = 0;
     int  op_code = -1;
@@ -391,6 +565,7 @@ cpu_run_state_t cpu_run(void)
             cc.i = CC_FLAG_SET;
 
             cpu.pc = (mem_read(VEC_NMI) << 8) + mem_read(VEC_NMI+1);
+            TRACE_INTERRUPT(TRACE_FLAG_NMI);
         }
         else if ( !(cc.f) && (intr_latch & INT_FIRQ) )
         {
@@ -408,6 +583,7 @@ cpu_run_state_t cpu_run(void)
             cc.i = CC_FLAG_SET;
 
             cpu.pc = (mem_read(VEC_FIRQ) << 8) + mem_read(VEC_FIRQ+1);
+            TRACE_INTERRUPT(TRACE_FLAG_FIRQ);
         }
         else if ( !(cc.i) && (intr_latch & INT_IRQ) )
         {
@@ -442,6 +618,7 @@ cpu_run_state_t cpu_run(void)
             cc.i = CC_FLAG_SET;
 
             cpu.pc = (mem_read(VEC_IRQ) << 8) + mem_read(VEC_IRQ+1);
+            TRACE_INTERRUPT(TRACE_FLAG_IRQ);
         }
 
         /* CPU now running so fetch instruction.
@@ -450,6 +627,10 @@ cpu_run_state_t cpu_run(void)
          */
         cpu.cpu_state = CPU_EXEC;
 
+#if (CPU_TRACE==2)
+        trace_start();
+#endif
+
         op_code = mem_read(cpu.pc);
         cpu.pc++;
 
@@ -462,7 +643,7 @@ cpu_run_state_t cpu_run(void)
 
             /* Search for 0x10 double byte op-code. If not found
              * then fall through the loop and catch the issue in the
-             * switch-case below.
+             * switch-case of exec_op_code10().
              * TODO change to binary search?
              */
             for ( op_code_index = OP_CODE10; op_code_index < OP_CODE11; op_code_index++ )
@@ -477,109 +658,7 @@ cpu_run_state_t cpu_run(void)
 
             eff_addr = get_eff_addr(op_code_index, &cycles, &bytes);
 
-            switch ( op_code )
-            {
-                /* CMPD
-                 */
-                case 0x83:
-                case 0x93:
-                case 0xa3:
-                case 0xb3:
-                    operand8 = (uint8_t) mem_read(eff_addr);
-                    eff_addr++;
-                    operand16 = ((uint16_t) operand8 << 8) + (uint16_t) mem_read(eff_addr);
-                    cmp16(d, operand16);
-                    break;
-
-                /* CMPY
-                 */
-                case 0x8c:
-                case 0x9c:
-                case 0xac:
-                case 0xbc:
-                    operand8 = (uint8_t) mem_read(eff_addr);
-                    eff_addr++;
-                    operand16 = ((uint16_t) operand8 << 8) + (uint16_t) mem_read(eff_addr);
-                    cmp16(cpu.y, operand16);
-                    break;
-
-                /* LDS
-                 */
-                case 0xce:
-                case 0xde:
-                case 0xee:
-                case 0xfe:
-                    operand8 = (uint8_t) mem_read(eff_addr);
-                    eff_addr++;
-                    cpu.s = ((uint16_t) operand8 << 8) + (uint16_t) mem_read(eff_addr);
-                    eval_cc_z16(cpu.s);
-                    eval_cc_n16(cpu.s);
-                    cc.v = CC_FLAG_CLR;
-                    cpu.nmi_armed = 1;
-                    break;
-
-                /* LDY
-                 */
-                case 0x8e:
-                case 0x9e:
-                case 0xae:
-                case 0xbe:
-                    operand8 = (uint8_t) mem_read(eff_addr);
-                    eff_addr++;
-                    cpu.y = ((uint16_t) operand8 << 8) + (uint16_t) mem_read(eff_addr);
-                    eval_cc_z16(cpu.y);
-                    eval_cc_n16(cpu.y);
-                    cc.v = CC_FLAG_CLR;
-                    break;
-
-                /* STS
-                 */
-                case 0xdf:
-                case 0xef:
-                case 0xff:
-                    mem_write(eff_addr, (uint8_t) (cpu.s >> 8));
-                    mem_write(eff_addr + 1, (uint8_t) (cpu.s));
-                    eval_cc_z16(cpu.s);
-                    eval_cc_n16(cpu.s);
-                    cc.v = CC_FLAG_CLR;
-                    break;
-
-                /* STY
-                 */
-                case 0x9f:
-                case 0xaf:
-                case 0xbf:
-                    mem_write(eff_addr, (uint8_t) (cpu.y >> 8));
-                    mem_write(eff_addr + 1, (uint8_t) (cpu.y));
-                    eval_cc_z16(cpu.y);
-                    eval_cc_n16(cpu.y);
-                    cc.v = CC_FLAG_CLR;
-                    break;
-
-                /* LBRN
-                 */
-                case 0x21:
-                    // Long branch never
-                    break;
-
-                /* Long conditional branches
-                 */
-                case 0x22 ... 0x2f:
-                    branch(op_code, 1, eff_addr, &cycles);
-                    break;
-
-                /* SWI2
-                 */
-                case 0x3f:
-                    swi(2);
-                    break;
-
-                default:
-                    /* Exception: Illegal 0x10 op-code cpu_run()
-                     */
-                    cpu.cpu_state = CPU_EXCEPTION;
-                    cpu.exception_line_num = __LINE__;
-            }
+            exec_op_code10(op_code, eff_addr, &cycles);
         }
         /* Double-byte 0x11 prefix
          */
@@ -589,7 +668,7 @@ cpu_run_state_t cpu_run(void)
             cpu.pc++;
             /* Search for 0x11 double byte op-code. If not found
              * then fall through the loop and catch the issue in the
-             * switch-case below.
+             * switch-case of exec_op_code11().
              * TODO change to binary search?
              */
             for ( op_code_index = OP_CODE11; op_code_index < sizeof(machine_code)/sizeof(machine_code_t); op_code_index++ )
@@ -604,1016 +683,678 @@ cpu_run_state_t cpu_run(void)
 
             eff_addr = get_eff_addr(op_code_index, &cycles, &bytes);
 
-            switch ( op_code )
-            {
-                /* CMPU
-                 */
-                case 0x83:
-                case 0x93:
-                case 0xa3:
-                case 0xb3:
-                    operand8 = (uint8_t) mem_read(eff_addr);
-                    eff_addr++;
-                    operand16 = ((uint16_t) operand8 << 8) + (uint16_t) mem_read(eff_addr);
-                    cmp16(cpu.u, operand16);
-                    break;
-
-                /* CMPS
-                 */
-                case 0x8c:
-                case 0x9c:
-                case 0xac:
-                case 0xbc:
-                    operand8 = (uint8_t) mem_read(eff_addr);
-                    eff_addr++;
-                    operand16 = ((uint16_t) operand8 << 8) + (uint16_t) mem_read(eff_addr);
-                    cmp16(cpu.s, operand16);
-                    break;
-
-                /* SWI3
-                 */
-                case 0x3f:
-                    swi(3);
-                    break;
-
-                default:
-                    /* Exception: Illegal 0x11 op-code cpu_run()
-                     */
-                    cpu.cpu_state = CPU_EXCEPTION;
-                    cpu.exception_line_num = __LINE__;
-            }
+            exec_op_code11(op_code, eff_addr, &cycles);
         }
         /* Common op-code processing
          */
         else
         {
-            /* 'operand8' will be operand byte, and for a 16-bit operand 'operand8'
-             * will be the high order byte and low order byte should be read separately
-             * and combined into 16-bit value.
-             */
             cycles = machine_code[op_code].cycles;
             bytes = machine_code[op_code].bytes;
 
             eff_addr = get_eff_addr(op_code, &cycles, &bytes);
 
-            switch ( op_code )
-            {
-                /* ABX
-                 */
-                case 0x3a:
-                    cpu.x += cpu.b;
-                    break;
+            exec_op_code(op_code, eff_addr, &cycles);
+        }
+    }
 
-                /* ADCA
-                 */
-                case 0x89:
-                case 0x99:
-                case 0xa9:
-                case 0xb9:
-                    operand8 = (uint8_t) mem_read(eff_addr);
-                    cpu.a = adc(cpu.a, operand8);
-                    break;
+    /* Preserves for other uses such as
+     * single step etc.
+     */
+    cpu.last_opcode_bytes = bytes;
+    cpu.last_opcode_cycles = cycles;
+    cpu.cc = get_cc();
 
-                /* ADCB
-                 */
-                case 0xc9:
-                case 0xd9:
-                case 0xe9:
-                case 0xf9:
-                    operand8 = (uint8_t) mem_read(eff_addr);
-                    cpu.b = adc(cpu.b, operand8);
-                    break;
+#if (CPU_TRACE==2)
+    if ( op_code != -1 )
+        trace_end(eff_addr, cycles);
+#endif
 
-                /* ADDA
-                 */
-                case 0x8b:
-                case 0x9b:
-                case 0xab:
-                case 0xbb:
-                    operand8 = (uint8_t) mem_read(eff_addr);
-                    cpu.a = add(cpu.a, operand8);
-                    break;
+    return cpu.cpu_state;
+}
 
-                /* ADDB
-                 */
-                case 0xcb:
-                case 0xdb:
-                case 0xeb:
-                case 0xfb:
-                    operand8 = (uint8_t) mem_read(eff_addr);
-                    cpu.b = add(cpu.b, operand8);
-                    break;
+/*------------------------------------------------
+ * cpu_run_block()
+ *
+ *  Execute a block of instructions.
+ *  When built with recompiled ROM blocks (CPU_ROM_RECOMP=1) instructions
+ *  in the BASIC ROM are executed by run_rom_blocks(), which also executes
+ *  BASIC's character fetch routine natively in all builds but CPU_TRACE.
+ *  When built with the ARM assembly core (CPU_ARM_CORE=1) the block is
+ *  executed by cpu_arm_run() and ends early on an IO access, so that
+ *  interrupt lines changed by peripherals are sampled before the next
+ *  instruction. Reset, halt, SYNC, pending interrupts and op-codes the
+ *  assembly core does not implement are handed to cpu_run().
+ *  Otherwise, and in CPU_TRACE builds, this executes a single cpu_run().
+ *
+ *  param:  Maximum number of instructions to execute
+ *  return: Number of instructions executed
+ */
+int cpu_run_block(int instructions)
+{
+    int     executed = 0;
 
-                /* ADDD
-                 */
-                case 0xc3:
-                case 0xd3:
-                case 0xe3:
-                case 0xf3:
-                    operand8 = (uint8_t) mem_read(eff_addr);
-                    eff_addr++;
-                    operand16 = ((uint16_t) operand8 << 8) + (uint16_t) mem_read(eff_addr);
-                    addd(operand16);
-                    break;
+#if (CPU_TRACE!=0)
+    instructions = 1;
+#endif
 
-                /* ANDA
-                 */
-                case 0x84:
-                case 0x94:
-                case 0xa4:
-                case 0xb4:
-                    operand8 = (uint8_t) mem_read(eff_addr);
-                    cpu.a = and(cpu.a, operand8);
-                    break;
+    if ( instructions > CPU_BLOCK )
+        instructions = CPU_BLOCK;
+    else if ( instructions < 1 )
+        instructions = 1;
 
-                /* ADDB
-                 */
-                case 0xc4:
-                case 0xd4:
-                case 0xe4:
-                case 0xf4:
-                    operand8 = (uint8_t) mem_read(eff_addr);
-                    cpu.b = and(cpu.b, operand8);
-                    break;
+#if (CPU_RECOMP_BLOCKS==1 || CPU_NATIVE_BLOCKS==1)
+    if ( rom_blocks_enabled )
+        executed = run_rom_blocks(instructions);
+#endif
 
-                /* ANDCC
-                 */
-                case 0x1c:
-                    operand8 = (uint8_t) mem_read(eff_addr);
-                    andcc(operand8);
-                    break;
+    if ( executed == 0 )
+    {
+#if (CPU_ARM_BLOCKS==1)
+        executed = run_arm_block(instructions);
+#else
+        cpu_run();
+        executed = 1;
+#endif
+    }
 
-                /* ASL, ASLA, ASLB
-                 * LSL, LSLA, LSLB
-                 */
-                case 0x08:
-                case 0x68:
-                case 0x78:
-                    operand8 = (uint8_t) mem_read(eff_addr);
-                    operand8 = asl(operand8);
-                    mem_write(eff_addr, operand8);
-                    break;
+    cpu.cycle_clock += cpu_get_block_cycles();
+    block_cycles = 0;
 
-                case 0x48:
-                    cpu.a = asl(cpu.a);
-                    break;
+    return executed;
+}
 
-                case 0x58:
-                    cpu.b = asl(cpu.b);
-                    break;
+/*------------------------------------------------
+ * cpu_get_state()
+ *
+ *  Get the state of the CPU.
+ *
+ *  param:  Pointer to CPU state data structure
+ *  return: CPU running state
+ */
+cpu_run_state_t cpu_get_state(cpu_state_t* cpu_state)
+{
+    memcpy(cpu_state, &cpu, sizeof(cpu_state_t));
 
-                /* ASR, ASRA, ASRB
-                 */
-                case 0x07:
-                case 0x67:
-                case 0x77:
-                    operand8 = (uint8_t) mem_read(eff_addr);
-                    operand8 = asr(operand8);
-                    mem_write(eff_addr, operand8);
-                    break;
+    return cpu.cpu_state;
+}
 
-                case 0x47:
-                    cpu.a = asr(cpu.a);
-                    break;
+/*------------------------------------------------
+ * cpu_get_block_cycles()
+ *
+ *  Get the CPU cycles of the last cpu_run_block().
+ *  A CPU that is halted, held in reset or waiting in SYNC
+ *  is counted as CPU_IDLE_CYCLES.
+ *
+ *  param:  Nothing
+ *  return: CPU cycles
+ */
+int cpu_get_block_cycles(void)
+{
+    if ( cpu.cpu_state != CPU_EXEC )
+        return CPU_IDLE_CYCLES;
 
-                case 0x57:
-                    cpu.b = asr(cpu.b);
-                    break;
+    return cpu.last_opcode_cycles;
+}
 
-                /* BITA
-                 */
-                case 0x85:
-                case 0x95:
-                case 0xa5:
-                case 0xb5:
-                    operand8 = (uint8_t) mem_read(eff_addr);
-                    bit(cpu.a, operand8);
-                    break;
+/*------------------------------------------------
+ * cpu_get_cycles()
+ *
+ *  Get the CPU cycle clock, for peripherals that time their
+ *  signals in emulated time. During a block of recompiled ROM code
+ *  the clock includes the block's instructions up to and including
+ *  the one being executed. Otherwise it is the clock at the start of
+ *  the block, which for the C core is the start of the instruction
+ *  and for the ARM assembly core the instruction after the last IO access.
+ *
+ *  param:  Nothing
+ *  return: CPU cycles, wraps around
+ */
+uint32_t cpu_get_cycles(void)
+{
+    return cpu.cycle_clock + block_cycles;
+}
 
-                /* BITB
-                 */
-                case 0xc5:
-                case 0xd5:
-                case 0xe5:
-                case 0xf5:
-                    operand8 = (uint8_t) mem_read(eff_addr);
-                    bit(cpu.b, operand8);
-                    break;
+/*------------------------------------------------
+ * cpu_set_rom_blocks()
+ *
+ *  Enable or disable the recompiled ROM blocks (CPU_ROM_RECOMP=1)
+ *  and the native character fetch routine.
+ *  When disabled, ROM code is interpreted one instruction at a time
+ *  like RAM code, for titles that patch or trace the ROM routines.
+ *
+ *  param:  1- enable, 0- disable
+ *  return: Nothing
+ */
+void cpu_set_rom_blocks(int enable)
+{
+    rom_blocks_enabled = enable;
+}
 
-                /* CLR, CLRA, CLRB
-                 */
-                case 0x0f:
-                case 0x6f:
-                case 0x7f:
-                    operand8 = clr();
-                    mem_write(eff_addr, operand8);
-                    break;
+/*------------------------------------------------
+ * cpu_set_state()
+ *
+ *  Set the state of the CPU, including the CC register and
+ *  interrupt lines, from a state saved by cpu_get_state().
+ *  Used by host tools that clone and restore machine state.
+ *
+ *  param:  Pointer to CPU state data structure
+ *  return: Nothing
+ */
+void cpu_set_state(cpu_state_t* cpu_state)
+{
+    memcpy(&cpu, cpu_state, sizeof(cpu_state_t));
+    set_cc(cpu.cc);
+}
 
-                case 0x4f:
-                    cpu.a = clr();
-                    break;
+/*------------------------------------------------
+ * cpu_get_menmonic()
+ *
+ *  Return a pointer to a constant string representing the
+ *  op-code's mnemonic at the input memory address.
+ *
+ *  param:  Memory address
+ *  return: Pointer to constant mnemonic string
+ */
+const char* cpu_get_menmonic(uint16_t address)
+{
+    int     i, op_code;
+    char   *mnemonic = 0;
 
-                case 0x5f:
-                    cpu.b = clr();
-                    break;
+    op_code = mem_read(address);
 
-                /* CMPA
-                 */
-                case 0x81:
-                case 0x91:
-                case 0xa1:
-                case 0xb1:
-                    operand8 = (uint8_t) mem_read(eff_addr);
-                    cmp(cpu.a, operand8);
-                    break;
+    if ( op_code == 0x10 )
+    {
+        op_code = mem_read(address + 1);
+        for ( i = OP_CODE10; i < OP_CODE11; i++ )
+        {
+            if ( op_code == machine_code[i].op )
+            {
+                mnemonic = machine_code[i].mnem;
+                break;
+            }
+        }
+    }
+    else if ( op_code == 0x11 )
+    {
+        op_code = mem_read(address + 1);
+        for ( i = OP_CODE11; i < sizeof(machine_code)/sizeof(machine_code_t); i++ )
+        {
+            if ( op_code == machine_code[i].op )
+            {
+                mnemonic = machine_code[i].mnem;
+                break;
+            }
+        }
+    }
+    else
+    {
+        mnemonic = machine_code[op_code].mnem;
+    }
 
-                /* CMPB
-                 */
-                case 0xc1:
-                case 0xd1:
-                case 0xe1:
-                case 0xf1:
-                    operand8 = (uint8_t) mem_read(eff_addr);
-                    cmp(cpu.b, operand8);
-                    break;
+    return mnemonic;
+}
 
-                /* CMPX
-                 */
-                case 0x8c:
-                case 0x9c:
-                case 0xac:
-                case 0xbc:
-                    operand8 = (uint8_t) mem_read(eff_addr);
-                    eff_addr++;
-                    operand16 = ((uint16_t) operand8 << 8) + (uint16_t) mem_read(eff_addr);
-                    cmp16(cpu.x, operand16);
-                    break;
+/*------------------------------------------------
+ * adc()
+ *
+ *  Add with carry.
+ *
+ *  acc+byte+carry
+ */
+static uint8_t adc(uint8_t acc, uint8_t byte)
+{
+    uint16_t result;
 
-                /* COM, COMA, COMB
-                 */
-                case 0x03:
-                case 0x63:
-                case 0x73:
-                    operand8 = (uint8_t) mem_read(eff_addr);
-                    operand8 = com(operand8);
-                    mem_write(eff_addr, operand8);
-                    break;
+    result = (acc + byte + cc.c);
 
-                case 0x43:
-                    cpu.a = com(cpu.a);
-                    break;
+    eval_cc_c(result);
+    eval_cc_z(result);
+    eval_cc_n(result);
+    eval_cc_v(acc, byte, result);
+    eval_cc_h(acc, byte, result);
 
-                case 0x53:
-                    cpu.b = com(cpu.b);
-                    break;
+    return (uint8_t) result;
+}
 
-                /* CWAI
-                 */
-                case 0x3c:
-                    operand8 = (uint8_t) mem_read(eff_addr);
-                    cwai(operand8);
-                    break;
-
-                /* DAA
-                 */
-                case 0x19:
-                    daa();
-                    break;
-
-                /* DEC, DECA, DECB
-                 */
-                case 0x0a:
-                case 0x6a:
-                case 0x7a:
-                    operand8 = (uint8_t) mem_read(eff_addr);
-                    operand8 = dec(operand8);
-                    mem_write(eff_addr, operand8);
-                    break;
-
-                case 0x4a:
-                    cpu.a = dec(cpu.a);
-                    break;
-
-                case 0x5a:
-                    cpu.b = dec(cpu.b);
-                    break;
-
-                /* EORA
-                 */
-                case 0x88:
-                case 0x98:
-                case 0xa8:
-                case 0xb8:
-                    operand8 = (uint8_t) mem_read(eff_addr);
-                    cpu.a = eor(cpu.a, operand8);
-                    break;
+/*------------------------------------------------
+ * add()
+ *
+ *  Add.
+ *
+ *  acc+byte
+ */
+static uint8_t add(uint8_t acc, uint8_t byte)
+{
+    uint16_t result;
 
-                /* EORB
-                 */
-                case 0xc8:
-                case 0xd8:
-                case 0xe8:
-                case 0xf8:
-                    operand8 = (uint8_t) mem_read(eff_addr);
-                    cpu.b = eor(cpu.b, operand8);
-                    break;
+    result = (acc + byte);
 
-                /* EXG
-                 */
-                case 0x1e:
-                    operand8 = (uint8_t) mem_read(eff_addr);
-                    exg(operand8);
-                    break;
+    eval_cc_c(result);
+    eval_cc_z(result);
+    eval_cc_n(result);
+    eval_cc_v(acc, byte, result);
+    eval_cc_h(acc, byte, result);
 
-                /* INC, INCA, INCB
-                 */
-                case 0x0c:
-                case 0x6c:
-                case 0x7c:
-                    operand8 = (uint8_t) mem_read(eff_addr);
-                    operand8 = inc(operand8);
-                    mem_write(eff_addr, operand8);
-                    break;
+    return (uint8_t) result;
+}
 
-                case 0x4c:
-                    cpu.a = inc(cpu.a);
-                    break;
+/*------------------------------------------------
+ * addd()
+ *
+ *  Add 16-bit operand to Acc-D
+ *
+ *  acc+word
+ */
+static void addd(uint16_t word)
+{
+    uint16_t acc;
+    uint32_t result;
 
-                case 0x5c:
-                    cpu.b = inc(cpu.b);
-                    break;
+    acc = (cpu.a << 8) + cpu.b;
+    result = acc + word;
 
-                /* JMP
-                 */
-                case 0x0e:
-                case 0x6e:
-                case 0x7e:
-                    cpu.pc = eff_addr;
-                    break;
+    cpu.a = result >> 8;
+    cpu.b = result & 0xff;
 
-                /* JSR
-                 */
-                case 0x9d:
-                case 0xad:
-                case 0xbd:
-                    cpu.s--;
-                    mem_write(cpu.s, GET_REG_LOW(cpu.pc));
-                    cpu.s--;
-                    mem_write(cpu.s, GET_REG_HIGH(cpu.pc));
-                    cpu.pc = eff_addr;
-                    break;
+    eval_cc_c16(result);
+    eval_cc_z16(result);
+    eval_cc_v16(acc, word, result);
+    eval_cc_n16(result);
+}
 
-                /* LDA
-                 */
-                case 0x86:
-                case 0x96:
-                case 0xa6:
-                case 0xb6:
-                    cpu.a = (uint8_t) mem_read(eff_addr);;
-                    eval_cc_z((uint16_t) cpu.a);
-                    eval_cc_n((uint16_t) cpu.a);
-                    cc.v = CC_FLAG_CLR;
-                    break;
+/*------------------------------------------------
+ * and()
+ *
+ *  Logical AND accumulator with byte operand.
+ *
+ */
+static uint8_t and(uint8_t acc, uint8_t byte)
+{
+    uint8_t result;
 
-                /* LDB
-                 */
-                case 0xc6:
-                case 0xd6:
-                case 0xe6:
-                case 0xf6:
-                    cpu.b = (uint8_t) mem_read(eff_addr);;
-                    eval_cc_z((uint16_t) cpu.b);
-                    eval_cc_n((uint16_t) cpu.b);
-                    cc.v = CC_FLAG_CLR;
-                    break;
+    result = (acc & byte);
 
-                /* LDD
-                 */
-                case 0xcc:
-                case 0xdc:
-                case 0xec:
-                case 0xfc:
-                    cpu.a = (uint8_t) mem_read(eff_addr);;
-                    eff_addr++;
-                    cpu.b = (uint8_t) mem_read(eff_addr);
-                    eval_cc_z16(d);
-                    eval_cc_n16(d);
-                    cc.v = CC_FLAG_CLR;
-                    break;
+    eval_cc_z((uint16_t) result);
+    eval_cc_n((uint16_t) result);
+    cc.v = CC_FLAG_CLR;
 
-                /* LDU
-                 */
-                case 0xce:
-                case 0xde:
-                case 0xee:
-                case 0xfe:
-                    operand8 = (uint8_t) mem_read(eff_addr);
-                    eff_addr++;
-                    cpu.u = ((uint16_t) operand8 << 8) + (uint16_t) mem_read(eff_addr);
-                    eval_cc_z16(cpu.u);
-                    eval_cc_n16(cpu.u);
-                    cc.v = CC_FLAG_CLR;
-                    break;
+    return result;
+}
 
-                /* LDX
-                 */
-                case 0x8e:
-                case 0x9e:
-                case 0xae:
-                case 0xbe:
-                    operand8 = (uint8_t) mem_read(eff_addr);
-                    eff_addr++;
-                    cpu.x = ((uint16_t) operand8 << 8) + (uint16_t) mem_read(eff_addr);
-                    eval_cc_z16(cpu.x);
-                    eval_cc_n16(cpu.x);
-                    cc.v = CC_FLAG_CLR;
-                    break;
+/*------------------------------------------------
+ * andcc()
+ *
+ *  Logical AND condition-code register with operand.
+ *
+ */
+static void andcc(uint8_t byte)
+{
+    uint8_t temp_cc;
 
-                /* LEA
-                 */
-                case 0x30:
-                    cpu.x = eff_addr;
-                    eval_cc_z16(cpu.x);
-                    break;
+    temp_cc = get_cc();
+    temp_cc &= byte;
+    set_cc(temp_cc);
+}
 
-                case 0x31:
-                    cpu.y = eff_addr;
-                    eval_cc_z16(cpu.y);
-                    break;
+/*------------------------------------------------
+ * asl()
+ *
+ *  Arithmetic shift left.
+ *
+ *  'byte' shift left, MSB into carry flag.
+ */
+static uint8_t asl(uint8_t byte)
+{
+    uint16_t result;
 
-                case 0x32:
-                    cpu.s = eff_addr;
-                    cpu.nmi_armed = 1;
-                    break;
+    result = ((uint16_t) byte) << 1;
 
-                case 0x33:
-                    cpu.u = eff_addr;
-                    break;
+    eval_cc_c(result);
+    eval_cc_z(result);
+    eval_cc_n(result);
+    eval_cc_v(byte, byte, result);
 
-                /* LSR, LSRA, LSRB
-                 */
-                case 0x04:
-                case 0x64:
-                case 0x74:
-                    operand8 = (uint8_t) mem_read(eff_addr);
-                    operand8 = lsr(operand8);
-                    mem_write(eff_addr, operand8);
-                    break;
+    return (uint8_t) result;
+}
 
-                case 0x44:
-                    cpu.a = lsr(cpu.a);
-                    break;
+/*------------------------------------------------
+ * asr()
+ *
+ *  Arithmetic shift right.
+ *
+ *  'byte' shift right, MSB replicated b7, LSB into carry flag.
+ */
+static uint8_t asr(uint8_t byte)
+{
+    uint8_t result;
 
-                case 0x54:
-                    cpu.b = lsr(cpu.b);
-                    break;
+    result = (byte >> 1) | (byte & 0x80);
 
-                /* MUL
-                 */
-                case 0x3d:
-                    operand16 = cpu.a * cpu.b;
-                    cpu.a = GET_REG_HIGH(operand16);
-                    cpu.b = GET_REG_LOW(operand16);
-                    eval_cc_z16(operand16);
-                    eval_cc_c(operand16);;
-                    break;
+    cc.c = byte & 0x01 ? CC_FLAG_SET : CC_FLAG_CLR;
+    eval_cc_z((uint16_t) result);
+    eval_cc_n((uint16_t) result);
 
-                /* NEG, NEGA, NEGB
-                 */
-                case 0x00:
-                case 0x60:
-                case 0x70:
-                    operand8 = (uint8_t) mem_read(eff_addr);
-                    operand8 = neg(operand8);
-                    mem_write(eff_addr, operand8);
-                    break;
+    return result;
+}
 
-                case 0x40:
-                    cpu.a = neg(cpu.a);
-                    break;
+/*------------------------------------------------
+ * bit()
+ *
+ *  Bit test accumulator with operand by AND
+ *  without changing accumulator.
+ *  Change flag bit appropriately.
+ *
+ *  acc AND byte
+ */
+static void bit(uint8_t acc, uint8_t byte)
+{
+    uint8_t result;
 
-                case 0x50:
-                    cpu.b = neg(cpu.b);
-                    break;
+    result = acc & byte;
 
-                /* NOP
-                 */
-                case 0x12:
-                    break;
+    eval_cc_z((uint16_t) result);
+    eval_cc_n((uint16_t) result);
+    cc.v = CC_FLAG_CLR;
+}
 
-                /* ORA, ORB
-                 */
-                case 0x8a:
-                case 0x9a:
-                case 0xaa:
-                case 0xba:
-                    operand8 = (uint8_t) mem_read(eff_addr);
-                    cpu.a = or(cpu.a, operand8);
-                    break;
+/*------------------------------------------------
+ * clr()
+ *
+ *  Clear (zero) bits in operand.
+ *  Change flag bit appropriately.
+ *
+ */
+static uint8_t clr(void)
+{
+    cc.c = CC_FLAG_CLR;
+    cc.v = CC_FLAG_CLR;
+    cc.z = CC_FLAG_SET;
+    cc.n = CC_FLAG_CLR;
 
-                case 0xca:
-                case 0xda:
-                case 0xea:
-                case 0xfa:
-                    operand8 = (uint8_t) mem_read(eff_addr);
-                    cpu.b = or(cpu.b, operand8);
-                    break;
+    return 0;
+}
 
-                /* ORCC
-                 */
-                case 0x1a:
-                    operand8 = (uint8_t) mem_read(eff_addr);
-                    orcc(operand8);
-                    break;
+/*------------------------------------------------
+ * cmp()
+ *
+ *  Compare 'arg' to 'byte' by subtracting
+ *  the byte from the argument and updating the
+ *  flags.
+ *
+ */
+static void cmp(uint8_t arg, uint8_t byte)
+{
+    uint16_t result;
 
-                /* PSHS, PSHU
-                 */
-                case 0x34:
-                    operand8 = (uint8_t) mem_read(eff_addr);
-                    pshs(operand8, &cycles);
-                    break;
+    result = arg - byte;
 
-                case 0x36:
-                    operand8 = (uint8_t) mem_read(eff_addr);
-                    pshu(operand8, &cycles);
-                    break;
+    eval_cc_c(result);
+    eval_cc_z(result);
+    eval_cc_n(result);
+    eval_cc_v(arg, ~byte, result);
+}
 
-                /* PULS, PULU
-                 */
-                case 0x35:
-                    operand8 = (uint8_t) mem_read(eff_addr);
-                    puls(operand8, &cycles);
-                    break;
+/*------------------------------------------------
+ * cmp16()
+ *
+ *  Compare 'arg' to 'word' by subtracting
+ *  the a 16-bit value from the argument and updating the
+ *  flags.
+ *
+ */
+static void cmp16(uint16_t arg, uint16_t word)
+{
+    uint32_t result;
 
-                case 0x37:
-                    operand8 = (uint8_t) mem_read(eff_addr);
-                    pulu(operand8, &cycles);
-                    break;
+    result = arg - word;
 
-                /* ROL, ROLA, ROLB
-                 */
-                case 0x09:
-                case 0x69:
-                case 0x79:
-                    operand8 = (uint8_t) mem_read(eff_addr);
-                    operand8 = rol(operand8);
-                    mem_write(eff_addr, operand8);
-                    break;
+    eval_cc_c16(result);
+    eval_cc_z16(result);
+    eval_cc_v16(arg, ~word, result);
+    eval_cc_n16(result);
+}
 
-                case 0x49:
-                    cpu.a = rol(cpu.a);
-                    break;
+/*------------------------------------------------
+ * com()
+ *
+ *  Complement (bit-wise NOT) a byte.
+ *
+ *  ~byte
+ */
+static uint8_t com(uint8_t byte)
+{
+    uint8_t result;
 
-                case 0x59:
-                    cpu.b = rol(cpu.b);
-                    break;
+    result = ~byte;
 
-                /* ROR, RORA, RORB
-                 */
-                case 0x06:
-                case 0x66:
-                case 0x76:
-                    operand8 = (uint8_t) mem_read(eff_addr);
-                    operand8 = ror(operand8);
-                    mem_write(eff_addr, operand8);
-                    break;
+    cc.c = CC_FLAG_SET;
+    cc.v = CC_FLAG_CLR;
+    eval_cc_z((uint16_t) result);
+    eval_cc_n((uint16_t) result);
 
-                case 0x46:
-                    cpu.a = ror(cpu.a);
-                    break;
+    return result;
+}
 
-                case 0x56:
-                    cpu.b = ror(cpu.b);
-                    break;
-
-                /* RTI
-                 */
-                case 0x3b:
-                    rti(&cycles);
-                    break;
-
-                /* RTS
-                 */
-                case 0x39:
-                     /* Restore PC and return
-                      */
-                     operand8 = mem_read(cpu.s);
-                     cpu.s++;
-                     cpu.pc = (uint16_t) operand8 << 8;
-                     operand8 = mem_read(cpu.s);
-                     cpu.s++;
-                     cpu.pc += operand8;
-                     break;
-
-                /* SBCA
-                 */
-                case 0x82:
-                case 0x92:
-                case 0xa2:
-                case 0xb2:
-                    operand8 = (uint8_t) mem_read(eff_addr);
-                    cpu.a = sbc(cpu.a, operand8);
-                    break;
-
-                /* SBCB
-                 */
-                case 0xc2:
-                case 0xd2:
-                case 0xe2:
-                case 0xf2:
-                    operand8 = (uint8_t) mem_read(eff_addr);
-                    cpu.b = sbc(cpu.b, operand8);
-                    break;
-
-                /* SEX
-                 */
-                case 0x1d:
-                    sex();
-                    break;
-
-                /* STA
-                 */
-                case 0x97:
-                case 0xa7:
-                case 0xb7:
-                    mem_write(eff_addr, cpu.a);
-                    eval_cc_z((uint16_t) cpu.a);
-                    eval_cc_n((uint16_t) cpu.a);
-                    cc.v = CC_FLAG_CLR;
-                    break;
-
-                /* STB
-                 */
-                case 0xd7:
-                case 0xe7:
-                case 0xf7:
-                    mem_write(eff_addr, cpu.b);
-                    eval_cc_z((uint16_t) cpu.b);
-                    eval_cc_n((uint16_t) cpu.b);
-                    cc.v = CC_FLAG_CLR;
-                    break;
-
-                /* STD
-                 */
-                case 0xdd:
-                case 0xed:
-                case 0xfd:
-                    mem_write(eff_addr, cpu.a);
-                    mem_write(eff_addr + 1, cpu.b);
-                    eval_cc_z16(d);
-                    eval_cc_n16(d);
-                    cc.v = CC_FLAG_CLR;
-                    break;
-
-                /* STU
-                 */
-                case 0xdf:
-                case 0xef:
-                case 0xff:
-                    mem_write(eff_addr, (uint8_t) (cpu.u >> 8));
-                    mem_write(eff_addr + 1, (uint8_t) (cpu.u));
-                    eval_cc_z16(cpu.u);
-                    eval_cc_n16(cpu.u);
-                    cc.v = CC_FLAG_CLR;
-                    break;
-
-                /* STX
-                 */
-                case 0x9f:
-                case 0xaf:
-                case 0xbf:
-                    mem_write(eff_addr, (uint8_t) (cpu.x >> 8));
-                    mem_write(eff_addr + 1, (uint8_t) (cpu.x));
-                    eval_cc_z16(cpu.x);
-                    eval_cc_n16(cpu.x);
-                    cc.v = CC_FLAG_CLR;
-                    break;
-
-                /* SUBA
-                 */
-                case 0x80:
-                case 0x90:
-                case 0xa0:
-                case 0xb0:
-                    operand8 = (uint8_t) mem_read(eff_addr);
-                    cpu.a = sub(cpu.a, operand8);
-                    break;
-
-                /* SUBB
-                 */
-                case 0xc0:
-                case 0xd0:
-                case 0xe0:
-                case 0xf0:
-                    operand8 = (uint8_t) mem_read(eff_addr);
-                    cpu.b = sub(cpu.b, operand8);
-                    break;
-
-                /* SUBD
-                 */
-                case 0x83:
-                case 0x93:
-                case 0xa3:
-                case 0xb3:
-                    operand8 = (uint8_t) mem_read(eff_addr);
-                    eff_addr++;
-                    operand16 = ((uint16_t ) operand8 << 8) + (uint16_t) mem_read(eff_addr);
-                    subd(operand16);
-                    break;
-
-                /* SWI
-                 */
-                case 0x3f:
-                    swi(1);
-                    break;
-
-                /* SYNC
-                 *
-                 * The SYNC instruction allows software to synchronize with an external hardware
-                 * event (interrupt). When executed, SYNC stops executing instructions and waits
-                 * for an interrupt. None of the CC flags are directly affected.
-                 */
-                case 0x13:
-                    cpu.cpu_state = CPU_SYNC;
-                    break;
-
-                /* TFR
-                 */
-                case 0x1f:
-                    operand8 = (uint8_t) mem_read(eff_addr);
-                    tfr(operand8);
-                    break;
-
-                /* TSTA
-                 */
-                case 0x4d:
-                    tst(cpu.a);
-                    break;
-
-                /* TSTB
-                 */
-                case 0x5d:
-                    tst(cpu.b);
-                    break;
+/*------------------------------------------------
+ * cwai()
+ *
+ *  This instruction logically ANDs the contents of the Condition Codes register with the 8-
+ *  bit value specified by the immediate operand. The result is placed back into the
+ *  Condition Codes register. The E flag in the CC register is then set and the entire machine
+ *  state is pushed onto the hardware stack (S). The CPU then halts execution and waits for
+ *  an unmasked interrupt to occur. When such an interrupt occurs, the CPU resumes
+ *  execution at the address obtained from the corresponding interrupt vector.
+ *
+ */
+static void cwai(uint8_t byte)
+{
+    uint8_t temp_cc;
 
-                /* TST
-                 */
-                case 0x0d:
-                case 0x6d:
-                case 0x7d:
-                    operand8 = (uint8_t) mem_read(eff_addr);
-                    tst(operand8);
-                    break;
+    temp_cc = get_cc();
+    temp_cc &= byte;
+    temp_cc |= 0x80;
+    set_cc(temp_cc);
 
-                /* BRA / LBRA
-                 */
-                case 0x20:
-                case 0x16:
-                    cpu.pc = eff_addr;
-                    break;
+    cpu.s--;
+    mem_write(cpu.s, cpu.pc & 0xff);
+    cpu.s--;
+    mem_write(cpu.s, (cpu.pc >> 8) & 0xff);
+    cpu.s--;
+    mem_write(cpu.s, cpu.u & 0xff);
+    cpu.s--;
+    mem_write(cpu.s, (cpu.u >> 8) & 0xff);
+    cpu.s--;
+    mem_write(cpu.s, cpu.y & 0xff);
+    cpu.s--;
+    mem_write(cpu.s, (cpu.y >> 8) & 0xff);
+    cpu.s--;
+    mem_write(cpu.s, cpu.x & 0xff);
+    cpu.s--;
+    mem_write(cpu.s, (cpu.x >> 8) & 0xff);
+    cpu.s--;
+    mem_write(cpu.s, cpu.dp);
+    cpu.s--;
+    mem_write(cpu.s, cpu.b);
+    cpu.s--;
+    mem_write(cpu.s, cpu.a);
+    cpu.s--;
+    mem_write(cpu.s, temp_cc);
 
-                /* BRN
-                 */
-                case 0x21:
-                    // Branch never
-                    break;
+    cpu.cpu_state = CPU_SYNC;
+}
 
-                /* BSR / LBSR
-                 */
-                case 0x8d:
-                case 0x17:
-                    cpu.s--;
-                    mem_write(cpu.s, GET_REG_LOW(cpu.pc));
-                    cpu.s--;
-                    mem_write(cpu.s, GET_REG_HIGH(cpu.pc));
-                    cpu.pc = eff_addr;
-                    break;
+/*------------------------------------------------
+ * daa()
+ *
+ *  Decimal adjust accumulator A
+ *
+ */
+static void daa(void)
+{
+    uint16_t    temp;
+    uint16_t    high_nibble;
+    uint16_t    low_nibble;
 
-                /* Short conditional branches
-                 */
-                case 0x22 ... 0x2f:
-                    branch(op_code, 0, eff_addr, &cycles);
-                    break;
+    temp = cpu.a;
+    high_nibble = temp & 0xf0;
+    low_nibble = temp & 0x0f;
 
-                default:
-                    /* Exception: Illegal op-code cpu_run()
-                     */
-                    cpu.cpu_state = CPU_EXCEPTION;
-                    cpu.exception_line_num = __LINE__;
-            }
-        }
-    }
+    if ( low_nibble > 0x09 || cc.h )
+        temp += 0x06;
+    if ( high_nibble > 0x80 && low_nibble > 0x09 )
+        temp += 0x60;
+    if (high_nibble > 0x90 || cc.c)
+        temp += 0x60;
 
-    /* Preserves for other uses such as
-     * single step etc.
-     */
-    cpu.last_opcode_bytes = bytes;
-    cpu.last_opcode_cycles = cycles;
-    cpu.cc = get_cc();
+    cpu.a = temp;
 
-    return cpu.cpu_state;
+    eval_cc_c(temp);
+    eval_cc_z(temp);
+    eval_cc_n(temp);
+    cc.v = CC_FLAG_CLR;
 }
 
 /*------------------------------------------------
- * cpu_get_state()
+ * dec()
  *
- *  Get the state of the CPU.
+ *  Decrement the operand.
  *
- *  param:  Pointer to CPU state data structure
- *  return: CPU running state
+ *  byte = byte - 1
  */
-cpu_run_state_t cpu_get_state(cpu_state_t* cpu_state)
+static uint8_t dec(uint8_t byte)
 {
-    memcpy(cpu_state, &cpu, sizeof(cpu_state_t));
+    uint16_t result;
 
-    return cpu.cpu_state;
+    result = byte - 1;
+
+    eval_cc_v(byte, 0xfe, result);
+    eval_cc_z(result);
+    eval_cc_n(result);
+
+    return (uint8_t) result;
 }
 
 /*------------------------------------------------
- * cpu_get_menmonic()
+ * eor()
  *
- *  Return a pointer to a constant string representing the
- *  op-code's mnemonic at the input memory address.
+ *  Exclusive OR accumulator with operand.
  *
- *  param:  Memory address
- *  return: Pointer to constant mnemonic string
+ *  acc ^ byte
  */
-const char* cpu_get_menmonic(uint16_t address)
+static uint8_t eor(uint8_t acc, uint8_t byte)
 {
-    int     i, op_code;
-    char   *mnemonic = 0;
+    uint8_t result;
 
-    op_code = mem_read(address);
+    result = acc ^ byte;
 
-    if ( op_code == 0x10 )
-    {
-        op_code = mem_read(address + 1);
-        for ( i = OP_CODE10; i < OP_CODE11; i++ )
-        {
-            if ( op_code == machine_code[i].op )
-            {
-                mnemonic = machine_code[i].mnem;
-                break;
-            }
-        }
-    }
-    else if ( op_code == 0x11 )
-    {
-        op_code = mem_read(address + 1);
-        for ( i = OP_CODE11; i < sizeof(machine_code)/sizeof(machine_code_t); i++ )
-        {
-            if ( op_code == machine_code[i].op )
-            {
-                mnemonic = machine_code[i].mnem;
-                break;
-            }
-        }
-    }
-    else
-    {
-        mnemonic = machine_code[op_code].mnem;
-    }
+    eval_cc_z((uint16_t) result);
+    eval_cc_n((uint16_t) result);
+    cc.v = CC_FLAG_CLR;
 
-    return mnemonic;
+    return result;
 }
 
 /*------------------------------------------------
- * adc()
+ * exg()
  *
- *  Add with carry.
+ *  Exchange like-sized registers.
+ *
+ *  NOTE: The function relies on the assembler to not mix
+ *  8-bit registers with 16-bit register, otherwise
+ *  results are unexpected.
+ *  Check: if (((regs ^ (regs << 4)) & 0x80) == 0) {...}
  *
- *  acc+byte+carry
  */
-static uint8_t adc(uint8_t acc, uint8_t byte)
+static void exg(uint8_t regs)
 {
-    uint16_t result;
+    int         src, dst;
+    uint16_t    temp1, temp2;
 
-    result = (acc + byte + cc.c);
+    src = (int)((regs >> 4) & 0x0f);
+    dst = (int)(regs & 0x0f);
 
-    eval_cc_c(result);
-    eval_cc_z(result);
-    eval_cc_n(result);
-    eval_cc_v(acc, byte, result);
-    eval_cc_h(acc, byte, result);
+    temp1 = read_register(src);
+    temp2 = read_register(dst);
 
-    return (uint8_t) result;
+    write_register(dst, temp1);
+    write_register(src, temp2);
 }
 
 /*------------------------------------------------
- * add()
+ * inc()
  *
- *  Add.
+ *  Increment the operand.
  *
- *  acc+byte
+ *  byte = byte + 1
  */
-static uint8_t add(uint8_t acc, uint8_t byte)
+static uint8_t inc(uint8_t byte)
 {
     uint16_t result;
 
-    result = (acc + byte);
+    result = byte + 1;
 
-    eval_cc_c(result);
+    eval_cc_v(byte, 1, result);
     eval_cc_z(result);
     eval_cc_n(result);
-    eval_cc_v(acc, byte, result);
-    eval_cc_h(acc, byte, result);
 
     return (uint8_t) result;
 }
 
 /*------------------------------------------------
- * addd()
+ * lsr()
  *
- *  Add 16-bit operand to Acc-D
- *
- *  acc+word
- */
-static void addd(uint16_t word)
-{
-    uint16_t acc;
-    uint32_t result;
-
-    acc = (cpu.a << 8) + cpu.b;
-    result = acc + word;
-
-    cpu.a = result >> 8;
-    cpu.b = result & 0xff;
-
-    eval_cc_c16(result);
-    eval_cc_z16(result);
-    eval_cc_v16(acc, word, result);
-    eval_cc_n16(result);
-}
-
-/*------------------------------------------------
- * and()
- *
- *  Logical AND accumulator with byte operand.
+ *  Logic shift right.
  *
+ *  'byte' shift right, MSB replicated with zero, LSB into carry flag.
  */
-static uint8_t and(uint8_t acc, uint8_t byte)
+static uint8_t lsr(uint8_t byte)
 {
     uint8_t result;
 
-    result = (acc & byte);
+    result = (byte >> 1) & 0x7f;
 
+    cc.c = byte & 0x01 ? CC_FLAG_SET : CC_FLAG_CLR;
     eval_cc_z((uint16_t) result);
-    eval_cc_n((uint16_t) result);
-    cc.v = CC_FLAG_CLR;
+    cc.n = CC_FLAG_CLR;
 
     return result;
 }
 
 /*------------------------------------------------
- * andcc()
- *
- *  Logical AND condition-code register with operand.
- *
- */
-static void andcc(uint8_t byte)
-{
-    uint8_t temp_cc;
-
-    temp_cc = get_cc();
-    temp_cc &= byte;
-    set_cc(temp_cc);
-}
-
-/*------------------------------------------------
- * asl()
+ * neg()
  *
- *  Arithmetic shift left.
+ *  Negate byte.
+ *  Two's complement: ~byte+1
  *
- *  'byte' shift left, MSB into carry flag.
  */
-static uint8_t asl(uint8_t byte)
+static uint8_t neg(uint8_t byte)
 {
     uint16_t result;
 
-    result = ((uint16_t) byte) << 1;
+    result =  0 - byte;
 
     eval_cc_c(result);
     eval_cc_z(result);
     eval_cc_n(result);
-    eval_cc_v(byte, byte, result);
+    eval_cc_v(0, ~byte, result);
 
     return (uint8_t) result;
 }
 
 /*------------------------------------------------
- * asr()
+ * or()
  *
- *  Arithmetic shift right.
+ *  Bit-wise logical OR between 'acc' and 'byte'
  *
- *  'byte' shift right, MSB replicated b7, LSB into carry flag.
  */
-static uint8_t asr(uint8_t byte)
+static uint8_t or(uint8_t acc, uint8_t byte)
 {
     uint8_t result;
 
-    result = (byte >> 1) | (byte & 0x80);
+    result = acc | byte;
 
-    cc.c = byte & 0x01 ? CC_FLAG_SET : CC_FLAG_CLR;
+    cc.v = CC_FLAG_CLR;
     eval_cc_z((uint16_t) result);
     eval_cc_n((uint16_t) result);
 
@@ -1621,196 +1362,355 @@ static uint8_t asr(uint8_t byte)
 }
 
 /*------------------------------------------------
- * bit()
+ * orcc()
  *
- *  Bit test accumulator with operand by AND
- *  without changing accumulator.
- *  Change flag bit appropriately.
+ *  Logical OR condition-code register with operand.
  *
- *  acc AND byte
  */
-static void bit(uint8_t acc, uint8_t byte)
+static void orcc(uint8_t byte)
 {
-    uint8_t result;
-
-    result = acc & byte;
+    uint8_t temp_cc;
 
-    eval_cc_z((uint16_t) result);
-    eval_cc_n((uint16_t) result);
-    cc.v = CC_FLAG_CLR;
+    temp_cc = get_cc();
+    temp_cc |= byte;
+    set_cc(temp_cc);
 }
 
 /*------------------------------------------------
- * clr()
+ * pshs()
  *
- *  Clear (zero) bits in operand.
- *  Change flag bit appropriately.
+ *  Push registers onto stack S (systems)
+ *  Modifies 's' stack register.
  *
+ *  param:  Push-list operand, and command cycles to update if needed.
+ *  return: Nothing
  */
-static uint8_t clr(void)
+static void pshs(uint8_t push_list, int *cycles)
 {
-    cc.c = CC_FLAG_CLR;
-    cc.v = CC_FLAG_CLR;
-    cc.z = CC_FLAG_SET;
-    cc.n = CC_FLAG_CLR;
+    (*cycles)++;
 
-    return 0;
+    if ( push_list & 0x80 )
+    {
+        (*cycles)++;
+        cpu.s--;
+        mem_write(cpu.s, cpu.pc & 0xff);
+        cpu.s--;
+        mem_write(cpu.s, (cpu.pc >> 8) & 0xff);
+    }
+
+    if ( push_list & 0x40 )
+    {
+        (*cycles)++;
+        cpu.s--;
+        mem_write(cpu.s, cpu.u & 0xff);
+        cpu.s--;
+        mem_write(cpu.s, (cpu.u >> 8) & 0xff);
+    }
+
+    if ( push_list & 0x20 )
+    {
+        (*cycles)++;
+        cpu.s--;
+        mem_write(cpu.s, cpu.y & 0xff);
+        cpu.s--;
+        mem_write(cpu.s, (cpu.y >> 8) & 0xff);
+    }
+
+    if ( push_list & 0x10 )
+    {
+        (*cycles)++;
+        cpu.s--;
+        mem_write(cpu.s, cpu.x & 0xff);
+        cpu.s--;
+        mem_write(cpu.s, (cpu.x >> 8) & 0xff);
+    }
+
+    if ( push_list & 0x08 )
+    {
+        cpu.s--;
+        mem_write(cpu.s, cpu.dp);
+    }
+
+    if ( push_list & 0x04 )
+    {
+        cpu.s--;
+        mem_write(cpu.s, cpu.b);
+    }
+
+    if ( push_list & 0x02 )
+    {
+        cpu.s--;
+        mem_write(cpu.s, cpu.a);
+    }
+
+    if ( push_list & 0x01 )
+    {
+        cpu.s--;
+        mem_write(cpu.s, (int) get_cc());
+    }
 }
 
 /*------------------------------------------------
- * cmp()
+ * pshu()
  *
- *  Compare 'arg' to 'byte' by subtracting
- *  the byte from the argument and updating the
- *  flags.
+ *  Push registers onto stack U (user)
+ *  Modifies 'u' stack register.
  *
+ *  param:  Push-list operand, and command cycles to update if needed.
+ *  return: Nothing
  */
-static void cmp(uint8_t arg, uint8_t byte)
+static void pshu(uint8_t push_list, int *cycles)
 {
-    uint16_t result;
+    (*cycles)++;
 
-    result = arg - byte;
+    if ( push_list & 0x80 )
+    {
+        (*cycles)++;
+        cpu.u--;
+        mem_write(cpu.u, cpu.pc & 0xff);
+        cpu.u--;
+        mem_write(cpu.u, (cpu.pc >> 8) & 0xff);
+    }
 
-    eval_cc_c(result);
-    eval_cc_z(result);
-    eval_cc_n(result);
-    eval_cc_v(arg, ~byte, result);
+    if ( push_list & 0x40 )
+    {
+        (*cycles)++;
+        cpu.u--;
+        mem_write(cpu.u, cpu.s & 0xff);
+        cpu.u--;
+        mem_write(cpu.u, (cpu.s >> 8) & 0xff);
+    }
+
+    if ( push_list & 0x20 )
+    {
+        (*cycles)++;
+        cpu.u--;
+        mem_write(cpu.u, cpu.y & 0xff);
+        cpu.u--;
+        mem_write(cpu.u, (cpu.y >> 8) & 0xff);
+    }
+
+    if ( push_list & 0x10 )
+    {
+        (*cycles)++;
+        cpu.u--;
+        mem_write(cpu.u, cpu.x & 0xff);
+        cpu.u--;
+        mem_write(cpu.u, (cpu.x >> 8) & 0xff);
+    }
+
+    if ( push_list & 0x08 )
+    {
+        cpu.u--;
+        mem_write(cpu.u, cpu.dp);
+    }
+
+    if ( push_list & 0x04 )
+    {
+        cpu.u--;
+        mem_write(cpu.u, cpu.b);
+    }
+
+    if ( push_list & 0x02 )
+    {
+        cpu.u--;
+        mem_write(cpu.u, cpu.a);
+    }
+
+    if ( push_list & 0x01 )
+    {
+        cpu.u--;
+        mem_write(cpu.u, get_cc());
+    }
 }
 
 /*------------------------------------------------
- * cmp16()
+ * puls()
  *
- *  Compare 'arg' to 'word' by subtracting
- *  the a 16-bit value from the argument and updating the
- *  flags.
+ *  Pull registers from stack S (systems)
+ *  Modifies 's' stack register.
  *
+ *  param:  Pull-list operand, and command cycles to update if needed.
+ *  return: Nothing
  */
-static void cmp16(uint16_t arg, uint16_t word)
+static void puls(uint8_t pull_list, int *cycles)
 {
-    uint32_t result;
+    uint16_t    val;
 
-    result = arg - word;
+    (*cycles)++;
 
-    eval_cc_c16(result);
-    eval_cc_z16(result);
-    eval_cc_v16(arg, ~word, result);
-    eval_cc_n16(result);
-}
+    if ( pull_list & 0x01 )
+    {
+        val = mem_read(cpu.s);
+        cpu.s++;
+        set_cc((uint8_t) val);
+    }
 
-/*------------------------------------------------
- * com()
- *
- *  Complement (bit-wise NOT) a byte.
- *
- *  ~byte
- */
-static uint8_t com(uint8_t byte)
-{
-    uint8_t result;
+    if ( pull_list & 0x02 )
+    {
+        val = mem_read(cpu.s);
+        cpu.s++;
+        cpu.a = val;
+    }
 
-    result = ~byte;
+    if ( pull_list & 0x04 )
+    {
+        val = mem_read(cpu.s);
+        cpu.s++;
+        cpu.b = val;
+    }
 
-    cc.c = CC_FLAG_SET;
-    cc.v = CC_FLAG_CLR;
-    eval_cc_z((uint16_t) result);
-    eval_cc_n((uint16_t) result);
+    if ( pull_list & 0x08 )
+    {
+        val = mem_read(cpu.s);
+        cpu.s++;
+        cpu.dp = val;
+    }
 
-    return result;
+    if ( pull_list & 0x10 )
+    {
+        (*cycles)++;
+        val = mem_read(cpu.s) << 8;
+        cpu.s++;
+        val += mem_read(cpu.s);
+        cpu.s++;
+        cpu.x = val;
+    }
+
+    if ( pull_list & 0x20 )
+    {
+        (*cycles)++;
+        val = mem_read(cpu.s) << 8;
+        cpu.s++;
+        val += mem_read(cpu.s);
+        cpu.s++;
+        cpu.y = val;
+    }
+
+    if ( pull_list & 0x40 )
+    {
+        (*cycles)++;
+        val = mem_read(cpu.s) << 8;
+        cpu.s++;
+        val += mem_read(cpu.s);
+        cpu.s++;
+        cpu.u = val;
+    }
+
+    if ( pull_list & 0x80 )
+    {
+        (*cycles)++;
+        val = mem_read(cpu.s) << 8;
+        cpu.s++;
+        val += mem_read(cpu.s);
+        cpu.s++;
+        cpu.pc = val;
+    }
 }
 
 /*------------------------------------------------
- * cwai()
+ * pulu()
  *
- *  This instruction logically ANDs the contents of the Condition Codes register with the 8-
- *  bit value specified by the immediate operand. The result is placed back into the
- *  Condition Codes register. The E flag in the CC register is then set and the entire machine
- *  state is pushed onto the hardware stack (S). The CPU then halts execution and waits for
- *  an unmasked interrupt to occur. When such an interrupt occurs, the CPU resumes
- *  execution at the address obtained from the corresponding interrupt vector.
+ *  Pull registers from stack U (user)
+ *  Modifies 'u' stack register.
  *
+ *  param:  Pull-list operand, and command cycles to update if needed.
+ *  return: Nothing
  */
-static void cwai(uint8_t byte)
+static void pulu(uint8_t pull_list, int *cycles)
 {
-    uint8_t temp_cc;
+    uint16_t    val;
 
-    temp_cc = get_cc();
-    temp_cc &= byte;
-    temp_cc |= 0x80;
-    set_cc(temp_cc);
+    (*cycles)++;
 
-    cpu.s--;
-    mem_write(cpu.s, cpu.pc & 0xff);
-    cpu.s--;
-    mem_write(cpu.s, (cpu.pc >> 8) & 0xff);
-    cpu.s--;
-    mem_write(cpu.s, cpu.u & 0xff);
-    cpu.s--;
-    mem_write(cpu.s, (cpu.u >> 8) & 0xff);
-    cpu.s--;
-    mem_write(cpu.s, cpu.y & 0xff);
-    cpu.s--;
-    mem_write(cpu.s, (cpu.y >> 8) & 0xff);
-    cpu.s--;
-    mem_write(cpu.s, cpu.x & 0xff);
-    cpu.s--;
-    mem_write(cpu.s, (cpu.x >> 8) & 0xff);
-    cpu.s--;
-    mem_write(cpu.s, cpu.dp);
-    cpu.s--;
-    mem_write(cpu.s, cpu.b);
-    cpu.s--;
-    mem_write(cpu.s, cpu.a);
-    cpu.s--;
-    mem_write(cpu.s, temp_cc);
+    if ( pull_list & 0x01 )
+    {
+        val = mem_read(cpu.u);
+        cpu.u++;
+        set_cc((uint8_t) val);
+    }
 
-    cpu.cpu_state = CPU_SYNC;
-}
+    if ( pull_list & 0x02 )
+    {
+        val = mem_read(cpu.u);
+        cpu.u++;
+        cpu.a = val;
+    }
 
-/*------------------------------------------------
- * daa()
- *
- *  Decimal adjust accumulator A
- *
- */
-static void daa(void)
-{
-    uint16_t    temp;
-    uint16_t    high_nibble;
-    uint16_t    low_nibble;
+    if ( pull_list & 0x04 )
+    {
+        val = mem_read(cpu.u);
+        cpu.u++;
+        cpu.b = val;
+    }
 
-    temp = cpu.a;
-    high_nibble = temp & 0xf0;
-    low_nibble = temp & 0x0f;
+    if ( pull_list & 0x08 )
+    {
+        val = mem_read(cpu.u);
+        cpu.u++;
+        cpu.dp = val;
+    }
 
-    if ( low_nibble > 0x09 || cc.h )
-        temp += 0x06;
-    if ( high_nibble > 0x80 && low_nibble > 0x09 )
-        temp += 0x60;
-    if (high_nibble > 0x90 || cc.c)
-        temp += 0x60;
+    if ( pull_list & 0x10 )
+    {
+        (*cycles)++;
+        val = mem_read(cpu.u) << 8;
+        cpu.u++;
+        val += mem_read(cpu.u);
+        cpu.u++;
+        cpu.x = val;
+    }
 
-    cpu.a = temp;
+    if ( pull_list & 0x20 )
+    {
+        (*cycles)++;
+        val = mem_read(cpu.u) << 8;
+        cpu.u++;
+        val += mem_read(cpu.u);
+        cpu.u++;
+        cpu.y = val;
+    }
 
-    eval_cc_c(temp);
-    eval_cc_z(temp);
-    eval_cc_n(temp);
-    cc.v = CC_FLAG_CLR;
+    if ( pull_list & 0x40 )
+    {
+        (*cycles)++;
+        val = mem_read(cpu.u) << 8;
+        cpu.u++;
+        val += mem_read(cpu.u);
+        cpu.u++;
+        cpu.s = val;
+    }
+
+    if ( pull_list & 0x80 )
+    {
+        (*cycles)++;
+        val = mem_read(cpu.u) << 8;
+        cpu.u++;
+        val += mem_read(cpu.u);
+        cpu.u++;
+        cpu.pc = val;
+    }
 }
 
 /*------------------------------------------------
- * dec()
+ * rol()
  *
- *  Decrement the operand.
+ *  Rotate left through Carry
  *
- *  byte = byte - 1
  */
-static uint8_t dec(uint8_t byte)
+static uint8_t rol(uint8_t byte)
 {
-    uint16_t result;
+    uint16_t    result;
 
-    result = byte - 1;
+    result = (byte << 1);
 
-    eval_cc_v(byte, 0xfe, result);
+    if ( cc.c )
+        result |= 0x0001;
+    else
+        result &= 0xfffe;
+
+    eval_cc_c(result);
+    eval_cc_v(byte, byte, result);
     eval_cc_z(result);
     eval_cc_n(result);
 
@@ -1818,899 +1718,1660 @@ static uint8_t dec(uint8_t byte)
 }
 
 /*------------------------------------------------
- * eor()
+ * ror()
  *
- *  Exclusive OR accumulator with operand.
+ *  Rotate right through Carry
  *
- *  acc ^ byte
  */
-static uint8_t eor(uint8_t acc, uint8_t byte)
+static uint8_t ror(uint8_t byte)
 {
-    uint8_t result;
+    uint16_t    result;
 
-    result = acc ^ byte;
 
-    eval_cc_z((uint16_t) result);
-    eval_cc_n((uint16_t) result);
-    cc.v = CC_FLAG_CLR;
+    result = byte;
 
-    return result;
-}
+    if ( cc.c )
+        result |= 0x0100;
+    else
+        result &= 0xfeff;
+
+    if ( byte & 0x01 )
+        cc.c = CC_FLAG_SET;
+    else
+        cc.c = CC_FLAG_CLR;
+
+    result = (result >> 1);
+
+    eval_cc_z(result);
+    eval_cc_n(result);
+
+    return (uint8_t) result;
+}
 
 /*------------------------------------------------
- * exg()
- *
- *  Exchange like-sized registers.
+ * rti()
  *
- *  NOTE: The function relies on the assembler to not mix
- *  8-bit registers with 16-bit register, otherwise
- *  results are unexpected.
- *  Check: if (((regs ^ (regs << 4)) & 0x80) == 0) {...}
+ *  Return from interrupt
  *
  */
-static void exg(uint8_t regs)
+static void rti(int *cycles)
 {
-    int         src, dst;
-    uint16_t    temp1, temp2;
+    uint8_t byte;
 
-    src = (int)((regs >> 4) & 0x0f);
-    dst = (int)(regs & 0x0f);
+    /* Restore CCR
+     */
+    byte = mem_read(cpu.s);
+    cpu.s++;
+    set_cc(byte);
 
-    temp1 = read_register(src);
-    temp2 = read_register(dst);
+    /* Restore registers if this is an extended
+     * interrupt frame (IRQ, NMI, SWIx)
+     */
+    if ( cc.e )
+    {
+        cpu.a = mem_read(cpu.s);
+        cpu.s++;
+        cpu.b = mem_read(cpu.s);
+        cpu.s++;
+        cpu.dp = mem_read(cpu.s);
+        cpu.s++;
+        cpu.x = mem_read(cpu.s) << 8;
+        cpu.s++;
+        cpu.x += mem_read(cpu.s);
+        cpu.s++;
+        cpu.y = mem_read(cpu.s) << 8;
+        cpu.s++;
+        cpu.y += mem_read(cpu.s);
+        cpu.s++;
+        cpu.u = mem_read(cpu.s) << 8;
+        cpu.s++;
+        cpu.u += mem_read(cpu.s);
+        cpu.s++;
 
-    write_register(dst, temp1);
-    write_register(src, temp2);
+        (*cycles) += 9;
+    }
+
+    /* Restore PC and return
+     */
+    byte = mem_read(cpu.s);
+    cpu.s++;
+    cpu.pc = (uint16_t) byte << 8;
+
+    byte = mem_read(cpu.s);
+    cpu.s++;
+    cpu.pc += (uint16_t) byte;
 }
 
 /*------------------------------------------------
- * inc()
+ * sbc()
  *
- *  Increment the operand.
+ *  Subtract with carry.
  *
- *  byte = byte + 1
+ *  acc-byte-carry
  */
-static uint8_t inc(uint8_t byte)
+static uint8_t sbc(uint8_t acc, uint8_t byte)
 {
     uint16_t result;
 
-    result = byte + 1;
+    result = acc - byte - cc.c;
 
-    eval_cc_v(byte, 1, result);
+    eval_cc_c(result);
     eval_cc_z(result);
     eval_cc_n(result);
+    eval_cc_v(acc, ~byte, result);
 
     return (uint8_t) result;
 }
 
 /*------------------------------------------------
- * lsr()
+ * sex()
  *
- *  Logic shift right.
+ *  Sign extend Acc-B to Acc-A
  *
- *  'byte' shift right, MSB replicated with zero, LSB into carry flag.
  */
-static uint8_t lsr(uint8_t byte)
+static void sex(void)
 {
-    uint8_t result;
-
-    result = (byte >> 1) & 0x7f;
-
-    cc.c = byte & 0x01 ? CC_FLAG_SET : CC_FLAG_CLR;
-    eval_cc_z((uint16_t) result);
-    cc.n = CC_FLAG_CLR;
+    if ( cpu.b & 0x80 )
+        cpu.a = 0xff;
+    else
+        cpu.a = 0;
 
-    return result;
+    cc.v = CC_FLAG_CLR;
+    eval_cc_z((uint16_t) cpu.a);
+    eval_cc_n((uint16_t) cpu.a);
 }
 
 /*------------------------------------------------
- * neg()
+ * sub()
  *
- *  Negate byte.
- *  Two's complement: ~byte+1
+ *  Subtract byte from Acc and set flags
  *
  */
-static uint8_t neg(uint8_t byte)
+static uint8_t sub(uint8_t acc, uint8_t byte)
 {
     uint16_t result;
 
-    result =  0 - byte;
+    result = acc - byte;
 
     eval_cc_c(result);
     eval_cc_z(result);
     eval_cc_n(result);
-    eval_cc_v(0, ~byte, result);
+    eval_cc_v(acc, ~byte, result);
 
     return (uint8_t) result;
 }
 
 /*------------------------------------------------
- * or()
+ * subd()
  *
- *  Bit-wise logical OR between 'acc' and 'byte'
+ *  Subtract word from D accumulator and set flags
+ *  Using 2's complement addition.
  *
  */
-static uint8_t or(uint8_t acc, uint8_t byte)
+static void subd(uint16_t word)
 {
-    uint8_t result;
+    uint16_t acc;
+    uint32_t result;
 
-    result = acc | byte;
+    acc = (cpu.a << 8) + cpu.b;
+    result = acc - word;
 
-    cc.v = CC_FLAG_CLR;
-    eval_cc_z((uint16_t) result);
-    eval_cc_n((uint16_t) result);
+    cpu.a = result >> 8;
+    cpu.b = result & 0xff;
 
-    return result;
+    eval_cc_c16(result);
+    eval_cc_z16(result);
+    eval_cc_v16(acc, ~word, result);
+    eval_cc_n16(result);
 }
 
 /*------------------------------------------------
- * orcc()
+ * swi()
  *
- *  Logical OR condition-code register with operand.
+ *  Software interrupt.
+ *  SWI type is input to the function:
+ *  SWI=1, SWI2=2, SWI3=3
  *
  */
-static void orcc(uint8_t byte)
+static void swi(int swi_id)
 {
-    uint8_t temp_cc;
+    cc.e = CC_FLAG_SET;
 
-    temp_cc = get_cc();
-    temp_cc |= byte;
-    set_cc(temp_cc);
+    cpu.s--;
+    mem_write(cpu.s, cpu.pc & 0xff);
+    cpu.s--;
+    mem_write(cpu.s, (cpu.pc >> 8) & 0xff);
+    cpu.s--;
+    mem_write(cpu.s, cpu.u & 0xff);
+    cpu.s--;
+    mem_write(cpu.s, (cpu.u >> 8) & 0xff);
+    cpu.s--;
+    mem_write(cpu.s, cpu.y & 0xff);
+    cpu.s--;
+    mem_write(cpu.s, (cpu.y >> 8) & 0xff);
+    cpu.s--;
+    mem_write(cpu.s, cpu.x & 0xff);
+    cpu.s--;
+    mem_write(cpu.s, (cpu.x >> 8) & 0xff);
+    cpu.s--;
+    mem_write(cpu.s, cpu.dp);
+    cpu.s--;
+    mem_write(cpu.s, cpu.b);
+    cpu.s--;
+    mem_write(cpu.s, cpu.a);
+    cpu.s--;
+    mem_write(cpu.s, get_cc());
+
+    switch ( swi_id )
+    {
+        case 1:
+            cc.i = CC_FLAG_SET;
+            cc.f = CC_FLAG_SET;
+            cpu.pc = (mem_read(VEC_SWI) << 8) + mem_read(VEC_SWI+1);
+            break;
+
+        case 2:
+            cpu.pc = (mem_read(VEC_SWI2) << 8) + mem_read(VEC_SWI2+1);
+            break;
+
+        case 3:
+            cpu.pc = (mem_read(VEC_SWI3) << 8) + mem_read(VEC_SWI3+1);
+            break;
+
+        default:
+            /* Exception: Illegal SWI type swi()
+             */
+            cpu.cpu_state = CPU_EXCEPTION;
+            cpu.exception_line_num = __LINE__;
+    }
 }
 
 /*------------------------------------------------
- * pshs()
+ * tfr()
  *
- *  Push registers onto stack S (systems)
- *  Modifies 's' stack register.
+ *  Transfer value from source register to destination register
+ *
+ *  NOTE: The function relies on the assembler to not mix
+ *  8-bit registers with 16-bit register, otherwise
+ *  results are unexpected.
+ *  Check: if (((regs ^ (regs << 4)) & 0x80) == 0) {...}
  *
- *  param:  Push-list operand, and command cycles to update if needed.
- *  return: Nothing
  */
-static void pshs(uint8_t push_list, int *cycles)
+static void tfr(uint8_t regs)
 {
-    (*cycles)++;
-
-    if ( push_list & 0x80 )
-    {
-        (*cycles)++;
-        cpu.s--;
-        mem_write(cpu.s, cpu.pc & 0xff);
-        cpu.s--;
-        mem_write(cpu.s, (cpu.pc >> 8) & 0xff);
-    }
+    int         src, dst;
+    uint16_t    temp1;
 
-    if ( push_list & 0x40 )
-    {
-        (*cycles)++;
-        cpu.s--;
-        mem_write(cpu.s, cpu.u & 0xff);
-        cpu.s--;
-        mem_write(cpu.s, (cpu.u >> 8) & 0xff);
-    }
+    src = (int)((regs >> 4) & 0x0f);
+    dst = (int)(regs & 0x0f);
 
-    if ( push_list & 0x20 )
-    {
-        (*cycles)++;
-        cpu.s--;
-        mem_write(cpu.s, cpu.y & 0xff);
-        cpu.s--;
-        mem_write(cpu.s, (cpu.y >> 8) & 0xff);
-    }
+    temp1 = read_register(src);
+    write_register(dst, temp1);
+}
 
-    if ( push_list & 0x10 )
-    {
-        (*cycles)++;
-        cpu.s--;
-        mem_write(cpu.s, cpu.x & 0xff);
-        cpu.s--;
-        mem_write(cpu.s, (cpu.x >> 8) & 0xff);
-    }
+/*------------------------------------------------
+ * tst()
+ *
+ *  Test 8 bit operand and set V,Z,N flags.
+ *
+ */
+static void tst(uint8_t byte)
+{
+    eval_cc_z((uint16_t) byte);
+    eval_cc_n((uint16_t) byte);
+    cc.v = CC_FLAG_CLR;
+}
 
-    if ( push_list & 0x08 )
+/*------------------------------------------------
+ * branch()
+ *
+ *  Implement conditional short branch and long branch.
+ *  The branch opcodes for both short and long variants are
+ *  identical except for the 0x10 byte prefix for long branches.
+ *  Calling code resolves long from short and then calls this function
+ *  to resolve branch condition and apply the offset.
+ *  To use this function with short branches (8-bit signed offset),
+ *  the branch offset must be sign-extended to 16-bit.
+ *
+ *  param:  Branch opcode, long ('1') or short ('0') branch, 16-bit sign-extended offset, 
+ *          pointer to opcode cycles.
+ *  return: Nothing
+ */
+static void branch(int instruction, int long_short, uint16_t effective_address, int *cycles)
+{
+    /* Parse the branch condition and apply
+       offset if branch is taken.
+     */
+    switch ( instruction )
     {
-        cpu.s--;
-        mem_write(cpu.s, cpu.dp);
-    }
+        /* BHI / LBHI
+         */
+        case 0x22:
+            if ( cc.c == CC_FLAG_CLR && cc.z == CC_FLAG_CLR )
+                do_branch(long_short, effective_address, cycles);
+            break;
 
-    if ( push_list & 0x04 )
-    {
-        cpu.s--;
-        mem_write(cpu.s, cpu.b);
-    }
+        /* BLS / LBLS
+         */
+        case 0x23:
+            if ( cc.c == CC_FLAG_SET || cc.z == CC_FLAG_SET )
+                do_branch(long_short, effective_address, cycles);
+            break;
 
-    if ( push_list & 0x02 )
-    {
-        cpu.s--;
-        mem_write(cpu.s, cpu.a);
-    }
+        /* BHS / LBHS / BCC / LBCC
+         */
+        case 0x24:
+            if ( cc.c == CC_FLAG_CLR )
+                do_branch(long_short, effective_address, cycles);
+            break;
 
-    if ( push_list & 0x01 )
-    {
-        cpu.s--;
-        mem_write(cpu.s, (int) get_cc());
+        /* BLO / LBLO / BCS / LBCS
+         */
+        case 0x25:
+            if ( cc.c == CC_FLAG_SET )
+                do_branch(long_short, effective_address, cycles);
+            break;
+
+        /* BNE / LBNE
+         */
+        case 0x26:
+            if ( cc.z == CC_FLAG_CLR )
+                do_branch(long_short, effective_address, cycles);
+            break;
+
+        /* BEQ / LBEQ
+         */
+        case 0x27:
+            if ( cc.z == CC_FLAG_SET )
+                do_branch(long_short, effective_address, cycles);
+            break;
+
+        /* BVC / LBVC
+         */
+        case 0x28:
+            if ( cc.v == CC_FLAG_CLR )
+                do_branch(long_short, effective_address, cycles);
+            break;
+
+        /* BVS / LBVS
+         */
+        case 0x29:
+            if ( cc.v == CC_FLAG_SET )
+                do_branch(long_short, effective_address, cycles);
+            break;
+
+        /* BPL / LBPL
+         */
+        case 0x2a:
+            if ( cc.n == CC_FLAG_CLR )
+                do_branch(long_short, effective_address, cycles);
+            break;
+
+        /* BMI / LBMI
+         */
+        case 0x2b:
+            if ( cc.n == CC_FLAG_SET )
+                do_branch(long_short, effective_address, cycles);
+            break;
+
+        /* BGE / LBGE
+         */
+        case 0x2c:
+            if ( cc.n == cc.v )
+                do_branch(long_short, effective_address, cycles);
+            break;
+
+        /* BLT / LBLT
+         */
+        case 0x2d:
+            if ( cc.n != cc.v )
+                do_branch(long_short, effective_address, cycles);
+            break;
+
+        /* BGT / LBGT
+         */
+        case 0x2e:
+            if ( cc.n == cc.v && cc.z == CC_FLAG_CLR )
+                do_branch(long_short, effective_address, cycles);
+            break;
+
+        /* BLE / LBLE
+         */
+        case 0x2f:
+            if ( cc.n != cc.v || cc.z == CC_FLAG_SET )
+                do_branch(long_short, effective_address, cycles);
+            break;
+
+        /* Exception: Illegal branch code branch()
+         *
+         * There should be no exception here because this function is always
+         * called from within a switch/case for a valid opcode range.
+         */
+        default:
+            cpu.cpu_state = CPU_EXCEPTION;
+            cpu.exception_line_num = __LINE__;
     }
 }
 
 /*------------------------------------------------
- * pshu()
+ * do_branch()
  *
- *  Push registers onto stack U (user)
- *  Modifies 'u' stack register.
+ *  Helper function to do the actual branch
+ *  by stacking the PC and changing to the target address.
  *
- *  param:  Push-list operand, and command cycles to update if needed.
+ *  param:  Long ('1') or short ('0') branch, 16-bit sign-extended offset,
+ *          pointer to opcode cycles.
  *  return: Nothing
  */
-static void pshu(uint8_t push_list, int *cycles)
+static void do_branch(int long_short, uint16_t effective_address, int *cycles)
 {
-    (*cycles)++;
-
-    if ( push_list & 0x80 )
-    {
-        (*cycles)++;
-        cpu.u--;
-        mem_write(cpu.u, cpu.pc & 0xff);
-        cpu.u--;
-        mem_write(cpu.u, (cpu.pc >> 8) & 0xff);
-    }
+    cpu.pc = effective_address;
+    (*cycles) += long_short;
+}
 
-    if ( push_list & 0x40 )
-    {
-        (*cycles)++;
-        cpu.u--;
-        mem_write(cpu.u, cpu.s & 0xff);
-        cpu.u--;
-        mem_write(cpu.u, (cpu.s >> 8) & 0xff);
-    }
+/*------------------------------------------------
+ * cpu_run_required()
+ *
+ *  Check if the next instruction must be executed by cpu_run() because
+ *  of reset, halt, a CPU state other than CPU_EXEC, or an interrupt that
+ *  cpu_run() will service before the next op-code fetch.
+ *
+ *  param:  Nothing
+ *  return: 1- cpu_run() is required, 0- block execution can continue
+ */
+static inline int cpu_run_required(void)
+{
+    return ( cpu.reset_asserted ||
+             cpu.halt_asserted ||
+             cpu.cpu_state != CPU_EXEC ||
+             (cpu.nmi_armed && cpu.nmi_latched) ||
+             (cpu.firq_asserted && !cc.f) ||
+             (cpu.irq_asserted && !cc.i) );
+}
 
-    if ( push_list & 0x20 )
-    {
-        (*cycles)++;
-        cpu.u--;
-        mem_write(cpu.u, cpu.y & 0xff);
-        cpu.u--;
-        mem_write(cpu.u, (cpu.y >> 8) & 0xff);
-    }
+#if (CPU_ARM_BLOCKS==1)
+/*------------------------------------------------
+ * run_arm_block()
+ *
+ *  Execute a block of instructions with the ARM assembly core.
+ *
+ *  param:  Maximum number of instructions to execute
+ *  return: Number of instructions executed
+ */
+static int run_arm_block(int instructions)
+{
+    cpu_arm_context_t   context;
+    int                 executed;
 
-    if ( push_list & 0x10 )
+    /* Conditions that the C core handles at instruction boundary
+     */
+    if ( cpu_run_required() ||
+         !cpu.nmi_armed ||
+         cpu.nmi_latched ||
+         cpu.pc >= CPU_ARM_IO_PAGE )
     {
-        (*cycles)++;
-        cpu.u--;
-        mem_write(cpu.u, cpu.x & 0xff);
-        cpu.u--;
-        mem_write(cpu.u, (cpu.x >> 8) & 0xff);
+        cpu_run();
+        return 1;
     }
 
-    if ( push_list & 0x08 )
+    context.pc = cpu.pc;
+    context.acc_d = d;
+    context.x = cpu.x;
+    context.y = cpu.y;
+    context.u = cpu.u;
+    context.s = cpu.s;
+    context.dpcc = (cpu.dp << 8) | get_cc();
+    context.memory = mem_get_map();
+    context.instructions = instructions;
+    context.cycles = 0;
+    context.exit_reason = CPU_ARM_EXIT_OK;
+
+    cpu.last_pc = cpu.pc;
+
+    cpu_arm_run(&context);
+
+    cpu.pc = (uint16_t) context.pc;
+    cpu.a = GET_REG_HIGH(context.acc_d);
+    cpu.b = GET_REG_LOW(context.acc_d);
+    cpu.x = (uint16_t) context.x;
+    cpu.y = (uint16_t) context.y;
+    cpu.u = (uint16_t) context.u;
+    cpu.s = (uint16_t) context.s;
+    cpu.dp = GET_REG_HIGH(context.dpcc);
+    set_cc(GET_REG_LOW(context.dpcc));
+
+    executed = context.instructions;
+    cpu.last_opcode_cycles = context.cycles;
+
+    if ( context.exit_reason == CPU_ARM_EXIT_FALLBACK )
     {
-        cpu.u--;
-        mem_write(cpu.u, cpu.dp);
+        cpu_run();
+        cpu.last_opcode_cycles += context.cycles;
+        executed++;
     }
-
-    if ( push_list & 0x04 )
+    else if ( context.exit_reason == CPU_ARM_EXIT_EXCEPTION )
     {
-        cpu.u--;
-        mem_write(cpu.u, cpu.b);
+        /* Exception: Illegal indexing mode cpu_arm_run()
+         */
+        cpu.cpu_state = CPU_EXCEPTION;
+        cpu.exception_line_num = __LINE__;
     }
 
-    if ( push_list & 0x02 )
-    {
-        cpu.u--;
-        mem_write(cpu.u, cpu.a);
-    }
+    cpu.cc = get_cc();
 
-    if ( push_list & 0x01 )
-    {
-        cpu.u--;
-        mem_write(cpu.u, get_cc());
-    }
+    return executed;
 }
+#endif
 
+#if (CPU_RECOMP_BLOCKS==1 || CPU_NATIVE_BLOCKS==1)
 /*------------------------------------------------
- * puls()
+ * run_rom_blocks()
  *
- *  Pull registers from stack S (systems)
- *  Modifies 's' stack register.
+ *  Execute recompiled ROM blocks for as long as PC is found
+ *  in the ROM block lookup table (see tools/recomp.c), and
+ *  the character fetch routine when PC is at one of its entries.
+ *  A block executes its op-codes through exec_op_code() and returns at
+ *  a control transfer, or after an instruction when cpu_run_required(),
+ *  so cycle counts and interrupt response are those of cpu_run().
  *
- *  param:  Pull-list operand, and command cycles to update if needed.
- *  return: Nothing
+ *  param:  Maximum number of instructions to execute
+ *  return: Number of instructions executed, '0' if PC is not in a native block
  */
-static void puls(uint8_t pull_list, int *cycles)
+static int run_rom_blocks(int instructions)
 {
-    uint16_t    val;
+#if (CPU_RECOMP_BLOCKS==1)
+    rom_block_t block;
+#endif
+    int         executed = 0;
+    int         count;
 
-    (*cycles)++;
+    cpu.last_pc = cpu.pc;
+    block_cycles = 0;
 
-    if ( pull_list & 0x01 )
+    while ( executed < instructions && !cpu_run_required() )
     {
-        val = mem_read(cpu.s);
-        cpu.s++;
-        set_cc((uint8_t) val);
+#if (CPU_RECOMP_BLOCKS==1)
+        if ( cpu.pc >= ROM_RECOMP_BASE &&
+             cpu.pc < (ROM_RECOMP_BASE + ROM_RECOMP_SIZE) &&
+             (block = rom_block_table[cpu.pc - ROM_RECOMP_BASE]) != 0 )
+        {
+            executed += block(&block_cycles);
+            continue;
+        }
+#endif
+
+        if ( (cpu.pc == GETNCH || cpu.pc == GETCCH) &&
+             (count = run_getnch(&block_cycles)) != 0 )
+        {
+            executed += count;
+            continue;
+        }
+
+        break;
     }
 
-    if ( pull_list & 0x02 )
+    if ( executed )
     {
-        val = mem_read(cpu.s);
-        cpu.s++;
-        cpu.a = val;
+        cpu.last_opcode_cycles = block_cycles;
+        cpu.cc = get_cc();
     }
 
-    if ( pull_list & 0x04 )
-    {
-        val = mem_read(cpu.s);
-        cpu.s++;
-        cpu.b = val;
-    }
-
-    if ( pull_list & 0x08 )
-    {
-        val = mem_read(cpu.s);
-        cpu.s++;
-        cpu.dp = val;
-    }
-
-    if ( pull_list & 0x10 )
-    {
-        (*cycles)++;
-        val = mem_read(cpu.s) << 8;
-        cpu.s++;
-        val += mem_read(cpu.s);
-        cpu.s++;
-        cpu.x = val;
-    }
-
-    if ( pull_list & 0x20 )
-    {
-        (*cycles)++;
-        val = mem_read(cpu.s) << 8;
-        cpu.s++;
-        val += mem_read(cpu.s);
-        cpu.s++;
-        cpu.y = val;
-    }
-
-    if ( pull_list & 0x40 )
-    {
-        (*cycles)++;
-        val = mem_read(cpu.s) << 8;
-        cpu.s++;
-        val += mem_read(cpu.s);
-        cpu.s++;
-        cpu.u = val;
-    }
-
-    if ( pull_list & 0x80 )
-    {
-        (*cycles)++;
-        val = mem_read(cpu.s) << 8;
-        cpu.s++;
-        val += mem_read(cpu.s);
-        cpu.s++;
-        cpu.pc = val;
-    }
+    return executed;
 }
 
 /*------------------------------------------------
- * pulu()
+ * run_getnch()
  *
- *  Pull registers from stack U (user)
- *  Modifies 'u' stack register.
+ *  Execute BASIC's character fetch routine from GETNCH or GETCCH
+ *  to its return, or to its jump back to GETNCH after a space.
+ *  The routine is only executed if its code in RAM and ROM is intact
+ *  and DP is 0, otherwise it is left to the interpreter. Memory
+ *  accesses, CC and cycle counts are those of its instructions.
  *
- *  param:  Pull-list operand, and command cycles to update if needed.
- *  return: Nothing
+ *  param:  Pointer to cycle count to add the routine's cycles to
+ *  return: Number of instructions executed, '0' if the routine was changed
  */
-static void pulu(uint8_t pull_list, int *cycles)
+static int run_getnch(int *cycles)
 {
-    uint16_t    val;
+    uint8_t    *memory;
+    int         executed = 0;
 
-    (*cycles)++;
+    memory = mem_get_map();
 
-    if ( pull_list & 0x01 )
+    if ( cpu.dp != 0 ||
+         memcmp(&memory[GETNCH], getnch_code, sizeof(getnch_code)) != 0 ||
+         memcmp(&memory[GETNCH_JMP], getnch_jmp_code, sizeof(getnch_jmp_code)) != 0 ||
+         memcmp(&memory[BROMHK], bromhk_code, sizeof(bromhk_code)) != 0 )
     {
-        val = mem_read(cpu.u);
-        cpu.u++;
-        set_cc((uint8_t) val);
+        return 0;
     }
 
-    if ( pull_list & 0x02 )
+    /* INC <CHARAD+1, BNE, and INC <CHARAD on a carry
+     */
+    if ( cpu.pc == GETNCH )
     {
-        val = mem_read(cpu.u);
-        cpu.u++;
-        cpu.a = val;
-    }
+        mem_write(CHARAD + 1, inc((uint8_t) mem_read(CHARAD + 1)));
+        executed += 2;
+        (*cycles) += GETNCH_INC_CYCLES;
 
-    if ( pull_list & 0x04 )
-    {
-        val = mem_read(cpu.u);
-        cpu.u++;
-        cpu.b = val;
+        if ( cc.z )
+        {
+            mem_write(CHARAD, inc((uint8_t) mem_read(CHARAD)));
+            executed++;
+            (*cycles) += GETNCH_INCH_CYCLES;
+        }
     }
 
-    if ( pull_list & 0x08 )
-    {
-        val = mem_read(cpu.u);
-        cpu.u++;
-        cpu.dp = val;
-    }
+    /* LDA >CHARAD, JMP >BROMHK, CMPA #':', BHS to RTS
+     */
+    cpu.a = (uint8_t) mem_read((mem_read(CHARAD) << 8) + mem_read(CHARAD + 1));
+    eval_cc_z((uint16_t) cpu.a);
+    eval_cc_n((uint16_t) cpu.a);
+    cc.v = CC_FLAG_CLR;
 
-    if ( pull_list & 0x10 )
-    {
-        (*cycles)++;
-        val = mem_read(cpu.u) << 8;
-        cpu.u++;
-        val += mem_read(cpu.u);
-        cpu.u++;
-        cpu.x = val;
-    }
+    cmp(cpu.a, ':');
+    executed += 4;
+    (*cycles) += GETNCH_LDA_CYCLES;
 
-    if ( pull_list & 0x20 )
+    if ( cc.c )
     {
-        (*cycles)++;
-        val = mem_read(cpu.u) << 8;
-        cpu.u++;
-        val += mem_read(cpu.u);
-        cpu.u++;
-        cpu.y = val;
-    }
+        /* CMPA #' ', BNE, and JMP <GETNCH on a space
+         */
+        cmp(cpu.a, ' ');
+        executed += 2;
 
-    if ( pull_list & 0x40 )
-    {
-        (*cycles)++;
-        val = mem_read(cpu.u) << 8;
-        cpu.u++;
-        val += mem_read(cpu.u);
-        cpu.u++;
-        cpu.s = val;
-    }
+        if ( cc.z )
+        {
+            cpu.pc = GETNCH;
+            executed++;
+            (*cycles) += GETNCH_SPACE_CYCLES;
+            return executed;
+        }
 
-    if ( pull_list & 0x80 )
-    {
-        (*cycles)++;
-        val = mem_read(cpu.u) << 8;
-        cpu.u++;
-        val += mem_read(cpu.u);
-        cpu.u++;
-        cpu.pc = val;
+        /* SUBA #'0', SUBA #-'0' set carry for a digit
+         */
+        cpu.a = sub(cpu.a, '0');
+        cpu.a = sub(cpu.a, (uint8_t) -'0');
+        executed += 2;
+        (*cycles) += GETNCH_DIGIT_CYCLES;
     }
+
+    /* RTS
+     */
+    cpu.pc = (uint16_t) mem_read(cpu.s) << 8;
+    cpu.pc += mem_read((uint16_t)(cpu.s + 1));
+    cpu.s += 2;
+    executed++;
+    (*cycles) += GETNCH_RTS_CYCLES;
+
+    return executed;
 }
+#endif
 
+#if (CPU_TRACE==2)
 /*------------------------------------------------
- * rol()
+ * trace_start()
  *
- *  Rotate left through Carry
+ *  Record the registers and the instruction bytes at PC
+ *  before the instruction is executed.
+ *  Bytes are read from the memory image so that IO
+ *  call-backs are not triggered.
  *
+ *  param:  Nothing
+ *  return: Nothing
  */
-static uint8_t rol(uint8_t byte)
+static void trace_start(void)
 {
-    uint16_t    result;
+    uint8_t    *memory;
+    int         i;
+
+    memory = mem_get_map();
+
+    trace_record.sync = TRACE_SYNC;
+    trace_record.pc = cpu.pc;
+    for ( i = 0; i < TRACE_CODE_BYTES; i++ )
+        trace_record.code[i] = memory[(cpu.pc + i) & 0xffff];
+
+    trace_record.a = cpu.a;
+    trace_record.b = cpu.b;
+    trace_record.dp = cpu.dp;
+    trace_record.cc = get_cc();
+    trace_record.x = cpu.x;
+    trace_record.y = cpu.y;
+    trace_record.u = cpu.u;
+    trace_record.s = cpu.s;
+}
 
-    result = (byte << 1);
+/*------------------------------------------------
+ * trace_end()
+ *
+ *  Complete the trace record of the executed instruction
+ *  and queue it in the trace buffer.
+ *
+ *  param:  Effective address and cycle count of the instruction
+ *  return: Nothing
+ */
+static void trace_end(int eff_addr, int cycles)
+{
+    trace_record.eff_addr = eff_addr;
+    trace_record.cycles = cycles;
 
-    if ( cc.c )
-        result |= 0x0001;
-    else
-        result &= 0xfffe;
+    if ( cpu.cpu_state == CPU_EXCEPTION )
+        trace_record.flags |= TRACE_FLAG_EXCEPTION;
 
-    eval_cc_c(result);
-    eval_cc_v(byte, byte, result);
-    eval_cc_z(result);
-    eval_cc_n(result);
+    trace_write(&trace_record);
 
-    return (uint8_t) result;
+    trace_record.flags = 0;
 }
+#endif
 
 /*------------------------------------------------
- * ror()
+ * exec_op_code10()
  *
- *  Rotate right through Carry
+ *  Execute a 0x10 prefixed op-code.
+ *  The effective address was already resolved by get_eff_addr()
+ *  and PC points to the next op-code. Shared by cpu_run() and the
+ *  recompiled ROM blocks, where a constant op-code reduces the
+ *  switch-case to the single executed case.
  *
+ *  param:  Op-code, effective address, pointer to cycle count to update if needed
+ *  return: Nothing
  */
-static uint8_t ror(uint8_t byte)
+static inline void exec_op_code10(int op_code, int eff_addr, int *cycles)
 {
-    uint16_t    result;
+    uint8_t     operand8;
+    uint16_t    operand16;
 
+    switch ( op_code )
+    {
+        /* CMPD
+         */
+        case 0x83:
+        case 0x93:
+        case 0xa3:
+        case 0xb3:
+            operand8 = (uint8_t) mem_read(eff_addr);
+            eff_addr++;
+            operand16 = ((uint16_t) operand8 << 8) + (uint16_t) mem_read(eff_addr);
+            cmp16(d, operand16);
+            break;
 
-    result = byte;
+        /* CMPY
+         */
+        case 0x8c:
+        case 0x9c:
+        case 0xac:
+        case 0xbc:
+            operand8 = (uint8_t) mem_read(eff_addr);
+            eff_addr++;
+            operand16 = ((uint16_t) operand8 << 8) + (uint16_t) mem_read(eff_addr);
+            cmp16(cpu.y, operand16);
+            break;
 
-    if ( cc.c )
-        result |= 0x0100;
-    else
-        result &= 0xfeff;
+        /* LDS
+         */
+        case 0xce:
+        case 0xde:
+        case 0xee:
+        case 0xfe:
+            operand8 = (uint8_t) mem_read(eff_addr);
+            eff_addr++;
+            cpu.s = ((uint16_t) operand8 << 8) + (uint16_t) mem_read(eff_addr);
+            eval_cc_z16(cpu.s);
+            eval_cc_n16(cpu.s);
+            cc.v = CC_FLAG_CLR;
+            cpu.nmi_armed = 1;
+            break;
 
-    if ( byte & 0x01 )
-        cc.c = CC_FLAG_SET;
-    else
-        cc.c = CC_FLAG_CLR;
+        /* LDY
+         */
+        case 0x8e:
+        case 0x9e:
+        case 0xae:
+        case 0xbe:
+            operand8 = (uint8_t) mem_read(eff_addr);
+            eff_addr++;
+            cpu.y = ((uint16_t) operand8 << 8) + (uint16_t) mem_read(eff_addr);
+            eval_cc_z16(cpu.y);
+            eval_cc_n16(cpu.y);
+            cc.v = CC_FLAG_CLR;
+            break;
 
-    result = (result >> 1);
+        /* STS
+         */
+        case 0xdf:
+        case 0xef:
+        case 0xff:
+            mem_write(eff_addr, (uint8_t) (cpu.s >> 8));
+            mem_write(eff_addr + 1, (uint8_t) (cpu.s));
+            eval_cc_z16(cpu.s);
+            eval_cc_n16(cpu.s);
+            cc.v = CC_FLAG_CLR;
+            break;
 
-    eval_cc_z(result);
-    eval_cc_n(result);
+        /* STY
+         */
+        case 0x9f:
+        case 0xaf:
+        case 0xbf:
+            mem_write(eff_addr, (uint8_t) (cpu.y >> 8));
+            mem_write(eff_addr + 1, (uint8_t) (cpu.y));
+            eval_cc_z16(cpu.y);
+            eval_cc_n16(cpu.y);
+            cc.v = CC_FLAG_CLR;
+            break;
 
-    return (uint8_t) result;
+        /* LBRN
+         */
+        case 0x21:
+            // Long branch never
+            break;
+
+        /* Long conditional branches
+         */
+        case 0x22 ... 0x2f:
+            branch(op_code, 1, eff_addr, cycles);
+            break;
+
+        /* SWI2
+         */
+        case 0x3f:
+            swi(2);
+            break;
+
+        default:
+            /* Exception: Illegal 0x10 op-code exec_op_code10()
+             */
+            cpu.cpu_state = CPU_EXCEPTION;
+            cpu.exception_line_num = __LINE__;
+    }
 }
 
 /*------------------------------------------------
- * rti()
+ * exec_op_code11()
  *
- *  Return from interrupt
+ *  Execute a 0x11 prefixed op-code.
+ *  The effective address was already resolved by get_eff_addr()
+ *  and PC points to the next op-code. Shared by cpu_run() and the
+ *  recompiled ROM blocks, where a constant op-code reduces the
+ *  switch-case to the single executed case.
  *
+ *  param:  Op-code, effective address, pointer to cycle count to update if needed
+ *  return: Nothing
  */
-static void rti(int *cycles)
+static inline void exec_op_code11(int op_code, int eff_addr, int *cycles)
 {
-    uint8_t byte;
-
-    /* Restore CCR
-     */
-    byte = mem_read(cpu.s);
-    cpu.s++;
-    set_cc(byte);
+    uint8_t     operand8;
+    uint16_t    operand16;
 
-    /* Restore registers if this is an extended
-     * interrupt frame (IRQ, NMI, SWIx)
-     */
-    if ( cc.e )
+    switch ( op_code )
     {
-        cpu.a = mem_read(cpu.s);
-        cpu.s++;
-        cpu.b = mem_read(cpu.s);
-        cpu.s++;
-        cpu.dp = mem_read(cpu.s);
-        cpu.s++;
-        cpu.x = mem_read(cpu.s) << 8;
-        cpu.s++;
-        cpu.x += mem_read(cpu.s);
-        cpu.s++;
-        cpu.y = mem_read(cpu.s) << 8;
-        cpu.s++;
-        cpu.y += mem_read(cpu.s);
-        cpu.s++;
-        cpu.u = mem_read(cpu.s) << 8;
-        cpu.s++;
-        cpu.u += mem_read(cpu.s);
-        cpu.s++;
+        /* CMPU
+         */
+        case 0x83:
+        case 0x93:
+        case 0xa3:
+        case 0xb3:
+            operand8 = (uint8_t) mem_read(eff_addr);
+            eff_addr++;
+            operand16 = ((uint16_t) operand8 << 8) + (uint16_t) mem_read(eff_addr);
+            cmp16(cpu.u, operand16);
+            break;
 
-        (*cycles) += 9;
-    }
+        /* CMPS
+         */
+        case 0x8c:
+        case 0x9c:
+        case 0xac:
+        case 0xbc:
+            operand8 = (uint8_t) mem_read(eff_addr);
+            eff_addr++;
+            operand16 = ((uint16_t) operand8 << 8) + (uint16_t) mem_read(eff_addr);
+            cmp16(cpu.s, operand16);
+            break;
 
-    /* Restore PC and return
-     */
-    byte = mem_read(cpu.s);
-    cpu.s++;
-    cpu.pc = (uint16_t) byte << 8;
+        /* SWI3
+         */
+        case 0x3f:
+            swi(3);
+            break;
 
-    byte = mem_read(cpu.s);
-    cpu.s++;
-    cpu.pc += (uint16_t) byte;
+        default:
+            /* Exception: Illegal 0x11 op-code exec_op_code11()
+             */
+            cpu.cpu_state = CPU_EXCEPTION;
+            cpu.exception_line_num = __LINE__;
+    }
 }
 
 /*------------------------------------------------
- * sbc()
+ * exec_op_code()
  *
- *  Subtract with carry.
+ *  Execute a single byte op-code.
+ *  The effective address was already resolved by get_eff_addr()
+ *  and PC points to the next op-code. Shared by cpu_run() and the
+ *  recompiled ROM blocks, where a constant op-code reduces the
+ *  switch-case to the single executed case.
  *
- *  acc-byte-carry
+ *  param:  Op-code, effective address, pointer to cycle count to update if needed
+ *  return: Nothing
  */
-static uint8_t sbc(uint8_t acc, uint8_t byte)
+static inline void exec_op_code(int op_code, int eff_addr, int *cycles)
 {
-    uint16_t result;
+    /* 'operand8' will be operand byte, and for a 16-bit operand 'operand8'
+     * will be the high order byte and low order byte should be read separately
+     * and combined into 16-bit value.
+     */
+    uint8_t     operand8;
+    uint16_t    operand16;
 
-    result = acc - byte - cc.c;
+    switch ( op_code )
+    {
+        /* ABX
+         */
+        case 0x3a:
+            cpu.x += cpu.b;
+            break;
 
-    eval_cc_c(result);
-    eval_cc_z(result);
-    eval_cc_n(result);
-    eval_cc_v(acc, ~byte, result);
+        /* ADCA
+         */
+        case 0x89:
+        case 0x99:
+        case 0xa9:
+        case 0xb9:
+            operand8 = (uint8_t) mem_read(eff_addr);
+            cpu.a = adc(cpu.a, operand8);
+            break;
 
-    return (uint8_t) result;
-}
+        /* ADCB
+         */
+        case 0xc9:
+        case 0xd9:
+        case 0xe9:
+        case 0xf9:
+            operand8 = (uint8_t) mem_read(eff_addr);
+            cpu.b = adc(cpu.b, operand8);
+            break;
 
-/*------------------------------------------------
- * sex()
- *
- *  Sign extend Acc-B to Acc-A
- *
- */
-static void sex(void)
-{
-    if ( cpu.b & 0x80 )
-        cpu.a = 0xff;
-    else
-        cpu.a = 0;
+        /* ADDA
+         */
+        case 0x8b:
+        case 0x9b:
+        case 0xab:
+        case 0xbb:
+            operand8 = (uint8_t) mem_read(eff_addr);
+            cpu.a = add(cpu.a, operand8);
+            break;
 
-    cc.v = CC_FLAG_CLR;
-    eval_cc_z((uint16_t) cpu.a);
-    eval_cc_n((uint16_t) cpu.a);
-}
+        /* ADDB
+         */
+        case 0xcb:
+        case 0xdb:
+        case 0xeb:
+        case 0xfb:
+            operand8 = (uint8_t) mem_read(eff_addr);
+            cpu.b = add(cpu.b, operand8);
+            break;
+
+        /* ADDD
+         */
+        case 0xc3:
+        case 0xd3:
+        case 0xe3:
+        case 0xf3:
+            operand8 = (uint8_t) mem_read(eff_addr);
+            eff_addr++;
+            operand16 = ((uint16_t) operand8 << 8) + (uint16_t) mem_read(eff_addr);
+            addd(operand16);
+            break;
+
+        /* ANDA
+         */
+        case 0x84:
+        case 0x94:
+        case 0xa4:
+        case 0xb4:
+            operand8 = (uint8_t) mem_read(eff_addr);
+            cpu.a = and(cpu.a, operand8);
+            break;
+
+        /* ADDB
+         */
+        case 0xc4:
+        case 0xd4:
+        case 0xe4:
+        case 0xf4:
+            operand8 = (uint8_t) mem_read(eff_addr);
+            cpu.b = and(cpu.b, operand8);
+            break;
+
+        /* ANDCC
+         */
+        case 0x1c:
+            operand8 = (uint8_t) mem_read(eff_addr);
+            andcc(operand8);
+            break;
+
+        /* ASL, ASLA, ASLB
+         * LSL, LSLA, LSLB
+         */
+        case 0x08:
+        case 0x68:
+        case 0x78:
+            operand8 = (uint8_t) mem_read(eff_addr);
+            operand8 = asl(operand8);
+            mem_write(eff_addr, operand8);
+            break;
+
+        case 0x48:
+            cpu.a = asl(cpu.a);
+            break;
+
+        case 0x58:
+            cpu.b = asl(cpu.b);
+            break;
+
+        /* ASR, ASRA, ASRB
+         */
+        case 0x07:
+        case 0x67:
+        case 0x77:
+            operand8 = (uint8_t) mem_read(eff_addr);
+            operand8 = asr(operand8);
+            mem_write(eff_addr, operand8);
+            break;
+
+        case 0x47:
+            cpu.a = asr(cpu.a);
+            break;
+
+        case 0x57:
+            cpu.b = asr(cpu.b);
+            break;
+
+        /* BITA
+         */
+        case 0x85:
+        case 0x95:
+        case 0xa5:
+        case 0xb5:
+            operand8 = (uint8_t) mem_read(eff_addr);
+            bit(cpu.a, operand8);
+            break;
+
+        /* BITB
+         */
+        case 0xc5:
+        case 0xd5:
+        case 0xe5:
+        case 0xf5:
+            operand8 = (uint8_t) mem_read(eff_addr);
+            bit(cpu.b, operand8);
+            break;
+
+        /* CLR, CLRA, CLRB
+         */
+        case 0x0f:
+        case 0x6f:
+        case 0x7f:
+            operand8 = clr();
+            mem_write(eff_addr, operand8);
+            break;
+
+        case 0x4f:
+            cpu.a = clr();
+            break;
+
+        case 0x5f:
+            cpu.b = clr();
+            break;
+
+        /* CMPA
+         */
+        case 0x81:
+        case 0x91:
+        case 0xa1:
+        case 0xb1:
+            operand8 = (uint8_t) mem_read(eff_addr);
+            cmp(cpu.a, operand8);
+            break;
+
+        /* CMPB
+         */
+        case 0xc1:
+        case 0xd1:
+        case 0xe1:
+        case 0xf1:
+            operand8 = (uint8_t) mem_read(eff_addr);
+            cmp(cpu.b, operand8);
+            break;
+
+        /* CMPX
+         */
+        case 0x8c:
+        case 0x9c:
+        case 0xac:
+        case 0xbc:
+            operand8 = (uint8_t) mem_read(eff_addr);
+            eff_addr++;
+            operand16 = ((uint16_t) operand8 << 8) + (uint16_t) mem_read(eff_addr);
+            cmp16(cpu.x, operand16);
+            break;
+
+        /* COM, COMA, COMB
+         */
+        case 0x03:
+        case 0x63:
+        case 0x73:
+            operand8 = (uint8_t) mem_read(eff_addr);
+            operand8 = com(operand8);
+            mem_write(eff_addr, operand8);
+            break;
+
+        case 0x43:
+            cpu.a = com(cpu.a);
+            break;
+
+        case 0x53:
+            cpu.b = com(cpu.b);
+            break;
+
+        /* CWAI
+         */
+        case 0x3c:
+            operand8 = (uint8_t) mem_read(eff_addr);
+            cwai(operand8);
+            break;
+
+        /* DAA
+         */
+        case 0x19:
+            daa();
+            break;
+
+        /* DEC, DECA, DECB
+         */
+        case 0x0a:
+        case 0x6a:
+        case 0x7a:
+            operand8 = (uint8_t) mem_read(eff_addr);
+            operand8 = dec(operand8);
+            mem_write(eff_addr, operand8);
+            break;
+
+        case 0x4a:
+            cpu.a = dec(cpu.a);
+            break;
+
+        case 0x5a:
+            cpu.b = dec(cpu.b);
+            break;
+
+        /* EORA
+         */
+        case 0x88:
+        case 0x98:
+        case 0xa8:
+        case 0xb8:
+            operand8 = (uint8_t) mem_read(eff_addr);
+            cpu.a = eor(cpu.a, operand8);
+            break;
+
+        /* EORB
+         */
+        case 0xc8:
+        case 0xd8:
+        case 0xe8:
+        case 0xf8:
+            operand8 = (uint8_t) mem_read(eff_addr);
+            cpu.b = eor(cpu.b, operand8);
+            break;
+
+        /* EXG
+         */
+        case 0x1e:
+            operand8 = (uint8_t) mem_read(eff_addr);
+            exg(operand8);
+            break;
+
+        /* INC, INCA, INCB
+         */
+        case 0x0c:
+        case 0x6c:
+        case 0x7c:
+            operand8 = (uint8_t) mem_read(eff_addr);
+            operand8 = inc(operand8);
+            mem_write(eff_addr, operand8);
+            break;
+
+        case 0x4c:
+            cpu.a = inc(cpu.a);
+            break;
+
+        case 0x5c:
+            cpu.b = inc(cpu.b);
+            break;
+
+        /* JMP
+         */
+        case 0x0e:
+        case 0x6e:
+        case 0x7e:
+            cpu.pc = eff_addr;
+            break;
+
+        /* JSR
+         */
+        case 0x9d:
+        case 0xad:
+        case 0xbd:
+            cpu.s--;
+            mem_write(cpu.s, GET_REG_LOW(cpu.pc));
+            cpu.s--;
+            mem_write(cpu.s, GET_REG_HIGH(cpu.pc));
+            cpu.pc = eff_addr;
+            break;
+
+        /* LDA
+         */
+        case 0x86:
+        case 0x96:
+        case 0xa6:
+        case 0xb6:
+            cpu.a = (uint8_t) mem_read(eff_addr);;
+            eval_cc_z((uint16_t) cpu.a);
+            eval_cc_n((uint16_t) cpu.a);
+            cc.v = CC_FLAG_CLR;
+            break;
+
+        /* LDB
+         */
+        case 0xc6:
+        case 0xd6:
+        case 0xe6:
+        case 0xf6:
+            cpu.b = (uint8_t) mem_read(eff_addr);;
+            eval_cc_z((uint16_t) cpu.b);
+            eval_cc_n((uint16_t) cpu.b);
+            cc.v = CC_FLAG_CLR;
+            break;
+
+        /* LDD
+         */
+        case 0xcc:
+        case 0xdc:
+        case 0xec:
+        case 0xfc:
+            cpu.a = (uint8_t) mem_read(eff_addr);;
+            eff_addr++;
+            cpu.b = (uint8_t) mem_read(eff_addr);
+            eval_cc_z16(d);
+            eval_cc_n16(d);
+            cc.v = CC_FLAG_CLR;
+            break;
+
+        /* LDU
+         */
+        case 0xce:
+        case 0xde:
+        case 0xee:
+        case 0xfe:
+            operand8 = (uint8_t) mem_read(eff_addr);
+            eff_addr++;
+            cpu.u = ((uint16_t) operand8 << 8) + (uint16_t) mem_read(eff_addr);
+            eval_cc_z16(cpu.u);
+            eval_cc_n16(cpu.u);
+            cc.v = CC_FLAG_CLR;
+            break;
+
+        /* LDX
+         */
+        case 0x8e:
+        case 0x9e:
+        case 0xae:
+        case 0xbe:
+            operand8 = (uint8_t) mem_read(eff_addr);
+            eff_addr++;
+            cpu.x = ((uint16_t) operand8 << 8) + (uint16_t) mem_read(eff_addr);
+            eval_cc_z16(cpu.x);
+            eval_cc_n16(cpu.x);
+            cc.v = CC_FLAG_CLR;
+            break;
+
+        /* LEA
+         */
+        case 0x30:
+            cpu.x = eff_addr;
+            eval_cc_z16(cpu.x);
+            break;
+
+        case 0x31:
+            cpu.y = eff_addr;
+            eval_cc_z16(cpu.y);
+            break;
+
+        case 0x32:
+            cpu.s = eff_addr;
+            cpu.nmi_armed = 1;
+            break;
+
+        case 0x33:
+            cpu.u = eff_addr;
+            break;
+
+        /* LSR, LSRA, LSRB
+         */
+        case 0x04:
+        case 0x64:
+        case 0x74:
+            operand8 = (uint8_t) mem_read(eff_addr);
+            operand8 = lsr(operand8);
+            mem_write(eff_addr, operand8);
+            break;
+
+        case 0x44:
+            cpu.a = lsr(cpu.a);
+            break;
+
+        case 0x54:
+            cpu.b = lsr(cpu.b);
+            break;
+
+        /* MUL
+         */
+        case 0x3d:
+            operand16 = cpu.a * cpu.b;
+            cpu.a = GET_REG_HIGH(operand16);
+            cpu.b = GET_REG_LOW(operand16);
+            eval_cc_z16(operand16);
+            eval_cc_c(operand16);;
+            break;
+
+        /* NEG, NEGA, NEGB
+         */
+        case 0x00:
+        case 0x60:
+        case 0x70:
+            operand8 = (uint8_t) mem_read(eff_addr);
+            operand8 = neg(operand8);
+            mem_write(eff_addr, operand8);
+            break;
+
+        case 0x40:
+            cpu.a = neg(cpu.a);
+            break;
+
+        case 0x50:
+            cpu.b = neg(cpu.b);
+            break;
+
+        /* NOP
+         */
+        case 0x12:
+            break;
+
+        /* ORA, ORB
+         */
+        case 0x8a:
+        case 0x9a:
+        case 0xaa:
+        case 0xba:
+            operand8 = (uint8_t) mem_read(eff_addr);
+            cpu.a = or(cpu.a, operand8);
+            break;
 
-/*------------------------------------------------
- * sub()
- *
- *  Subtract byte from Acc and set flags
- *
- */
-static uint8_t sub(uint8_t acc, uint8_t byte)
-{
-    uint16_t result;
+        case 0xca:
+        case 0xda:
+        case 0xea:
+        case 0xfa:
+            operand8 = (uint8_t) mem_read(eff_addr);
+            cpu.b = or(cpu.b, operand8);
+            break;
 
-    result = acc - byte;
+        /* ORCC
+         */
+        case 0x1a:
+            operand8 = (uint8_t) mem_read(eff_addr);
+            orcc(operand8);
+            break;
 
-    eval_cc_c(result);
-    eval_cc_z(result);
-    eval_cc_n(result);
-    eval_cc_v(acc, ~byte, result);
+        /* PSHS, PSHU
+         */
+        case 0x34:
+            operand8 = (uint8_t) mem_read(eff_addr);
+            pshs(operand8, cycles);
+            break;
 
-    return (uint8_t) result;
-}
+        case 0x36:
+            operand8 = (uint8_t) mem_read(eff_addr);
+            pshu(operand8, cycles);
+            break;
 
-/*------------------------------------------------
- * subd()
- *
- *  Subtract word from D accumulator and set flags
- *  Using 2's complement addition.
- *
- */
-static void subd(uint16_t word)
-{
-    uint16_t acc;
-    uint32_t result;
+        /* PULS, PULU
+         */
+        case 0x35:
+            operand8 = (uint8_t) mem_read(eff_addr);
+            puls(operand8, cycles);
+            break;
 
-    acc = (cpu.a << 8) + cpu.b;
-    result = acc - word;
+        case 0x37:
+            operand8 = (uint8_t) mem_read(eff_addr);
+            pulu(operand8, cycles);
+            break;
 
-    cpu.a = result >> 8;
-    cpu.b = result & 0xff;
+        /* ROL, ROLA, ROLB
+         */
+        case 0x09:
+        case 0x69:
+        case 0x79:
+            operand8 = (uint8_t) mem_read(eff_addr);
+            operand8 = rol(operand8);
+            mem_write(eff_addr, operand8);
+            break;
 
-    eval_cc_c16(result);
-    eval_cc_z16(result);
-    eval_cc_v16(acc, ~word, result);
-    eval_cc_n16(result);
-}
+        case 0x49:
+            cpu.a = rol(cpu.a);
+            break;
 
-/*------------------------------------------------
- * swi()
- *
- *  Software interrupt.
- *  SWI type is input to the function:
- *  SWI=1, SWI2=2, SWI3=3
- *
- */
-static void swi(int swi_id)
-{
-    cc.e = CC_FLAG_SET;
+        case 0x59:
+            cpu.b = rol(cpu.b);
+            break;
 
-    cpu.s--;
-    mem_write(cpu.s, cpu.pc & 0xff);
-    cpu.s--;
-    mem_write(cpu.s, (cpu.pc >> 8) & 0xff);
-    cpu.s--;
-    mem_write(cpu.s, cpu.u & 0xff);
-    cpu.s--;
-    mem_write(cpu.s, (cpu.u >> 8) & 0xff);
-    cpu.s--;
-    mem_write(cpu.s, cpu.y & 0xff);
-    cpu.s--;
-    mem_write(cpu.s, (cpu.y >> 8) & 0xff);
-    cpu.s--;
-    mem_write(cpu.s, cpu.x & 0xff);
-    cpu.s--;
-    mem_write(cpu.s, (cpu.x >> 8) & 0xff);
-    cpu.s--;
-    mem_write(cpu.s, cpu.dp);
-    cpu.s--;
-    mem_write(cpu.s, cpu.b);
-    cpu.s--;
-    mem_write(cpu.s, cpu.a);
-    cpu.s--;
-    mem_write(cpu.s, get_cc());
+        /* ROR, RORA, RORB
+         */
+        case 0x06:
+        case 0x66:
+        case 0x76:
+            operand8 = (uint8_t) mem_read(eff_addr);
+            operand8 = ror(operand8);
+            mem_write(eff_addr, operand8);
+            break;
 
-    switch ( swi_id )
-    {
-        case 1:
-            cc.i = CC_FLAG_SET;
-            cc.f = CC_FLAG_SET;
-            cpu.pc = (mem_read(VEC_SWI) << 8) + mem_read(VEC_SWI+1);
+        case 0x46:
+            cpu.a = ror(cpu.a);
             break;
 
-        case 2:
-            cpu.pc = (mem_read(VEC_SWI2) << 8) + mem_read(VEC_SWI2+1);
+        case 0x56:
+            cpu.b = ror(cpu.b);
             break;
 
-        case 3:
-            cpu.pc = (mem_read(VEC_SWI3) << 8) + mem_read(VEC_SWI3+1);
+        /* RTI
+         */
+        case 0x3b:
+            rti(cycles);
             break;
 
-        default:
-            /* Exception: Illegal SWI type swi()
-             */
-            cpu.cpu_state = CPU_EXCEPTION;
-            cpu.exception_line_num = __LINE__;
-    }
-}
+        /* RTS
+         */
+        case 0x39:
+             /* Restore PC and return
+              */
+             operand8 = mem_read(cpu.s);
+             cpu.s++;
+             cpu.pc = (uint16_t) operand8 << 8;
+             operand8 = mem_read(cpu.s);
+             cpu.s++;
+             cpu.pc += operand8;
+             break;
+
+        /* SBCA
+         */
+        case 0x82:
+        case 0x92:
+        case 0xa2:
+        case 0xb2:
+            operand8 = (uint8_t) mem_read(eff_addr);
+            cpu.a = sbc(cpu.a, operand8);
+            break;
 
-/*------------------------------------------------
- * tfr()
- *
- *  Transfer value from source register to destination register
- *
- *  NOTE: The function relies on the assembler to not mix
- *  8-bit registers with 16-bit register, otherwise
- *  results are unexpected.
- *  Check: if (((regs ^ (regs << 4)) & 0x80) == 0) {...}
- *
- */
-static void tfr(uint8_t regs)
-{
-    int         src, dst;
-    uint16_t    temp1;
+        /* SBCB
+         */
+        case 0xc2:
+        case 0xd2:
+        case 0xe2:
+        case 0xf2:
+            operand8 = (uint8_t) mem_read(eff_addr);
+            cpu.b = sbc(cpu.b, operand8);
+            break;
 
-    src = (int)((regs >> 4) & 0x0f);
-    dst = (int)(regs & 0x0f);
+        /* SEX
+         */
+        case 0x1d:
+            sex();
+            break;
 
-    temp1 = read_register(src);
-    write_register(dst, temp1);
-}
+        /* STA
+         */
+        case 0x97:
+        case 0xa7:
+        case 0xb7:
+            mem_write(eff_addr, cpu.a);
+            eval_cc_z((uint16_t) cpu.a);
+            eval_cc_n((uint16_t) cpu.a);
+            cc.v = CC_FLAG_CLR;
+            break;
 
-/*------------------------------------------------
- * tst()
- *
- *  Test 8 bit operand and set V,Z,N flags.
- *
- */
-static void tst(uint8_t byte)
-{
-    eval_cc_z((uint16_t) byte);
-    eval_cc_n((uint16_t) byte);
-    cc.v = CC_FLAG_CLR;
-}
+        /* STB
+         */
+        case 0xd7:
+        case 0xe7:
+        case 0xf7:
+            mem_write(eff_addr, cpu.b);
+            eval_cc_z((uint16_t) cpu.b);
+            eval_cc_n((uint16_t) cpu.b);
+            cc.v = CC_FLAG_CLR;
+            break;
 
-/*------------------------------------------------
- * branch()
- *
- *  Implement conditional short branch and long branch.
- *  The branch opcodes for both short and long variants are
- *  identical except for the 0x10 byte prefix for long branches.
- *  Calling code resolves long from short and then calls this function
- *  to resolve branch condition and apply the offset.
- *  To use this function with short branches (8-bit signed offset),
- *  the branch offset must be sign-extended to 16-bit.
- *
- *  param:  Branch opcode, long ('1') or short ('0') branch, 16-bit sign-extended offset, 
- *          pointer to opcode cycles.
- *  return: Nothing
- */
-static void branch(int instruction, int long_short, uint16_t effective_address, int *cycles)
-{
-    /* Parse the branch condition and apply
-       offset if branch is taken.
-     */
-    switch ( instruction )
-    {
-        /* BHI / LBHI
+        /* STD
          */
-        case 0x22:
-            if ( cc.c == CC_FLAG_CLR && cc.z == CC_FLAG_CLR )
-                do_branch(long_short, effective_address, cycles);
+        case 0xdd:
+        case 0xed:
+        case 0xfd:
+            mem_write(eff_addr, cpu.a);
+            mem_write(eff_addr + 1, cpu.b);
+            eval_cc_z16(d);
+            eval_cc_n16(d);
+            cc.v = CC_FLAG_CLR;
             break;
 
-        /* BLS / LBLS
+        /* STU
          */
-        case 0x23:
-            if ( cc.c == CC_FLAG_SET || cc.z == CC_FLAG_SET )
-                do_branch(long_short, effective_address, cycles);
+        case 0xdf:
+        case 0xef:
+        case 0xff:
+            mem_write(eff_addr, (uint8_t) (cpu.u >> 8));
+            mem_write(eff_addr + 1, (uint8_t) (cpu.u));
+            eval_cc_z16(cpu.u);
+            eval_cc_n16(cpu.u);
+            cc.v = CC_FLAG_CLR;
             break;
 
-        /* BHS / LBHS / BCC / LBCC
+        /* STX
          */
-        case 0x24:
-            if ( cc.c == CC_FLAG_CLR )
-                do_branch(long_short, effective_address, cycles);
+        case 0x9f:
+        case 0xaf:
+        case 0xbf:
+            mem_write(eff_addr, (uint8_t) (cpu.x >> 8));
+            mem_write(eff_addr + 1, (uint8_t) (cpu.x));
+            eval_cc_z16(cpu.x);
+            eval_cc_n16(cpu.x);
+            cc.v = CC_FLAG_CLR;
             break;
 
-        /* BLO / LBLO / BCS / LBCS
+        /* SUBA
          */
-        case 0x25:
-            if ( cc.c == CC_FLAG_SET )
-                do_branch(long_short, effective_address, cycles);
+        case 0x80:
+        case 0x90:
+        case 0xa0:
+        case 0xb0:
+            operand8 = (uint8_t) mem_read(eff_addr);
+            cpu.a = sub(cpu.a, operand8);
             break;
 
-        /* BNE / LBNE
+        /* SUBB
          */
-        case 0x26:
-            if ( cc.z == CC_FLAG_CLR )
-                do_branch(long_short, effective_address, cycles);
+        case 0xc0:
+        case 0xd0:
+        case 0xe0:
+        case 0xf0:
+            operand8 = (uint8_t) mem_read(eff_addr);
+            cpu.b = sub(cpu.b, operand8);
             break;
 
-        /* BEQ / LBEQ
+        /* SUBD
          */
-        case 0x27:
-            if ( cc.z == CC_FLAG_SET )
-                do_branch(long_short, effective_address, cycles);
+        case 0x83:
+        case 0x93:
+        case 0xa3:
+        case 0xb3:
+            operand8 = (uint8_t) mem_read(eff_addr);
+            eff_addr++;
+            operand16 = ((uint16_t ) operand8 << 8) + (uint16_t) mem_read(eff_addr);
+            subd(operand16);
             break;
 
-        /* BVC / LBVC
+        /* SWI
          */
-        case 0x28:
-            if ( cc.v == CC_FLAG_CLR )
-                do_branch(long_short, effective_address, cycles);
+        case 0x3f:
+            swi(1);
             break;
 
-        /* BVS / LBVS
+        /* SYNC
+         *
+         * The SYNC instruction allows software to synchronize with an external hardware
+         * event (interrupt). When executed, SYNC stops executing instructions and waits
+         * for an interrupt. None of the CC flags are directly affected.
          */
-        case 0x29:
-            if ( cc.v == CC_FLAG_SET )
-                do_branch(long_short, effective_address, cycles);
+        case 0x13:
+            cpu.cpu_state = CPU_SYNC;
             break;
 
-        /* BPL / LBPL
+        /* TFR
          */
-        case 0x2a:
-            if ( cc.n == CC_FLAG_CLR )
-                do_branch(long_short, effective_address, cycles);
+        case 0x1f:
+            operand8 = (uint8_t) mem_read(eff_addr);
+            tfr(operand8);
             break;
 
-        /* BMI / LBMI
+        /* TSTA
          */
-        case 0x2b:
-            if ( cc.n == CC_FLAG_SET )
-                do_branch(long_short, effective_address, cycles);
+        case 0x4d:
+            tst(cpu.a);
             break;
 
-        /* BGE / LBGE
+        /* TSTB
          */
-        case 0x2c:
-            if ( cc.n == cc.v )
-                do_branch(long_short, effective_address, cycles);
+        case 0x5d:
+            tst(cpu.b);
             break;
 
-        /* BLT / LBLT
+        /* TST
          */
-        case 0x2d:
-            if ( cc.n != cc.v )
-                do_branch(long_short, effective_address, cycles);
+        case 0x0d:
+        case 0x6d:
+        case 0x7d:
+            operand8 = (uint8_t) mem_read(eff_addr);
+            tst(operand8);
             break;
 
-        /* BGT / LBGT
+        /* BRA / LBRA
          */
-        case 0x2e:
-            if ( cc.n == cc.v && cc.z == CC_FLAG_CLR )
-                do_branch(long_short, effective_address, cycles);
+        case 0x20:
+        case 0x16:
+            cpu.pc = eff_addr;
             break;
 
-        /* BLE / LBLE
+        /* BRN
          */
-        case 0x2f:
-            if ( cc.n != cc.v || cc.z == CC_FLAG_SET )
-                do_branch(long_short, effective_address, cycles);
+        case 0x21:
+            // Branch never
             break;
 
-        /* Exception: Illegal branch code branch()
-         *
-         * There should be no exception here because this function is always
-         * called from within a switch/case for a valid opcode range.
+        /* BSR / LBSR
          */
+        case 0x8d:
+        case 0x17:
+            cpu.s--;
+            mem_write(cpu.s, GET_REG_LOW(cpu.pc));
+            cpu.s--;
+            mem_write(cpu.s, GET_REG_HIGH(cpu.pc));
+            cpu.pc = eff_addr;
+            break;
+
+        /* Short conditional branches
+         */
+        case 0x22 ... 0x2f:
+            branch(op_code, 0, eff_addr, cycles);
+            break;
+
         default:
+            /* Exception: Illegal op-code exec_op_code()
+             */
             cpu.cpu_state = CPU_EXCEPTION;
             cpu.exception_line_num = __LINE__;
     }
 }
 
-/*------------------------------------------------
- * do_branch()
- *
- *  Helper function to do the actual branch
- *  by stacking the PC and changing to the target address.
- *
- *  param:  Long ('1') or short ('0') branch, 16-bit sign-extended offset,
- *          pointer to opcode cycles.
- *  return: Nothing
- */
-static void do_branch(int long_short, uint16_t effective_address, int *cycles)
-{
-    cpu.pc = effective_address;
-    (*cycles) += long_short;
-}
-
 /*------------------------------------------------
  * get_eff_addr()
  *
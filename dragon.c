@@ -19,6 +19,15 @@
 #include    "vdg.h"
 #include    "pia.h"
 #include    "loader.h"
+#include    "trace.h"
+#include    "log.h"
+#include    "pmu.h"
+#include    "audio.h"
+#include    "acia.h"
+#include    "boot.h"
+#include    "audit.h"
+#include    "profile.h"
+#include    "printer.h"
 
 /* -----------------------------------------
    Dragon 32 ROM image
@@ -53,6 +62,19 @@ static int get_reset_state(uint32_t time);
     int     i;
     int     emulator_escape_code;
     int     vdg_render_cycles = 0;
+    int     cpu_instructions;
+    int     block_cycles;
+    int     frame_cycles = 0;
+    int     speed;
+    int     reset_type = 0;
+    int     skipped_frames = 0;
+    const profile_t *profile;
+    int     boot_frames = 0;
+#if (CPU_TRACE==1)
+    cpu_state_t cpu_state;
+#endif
+
+    boot_mark(BOOT_KERNEL);
 
     if ( rpi_gpio_init() == -1 )
     {
@@ -72,6 +94,7 @@ static int get_reset_state(uint32_t time);
         i++;
     }
     printf("Loaded %i bytes.\n", i - 1);
+    boot_mark(BOOT_ROM_LOAD);
 
     mem_define_rom(DRAGON_ROM_START, DRAGON_ROM_END);
 
@@ -79,11 +102,37 @@ static int get_reset_state(uint32_t time);
      */
     sam_init();
     pia_init();
+    boot_mark(BOOT_DEVICES);
+
     vdg_init();
+    boot_mark(BOOT_FRAME_BUFFER);
 
     printf("Initializing CPU.\n");
     cpu_init(RUN_ADDRESS);
 
+#if (CPU_TRACE==2)
+    trace_init();
+#endif
+
+#if (PMU_ENABLE==1)
+    pmu_init();
+#endif
+
+#if (AUDIO_BLEP==1)
+    audio_init();
+#endif
+
+#if (ACIA_ENABLE==1)
+    acia_init();
+#endif
+
+    boot_mark(BOOT_CPU);
+
+    audit_init();
+    printer_init();
+
+    profile = profile_get();
+
     /* CPU endless execution loop.
      */
     printf("Starting CPU.\n");
@@ -92,12 +141,56 @@ static int get_reset_state(uint32_t time);
     for (;;)
     {
         //rpi_testpoint_on();
-        cpu_run();
+        PMU_ENTER(PMU_CPU);
+        cpu_instructions = cpu_run_block(VDG_RENDER_CYCLES - vdg_render_cycles);
+        PMU_LEAVE();
         //rpi_testpoint_off();
 
-        bcm2835_crude_delay(2);
+        block_cycles = cpu_get_block_cycles();
+        frame_cycles += block_cycles;
+
+#if (AUDIO_BLEP==1)
+        audio_advance(block_cycles);
+        audio_output();
+#endif
+
+#if (ACIA_ENABLE==1)
+        acia_advance(block_cycles);
+#endif
+
+#if (CPU_TRACE==1)
+        cpu_get_state(&cpu_state);
+        printf("%04x %02x %02x %04x %04x %04x %04x %02x %02x %i\n",
+                cpu_state.pc, cpu_state.a, cpu_state.b, cpu_state.x, cpu_state.y,
+                cpu_state.u, cpu_state.s, cpu_state.dp, cpu_state.cc, cpu_state.last_opcode_cycles);
+#elif (CPU_TRACE==2)
+        /* Send binary trace records while the UART is ready,
+         * and wait for it only when the trace buffer is full
+         */
+        trace_drain();
+        while ( trace_full() )
+            trace_drain();
+#endif
+
+        /* Pace the CPU to the emulated clock, faster by the profile's clock
+         * multiplier, and by its tape multiplier while the cassette motor is on.
+         * The tape signal is timed in CPU cycles, so it speeds up with the CPU
+         * and any tape loader keeps working. Fast loading from tape is not paced.
+         */
+        if ( pia_tape_motor() )
+            speed = profile->fast_load ? 0 : profile->speed * profile->tape_speed;
+        else
+            speed = profile->speed;
 
-        switch ( get_reset_state(LONG_RESET_DELAY) )
+        if ( speed == 1 )
+            bcm2835_crude_delay(2 * cpu_instructions);
+        else if ( speed > 1 )
+            bcm2835_crude_delay((2 * cpu_instructions) / speed);
+
+        /* The reset button is scanned once per frame, and a reset
+         * is asserted for one CPU block
+         */
+        switch ( reset_type )
         {
             case 0:
                 cpu_reset(0);
@@ -107,7 +200,7 @@ static int get_reset_state(uint32_t time);
                 /* Cold start flag set to value that is not 0x55
                  */
                 mem_write(0x71, 0);
-                printf("Force cold restart.\n");
+                LOG0(LOG_COLD_RESTART);
                 /* no break */
 
             case 1:
@@ -115,21 +208,67 @@ static int get_reset_state(uint32_t time);
                 break;
 
             default:
-                printf("kernel(): unknown reset state.\n");
+                LOG0(LOG_RESET_UNKNOWN);
         }
 
+        reset_type = 0;
+
+        log_drain();
+
+#if (PMU_ENABLE==1)
+        pmu_monitor();
+#endif
+
         emulator_escape_code = pia_function_key();
         if ( emulator_escape_code == ESCAPE_LOADER )
+        {
+            audit_report();
+            printer_flush();
             loader();
+            audit_resync();
+        }
 
-        vdg_render_cycles++;
-        if ( vdg_render_cycles == VDG_RENDER_CYCLES )
+        vdg_render_cycles += cpu_instructions;
+        if ( vdg_render_cycles >= VDG_RENDER_CYCLES )
         {
-            rpi_testpoint_on();
-            vdg_render();
-            rpi_testpoint_off();
+            /* Render one of every 'frame_skip' frames
+             */
+            skipped_frames++;
+            if ( skipped_frames >= profile->frame_skip )
+            {
+                skipped_frames = 0;
+                rpi_testpoint_on();
+                PMU_ENTER(PMU_VDG);
+                vdg_render();
+                PMU_LEAVE();
+                rpi_testpoint_off();
+            }
             pia_vsync_irq();
             vdg_render_cycles = 0;
+
+            rpi_button_scan();
+            reset_type = get_reset_state(LONG_RESET_DELAY);
+
+            audit_frame(frame_cycles);
+            frame_cycles = 0;
+
+            printer_frame();
+
+            /* Boot timeline of the first frames
+             */
+            if ( boot_frames < BOOT_REPORT_FRAMES )
+            {
+                boot_frames++;
+                if ( boot_frames == 1 )
+                {
+                    boot_mark(BOOT_FIRST_FRAME);
+                }
+                else if ( boot_frames == BOOT_REPORT_FRAMES )
+                {
+                    boot_mark(BOOT_FRAMES);
+                    boot_report();
+                }
+            }
         }
     }
 
@@ -141,9 +280,10 @@ static int get_reset_state(uint32_t time);
 /*------------------------------------------------
  * get_reset_state()
  *
- * Scan the reset button with rpi_reset_button() and return
- * '1' for short reset and '2' for long reset press.
- * '0' for no press.
+ * Track the reset button level of rpi_reset_button() and return
+ * '1' for short reset and '2' for long reset press when the button
+ * is released, '0' otherwise. The press is timed from the scan that
+ * first saw it, so the emulation keeps running while the button is held.
  * Accepts 'time' in micro-seconds as a parameter for determining long
  * press.
  *
@@ -153,13 +293,22 @@ static int get_reset_state(uint32_t time);
  */
 static int get_reset_state(uint32_t time)
 {
-    uint32_t    start_time;
+    static int      pressed = 0;
+    static uint32_t start_time;
+
     int         reset_type = 0;
 
     if ( rpi_reset_button() == 0 )  // Active low!
     {
-        start_time = rpi_system_timer();
-        while ( !rpi_reset_button() );
+        if ( !pressed )
+        {
+            pressed = 1;
+            start_time = rpi_system_timer();
+        }
+    }
+    else if ( pressed )
+    {
+        pressed = 0;
         if ( (rpi_system_timer() - start_time) >= time )
         {
             reset_type = 2;
@@ -58,6 +58,7 @@ LD = $(TOOLDIR)/bin/arm-none-eabi-ld
 AS = $(TOOLDIR)/bin/arm-none-eabi-as
 AR = $(TOOLDIR)/bin/arm-none-eabi-ar
 OBJCOPY = $(TOOLDIR)/bin/arm-none-eabi-objcopy
+SIZE = $(TOOLDIR)/bin/arm-none-eabi-size
 
 LIBDIR1 = $(TOOLDIR)/arm-none-eabi/lib				# libc_nano (Newlib)
 LIBDIR2 = $(TOOLDIR)/lib/gcc/arm-none-eabi/9.2.1	# libgcc
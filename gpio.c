@@ -262,7 +262,8 @@ uint32_t bcm2835_gpio_eds_multi(uint32_t mask)
 /*------------------------------------------------
  * bcm2835_gpio_clear_eds()
  *
- *   Write a 1 to clear the bit in EDS
+ *   Write a 1 to clear the bit in EDS. Bits written as 0 are
+ *   not changed, so other pending events are not cleared.
  *
  * param:  Pin number
  * return: none
@@ -277,9 +278,9 @@ void bcm2835_gpio_clr_eds(int pin)
     dmb();
 
     if ( pin < 32 )
-        bcm2835_gpio->gpeds0 |= (1 << shift);
+        bcm2835_gpio->gpeds0 = (1 << shift);
     else
-        bcm2835_gpio->gpeds0 |= (1 << shift);
+        bcm2835_gpio->gpeds1 = (1 << shift);
 
     dmb();
 }
@@ -296,7 +297,7 @@ void bcm2835_gpio_clr_eds(int pin)
 void bcm2835_gpio_clr_eds_multi(uint32_t mask)
 {
     dmb();
-    bcm2835_gpio->gpeds0 |= mask;
+    bcm2835_gpio->gpeds0 = mask;
     dmb();
 }
 
@@ -0,0 +1,26 @@
+/********************************************************************
+ * acia.h
+ *
+ *  Header for module that implements the MOS 6551 ACIA serial port
+ *  of the Dragon 64 (ACIA_ENABLE=1).
+ *
+ *  The ACIA is bridged to the Raspberry Pi mini UART. Characters are
+ *  paced at the programmed baud rate in emulated CPU cycles, and the
+ *  mini UART line itself always runs at DEFAULT_UART_RATE.
+ *
+ *  October 19, 2026
+ *
+ *******************************************************************/
+
+#ifndef __ACIA_H__
+#define __ACIA_H__
+
+#include    "section.h"
+
+/********************************************************************
+ *  ACIA module API
+ */
+void acia_init(void) SECTION_COLD;
+void acia_advance(int cycles) SECTION_HOT;
+
+#endif  /* __ACIA_H__ */
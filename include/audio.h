@@ -0,0 +1,60 @@
+/********************************************************************
+ * audio.h
+ *
+ *  Header file for the band-limited DAC audio module (AUDIO_BLEP=1).
+ *
+ *  DAC writes are time stamped in emulated CPU cycles and turned into
+ *  band-limited steps (BLEP) that are summed into a fixed rate PCM
+ *  stream through a polyphase step kernel. The kernel table,
+ *  dragon/blep.h, is generated at build time by tools/blepgen.c.
+ *  The PCM stream is queued in a ring buffer and sent to the 6-bit DAC
+ *  at the sample rate by the main loop.
+ *
+ *  October 19, 2026
+ *
+ *******************************************************************/
+
+#ifndef __AUDIO_H__
+#define __AUDIO_H__
+
+#include    <stdint.h>
+
+#include    "section.h"
+
+#define     AUDIO_SAMPLE_RATE       22050       // PCM output rate in Hz
+
+#define     AUDIO_PHASES            32          // Kernel sub-sample phases
+#define     AUDIO_TAPS              16          // Kernel length in samples, latency is half of it
+#define     AUDIO_KERNEL_BITS       15          // Kernel phase sum, 1 << AUDIO_KERNEL_BITS
+
+#define     AUDIO_DAC_BITS          6           // DAC level 0 to 63
+#define     AUDIO_PCM_SHIFT         8           // DAC level to PCM sample scale
+
+/* Resampler state, saved and restored around frames
+ * that are emulated but not played (libretro run-ahead)
+ */
+typedef struct
+{
+    int32_t     delta_buffer[AUDIO_TAPS];
+    uint32_t    sample_time;
+    int32_t     accumulator;
+    int         dac_level;
+    uint32_t    block_start;
+    int         pcm_head;
+    int         pcm_tail;
+} audio_state_t;
+
+/********************************************************************
+ *  Audio module API
+ */
+void audio_init(void) SECTION_COLD;
+void audio_enable(int enable);
+void audio_dac_write(int level) SECTION_HOT;
+void audio_advance(int cycles) SECTION_HOT;
+int  audio_output(void) SECTION_HOT;
+int  audio_read(int16_t *buffer, int count);
+
+void audio_get_state(audio_state_t *audio_state);
+void audio_set_state(audio_state_t *audio_state);
+
+#endif  /* __AUDIO_H__ */
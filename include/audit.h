@@ -0,0 +1,37 @@
+/********************************************************************
+ * audit.h
+ *
+ *  Header file for the timing drift auditor.
+ *
+ *  The main loop counts a frame in executed instructions, so the
+ *  emulated time of a frame varies and is not tied to real time.
+ *  The auditor adds up the emulated CPU cycles and the real system
+ *  timer time of every frame since boot, and reports the drift of
+ *  emulated time from real time in ppm, the worst frame overrun and
+ *  the frames lost to overruns. Crossing a drift threshold, and a
+ *  frame that overruns by more than a frame, raise a log event.
+ *
+ *  October 19, 2026
+ *
+ *******************************************************************/
+
+#ifndef __AUDIT_H__
+#define __AUDIT_H__
+
+#include    <stdint.h>
+
+#include    "section.h"
+
+#define     AUDIT_FRAME_US          20000       // 50Hz frame
+#define     AUDIT_CHECK_FRAMES      250         // Drift check interval, 5 seconds
+#define     AUDIT_DRIFT_PPM         5000        // Drift log event threshold
+
+/********************************************************************
+ *  Timing drift auditor API
+ */
+void audit_init(void) SECTION_COLD;
+void audit_resync(void);
+void audit_frame(int cycles) SECTION_HOT;
+void audit_report(void) SECTION_COLD;
+
+#endif  /* __AUDIT_H__ */
@@ -30,7 +30,7 @@
 #define     AUXUART_7BIT                0x00000001              // Default is 8-bit
 #define     AUXUART_ENA_HW_FLOW         0x00000002              // Default no hardware flow control
 #define     AUXUART_ENA_RX_IRQ          0x00000004              // Default is without receiver interrupts
-#define     AUXUART_ENA_TX_IRQ          0x00000008              // Default is without receiver interrupts
+#define     AUXUART_ENA_TX_IRQ          0x00000008              // Default is without transmitter interrupts
 
 /* Values are BAUD rate clock divider register,
  * and used here to save the need for division calculation.
@@ -58,6 +58,7 @@ void    bcm2835_auxuart_close(void);                            // Close auxilia
 int     bcm2835_auxuart_rx_data(uint8_t *buffer, int count);    // Receive data from Rx buffer
 int     bcm2835_auxuart_rx_byte(uint8_t *byte);                 // Read byte from Rx circular buffer.
 int     bcm2835_auxuart_tx_data(uint8_t *buffer, int count);    // Transmit data through Tx buffer
+int     bcm2835_auxuart_tx_byte(uint8_t byte);                  // Add byte to Tx circular buffer without waiting
 
 /* Non-buffered, UART direct Rx and Tx
  */
@@ -65,5 +66,6 @@ void    bcm2835_auxuart_putchr(uint8_t byte);                   // Output a char
 uint8_t bcm2835_auxuart_getchr(void);                           // Get a character from receive buffer
 uint8_t bcm2835_auxuart_waitchr(void);                          // Wait (block) for character from receive buffer
 int     bcm2835_auxuart_ischar(void);                           // Check if a character is present in the receive buffer
+int     bcm2835_auxuart_tx_ready(void);                         // Check if the transmitter can accept a byte
 
 #endif  /* __AUXUART_H__ */
@@ -0,0 +1,28 @@
+/********************************************************************
+ * bench.h
+ *
+ *  Header file for the benchmark module (BENCH=1).
+ *
+ *  Benchmarks time emulator and driver functions with the system
+ *  timer and print their results on the serial console. They run
+ *  from the loader on the RPi, and from tools/bench.c on the host.
+ *  bench_storage() measures the SD card and file system, and
+ *  bench_vdg() the render time of every video mode.
+ *
+ *  October 19, 2026
+ *
+ *******************************************************************/
+
+#ifndef __BENCH_H__
+#define __BENCH_H__
+
+#include    "sdfat32.h"
+#include    "section.h"
+
+/********************************************************************
+ *  Benchmark API
+ */
+void bench_storage(dir_entry_t *file) SECTION_COLD;
+void bench_vdg(void) SECTION_COLD;
+
+#endif  /* __BENCH_H__ */
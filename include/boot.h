@@ -0,0 +1,46 @@
+/********************************************************************
+ * boot.h
+ *
+ *  Header file for the boot timeline module.
+ *
+ *  boot_mark() records the system timer at the end of each boot phase
+ *  in a static table, and boot_report() prints the phases with their
+ *  time since power-on and their duration. The system timer starts at
+ *  power-on, so the first phase includes the GPU firmware boot.
+ *
+ *  October 19, 2026
+ *
+ *******************************************************************/
+
+#ifndef __BOOT_H__
+#define __BOOT_H__
+
+#include    <stdint.h>
+
+#include    "section.h"
+
+#define     BOOT_REPORT_FRAMES      50          // Frames after which the timeline is printed
+
+typedef enum
+{
+    BOOT_KERNEL = 0,                // Kernel entry, firmware boot
+    BOOT_UART,                      // Serial console
+    BOOT_SPI0,                      // AVR keyboard controller SPI
+    BOOT_AVR_RESET,                 // AVR reset and its start-up delay
+    BOOT_GPIO,                      // DAC, joystick, audio multiplexer and reset GPIO
+    BOOT_ROM_LOAD,                  // Dragon ROM copy into emulated memory
+    BOOT_DEVICES,                   // SAM and PIA
+    BOOT_FRAME_BUFFER,              // VDG and frame buffer mailbox negotiation
+    BOOT_CPU,                       // CPU, and the optional trace, PMU and audio modules
+    BOOT_FIRST_FRAME,               // First frame rendered
+    BOOT_FRAMES,                    // BOOT_REPORT_FRAMES frames rendered
+    BOOT_PHASES
+} boot_phase_t;
+
+/********************************************************************
+ *  Boot timeline API
+ */
+void boot_mark(boot_phase_t phase) SECTION_COLD;
+void boot_report(void) SECTION_COLD;
+
+#endif  /* __BOOT_H__ */
@@ -12,6 +12,16 @@
 
 #include    <stdint.h>
 
+#include    "section.h"
+
+#define     CPU_CLOCK_HZ    894886  // Dragon 32 E clock in Hz
+
+/********************************************************************
+ *  Devices that share the IRQ line
+ */
+#define     CPU_IRQ_PIA     0x01
+#define     CPU_IRQ_ACIA    0x02
+
 /********************************************************************
  *  CPU run state
  */
@@ -56,25 +66,33 @@ typedef struct
     int     nmi_latched;
     int     halt_asserted;
     int     reset_asserted;
-    int     irq_asserted;
+    int     irq_asserted;       // CPU_IRQ_* bit of each device asserting IRQ
     int     firq_asserted;
     int     exception_line_num;
+
+    uint32_t    cycle_clock;    // CPU cycles of all cpu_run_block() calls
 } cpu_state_t;
 
 /********************************************************************
  *  CPU module API
  */
-int  cpu_init(int address);
+int  cpu_init(int address) SECTION_COLD;
 
 void cpu_halt(int state);
 void cpu_reset(int state);
 void cpu_nmi_trigger(void);
 void cpu_firq(int state);
 void cpu_irq(int state);
+void cpu_irq_source(int source, int state);
 
-cpu_run_state_t cpu_run(void);
+cpu_run_state_t cpu_run(void) SECTION_HOT;
+int             cpu_run_block(int instructions) SECTION_HOT;
 
+int             cpu_get_block_cycles(void);
+uint32_t        cpu_get_cycles(void) SECTION_HOT;
+void            cpu_set_rom_blocks(int enable);
 cpu_run_state_t cpu_get_state(cpu_state_t* cpu_state);
+void            cpu_set_state(cpu_state_t* cpu_state);
 const char*     cpu_get_menmonic(uint16_t address);
 
 #endif  /* __CPU_H__ */
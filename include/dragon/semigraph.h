@@ -15,7 +15,7 @@
 /* Dragon computer 12x12 semigraphics bit patterns
  */
 
-uint8_t const semi_graph_4[][12] = {
+uint8_t const semi_graph_4[][12] SECTION_HOT_RODATA = {
  //   ............. L3/L2 ..............  ............. L1/L0 ..............
     { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // 0
     { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F }, // 1
@@ -35,7 +35,7 @@ uint8_t const semi_graph_4[][12] = {
     { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF }, // 15
 };
 
-uint8_t const semi_graph_6[][12] = {
+uint8_t const semi_graph_6[][12] SECTION_HOT_RODATA = {
  //   ....... L5/L4 ........  ....... L3/L2 ........  ....... L1/L0 ........
     { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // 0
     { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0F, 0x0F, 0x0F, 0x0F }, // 1
@@ -14,5 +14,6 @@
 
 void loader(void);
 int  loader_mount_cas_file(dir_entry_t *cas_file);
+int  loader_mount_printer_file(dir_entry_t *printer_file_entry);
 
 #endif  /* __LOADER_H__ */
@@ -0,0 +1,111 @@
+/********************************************************************
+ * log.h
+ *
+ *  Header file that defines the binary log interface.
+ *
+ *  With LOG_BINARY=1 a LOGn() call site stores a header word with the
+ *  message ID and argument count, and the raw 32-bit arguments, in a
+ *  RAM ring buffer. log_drain() sends the buffer to the serial console
+ *  while the UART can accept bytes, and tools/logdump.c turns the
+ *  messages back into text with the formats from logmsg.h.
+ *  With LOG_BINARY=0 a LOGn() call site is a printf() of the same format.
+ *
+ *  Serial stream of a message, 32-bit words are little endian:
+ *      LOG_SYNC, argument count, message ID (16 bits), arguments
+ *
+ *  October 19, 2026
+ *
+ *******************************************************************/
+
+#ifndef __LOG_H__
+#define __LOG_H__
+
+#include    <stdint.h>
+
+#define     LOG_SYNC                0xa6        // First byte of every message
+#define     LOG_ARGS_MAX            4
+#define     LOG_WORDS               4096        // Ring buffer size in 32-bit words, a power of 2
+#define     LOG_MASK                (LOG_WORDS - 1)
+
+#define     LOG_HEADER(id, n)       (LOG_SYNC | ((n) << 8) | ((uint32_t)(id) << 16))
+
+/* Message IDs from the message catalogue
+ */
+typedef enum
+{
+#define     LOG_MESSAGE(id, format)     id,
+#include    "logmsg.h"
+#undef      LOG_MESSAGE
+    LOG_MESSAGES
+} log_id_t;
+
+/********************************************************************
+ *  Binary log API
+ */
+void log_drain(void);
+void log_flush(void);
+
+#if (LOG_BINARY==1)
+
+extern uint32_t log_buffer[LOG_WORDS];
+extern uint32_t log_head;
+extern uint32_t log_tail;
+extern uint32_t log_dropped;
+
+/* Message call sites, a header store and one store per argument
+ */
+#define     LOG0(id)                log_msg(LOG_HEADER(id, 0), 0, 0, 0, 0, 1)
+#define     LOG1(id, a)             log_msg(LOG_HEADER(id, 1), (a), 0, 0, 0, 2)
+#define     LOG2(id, a, b)          log_msg(LOG_HEADER(id, 2), (a), (b), 0, 0, 3)
+#define     LOG3(id, a, b, c)       log_msg(LOG_HEADER(id, 3), (a), (b), (c), 0, 4)
+#define     LOG4(id, a, b, c, d)    log_msg(LOG_HEADER(id, 4), (a), (b), (c), (d), 5)
+
+/*------------------------------------------------
+ * log_msg()
+ *
+ *  Queue a message in the log ring buffer, or count it as
+ *  dropped if the buffer is full. Always in-lined, so a call site
+ *  with a constant word count only stores the words it uses.
+ *
+ *  param:  Header word, arguments, word count including header
+ *  return: Nothing
+ */
+static inline __attribute__((always_inline))
+void log_msg(uint32_t header, uint32_t a, uint32_t b, uint32_t c, uint32_t d, int words)
+{
+    uint32_t    head = log_head;
+
+    if ( (head - log_tail) > (uint32_t)(LOG_WORDS - words) )
+    {
+        log_dropped++;
+        return;
+    }
+
+    log_buffer[head & LOG_MASK] = header;
+    if ( words > 1 )
+        log_buffer[(head + 1) & LOG_MASK] = a;
+    if ( words > 2 )
+        log_buffer[(head + 2) & LOG_MASK] = b;
+    if ( words > 3 )
+        log_buffer[(head + 3) & LOG_MASK] = c;
+    if ( words > 4 )
+        log_buffer[(head + 4) & LOG_MASK] = d;
+
+    log_head = head + words;
+}
+
+#else
+
+#include    "printf.h"
+
+extern const char *log_format[LOG_MESSAGES];
+
+#define     LOG0(id)                printf(log_format[id])
+#define     LOG1(id, a)             printf(log_format[id], (a))
+#define     LOG2(id, a, b)          printf(log_format[id], (a), (b))
+#define     LOG3(id, a, b, c)       printf(log_format[id], (a), (b), (c))
+#define     LOG4(id, a, b, c, d)    printf(log_format[id], (a), (b), (c), (d))
+
+#endif  /* LOG_BINARY */
+
+#endif  /* __LOG_H__ */
@@ -0,0 +1,54 @@
+/********************************************************************
+ * logmsg.h
+ *
+ *  Binary log message catalogue.
+ *
+ *  Each LOG_MESSAGE(id, format) line defines a message ID and its
+ *  printf() format. log.h builds the message ID enumeration from this
+ *  list, and log.c and tools/logdump.c build the format table, so
+ *  the emulator and the host decoder always agree on message IDs.
+ *  Formats take integer arguments only (%d %i %u %x %X %o %c), at most
+ *  LOG_ARGS_MAX of them. Add new messages at the end of the list.
+ *  Message IDs are part of captured logs, so existing messages keep
+ *  their place. The named VDG mode messages are in video_mode_t order,
+ *  one per mode, so the mode name is in the format table and not in the
+ *  emulator; vdg.c checks the order at compile time. LOG_VDG_MODE logs
+ *  a mode number outside video_mode_t.
+ *
+ *  This file has no include guard, it is included with different
+ *  definitions of LOG_MESSAGE().
+ *
+ *  October 19, 2026
+ *
+ *******************************************************************/
+
+LOG_MESSAGE(LOG_DROPPED,            "log: %u messages dropped\n")
+LOG_MESSAGE(LOG_COLD_RESTART,       "Force cold restart.\n")
+LOG_MESSAGE(LOG_RESET_UNKNOWN,      "kernel(): unknown reset state.\n")
+LOG_MESSAGE(LOG_PIA_SCAN_CODE,      "io_handler_pia0_pb(): Illegal scan code 0x%02x.\n")
+LOG_MESSAGE(LOG_VDG_FB_ERROR,       "vdg_render(): Frame buffer error.\n")
+LOG_MESSAGE(LOG_VDG_MODE,           "VDG mode: %d\n")
+LOG_MESSAGE(LOG_VDG_MODE_UNSUPPORTED, "vdg_render(): Mode not supported %d\n")
+LOG_MESSAGE(LOG_VDG_MODE_ILLEGAL,   "vdg_render(): Illegal mode %d.\n")
+LOG_MESSAGE(LOG_VDG_MODE_UNRESOLVED, "vdg_get_mode(): Cannot resolve mode, SAM %d PIA 0x%02x.\n")
+LOG_MESSAGE(LOG_AUDIT_DRIFT,        "audit: drift %d ppm after %u frames\n")
+LOG_MESSAGE(LOG_AUDIT_DRIFT_OK,     "audit: drift back to %d ppm after %u frames\n")
+LOG_MESSAGE(LOG_AUDIT_OVERRUN,      "audit: frame %u overran by %u uS\n")
+LOG_MESSAGE(LOG_PRINTER_FULL,       "printer: capture file full after %u bytes\n")
+LOG_MESSAGE(LOG_PRINTER_SD_ERROR,   "printer: SD write error %d at LBA %u\n")
+LOG_MESSAGE(LOG_VDG_MODE_ALPHA_INT, "VDG mode: ALPHA_INT\n")
+LOG_MESSAGE(LOG_VDG_MODE_ALPHA_EXT, "VDG mode: ALPHA_EXT\n")
+LOG_MESSAGE(LOG_VDG_MODE_SEMI_GR4,  "VDG mode: SEMI_GR4\n")
+LOG_MESSAGE(LOG_VDG_MODE_SEMI_GR6,  "VDG mode: SEMI_GR6\n")
+LOG_MESSAGE(LOG_VDG_MODE_SEMI_GR8,  "VDG mode: SEMI_GR8\n")
+LOG_MESSAGE(LOG_VDG_MODE_SEMI_GR12, "VDG mode: SEMI_GR12\n")
+LOG_MESSAGE(LOG_VDG_MODE_SEMI_GR24, "VDG mode: SEMI_GR24\n")
+LOG_MESSAGE(LOG_VDG_MODE_GRAPH_1C,  "VDG mode: GRAPH_1C\n")
+LOG_MESSAGE(LOG_VDG_MODE_GRAPH_1R,  "VDG mode: GRAPH_1R\n")
+LOG_MESSAGE(LOG_VDG_MODE_GRAPH_2C,  "VDG mode: GRAPH_2C\n")
+LOG_MESSAGE(LOG_VDG_MODE_GRAPH_2R,  "VDG mode: GRAPH_2R\n")
+LOG_MESSAGE(LOG_VDG_MODE_GRAPH_3C,  "VDG mode: GRAPH_3C\n")
+LOG_MESSAGE(LOG_VDG_MODE_GRAPH_3R,  "VDG mode: GRAPH_3R\n")
+LOG_MESSAGE(LOG_VDG_MODE_GRAPH_6C,  "VDG mode: GRAPH_6C\n")
+LOG_MESSAGE(LOG_VDG_MODE_GRAPH_6R,  "VDG mode: GRAPH_6R\n")
+LOG_MESSAGE(LOG_VDG_MODE_DMA,       "VDG mode: DMA\n")
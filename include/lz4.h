@@ -0,0 +1,35 @@
+/********************************************************************
+ * lz4.h
+ *
+ *  Header file for the LZ4 compressed image reader.
+ *
+ *  ROM and CAS images on the SD card can be LZ4 frames, which the
+ *  reader decompresses a block at a time while the file is read,
+ *  so fewer bytes cross the SPI bus. Files that are not LZ4 frames
+ *  are read as they are. Frames have independent blocks of up to
+ *  64K bytes, as tools/lz4pack.c or 'lz4 -B4' write them.
+ *
+ *  October 19, 2026
+ *
+ *******************************************************************/
+
+#ifndef __LZ4_H__
+#define __LZ4_H__
+
+#include    <stdint.h>
+
+#include    "section.h"
+#include    "sdfat32.h"
+
+#define     LZ4_MAGIC               0x184d2204  // LZ4 frame magic number
+#define     LZ4_BLOCK_MAX           (64 * 1024) // Largest block, frame block maximum size 4
+
+/********************************************************************
+ *  LZ4 image reader API
+ */
+int  lz4_fopen(dir_entry_t *directory_entry) SECTION_COLD;
+void lz4_fclose(void) SECTION_COLD;
+int  lz4_fread(uint8_t *buffer, int buffer_length);
+int  lz4_is_compressed(void);
+
+#endif  /* __LZ4_H__ */
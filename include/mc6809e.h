@@ -17,6 +17,8 @@
 
 #include    <stdint.h>
 
+#include    "section.h"
+
 #define     ADDR_DIRECT             1
 #define     ADDR_INHERENT           2
 #define     ADDR_RELATIVE           3           // 8-bit address offset
@@ -41,7 +43,7 @@ typedef struct
     int  bytes;
 } machine_code_t;
 
-machine_code_t machine_code[] = {
+machine_code_t machine_code[] SECTION_HOT_DATA = {
     {0x00, "neg"  , ADDR_DIRECT    , 6 , 2},
     {0x01, "???"  , ILLEGAL_OP     , 0 , 1},    // Zero cycles and "???" notes illegal op-code
     {0x02, "???"  , ILLEGAL_OP     , 0 , 1},
@@ -12,7 +12,14 @@
 
 #include    <stdint.h>
 
+#include    "section.h"
+
 #define     MEMORY                  65536       // 64K Byte
+#define     MEM_PAGE_SIZE           256
+#define     MEM_PAGES               (MEMORY/MEM_PAGE_SIZE)
+
+#define     MEM_PAGE_ROM            0x01        // Page attribute: page has ROM locations
+#define     MEM_PAGE_IO             0x02        // Page attribute: page has IO locations
 
 #define     MEM_OK                  0           // Operation ok
 #define     MEM_ADD_RANGE          -1           // Address out of range
@@ -31,12 +38,14 @@ typedef uint8_t (*io_handler_callback)(uint16_t, uint8_t, mem_operation_t);
  *  Memory module API
  */
 
-void mem_init(void);
+void mem_init(void) SECTION_COLD;
 
-int  mem_read(int address);
-int  mem_write(int address, int data);
+int  mem_read(int address) SECTION_HOT;
+int  mem_write(int address, int data) SECTION_HOT;
 int  mem_define_rom(int addr_start, int addr_end);
 int  mem_define_io(int addr_start, int addr_end, io_handler_callback io_handler);
-int  mem_load(int addr_start, uint8_t *buffer, int length);
+int  mem_load(int addr_start, uint8_t *buffer, int length) SECTION_COLD;
+
+uint8_t *mem_get_map(void);
 
 #endif  /* __MEM_H__ */
@@ -10,9 +10,35 @@
 #ifndef __PIA_H__
 #define __PIA_H__
 
+#include    <stdint.h>
+
+#define     PIA_KBD_ROWS        7
+
+/* PIA state for machine snapshots
+ */
+typedef struct
+{
+    int         pia0_cb1_int_enabled;
+    uint8_t     pia0_cra;
+    uint8_t     pia0_crb;
+    uint8_t     pia1_cra;
+    uint8_t     pia1_crb;
+    uint8_t     audio_mux_select;
+    uint8_t     keyboard_rows[PIA_KBD_ROWS];
+    uint8_t     cas_byte;
+    int         cas_bit_index;
+    int         tape_running;
+    uint32_t    tape_bit_start;
+    int         tape_bit_cycles;
+} pia_state_t;
+
 void pia_init(void);
 
 void pia_vsync_irq(void);
 int  pia_function_key(void);
+int  pia_tape_motor(void);
+
+void pia_get_state(pia_state_t *pia_state);
+void pia_set_state(pia_state_t *pia_state);
 
 #endif  /* __PIA_H__ */
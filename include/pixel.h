@@ -0,0 +1,34 @@
+/********************************************************************
+ * pixel.h
+ *
+ *  Header file for the pixel expansion module that converts
+ *  1 bit per pixel and 2 bits per pixel VDG video bytes into
+ *  8 bit per pixel frame buffer pixels.
+ *
+ *  The pixel kernels are selected at build time: ARMv6 SIMD
+ *  (USUB8/SEL) when the target has it, and a portable 32-bit
+ *  SWAR kernel otherwise. tools/pixcheck.c verifies the portable
+ *  kernel against a pixel by pixel reference on the host.
+ *
+ *  October 19, 2026
+ *
+ *******************************************************************/
+
+#ifndef __PIXEL_H__
+#define __PIXEL_H__
+
+#include    <stdint.h>
+
+#include    "section.h"
+
+#define     PIXEL_SCALE_MAX         2           // Horizontal pixel scaling 1x or 2x
+
+/********************************************************************
+ *  Pixel expansion API
+ */
+void pixel_expand_1bpp(uint8_t *dst, const uint8_t *src, int count, int fg_color, int bg_color, int scale) SECTION_HOT;
+void pixel_expand_2bpp(uint8_t *dst, const uint8_t *src, int count, const int *palette, int scale) SECTION_HOT;
+
+const char *pixel_kernel_name(void);
+
+#endif  /* __PIXEL_H__ */
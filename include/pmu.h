@@ -0,0 +1,72 @@
+/********************************************************************
+ * pmu.h
+ *
+ *  Header file for the ARM1176 performance monitor unit (PMU) module.
+ *
+ *  The PMU has a cycle counter and two event counters. The module
+ *  accumulates the counters per emulator phase: code between
+ *  PMU_ENTER(phase) and PMU_LEAVE() is charged to that phase, and
+ *  phases nest, so IO handler calls made during a CPU step are
+ *  charged to PMU_IO and not to PMU_CPU.
+ *  The macros are empty unless the build sets PMU_ENABLE=1.
+ *
+ *  October 19, 2026
+ *
+ *******************************************************************/
+
+#ifndef __PMU_H__
+#define __PMU_H__
+
+#include    <stdint.h>
+
+/* ARM1176 event numbers (ARM1176JZF-S TRM, Performance Monitor Control Register)
+ */
+#define     PMU_EV_ICACHE_MISS      0x00
+#define     PMU_EV_IBUF_STALL       0x01
+#define     PMU_EV_DATA_DEP_STALL   0x02
+#define     PMU_EV_IMICRO_TLB_MISS  0x03
+#define     PMU_EV_DMICRO_TLB_MISS  0x04
+#define     PMU_EV_BRANCH           0x05
+#define     PMU_EV_BRANCH_MISPRED   0x06
+#define     PMU_EV_INSTRUCTIONS     0x07
+#define     PMU_EV_DCACHE_ACCESS    0x09
+#define     PMU_EV_DCACHE_MISS      0x0b
+#define     PMU_EV_DCACHE_WB        0x0c
+#define     PMU_EV_PC_CHANGE        0x0d
+#define     PMU_EV_MAIN_TLB_MISS    0x0f
+#define     PMU_EV_EXT_ACCESS       0x10
+#define     PMU_EV_LSU_STALL        0x11
+#define     PMU_EV_WB_DRAIN         0x12
+
+/* Emulator phases
+ */
+typedef enum
+{
+    PMU_OTHER = 0,                  // Main loop and anything not in a phase below
+    PMU_CPU,                        // cpu_run_block()
+    PMU_VDG,                        // vdg_render()
+    PMU_IO,                         // Memory mapped IO call-backs
+    PMU_SD,                         // SD card block reads
+    PMU_PHASES
+} pmu_phase_t;
+
+/********************************************************************
+ *  PMU module API
+ */
+void pmu_init(void);
+void pmu_set_events(int event0, int event1);
+void pmu_clear(void);
+void pmu_enter(pmu_phase_t phase);
+void pmu_leave(void);
+void pmu_report(void);
+void pmu_monitor(void);
+
+#if (PMU_ENABLE==1)
+#define     PMU_ENTER(phase)        pmu_enter(phase)
+#define     PMU_LEAVE()             pmu_leave()
+#else
+#define     PMU_ENTER(phase)
+#define     PMU_LEAVE()
+#endif
+
+#endif  /* __PMU_H__ */
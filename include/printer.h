@@ -0,0 +1,31 @@
+/********************************************************************
+ * printer.h
+ *
+ *  Header file for the parallel printer capture module.
+ *
+ *  Bytes that the Dragon sends to its printer port are collected
+ *  in RAM and written to PRINTER.TXT in the root directory of the
+ *  SD card, in place, a cluster at a time.
+ *
+ *  October 19, 2026
+ *
+ *******************************************************************/
+
+#ifndef __PRINTER_H__
+#define __PRINTER_H__
+
+#include    <stdint.h>
+
+#include    "section.h"
+
+#define     PRINTER_FILE_NAME       "PRINTER.TXT"
+
+/********************************************************************
+ *  Printer module API
+ */
+void printer_init(void) SECTION_COLD;
+void printer_write(uint8_t data);
+void printer_frame(void) SECTION_HOT;
+void printer_flush(void) SECTION_COLD;
+
+#endif  /* __PRINTER_H__ */
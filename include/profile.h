@@ -0,0 +1,40 @@
+/********************************************************************
+ * profile.h
+ *
+ *  Header file for per-title performance profiles.
+ *
+ *  Profiles are read from PROFILES.TXT in the directory of the ROM
+ *  or CAS file that the loader loads, and applied when it is loaded.
+ *
+ *  October 19, 2026
+ *
+ *******************************************************************/
+
+#ifndef __PROFILE_H__
+#define __PROFILE_H__
+
+#include    "section.h"
+#include    "sdfat32.h"
+
+#define     PROFILE_FILE_NAME       "PROFILES.TXT"
+#define     PROFILE_MAX_FRAME_SKIP  4
+#define     PROFILE_MAX_SPEED       8
+#define     PROFILE_MAX_TAPE_SPEED  20
+
+typedef struct
+{
+    int     fast_load;      // Run without pacing while the cassette motor is on
+    int     rom_blocks;     // Recompiled ROM blocks and native character fetch
+    int     frame_skip;     // Render one of every 'frame_skip' frames
+    int     speed;          // CPU clock multiplier, reduces pacing delay
+    int     tape_speed;     // CPU clock multiplier while the cassette motor is on
+    int     artifact;       // PMODE4 artifact colours, VDG_ARTIFACT_*
+} profile_t;
+
+/********************************************************************
+ *  Profile module API
+ */
+void             profile_select(dir_entry_t *directory_list, int list_length, char *title) SECTION_COLD;
+const profile_t *profile_get(void);
+
+#endif  /* __PROFILE_H__ */
@@ -13,6 +13,8 @@
 
 #include    <stdint.h>
 
+#include    "section.h"
+
 #define     DEFAULT_UART_RATE   BAUD_115200
 #define     DEFAULT_SPI0_RATE   2000000     // Keyboard interface Hz bit rate
 
@@ -26,14 +28,15 @@ typedef enum
         SD_TIMEOUT,
         SD_BAD_CRC,
         SD_READ_FAIL,
+        SD_WRITE_FAIL,
     } sd_error_t;
 
 /********************************************************************
  *  RPi bare meta module API
  */
-int      rpi_gpio_init(void);
+int      rpi_gpio_init(void) SECTION_COLD;
 
-uint8_t *rpi_fb_init(int h, int v);
+uint8_t *rpi_fb_init(int h, int v) SECTION_COLD;
 uint8_t *rpi_fb_resolution(int h, int v);
 
 uint32_t rpi_system_timer(void);
@@ -45,6 +48,7 @@ int      rpi_joystk_comp(void);
 int      rpi_rjoystk_button(void);
 
 int      rpi_reset_button(void);
+void     rpi_button_scan(void);
 
 void     rpi_audio_mux_set(int);
 
@@ -57,10 +61,12 @@ void     rpi_testpoint_on(void);
 void     rpi_testpoint_off(void);
 
 void     rpi_halt(void);
+int      rpi_uart_write(uint8_t *buffer, int count);
 
 // XXX does not need to be defined void     _putchar(char character);
 
-sd_error_t rpi_sd_init(void);
-sd_error_t rpi_sd_read_block(uint32_t lba, uint8_t *buffer, uint32_t length);
+sd_error_t rpi_sd_init(void) SECTION_COLD;
+sd_error_t rpi_sd_read_block(uint32_t lba, uint8_t *buffer, uint32_t length) SECTION_COLD;
+sd_error_t rpi_sd_write_block(uint32_t lba, uint8_t *buffer, uint32_t length) SECTION_COLD;
 
 #endif  /* __RPI_H__ */
@@ -11,6 +11,23 @@
 #ifndef __SAM_H__
 #define __SAM_H__
 
+#include    <stdint.h>
+
+/* SAM registers, also the SAM state for machine snapshots
+ */
+typedef struct
+{
+    uint8_t vdg_mode;
+    uint8_t vdg_display_offset;
+    uint8_t page;
+    uint8_t mpu_rate;
+    uint8_t memory_size;
+    uint8_t memory_map_type;
+} sam_state_t;
+
 void sam_init(void);
 
+void sam_get_state(sam_state_t *sam_state);
+void sam_set_state(sam_state_t *sam_state);
+
 #endif  /* __SAM_H__ */
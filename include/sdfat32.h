@@ -2,11 +2,12 @@
  * sdfat32.h
  *
  *  Header file for SPI SD card reader that implements a minimal
- *  read-only driver for FAT32 file system, and an interface to
+ *  read-only driver for FAT32 and exFAT file systems, and an interface to
  *  read CAS and ROM files into emulator memory.
  *
- *  This is a minimal implementation, FAT32, read only, v1.0 SD card
- *  compliant driver. The goal is functionality not performance.
+ *  This is a minimal implementation, FAT32 and exFAT, read only, SD card
+ *  driver. The goal is functionality not performance, except for
+ *  contiguous exFAT files that are read without walking the FAT.
  *
  *  May 9, 2021
  *
@@ -27,6 +28,7 @@ typedef struct
         char        sfn[FAT32_DOS_FILE_NAME];
         uint32_t    cluster_chain_head;
         int         file_size;
+        int         is_contiguous;      // exFAT NoFatChain, clusters follow each other
     } dir_entry_t;
 
 typedef enum
@@ -36,13 +38,14 @@ typedef enum
         FAT_BAD_SECTOR_SIG,
         FAT_BAD_PARTITION_TYPE,
         FAT_BAD_SECTOR_PER_CLUS,
+        FAT_BAD_SECTOR_SIZE,
     } fat_error_t;
 
 /********************************************************************
  *  SD FAT32 reader API
  */
 fat_error_t fat32_init(void);
-int         fat32_parse_dir(uint32_t start_cluster, dir_entry_t *directory_list, int dir_list_length);
+int         fat32_parse_dir(dir_entry_t *directory, dir_entry_t *directory_list, int dir_list_length);
 
 int         fat32_fopen(dir_entry_t *directory_entry);
 void        fat32_fclose(void);
@@ -50,5 +53,12 @@ int         fat32_fseek(int byte_position);
 int         fat32_fread(uint8_t *buffer, int buffer_length);
 int         fat32_fstat(void);
 int         fat32_ftell(void);
+int         fat32_name_match(char *name, char *match);
+
+int         fat32_chain_length(uint32_t start_cluster);
+
+int         fat32_cluster_bytes(void);
+uint32_t    fat32_cluster_sector(uint32_t cluster_num);
+uint32_t    fat32_next_cluster(dir_entry_t *directory_entry, uint32_t cluster_num);
 
 #endif  /* __SDFAT32_H__ */
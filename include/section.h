@@ -0,0 +1,43 @@
+/********************************************************************
+ * section.h
+ *
+ *  Header file with the code and data placement attributes used
+ *  with the project linker script dragon.ld.
+ *
+ *  SECTION_HOT code is linked contiguously right after the start-up
+ *  code, so that the emulation loop shares the 16KB I-cache with as
+ *  little else as possible. SECTION_COLD code (initialization, loader,
+ *  SD card and file system) is linked after all other code.
+ *  Hot data and lookup tables are grouped and cache line aligned.
+ *  The attributes are empty in host builds of the emulator modules.
+ *
+ *  October 19, 2026
+ *
+ *******************************************************************/
+
+#ifndef __SECTION_H__
+#define __SECTION_H__
+
+#define     CACHE_LINE              32          // ARM1176 L1 cache line size in bytes
+
+#if (RPI_BARE_METAL==1)
+
+#define     SECTION_HOT             __attribute__((section(".text.hot")))
+#define     SECTION_COLD            __attribute__((section(".text.cold")))
+#define     SECTION_HOT_RODATA      __attribute__((section(".rodata.hot"), aligned(CACHE_LINE)))
+#define     SECTION_HOT_DATA        __attribute__((section(".data.hot"), aligned(CACHE_LINE)))
+#define     SECTION_HOT_BSS         __attribute__((section(".bss.hot"), aligned(CACHE_LINE)))
+#define     CACHE_ALIGNED           __attribute__((aligned(CACHE_LINE)))
+
+#else
+
+#define     SECTION_HOT
+#define     SECTION_COLD
+#define     SECTION_HOT_RODATA
+#define     SECTION_HOT_DATA
+#define     SECTION_HOT_BSS
+#define     CACHE_ALIGNED
+
+#endif
+
+#endif  /* __SECTION_H__ */
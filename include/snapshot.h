@@ -0,0 +1,52 @@
+/********************************************************************
+ * snapshot.h
+ *
+ *  Header for the machine snapshot module.
+ *
+ *  A snapshot holds the CPU, SAM, PIA and VDG state, the 32K RAM,
+ *  and the IO page of the memory image. ROM is not part of
+ *  a snapshot.
+ *
+ *  October 19, 2026
+ *
+ *******************************************************************/
+
+#ifndef __SNAPSHOT_H__
+#define __SNAPSHOT_H__
+
+#include    <stdint.h>
+
+#include    "cpu.h"
+#include    "mem.h"
+#include    "sam.h"
+#include    "pia.h"
+#include    "vdg.h"
+
+#define     SNAPSHOT_MAGIC          0x32334744  // "DG32"
+#define     SNAPSHOT_VERSION        2
+
+#define     SNAPSHOT_RAM_SIZE       0x8000      // Dragon 32 RAM 0x0000 to 0x7fff
+#define     SNAPSHOT_IO_PAGE        0xff00
+
+#define     SNAPSHOT_OK             0
+#define     SNAPSHOT_BAD_HEADER    -1
+
+typedef struct
+{
+    uint32_t    magic;
+    uint32_t    version;
+    cpu_state_t cpu;
+    sam_state_t sam;
+    pia_state_t pia;
+    vdg_state_t vdg;
+    uint8_t     io_page[MEM_PAGE_SIZE];
+    uint8_t     ram[SNAPSHOT_RAM_SIZE];
+} snapshot_t;
+
+/********************************************************************
+ *  Snapshot module API
+ */
+void snapshot_save(snapshot_t *snapshot);
+int  snapshot_restore(snapshot_t *snapshot);
+
+#endif  /* __SNAPSHOT_H__ */
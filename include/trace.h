@@ -0,0 +1,62 @@
+/********************************************************************
+ * trace.h
+ *
+ *  Header file that defines the binary CPU trace record and the
+ *  trace module interface (CPU_TRACE=2).
+ *
+ *  cpu_run() fills one record per executed instruction with the
+ *  register values before execution, the instruction bytes, the
+ *  effective address and the cycle count. Records are queued in RAM
+ *  and sent over the serial console by trace_drain(), and decoded
+ *  into disassembly on the host by tools/tracedump.c.
+ *  Multi-byte fields are little endian on both the RPi and the host.
+ *
+ *  October 19, 2026
+ *
+ *******************************************************************/
+
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#include    <stdint.h>
+
+#define     TRACE_SYNC              0xa5        // First byte of every record
+
+/* Record flags
+ */
+#define     TRACE_FLAG_NMI          0x01        // NMI serviced before the instruction
+#define     TRACE_FLAG_FIRQ         0x02        // FIRQ serviced before the instruction
+#define     TRACE_FLAG_IRQ          0x04        // IRQ serviced before the instruction
+#define     TRACE_FLAG_EXCEPTION    0x80        // Instruction raised an emulation exception
+
+#define     TRACE_CODE_BYTES        5           // Longest MC6809E instruction
+
+/* Binary trace record, 24 bytes with no padding
+ */
+typedef struct
+{
+    uint8_t     sync;                           // TRACE_SYNC
+    uint8_t     flags;                          // TRACE_FLAG_*
+    uint16_t    pc;                             // Instruction address
+    uint8_t     code[TRACE_CODE_BYTES];         // Instruction bytes
+    uint8_t     cycles;                         // Cycles including indexed and branch extras
+    uint16_t    eff_addr;                       // Effective address
+    uint8_t     a;                              // Registers before execution
+    uint8_t     b;
+    uint8_t     dp;
+    uint8_t     cc;
+    uint16_t    x;
+    uint16_t    y;
+    uint16_t    u;
+    uint16_t    s;
+} trace_record_t;
+
+/********************************************************************
+ *  Trace module API
+ */
+void trace_init(void);
+void trace_write(trace_record_t *record);
+int  trace_drain(void);
+int  trace_full(void);
+
+#endif  /* __TRACE_H__ */
@@ -11,13 +11,37 @@
 #ifndef __VDG_H__
 #define __VDG_H__
 
+#include    <stdint.h>
+
+#include    "section.h"
+
 #define     VDG_REFRESH_RATE        50      // in Hz
 
-void vdg_init(void);
-void vdg_render(void);
+/* VDG mode and video RAM offset for machine snapshots
+ */
+typedef struct
+{
+    uint8_t     video_ram_offset;
+    uint8_t     pia_video_mode;
+    int         sam_video_mode;
+} vdg_state_t;
+
+/* PMODE4 artifact colour phase
+ */
+#define     VDG_ARTIFACT_OFF        0
+#define     VDG_ARTIFACT_BLUE_RED   1
+#define     VDG_ARTIFACT_RED_BLUE   2
+
+void vdg_init(void) SECTION_COLD;
+void vdg_render(void) SECTION_HOT;
 
 void vdg_set_video_offset(uint8_t offset);
 void vdg_set_mode_sam(int sam_mode);
 void vdg_set_mode_pia(uint8_t pia_mode);
+void vdg_set_artifact(int artifact);
+void vdg_set_mode_log(int enable);
+
+void vdg_get_state(vdg_state_t *vdg_state);
+void vdg_set_state(vdg_state_t *vdg_state);
 
 #endif  /* __VDG_H__ */
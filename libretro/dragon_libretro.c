@@ -0,0 +1,704 @@
+/********************************************************************
+ * dragon_libretro.c
+ *
+ *  libretro core of the Dragon 32 emulator.
+ *
+ *  The emulation modules, cpu.c mem.c sam.c pia.c vdg.c and audio.c,
+ *  are built for the host with host.c in place of the RPi bare-metal
+ *  modules. retro_run() executes exactly one 50Hz video frame of CPU
+ *  cycles, renders the VDG frame buffer, and hands the band-limited
+ *  DAC stream of the same frame to the front-end. There is no waiting
+ *  for real time, so the front-end sets the pace and can run the core
+ *  far faster than real time.
+ *
+ *  Save states are snapshot.c machine snapshots with the host state and
+ *  frame timing of the core. The same snapshots, kept in RAM, implement
+ *  the run-ahead option. A .cas content file, or an LZ4 compressed one,
+ *  is mounted as the cassette, the BASIC ROM is built in. Presented
+ *  frames can also be exported to other processes through shared
+ *  memory, see shmfb.h.
+ *
+ *  October 19, 2026
+ *
+ *******************************************************************/
+
+#include    <stdio.h>
+#include    <stdint.h>
+#include    <string.h>
+#include    <stdlib.h>
+
+#include    "libretro.h"
+
+#include    "mem.h"
+#include    "cpu.h"
+#include    "sam.h"
+#include    "vdg.h"
+#include    "pia.h"
+#include    "audio.h"
+#include    "snapshot.h"
+
+#include    "host.h"
+#include    "shmfb.h"
+
+/* -----------------------------------------
+   Dragon 32 ROM image
+----------------------------------------- */
+#include    "dragon/dragon.h"
+
+/* -----------------------------------------
+   Local definitions
+----------------------------------------- */
+#define     DRAGON_ROM_START        0x8000
+#define     DRAGON_ROM_END          0xfeff
+
+#define     FRAME_CYCLES            (CPU_CLOCK_HZ / VDG_REFRESH_RATE)
+#define     FRAME_CYCLES_REM        (CPU_CLOCK_HZ % VDG_REFRESH_RATE)
+#define     FRAME_USEC              (1000000 / VDG_REFRESH_RATE)
+#define     FRAME_SAMPLES_MAX       1024        // PCM samples read per frame, above AUDIO_SAMPLE_RATE / VDG_REFRESH_RATE
+
+#define     CPU_MIN_CYCLES          2           // Fewest cycles of an instruction
+
+#define     PCM_CENTER              ((((1 << AUDIO_DAC_BITS) - 1) << AUDIO_PCM_SHIFT) / 2)
+
+#define     JOYSTK_ANALOG_RANGE     65536       // libretro analog axis -32768 to 32767
+
+#define     RUNAHEAD_MAX            4           // Largest 'dragon32_runahead' option value
+
+/* Save state and run-ahead state, the machine snapshot,
+ * the host state and the frame timing of the core
+ */
+typedef struct
+{
+    snapshot_t      machine;
+    host_state_t    host;
+    int32_t         frame_cycles;
+    int32_t         frame_cycles_frac;
+} core_state_t;
+
+/* -----------------------------------------
+   Module static functions
+----------------------------------------- */
+static void machine_init(void);
+static void run_frame(int render);
+static void state_save(core_state_t *state);
+static bool state_restore(core_state_t *state);
+static void options_update(int force);
+static void keyboard_event(bool down, unsigned keycode, uint32_t character, uint16_t key_modifiers);
+static void joystick_update(void);
+static int  joystick_axis(int16_t value);
+static void video_output(void);
+static void audio_stream_output(void);
+
+/* -----------------------------------------
+   Module globals
+----------------------------------------- */
+static retro_environment_t          environ_cb;
+static retro_video_refresh_t        video_cb;
+static retro_audio_sample_t         audio_cb;
+static retro_audio_sample_batch_t   audio_batch_cb;
+static retro_input_poll_t           input_poll_cb;
+static retro_input_state_t          input_state_cb;
+
+static uint32_t     video_out[HOST_FB_WIDTH * HOST_FB_HEIGHT];
+static int16_t      pcm_samples[FRAME_SAMPLES_MAX];
+static int16_t      pcm_stereo[FRAME_SAMPLES_MAX * 2];
+
+static int          frame_cycles = 0;           // Cycles run past the end of the last frame
+static int          frame_cycles_frac = 0;      // Frame cycle remainder, in 1/VDG_REFRESH_RATE cycles
+static int          reset_asserted = 0;
+
+static uint8_t     *cas_image = 0;
+
+static core_state_t core_state;
+
+static int          runahead_frames = 0;
+static core_state_t runahead_state;
+static audio_state_t runahead_audio;
+
+static const struct retro_variable core_options[] =
+{
+    { "dragon32_runahead", "Run-ahead frames; 0|1|2|3|4" },
+    { "dragon32_shm_export", "Shared memory frame export; disabled|enabled" },
+    { 0, 0 },
+};
+
+/* libretro key codes to the PS/2 scan codes
+ * of the keyboard AVR interface that pia.c decodes
+ */
+static const struct
+{
+    unsigned    keycode;
+    uint8_t     scan_code;
+} key_map[] =
+{
+    { RETROK_ESCAPE,        1  },   // Break
+    { RETROK_1,             2  },
+    { RETROK_2,             3  },
+    { RETROK_3,             4  },
+    { RETROK_4,             5  },
+    { RETROK_5,             6  },
+    { RETROK_6,             7  },
+    { RETROK_7,             8  },
+    { RETROK_8,             9  },
+    { RETROK_9,             10 },
+    { RETROK_0,             11 },
+    { RETROK_MINUS,         12 },
+    { RETROK_EQUALS,        13 },   // :
+    { RETROK_BACKSPACE,     14 },   // Clear
+    { RETROK_q,             16 },
+    { RETROK_w,             17 },
+    { RETROK_e,             18 },
+    { RETROK_r,             19 },
+    { RETROK_t,             20 },
+    { RETROK_y,             21 },
+    { RETROK_u,             22 },
+    { RETROK_i,             23 },
+    { RETROK_o,             24 },
+    { RETROK_p,             25 },
+    { RETROK_LEFTBRACKET,   26 },   // @
+    { RETROK_RETURN,        28 },
+    { RETROK_a,             30 },
+    { RETROK_s,             31 },
+    { RETROK_d,             32 },
+    { RETROK_f,             33 },
+    { RETROK_g,             34 },
+    { RETROK_h,             35 },
+    { RETROK_j,             36 },
+    { RETROK_k,             37 },
+    { RETROK_l,             38 },
+    { RETROK_SEMICOLON,     39 },
+    { RETROK_LSHIFT,        42 },
+    { RETROK_RSHIFT,        42 },
+    { RETROK_z,             44 },
+    { RETROK_x,             45 },
+    { RETROK_c,             46 },
+    { RETROK_v,             47 },
+    { RETROK_b,             48 },
+    { RETROK_n,             49 },
+    { RETROK_m,             50 },
+    { RETROK_COMMA,         51 },
+    { RETROK_PERIOD,        52 },
+    { RETROK_SLASH,         53 },
+    { RETROK_SPACE,         57 },
+    { RETROK_UP,            72 },
+    { RETROK_LEFT,          75 },
+    { RETROK_RIGHT,         77 },
+    { RETROK_DOWN,          80 },
+};
+
+/********************************************************************
+ *  libretro API
+ */
+
+unsigned retro_api_version(void)
+{
+    return RETRO_API_VERSION;
+}
+
+void retro_set_environment(retro_environment_t cb)
+{
+    bool    no_game = true;
+
+    environ_cb = cb;
+    environ_cb(RETRO_ENVIRONMENT_SET_SUPPORT_NO_GAME, &no_game);
+    environ_cb(RETRO_ENVIRONMENT_SET_VARIABLES, (void *) core_options);
+}
+
+void retro_set_video_refresh(retro_video_refresh_t cb)
+{
+    video_cb = cb;
+}
+
+void retro_set_audio_sample(retro_audio_sample_t cb)
+{
+    audio_cb = cb;
+}
+
+void retro_set_audio_sample_batch(retro_audio_sample_batch_t cb)
+{
+    audio_batch_cb = cb;
+}
+
+void retro_set_input_poll(retro_input_poll_t cb)
+{
+    input_poll_cb = cb;
+}
+
+void retro_set_input_state(retro_input_state_t cb)
+{
+    input_state_cb = cb;
+}
+
+void retro_init(void)
+{
+}
+
+void retro_deinit(void)
+{
+    shmfb_close();
+}
+
+void retro_get_system_info(struct retro_system_info *info)
+{
+    memset(info, 0, sizeof(*info));
+    info->library_name = "Dragon32";
+    info->library_version = "1.0";
+    info->valid_extensions = "cas|lz4";
+    info->need_fullpath = false;
+    info->block_extract = false;
+}
+
+void retro_get_system_av_info(struct retro_system_av_info *info)
+{
+    memset(info, 0, sizeof(*info));
+    info->geometry.base_width = HOST_FB_WIDTH;
+    info->geometry.base_height = HOST_FB_HEIGHT;
+    info->geometry.max_width = HOST_FB_WIDTH;
+    info->geometry.max_height = HOST_FB_HEIGHT;
+    info->geometry.aspect_ratio = 4.0f / 3.0f;
+    info->timing.fps = VDG_REFRESH_RATE;
+    info->timing.sample_rate = AUDIO_SAMPLE_RATE;
+}
+
+void retro_set_controller_port_device(unsigned port, unsigned device)
+{
+}
+
+bool retro_load_game(const struct retro_game_info *game)
+{
+    enum retro_pixel_format         format = RETRO_PIXEL_FORMAT_XRGB8888;
+    struct retro_keyboard_callback  keyboard = { keyboard_event };
+
+    if ( !environ_cb(RETRO_ENVIRONMENT_SET_PIXEL_FORMAT, &format) )
+        return false;
+
+    environ_cb(RETRO_ENVIRONMENT_SET_KEYBOARD_CALLBACK, &keyboard);
+    options_update(1);
+
+    machine_init();
+
+    /* The content is a cassette image, keep a copy
+     * because the front-end may release its buffer
+     */
+    if ( game && game->data && game->size > 0 )
+    {
+        cas_image = malloc(game->size);
+        if ( cas_image == 0 )
+            return false;
+
+        memcpy(cas_image, game->data, game->size);
+        if ( !host_cas_mount(cas_image, (int) game->size) )
+            return false;
+    }
+
+    return true;
+}
+
+bool retro_load_game_special(unsigned game_type, const struct retro_game_info *info, size_t num_info)
+{
+    return false;
+}
+
+void retro_unload_game(void)
+{
+    host_cas_unmount();
+    free(cas_image);
+    cas_image = 0;
+}
+
+unsigned retro_get_region(void)
+{
+    return RETRO_REGION_PAL;
+}
+
+void retro_reset(void)
+{
+    host_init();
+    cpu_reset(1);
+    reset_asserted = 1;
+}
+
+/*------------------------------------------------
+ * retro_run()
+ *
+ *  Run one video frame of emulation, and with run-ahead
+ *  present the frame 'runahead_frames' later instead.
+ *
+ *  Run-ahead runs the frame with the current input and plays its audio,
+ *  saves the machine, runs further frames with the same input, shows the
+ *  last one, and restores the machine. A game that reacts to input a
+ *  frame or two after reading it is then seen reacting in the frame
+ *  the input was given.
+ *
+ *  param:  Nothing
+ *  return: Nothing
+ */
+void retro_run(void)
+{
+    int     i;
+
+    input_poll_cb();
+    options_update(0);
+    joystick_update();
+
+    if ( runahead_frames == 0 )
+    {
+        run_frame(1);
+        audio_stream_output();
+        video_output();
+        return;
+    }
+
+    run_frame(0);
+    audio_stream_output();
+
+    state_save(&runahead_state);
+    audio_get_state(&runahead_audio);
+
+    for ( i = 1; i <= runahead_frames; i++ )
+        run_frame(i == runahead_frames);
+
+    video_output();
+
+    state_restore(&runahead_state);
+    audio_set_state(&runahead_audio);
+}
+
+size_t retro_serialize_size(void)
+{
+    return sizeof(core_state_t);
+}
+
+bool retro_serialize(void *data, size_t size)
+{
+    if ( size < sizeof(core_state_t) )
+        return false;
+
+    state_save(&core_state);
+    memcpy(data, &core_state, sizeof(core_state_t));
+
+    return true;
+}
+
+bool retro_unserialize(const void *data, size_t size)
+{
+    if ( size < sizeof(core_state_t) )
+        return false;
+
+    memcpy(&core_state, data, sizeof(core_state_t));
+
+    return state_restore(&core_state);
+}
+
+void retro_cheat_reset(void)
+{
+}
+
+void retro_cheat_set(unsigned index, bool enabled, const char *code)
+{
+}
+
+void *retro_get_memory_data(unsigned id)
+{
+    if ( id == RETRO_MEMORY_SYSTEM_RAM )
+        return mem_get_map();
+
+    return 0;
+}
+
+size_t retro_get_memory_size(unsigned id)
+{
+    if ( id == RETRO_MEMORY_SYSTEM_RAM )
+        return SNAPSHOT_RAM_SIZE;
+
+    return 0;
+}
+
+/*------------------------------------------------
+ * machine_init()
+ *
+ *  Load the ROM and initialize the emulation modules,
+ *  in the same order as the bare-metal main().
+ *
+ *  param:  Nothing
+ *  return: Nothing
+ */
+static void machine_init(void)
+{
+    int     i;
+
+    host_init();
+    mem_init();
+
+    i = 0;
+    while ( code[i] != -1 )
+    {
+        mem_write(i + LOAD_ADDRESS, code[i]);
+        i++;
+    }
+
+    mem_define_rom(DRAGON_ROM_START, DRAGON_ROM_END);
+
+    sam_init();
+    pia_init();
+    vdg_init();
+
+    cpu_init(RUN_ADDRESS);
+    audio_init();
+
+    frame_cycles = 0;
+    frame_cycles_frac = 0;
+
+    cpu_reset(1);
+    reset_asserted = 1;
+}
+
+/*------------------------------------------------
+ * run_frame()
+ *
+ *  Run one video frame of emulation.
+ *  The CPU runs in blocks until the frame's cycle budget is used,
+ *  and the cycles a block runs past the budget are taken from the
+ *  next frame. The frame then ends the way the bare-metal main loop
+ *  renders a frame, with vdg_render() and the field sync IRQ.
+ *
+ *  param:  1- render the VDG frame buffer, 0- skip rendering
+ *  return: Nothing
+ */
+static void run_frame(int render)
+{
+    int     budget;
+    int     cycles;
+
+    budget = FRAME_CYCLES;
+    frame_cycles_frac += FRAME_CYCLES_REM;
+    if ( frame_cycles_frac >= VDG_REFRESH_RATE )
+    {
+        frame_cycles_frac -= VDG_REFRESH_RATE;
+        budget++;
+    }
+
+    while ( frame_cycles < budget && !host_halted() )
+    {
+        cpu_run_block((budget - frame_cycles) / CPU_MIN_CYCLES);
+        cycles = cpu_get_block_cycles();
+        audio_advance(cycles);
+        frame_cycles += cycles;
+
+        /* Release reset after one block, as the
+         * bare-metal main loop does
+         */
+        if ( reset_asserted )
+        {
+            cpu_reset(0);
+            reset_asserted = 0;
+        }
+    }
+
+    if ( frame_cycles >= budget )
+        frame_cycles -= budget;
+    else
+        frame_cycles = 0;
+
+    /* Function keys escape to the SD card loader
+     * on the bare-metal emulator, there is none here
+     */
+    pia_function_key();
+
+    if ( render )
+        vdg_render();
+
+    pia_vsync_irq();
+
+    host_timer_advance(FRAME_USEC);
+}
+
+/*------------------------------------------------
+ * state_save()
+ *
+ *  Save the machine snapshot, the host state
+ *  and the frame timing of the core.
+ *
+ *  param:  Pointer to core state
+ *  return: Nothing
+ */
+static void state_save(core_state_t *state)
+{
+    snapshot_save(&state->machine);
+    host_get_state(&state->host);
+
+    state->frame_cycles = frame_cycles;
+    state->frame_cycles_frac = frame_cycles_frac;
+}
+
+/*------------------------------------------------
+ * state_restore()
+ *
+ *  Restore a state saved by state_save().
+ *
+ *  param:  Pointer to core state
+ *  return: true- restored, false- not a snapshot of this core version
+ */
+static bool state_restore(core_state_t *state)
+{
+    if ( snapshot_restore(&state->machine) != SNAPSHOT_OK )
+        return false;
+
+    host_set_state(&state->host);
+
+    frame_cycles = state->frame_cycles;
+    frame_cycles_frac = state->frame_cycles_frac;
+
+    return true;
+}
+
+/*------------------------------------------------
+ * options_update()
+ *
+ *  Read the core options when the front-end changed them.
+ *
+ *  param:  1- read the options even if not changed
+ *  return: Nothing
+ */
+static void options_update(int force)
+{
+    struct retro_variable   variable = { "dragon32_runahead", 0 };
+    bool                    updated = false;
+
+    if ( !force &&
+         (!environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE_UPDATE, &updated) || !updated) )
+        return;
+
+    if ( environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &variable) && variable.value )
+    {
+        runahead_frames = atoi(variable.value);
+        if ( runahead_frames < 0 || runahead_frames > RUNAHEAD_MAX )
+            runahead_frames = 0;
+    }
+
+    variable.key = "dragon32_shm_export";
+    variable.value = 0;
+
+    if ( environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &variable) && variable.value &&
+         strcmp(variable.value, "enabled") == 0 )
+        shmfb_open();
+    else
+        shmfb_close();
+}
+
+/*------------------------------------------------
+ * keyboard_event()
+ *
+ *  libretro keyboard call-back.
+ *  Queue the 'make' or 'break' scan code of keys
+ *  that are on the Dragon keyboard.
+ *
+ *  param:  Key state, libretro key code, character and modifiers
+ *  return: Nothing
+ */
+static void keyboard_event(bool down, unsigned keycode, uint32_t character, uint16_t key_modifiers)
+{
+    int     i;
+
+    for ( i = 0; i < (int)(sizeof(key_map) / sizeof(key_map[0])); i++ )
+    {
+        if ( key_map[i].keycode == keycode )
+        {
+            host_keyboard_event(down ? key_map[i].scan_code : (key_map[i].scan_code | 0x80));
+            break;
+        }
+    }
+}
+
+/*------------------------------------------------
+ * joystick_update()
+ *
+ *  Read the left analog stick of port 0 as the right
+ *  Dragon joystick, with joypad 'A' or 'B' as its button.
+ *
+ *  param:  Nothing
+ *  return: Nothing
+ */
+static void joystick_update(void)
+{
+    int     x, y, button;
+
+    x = joystick_axis(input_state_cb(0, RETRO_DEVICE_ANALOG, RETRO_DEVICE_INDEX_ANALOG_LEFT, RETRO_DEVICE_ID_ANALOG_X));
+    y = joystick_axis(input_state_cb(0, RETRO_DEVICE_ANALOG, RETRO_DEVICE_INDEX_ANALOG_LEFT, RETRO_DEVICE_ID_ANALOG_Y));
+
+    button = input_state_cb(0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_A) ||
+             input_state_cb(0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_B);
+
+    host_joystick_set(x, y, button);
+}
+
+/*------------------------------------------------
+ * joystick_axis()
+ *
+ *  Scale a libretro analog axis to the joystick range.
+ *
+ *  param:  Analog axis value
+ *  return: Joystick position 0 to HOST_JOYSTK_MAX
+ */
+static int joystick_axis(int16_t value)
+{
+    return (((int) value + JOYSTK_ANALOG_RANGE / 2) * (HOST_JOYSTK_MAX + 1)) / JOYSTK_ANALOG_RANGE;
+}
+
+/*------------------------------------------------
+ * video_output()
+ *
+ *  Convert the 8 bit per pixel VDG frame buffer
+ *  to XRGB8888, send it to the front-end and
+ *  to the shared memory frame export.
+ *
+ *  param:  Nothing
+ *  return: Nothing
+ */
+static void video_output(void)
+{
+    vdg_state_t vdg_state;
+    uint8_t    *fb;
+    int         width, height, i;
+
+    fb = host_fb_get(&width, &height);
+
+    for ( i = 0; i < width * height; i++ )
+        video_out[i] = host_fb_color(fb[i]);
+
+    video_cb(video_out, width, height, width * sizeof(uint32_t));
+
+    vdg_get_state(&vdg_state);
+    shmfb_publish(video_out, width, height, vdg_state.pia_video_mode, vdg_state.sam_video_mode);
+}
+
+/*------------------------------------------------
+ * audio_stream_output()
+ *
+ *  Read the frame's PCM samples from the audio module and
+ *  send them to the front-end as centered 16-bit stereo.
+ *
+ *  param:  Nothing
+ *  return: Nothing
+ */
+static void audio_stream_output(void)
+{
+    int     count, i, sample;
+
+    count = audio_read(pcm_samples, FRAME_SAMPLES_MAX);
+
+    for ( i = 0; i < count; i++ )
+    {
+        sample = (pcm_samples[i] - PCM_CENTER) * 2;
+        if ( sample > INT16_MAX )
+            sample = INT16_MAX;
+        else if ( sample < INT16_MIN )
+            sample = INT16_MIN;
+
+        pcm_stereo[2 * i] = (int16_t) sample;
+        pcm_stereo[2 * i + 1] = (int16_t) sample;
+    }
+
+    if ( count > 0 )
+        audio_batch_cb(pcm_stereo, count);
+}
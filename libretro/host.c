@@ -0,0 +1,532 @@
+/********************************************************************
+ * host.c
+ *
+ *  Host implementation of the RPi bare-metal interface (rpi.h)
+ *  for the libretro core and the tools/scenario.c runner.
+ *
+ *  The frame buffer is an 8 bit per pixel surface in host memory
+ *  with the palette of rpibm.c, the system timer is emulated time
+ *  advanced by the core, and keyboard, joystick comparator and cassette
+ *  input are fed by the core from the libretro front-end.
+ *  The SD card is not available, so the FAT32 file and loader
+ *  calls made by pia.c read the cassette image the core mounted,
+ *  and printer output is discarded. An LZ4 compressed cassette
+ *  image is expanded when it is mounted.
+ *
+ *  October 19, 2026
+ *
+ *******************************************************************/
+
+#include    <stdio.h>
+#include    <stdint.h>
+#include    <stdlib.h>
+#include    <string.h>
+
+#include    "rpi.h"
+#include    "sdfat32.h"
+#include    "loader.h"
+#include    "lz4.h"
+#include    "printer.h"
+#include    "log.h"
+
+#include    "host.h"
+
+/* -----------------------------------------
+   Local definitions
+----------------------------------------- */
+#define     KBD_QUEUE_LENGTH        64          // Scan code queue, a power of 2
+#define     KBD_QUEUE_MASK          (KBD_QUEUE_LENGTH - 1)
+
+#define     AUDIO_MUX_JSTKX         0
+#define     AUDIO_MUX_JSTKY         1
+
+/* -----------------------------------------
+   Module globals
+----------------------------------------- */
+static uint8_t      frame_buffer[HOST_FB_WIDTH * HOST_FB_HEIGHT];
+static int          fb_width = 0;
+static int          fb_height = 0;
+
+/* Same colors as 'palette_bgr[]' in rpibm.c, in XRGB8888 format
+ */
+static const uint32_t palette_xrgb[HOST_PALETTE_COLORS] =
+{
+        0x00000000,
+        0x00000080,
+        0x00008000,
+        0x00008080,
+        0x00800000,
+        0x00800080,
+        0x00ffa500,
+        0x00c0c0c0,
+        0x00808080,
+        0x000000ff,
+        0x0000ff00,
+        0x0000ffff,
+        0x00ff0000,
+        0x00ff00ff,
+        0x00ffff00,
+        0x00ffffff
+};
+
+static uint32_t     system_time = 0;
+
+static uint8_t      kbd_queue[KBD_QUEUE_LENGTH];
+static int          kbd_head = 0;
+static int          kbd_tail = 0;
+
+static int          joystick_x = HOST_JOYSTK_MAX / 2;
+static int          joystick_y = HOST_JOYSTK_MAX / 2;
+static int          joystick_button = 0;
+static int          audio_mux = 0;
+static int          dac_level = 0;
+
+static const uint8_t *cas_data = 0;
+static int          cas_length = 0;
+static int          cas_position = 0;
+static int          cas_open = 0;
+static uint8_t     *cas_expanded = 0;           // Expanded LZ4 image, owned by the host
+
+static int          halted = 0;
+
+/*------------------------------------------------
+ * host_init()
+ *
+ *  Initialize the host interface state.
+ *
+ *  param:  Nothing
+ *  return: Nothing
+ */
+void host_init(void)
+{
+    memset(frame_buffer, 0, sizeof(frame_buffer));
+
+    system_time = 0;
+    kbd_head = 0;
+    kbd_tail = 0;
+    halted = 0;
+}
+
+/*------------------------------------------------
+ * host_fb_get()
+ *
+ *  Get the frame buffer and its current resolution.
+ *
+ *  param:  Pointers to width and height
+ *  return: Pointer to frame buffer
+ */
+uint8_t *host_fb_get(int *width, int *height)
+{
+    *width = fb_width;
+    *height = fb_height;
+
+    return frame_buffer;
+}
+
+/*------------------------------------------------
+ * host_fb_color()
+ *
+ *  Convert a frame buffer palette index to an XRGB8888 color.
+ *
+ *  param:  Palette index
+ *  return: XRGB8888 color
+ */
+uint32_t host_fb_color(int index)
+{
+    return palette_xrgb[index & (HOST_PALETTE_COLORS - 1)];
+}
+
+/*------------------------------------------------
+ * host_timer_advance()
+ *
+ *  Advance the emulated system timer.
+ *
+ *  param:  Micro-seconds
+ *  return: Nothing
+ */
+void host_timer_advance(uint32_t usec)
+{
+    system_time += usec;
+}
+
+/*------------------------------------------------
+ * host_keyboard_event()
+ *
+ *  Queue a keyboard scan code for rpi_keyboard_read().
+ *  The scan code is dropped when the queue is full.
+ *
+ *  param:  Scan code, bit.7 set for a 'break' code
+ *  return: Nothing
+ */
+void host_keyboard_event(int scan_code)
+{
+    if ( (kbd_head - kbd_tail) >= KBD_QUEUE_LENGTH )
+        return;
+
+    kbd_queue[kbd_head & KBD_QUEUE_MASK] = (uint8_t) scan_code;
+    kbd_head++;
+}
+
+/*------------------------------------------------
+ * host_joystick_set()
+ *
+ *  Set the right joystick position and button state.
+ *
+ *  param:  X and Y position 0 to HOST_JOYSTK_MAX, button 1- pressed
+ *  return: Nothing
+ */
+void host_joystick_set(int x, int y, int button)
+{
+    joystick_x = x;
+    joystick_y = y;
+    joystick_button = button;
+}
+
+/*------------------------------------------------
+ * host_cas_mount()
+ *
+ *  Mount a cassette image that pia.c reads when the
+ *  cassette motor is turned on. The data is not copied and must
+ *  remain valid until host_cas_unmount().
+ *  An LZ4 compressed image is expanded here with lz4.c, rather than
+ *  while the tape is read, so that a save state only needs the
+ *  read position of the expanded image.
+ *
+ *  param:  Cassette image and its length in bytes
+ *  return: 1- mounted, 0- no data or a bad LZ4 image
+ */
+int host_cas_mount(const uint8_t *data, int length)
+{
+    dir_entry_t cas_file;
+    uint8_t    *buffer;
+    int         size, count;
+
+    if ( data == 0 || length <= 0 )
+        return 0;
+
+    host_cas_unmount();
+
+    cas_data = data;
+    cas_length = length;
+
+    if ( !loader_mount_cas_file(&cas_file) || !lz4_fopen(&cas_file) )
+    {
+        host_cas_unmount();
+        return 0;
+    }
+
+    if ( lz4_is_compressed() )
+    {
+        size = 0;
+        buffer = 0;
+
+        do
+        {
+            if ( (buffer = realloc(cas_expanded, size + LZ4_BLOCK_MAX)) == 0 )
+                break;
+
+            cas_expanded = buffer;
+            count = lz4_fread(&cas_expanded[size], LZ4_BLOCK_MAX);
+            size += count;
+        } while ( count == LZ4_BLOCK_MAX );
+
+        lz4_fclose();
+
+        if ( buffer == 0 || count < 0 || size == 0 )
+        {
+            host_cas_unmount();
+            return 0;
+        }
+
+        cas_data = cas_expanded;
+        cas_length = size;
+    }
+    else
+    {
+        lz4_fclose();
+    }
+
+    return 1;
+}
+
+/*------------------------------------------------
+ * host_cas_unmount()
+ *
+ *  Remove the mounted cassette image.
+ *
+ *  param:  Nothing
+ *  return: Nothing
+ */
+void host_cas_unmount(void)
+{
+    cas_data = 0;
+    cas_length = 0;
+    cas_position = 0;
+    cas_open = 0;
+
+    free(cas_expanded);
+    cas_expanded = 0;
+}
+
+/*------------------------------------------------
+ * host_halted()
+ *
+ *  Check if the emulation called rpi_halt().
+ *
+ *  param:  Nothing
+ *  return: 1- halted, 0- running
+ */
+int host_halted(void)
+{
+    return halted;
+}
+
+/*------------------------------------------------
+ * host_get_state()
+ *
+ *  Get the host state that the emulation changes.
+ *
+ *  param:  Pointer to host state data structure
+ *  return: Nothing
+ */
+void host_get_state(host_state_t *host_state)
+{
+    host_state->system_time = system_time;
+    host_state->kbd_tail = kbd_tail;
+    host_state->cas_position = cas_position;
+    host_state->dac_level = dac_level;
+}
+
+/*------------------------------------------------
+ * host_set_state()
+ *
+ *  Set the host state from a state saved by host_get_state().
+ *  Scan codes read since the state was saved are read again.
+ *
+ *  param:  Pointer to host state data structure
+ *  return: Nothing
+ */
+void host_set_state(host_state_t *host_state)
+{
+    system_time = host_state->system_time;
+    cas_position = host_state->cas_position;
+    dac_level = host_state->dac_level;
+
+    /* A save state from another session can be
+     * ahead of the queue, keep the queue consistent
+     */
+    if ( (kbd_head - host_state->kbd_tail) >= 0 &&
+         (kbd_head - host_state->kbd_tail) <= KBD_QUEUE_LENGTH )
+        kbd_tail = host_state->kbd_tail;
+    else
+        kbd_tail = kbd_head;
+
+    if ( cas_position > cas_length )
+        cas_position = cas_length;
+
+    /* The restored position is that of an open file,
+     * which a motor on must not open again
+     */
+    cas_open = (cas_data != 0);
+}
+
+/********************************************************************
+ *  RPi bare metal interface, rpi.h
+ */
+
+int rpi_gpio_init(void)
+{
+    return 0;
+}
+
+uint8_t *rpi_fb_init(int h, int v)
+{
+    if ( h > HOST_FB_WIDTH || v > HOST_FB_HEIGHT )
+        return 0;
+
+    fb_width = h;
+    fb_height = v;
+
+    return frame_buffer;
+}
+
+uint8_t *rpi_fb_resolution(int h, int v)
+{
+    return rpi_fb_init(h, v);
+}
+
+uint32_t rpi_system_timer(void)
+{
+    return system_time;
+}
+
+int rpi_keyboard_read(void)
+{
+    int     scan_code = 0;
+
+    if ( kbd_tail != kbd_head )
+    {
+        scan_code = kbd_queue[kbd_tail & KBD_QUEUE_MASK];
+        kbd_tail++;
+    }
+
+    return scan_code;
+}
+
+void rpi_keyboard_reset(void)
+{
+    kbd_head = 0;
+    kbd_tail = 0;
+}
+
+/* The comparator output is high when the selected joystick
+ * potentiometer is at or above the DAC level
+ */
+int rpi_joystk_comp(void)
+{
+    int     level = 0;
+
+    if ( audio_mux == AUDIO_MUX_JSTKX )
+        level = joystick_x;
+    else if ( audio_mux == AUDIO_MUX_JSTKY )
+        level = joystick_y;
+
+    return (level >= dac_level);
+}
+
+int rpi_rjoystk_button(void)
+{
+    return !joystick_button;    // Active low
+}
+
+int rpi_reset_button(void)
+{
+    return 1;                   // Active low, reset is done by the core
+}
+
+void rpi_audio_mux_set(int select)
+{
+    audio_mux = select;
+}
+
+void rpi_write_dac(int level)
+{
+    dac_level = level;
+}
+
+void rpi_disable(void)
+{
+}
+
+void rpi_enable(void)
+{
+}
+
+void rpi_testpoint_on(void)
+{
+}
+
+void rpi_testpoint_off(void)
+{
+}
+
+/* The core stops running the CPU instead of
+ * looping forever, until it is reset
+ */
+void rpi_halt(void)
+{
+    log_flush();
+    fprintf(stderr, "HALT\n");
+    halted = 1;
+}
+
+int rpi_uart_write(uint8_t *buffer, int count)
+{
+    return (int) fwrite(buffer, 1, count, stderr);
+}
+
+void _putchar(char character)
+{
+    fputc(character, stderr);
+}
+
+sd_error_t rpi_sd_init(void)
+{
+    return SD_FAIL;
+}
+
+sd_error_t rpi_sd_read_block(uint32_t lba, uint8_t *buffer, uint32_t length)
+{
+    return SD_FAIL;
+}
+
+/* There is no SD card to capture to,
+ * so printer output is discarded
+ */
+void printer_write(uint8_t data)
+{
+}
+
+/********************************************************************
+ *  Cassette image access for pia.c, sdfat32.h and loader.h
+ */
+
+int loader_mount_cas_file(dir_entry_t *cas_file)
+{
+    if ( cas_data == 0 )
+        return 0;
+
+    memset(cas_file, 0, sizeof(dir_entry_t));
+    strcpy(cas_file->sfn, "CONTENT.CAS");
+    cas_file->cluster_chain_head = 1;
+    cas_file->file_size = cas_length;
+
+    return 1;
+}
+
+/* Like the FAT32 driver, opening the file while it is
+ * open fails and does not reset the read position
+ */
+int fat32_fopen(dir_entry_t *directory_entry)
+{
+    if ( cas_data == 0 || cas_open )
+        return 0;
+
+    cas_open = 1;
+    cas_position = 0;
+
+    return 1;
+}
+
+void fat32_fclose(void)
+{
+    cas_open = 0;
+    cas_position = 0;
+}
+
+int fat32_fseek(int byte_position)
+{
+    if ( !cas_open || byte_position >= cas_length )
+        return 0;
+
+    cas_position = byte_position;
+
+    return 1;
+}
+
+int fat32_fread(uint8_t *buffer, int buffer_length)
+{
+    int     count;
+
+    if ( cas_data == 0 )
+        return 0;
+
+    count = cas_length - cas_position;
+    if ( count > buffer_length )
+        count = buffer_length;
+
+    memcpy(buffer, &cas_data[cas_position], count);
+    cas_position += count;
+
+    return count;
+}
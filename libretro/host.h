@@ -0,0 +1,54 @@
+/********************************************************************
+ * host.h
+ *
+ *  Header for the host implementation of the RPi bare-metal
+ *  interface (rpi.h) that is used by the libretro core.
+ *
+ *  October 19, 2026
+ *
+ *******************************************************************/
+
+#ifndef __HOST_H__
+#define __HOST_H__
+
+#include    <stdint.h>
+
+#define     HOST_FB_WIDTH           256         // Largest VDG frame buffer
+#define     HOST_FB_HEIGHT          192
+#define     HOST_PALETTE_COLORS     16
+
+#define     HOST_JOYSTK_MAX         63          // Joystick axis range matches the 6-bit DAC
+
+/* Host state that the emulation changes, for save states and run-ahead.
+ * Queued keyboard input is not state, only the read position is.
+ */
+typedef struct
+{
+    uint32_t    system_time;
+    int32_t     kbd_tail;
+    int32_t     cas_position;
+    int32_t     dac_level;
+} host_state_t;
+
+/********************************************************************
+ *  Host interface API
+ */
+void     host_init(void);
+
+uint8_t *host_fb_get(int *width, int *height);
+uint32_t host_fb_color(int index);
+
+void     host_timer_advance(uint32_t usec);
+
+void     host_keyboard_event(int scan_code);
+void     host_joystick_set(int x, int y, int button);
+
+int      host_cas_mount(const uint8_t *data, int length);
+void     host_cas_unmount(void);
+
+int      host_halted(void);
+
+void     host_get_state(host_state_t *host_state);
+void     host_set_state(host_state_t *host_state);
+
+#endif  /* __HOST_H__ */
@@ -0,0 +1,151 @@
+/********************************************************************
+ * shmfb.c
+ *
+ *  Shared memory frame export of the libretro core.
+ *
+ *  Presented frames are copied into the POSIX shared memory ring
+ *  that shmfb.h describes, so viewers, encoders and screen analysis
+ *  tools can map it and read every frame without sockets and without
+ *  slowing the core. The object is created when the export is enabled
+ *  and unlinked when it is disabled, readers that still have it
+ *  mapped keep their mapping.
+ *
+ *  October 19, 2026
+ *
+ *******************************************************************/
+
+#include    <stdio.h>
+#include    <stdint.h>
+#include    <string.h>
+#include    <fcntl.h>
+#include    <unistd.h>
+#include    <sys/mman.h>
+
+#include    "vdg.h"
+
+#include    "shmfb.h"
+
+/* -----------------------------------------
+   Module globals
+----------------------------------------- */
+static shmfb_t     *shmfb = 0;
+static uint32_t     frame = 0;
+
+/*------------------------------------------------
+ * shmfb_open()
+ *
+ *  Create the shared memory object, map it,
+ *  and initialize its header.
+ *
+ *  param:  Nothing
+ *  return: 0- ok, -1- failed
+ */
+int shmfb_open(void)
+{
+    void   *map;
+    int     fd;
+
+    if ( shmfb )
+        return 0;
+
+    fd = shm_open(SHMFB_NAME, O_CREAT | O_RDWR, 0644);
+    if ( fd == -1 )
+    {
+        perror("shmfb_open(): " SHMFB_NAME);
+        return -1;
+    }
+
+    if ( ftruncate(fd, sizeof(shmfb_t)) == -1 )
+    {
+        perror("shmfb_open(): ftruncate");
+        close(fd);
+        shm_unlink(SHMFB_NAME);
+        return -1;
+    }
+
+    map = mmap(0, sizeof(shmfb_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if ( map == MAP_FAILED )
+    {
+        perror("shmfb_open(): mmap");
+        shm_unlink(SHMFB_NAME);
+        return -1;
+    }
+
+    shmfb = map;
+    frame = 0;
+
+    /* The object may be left from an earlier run,
+     * so readers see no frames until the next one
+     */
+    __atomic_store_n(&shmfb->frame, 0, __ATOMIC_RELEASE);
+    memset(shmfb->slot, 0, sizeof(shmfb->slot));
+
+    shmfb->version = SHMFB_VERSION;
+    shmfb->slots = SHMFB_SLOTS;
+    shmfb->slot_size = sizeof(shmfb_slot_t);
+    shmfb->width_max = SHMFB_WIDTH_MAX;
+    shmfb->height_max = SHMFB_HEIGHT_MAX;
+    shmfb->refresh_rate = VDG_REFRESH_RATE;
+    __atomic_store_n(&shmfb->magic, SHMFB_MAGIC, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+/*------------------------------------------------
+ * shmfb_close()
+ *
+ *  Unmap and unlink the shared memory object.
+ *
+ *  param:  Nothing
+ *  return: Nothing
+ */
+void shmfb_close(void)
+{
+    if ( shmfb == 0 )
+        return;
+
+    munmap(shmfb, sizeof(shmfb_t));
+    shm_unlink(SHMFB_NAME);
+    shmfb = 0;
+}
+
+/*------------------------------------------------
+ * shmfb_publish()
+ *
+ *  Copy a frame into the next slot of the ring and make it
+ *  the last complete frame. Does nothing while the export is closed.
+ *
+ *  param:  XRGB8888 pixels, width and height, VDG mode of PIA and SAM
+ *  return: Nothing
+ */
+void shmfb_publish(const uint32_t *pixels, int width, int height, int pia_video_mode, int sam_video_mode)
+{
+    shmfb_slot_t   *slot;
+    uint32_t        sequence;
+
+    if ( shmfb == 0 || width > SHMFB_WIDTH_MAX || height > SHMFB_HEIGHT_MAX )
+        return;
+
+    frame++;
+    slot = &shmfb->slot[frame % SHMFB_SLOTS];
+
+    /* Odd sequence before the slot changes, and
+     * the next even one after all of it was written
+     */
+    sequence = slot->sequence;
+    __atomic_store_n(&slot->sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    slot->frame = frame;
+    slot->width = width;
+    slot->height = height;
+    slot->stride = width * sizeof(uint32_t);
+    slot->pia_video_mode = pia_video_mode;
+    slot->sam_video_mode = sam_video_mode;
+    memcpy(slot->pixels, pixels, width * height * sizeof(uint32_t));
+
+    __atomic_store_n(&slot->sequence, sequence + 2, __ATOMIC_RELEASE);
+    __atomic_store_n(&shmfb->frame, frame, __ATOMIC_RELEASE);
+}
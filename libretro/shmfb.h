@@ -0,0 +1,76 @@
+/********************************************************************
+ * shmfb.h
+ *
+ *  Header for the shared memory frame export of the libretro core,
+ *  and the layout of the shared memory object for the processes
+ *  that read it.
+ *
+ *  The core publishes each presented frame as XRGB8888 pixels into a
+ *  ring of SHMFB_SLOTS slots in the POSIX shared memory object
+ *  SHMFB_NAME. Frame n is written to slot n % SHMFB_SLOTS, and the
+ *  header 'frame' field is the number of the last complete frame,
+ *  0 before the first one. The core never waits for a reader.
+ *
+ *  A slot's 'sequence' is odd while the core writes the slot.
+ *  A reader loads 'frame' and the slot's 'sequence', reads the slot,
+ *  and loads 'sequence' again. The frame is intact if both sequence
+ *  values are the same even number, otherwise the core wrote the
+ *  slot at the same time and the reader tries the newest frame again.
+ *  Reads of this header's fields must be acquire loads.
+ *
+ *  October 19, 2026
+ *
+ *******************************************************************/
+
+#ifndef __SHMFB_H__
+#define __SHMFB_H__
+
+#include    <stdint.h>
+
+#define     SHMFB_NAME              "/dragon32_fb"
+#define     SHMFB_MAGIC             0x46323344  // "D32F"
+#define     SHMFB_VERSION           1
+
+#define     SHMFB_SLOTS             4
+#define     SHMFB_WIDTH_MAX         256
+#define     SHMFB_HEIGHT_MAX        192
+
+/* One frame of the ring
+ */
+typedef struct
+{
+    uint32_t    sequence;           // Odd while the slot is written
+    uint32_t    frame;              // Frame number
+    uint32_t    width;              // Pixels
+    uint32_t    height;
+    uint32_t    stride;             // Bytes per line
+    uint32_t    pia_video_mode;     // VDG mode bits of PIA1 port B
+    uint32_t    sam_video_mode;     // SAM display mode
+    uint32_t    reserved;
+    uint32_t    pixels[SHMFB_WIDTH_MAX * SHMFB_HEIGHT_MAX];     // XRGB8888
+} shmfb_slot_t;
+
+/* The shared memory object
+ */
+typedef struct
+{
+    uint32_t    magic;
+    uint32_t    version;
+    uint32_t    slots;
+    uint32_t    slot_size;          // Bytes
+    uint32_t    width_max;
+    uint32_t    height_max;
+    uint32_t    refresh_rate;       // Emulated frames per second
+    uint32_t    frame;              // Last complete frame, 0 for none
+    uint32_t    reserved[8];
+    shmfb_slot_t slot[SHMFB_SLOTS];
+} shmfb_t;
+
+/********************************************************************
+ *  Frame export API of the core
+ */
+int  shmfb_open(void);
+void shmfb_close(void);
+void shmfb_publish(const uint32_t *pixels, int width, int height, int pia_video_mode, int sam_video_mode);
+
+#endif  /* __SHMFB_H__ */
@@ -3,6 +3,7 @@
  *
  *  ROM and CAS file loader module.
  *  Activated as an emulator escape.
+ *  ROM and CAS files can be LZ4 compressed, see lz4.h.
  *
  *  May 11, 2021
  *
@@ -20,6 +21,13 @@
 #include    "vdg.h"
 
 #include    "loader.h"
+#include    "lz4.h"
+#include    "profile.h"
+#include    "printer.h"
+
+#if (BENCH_ENABLE==1)
+#include    "bench.h"
+#endif
 
 /* -----------------------------------------
    Module definition
@@ -33,13 +41,19 @@
 #define     SCAN_CODE_ENTR          28
 #define     SCAN_CODE_UP            72
 #define     SCAN_CODE_DOWN          80
+#define     SCAN_CODE_V             47
+#define     SCAN_CODE_B             48
 
 #define     TERMINAL_STATUS_ROW     15
 #define     TERMINAL_LIST_LENGTH    (TERMINAL_STATUS_ROW-1)
 #define     TERMINAL_LINE_LENGTH    31
 
 #define     MSG_EXIT                "PRESS <Q> TO EXIT.              "
+#if (BENCH_ENABLE==1)
+#define     MSG_STATUS              "PRESS: <UP><DN><ENTER><B><V><Q> "
+#else
 #define     MSG_STATUS              "PRESS: <UP> <DOWN> <ENTER> <Q>  "
+#endif
 #define     MSG_SD_ERROR            "SD CARD INITIALIZATION FAILED,  " \
                                     "REPLACE OR INSERT A CARD.       "
 #define     MSG_FAT32_ERROR         "FAT32 INITIALIZATION FAILED,    " \
@@ -49,6 +63,7 @@
 #define     MSG_ROM_READ_DONE       "ROM IMAGE LOAD COMPLETED.       "
 #define     MSG_CAS_READ_ERROR      "CAS FILE READ ERROR.            "
 #define     MSG_CAS_FILE_MOUNTED    "CAS FILE MOUNTED.               "
+#define     MSG_BENCH_RUNNING       "RUNNING BENCHMARK, SEE CONSOLE. "
 
 #define     CODE_BUFFER_SIZE        (16*1024)
 #define     CARTRIDGE_ROM_BASE      0xc000
@@ -70,6 +85,7 @@ typedef enum
    Module function
 ----------------------------------------- */
 static file_type_t file_get_type(char *directory_entry);
+static void        file_close_cas(void);
 
 static void        text_write(int row, int col, char *text);
 static void        text_highlight(int on_off, int row);
@@ -87,6 +103,7 @@ static int      sd_card_initialized = 0;
 static uint8_t  text_screen_save[512];
 static uint8_t  code_buffer[CODE_BUFFER_SIZE];
 static dir_entry_t  mounted_cas_file;
+static dir_entry_t  printer_file;
 
 /*------------------------------------------------
  * loader()
@@ -156,7 +173,7 @@ void loader(void)
 
     /* Initial directory load
      */
-    if ( (list_length = fat32_parse_dir(2, directory_list, FAT32_MAX_DIR_LIST)) == -1 )
+    if ( (list_length = fat32_parse_dir(0, directory_list, FAT32_MAX_DIR_LIST)) == -1 )
     {
         sd_card_initialized = 0;
 
@@ -168,6 +185,18 @@ void loader(void)
         return;
     }
 
+    /* The printer capture file is in the root directory
+     */
+    for ( i = 0; i < list_length; i++ )
+    {
+        if ( !directory_list[i].is_directory &&
+             fat32_name_match(directory_list[i].lfn, PRINTER_FILE_NAME) )
+        {
+            memcpy(&printer_file, &directory_list[i], sizeof(dir_entry_t));
+            break;
+        }
+    }
+
     /* Main loop.
      */
     list_start = 0;
@@ -221,6 +250,46 @@ void loader(void)
                     list_start = list_length - (TERMINAL_LIST_LENGTH + 1);
             }
         }
+#if (BENCH_ENABLE==1)
+        else if ( key_pressed == SCAN_CODE_B &&
+                  !directory_list[(list_start + highlighted_line)].is_directory )
+        {
+            /* Run the storage benchmark on the highlighted file.
+             * The benchmark parses the root directory, so return to it.
+             */
+            text_clear();
+            text_write(0, 0, MSG_BENCH_RUNNING);
+            vdg_render();
+
+            file_close_cas();
+            bench_storage(&directory_list[(list_start + highlighted_line)]);
+
+            text_clear();
+
+            if ( (list_length = fat32_parse_dir(0, directory_list, FAT32_MAX_DIR_LIST)) == -1 )
+            {
+                sd_card_initialized = 0;
+
+                text_write(0, 0, MSG_DIR_READ_ERROR);
+                text_write(TERMINAL_STATUS_ROW, 0, MSG_EXIT);
+
+                util_wait_quit();
+                break;
+            }
+
+            list_start = 0;
+            prev_list_start = 0;
+            highlighted_line = 0;
+            text_dir_output(list_start, list_length, directory_list);
+        }
+        else if ( key_pressed == SCAN_CODE_V )
+        {
+            /* Run the VDG render benchmark, which
+             * restores the loader screen when done
+             */
+            bench_vdg();
+        }
+#endif
         else if ( key_pressed == SCAN_CODE_ENTR )
         {
             text_clear();
@@ -229,7 +298,7 @@ void loader(void)
             {
                 /* Read and display the directory
                  */
-                if ( (list_length = fat32_parse_dir(directory_list[(list_start + highlighted_line)].cluster_chain_head,
+                if ( (list_length = fat32_parse_dir(&directory_list[(list_start + highlighted_line)],
                                                     directory_list, FAT32_MAX_DIR_LIST)) == -1 )
                 {
                     sd_card_initialized = 0;
@@ -253,14 +322,26 @@ void loader(void)
                  */
                 file_type = file_get_type(directory_list[(list_start + highlighted_line)].lfn);
 
+                /* Apply the title's profile before the title's file is opened,
+                 * the file system has one open file
+                 */
+                if ( file_type == FILE_ROM || file_type == FILE_CAS )
+                {
+                    file_close_cas();
+                    profile_select(directory_list, list_length, directory_list[(list_start + highlighted_line)].lfn);
+                }
+
                 if ( file_type == FILE_ROM )
                 {
-                    /* Load ROM image into emulator memory
-                     * and change EXEC default vector to 0xC000
+                    /* Load ROM image into emulator memory, decompressing
+                     * an LZ4 image, and change EXEC default vector to 0xC000
                      */
-                    fat32_fopen(&directory_list[(list_start + highlighted_line)]);
-                    rom_bytes = fat32_fread(code_buffer, CODE_BUFFER_SIZE);
-                    fat32_fclose();
+                    rom_bytes = -1;
+                    if ( lz4_fopen(&directory_list[(list_start + highlighted_line)]) )
+                    {
+                        rom_bytes = lz4_fread(code_buffer, CODE_BUFFER_SIZE);
+                        lz4_fclose();
+                    }
 
                     if ( rom_bytes == -1 )
                     {
@@ -332,6 +413,26 @@ int loader_mount_cas_file(dir_entry_t *cas_file)
     return 0;
 }
 
+/*------------------------------------------------
+ * loader_mount_printer_file()
+ *
+ *  Return the directory entry of the printer capture file,
+ *  found in the root directory when the loader starts.
+ *
+ *  param:  Pointer to directory entry record
+ *  return: 0=no file, 1=ok
+ */
+int loader_mount_printer_file(dir_entry_t *printer_file_entry)
+{
+    if ( printer_file.cluster_chain_head != 0 )
+    {
+        memcpy(printer_file_entry, &printer_file, sizeof(dir_entry_t));
+        return 1;
+    }
+
+    return 0;
+}
+
 /*------------------------------------------------
  * file_get_type()
  *
@@ -355,6 +456,22 @@ static file_type_t file_get_type(char *directory_entry)
     return FILE_OTHER;
 }
 
+/*------------------------------------------------
+ * file_close_cas()
+ *
+ *  Close the mounted CAS file, which the cassette input keeps open
+ *  after the motor turned on. The file system has one open file, so
+ *  this is done before the loader opens any other file. The tape
+ *  starts again from its beginning the next time the motor turns on.
+ *
+ *  param:  Nothing
+ *  return: Nothing
+ */
+static void file_close_cas(void)
+{
+    lz4_fclose();
+}
+
 /*------------------------------------------------
  * text_write()
  *
@@ -0,0 +1,114 @@
+/********************************************************************
+ * log.c
+ *
+ *  Binary log module.
+ *
+ *  With LOG_BINARY=1 messages queued by the LOGn() macros are sent to
+ *  the serial console by log_drain() without waiting on the UART.
+ *  Text is reconstructed on the host by tools/logdump.c.
+ *  With LOG_BINARY=0 the module only holds the format table used by
+ *  the printf() form of LOGn().
+ *
+ *  October 19, 2026
+ *
+ *******************************************************************/
+
+#include    <stdint.h>
+
+#include    "rpi.h"
+#include    "log.h"
+
+/* -----------------------------------------
+   Local definitions
+----------------------------------------- */
+
+/* -----------------------------------------
+   Module static functions
+----------------------------------------- */
+
+/* -----------------------------------------
+   Module globals
+----------------------------------------- */
+#if (LOG_BINARY==1)
+
+uint32_t        log_buffer[LOG_WORDS];
+uint32_t        log_head = 0;           // Next word to write
+uint32_t        log_tail = 0;           // Next word to send
+uint32_t        log_dropped = 0;        // Messages lost to a full buffer
+
+static int      log_offset = 0;         // Bytes of the tail word already sent
+
+#else
+
+const char     *log_format[LOG_MESSAGES] = {
+#define     LOG_MESSAGE(id, format)     format,
+#include    "logmsg.h"
+#undef      LOG_MESSAGE
+};
+
+#endif
+
+/*------------------------------------------------
+ * log_drain()
+ *
+ *  Send queued log messages to the serial console for as long
+ *  as the UART accepts bytes without waiting.
+ *  A count of dropped messages is queued as a message of its own.
+ *
+ *  param:  Nothing
+ *  return: Nothing
+ */
+void log_drain(void)
+{
+#if (LOG_BINARY==1)
+    uint32_t    word;
+    uint8_t     bytes[4];
+    int         sent;
+
+    if ( log_dropped && (log_head - log_tail) <= (uint32_t)(LOG_WORDS - 2) )
+    {
+        word = log_dropped;
+        log_dropped = 0;
+        LOG1(LOG_DROPPED, word);
+    }
+
+    while ( log_tail != log_head )
+    {
+        word = log_buffer[log_tail & LOG_MASK];
+        bytes[0] = word;
+        bytes[1] = word >> 8;
+        bytes[2] = word >> 16;
+        bytes[3] = word >> 24;
+
+        sent = rpi_uart_write(&bytes[log_offset], 4 - log_offset);
+        log_offset += sent;
+
+        if ( log_offset < 4 )
+            break;
+
+        log_offset = 0;
+        log_tail++;
+    }
+#endif
+}
+
+/*------------------------------------------------
+ * log_flush()
+ *
+ *  Send all queued log messages, waiting for the UART.
+ *  Called before the emulator halts so that the last
+ *  messages are not lost.
+ *
+ *  param:  Nothing
+ *  return: Nothing
+ */
+void log_flush(void)
+{
+#if (LOG_BINARY==1)
+    do
+    {
+        log_drain();
+    }
+    while ( log_tail != log_head || log_dropped );
+#endif
+}
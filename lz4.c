@@ -0,0 +1,367 @@
+/********************************************************************
+ * lz4.c
+ *
+ *  LZ4 compressed image reader.
+ *
+ *  A layer over the one open file of the SD card file system that
+ *  reads ROM and CAS images stored as LZ4 frames. lz4_fopen() checks
+ *  for the frame magic number, and lz4_fread() then reads one compressed
+ *  block at a time with a multi-sector fat32_fread(), decodes it to the
+ *  block buffer, and copies decoded bytes to the caller as they are
+ *  read. A file without the magic number is read as it is.
+ *
+ *  Only frames with independent blocks of up to 64K bytes and no
+ *  dictionary are accepted, so a block is decoded without the data of
+ *  the blocks before it. Block and content checksums are skipped,
+ *  not verified.
+ *
+ *  October 19, 2026
+ *
+ *******************************************************************/
+
+#include    <stdint.h>
+#include    <string.h>
+
+#include    "sdfat32.h"
+#include    "lz4.h"
+
+/* -----------------------------------------
+   Local definitions
+----------------------------------------- */
+#define     LZ4_FLG_VERSION_MASK    0xc0        // Frame descriptor FLG byte
+#define     LZ4_FLG_VERSION         0x40
+#define     LZ4_FLG_BLOCK_INDEP     0x20
+#define     LZ4_FLG_BLOCK_CHECKSUM  0x10
+#define     LZ4_FLG_CONTENT_SIZE    0x08
+#define     LZ4_FLG_DICT_ID         0x01
+
+#define     LZ4_BD_BLOCK_MAX_MASK   0x70        // Frame descriptor BD byte
+#define     LZ4_BD_BLOCK_64K        0x40
+
+#define     LZ4_BLOCK_UNCOMPRESSED  0x80000000  // Block size flag
+#define     LZ4_MIN_MATCH           4
+
+/* -----------------------------------------
+   Module static functions
+----------------------------------------- */
+static int  lz4_next_block(void);
+static int  lz4_decode_block(const uint8_t *in, int in_length, uint8_t *out, int out_max);
+static int  lz4_read_le32(uint32_t *value);
+
+/* -----------------------------------------
+   Module globals
+----------------------------------------- */
+static int      compressed = 0;                 // The open file is an LZ4 frame
+static int      frame_end = 0;                  // The frame's end mark was read
+static int      block_checksum = 0;             // Blocks are followed by a checksum
+
+static int      out_length = 0;                 // Decoded bytes in 'block_out'
+static int      out_position = 0;               // Next decoded byte to read
+
+static uint8_t  block_in[LZ4_BLOCK_MAX];
+static uint8_t  block_out[LZ4_BLOCK_MAX];
+
+/*------------------------------------------------
+ * lz4_fopen()
+ *
+ *  Open a file for reading with fat32_fopen(), and read its
+ *  LZ4 frame header if it has one. Like fat32_fopen(), opening
+ *  a file while a file is open fails, and the open file keeps
+ *  its read position.
+ *
+ *  param:  Pointer to the file's directory entry
+ *  return: 1=file open, 0=error or an LZ4 frame that is not supported
+ */
+int lz4_fopen(dir_entry_t *directory_entry)
+{
+    uint32_t    magic;
+    uint8_t     descriptor[2];
+    uint8_t     skip[9];                        // Content size and header checksum
+
+    if ( !fat32_fopen(directory_entry) )
+        return 0;
+
+    compressed = 0;
+    frame_end = 0;
+    out_length = 0;
+    out_position = 0;
+
+    if ( !lz4_read_le32(&magic) || magic != LZ4_MAGIC )
+    {
+        fat32_fseek(0);
+        return 1;
+    }
+
+    if ( fat32_fread(descriptor, 2) != 2 ||
+         (descriptor[0] & LZ4_FLG_VERSION_MASK) != LZ4_FLG_VERSION ||
+         (descriptor[0] & LZ4_FLG_BLOCK_INDEP) == 0 ||
+         (descriptor[0] & LZ4_FLG_DICT_ID) ||
+         (descriptor[1] & LZ4_BD_BLOCK_MAX_MASK) > LZ4_BD_BLOCK_64K )
+    {
+        fat32_fclose();
+        return 0;
+    }
+
+    block_checksum = (descriptor[0] & LZ4_FLG_BLOCK_CHECKSUM);
+
+    /* Skip the content size and the header checksum
+     */
+    if ( fat32_fread(skip, (descriptor[0] & LZ4_FLG_CONTENT_SIZE) ? 9 : 1) <= 0 )
+    {
+        fat32_fclose();
+        return 0;
+    }
+
+    compressed = 1;
+
+    return 1;
+}
+
+/*------------------------------------------------
+ * lz4_fclose()
+ *
+ *  Close the file opened with lz4_fopen().
+ *
+ *  param:  Nothing
+ *  return: Nothing
+ */
+void lz4_fclose(void)
+{
+    compressed = 0;
+    out_length = 0;
+    out_position = 0;
+
+    fat32_fclose();
+}
+
+/*------------------------------------------------
+ * lz4_fread()
+ *
+ *  Read decoded bytes of the open file, or the file's bytes
+ *  if it is not an LZ4 frame. Blocks are decoded as the read
+ *  position reaches them.
+ *
+ *  param:  Buffer and its length
+ *  return: Bytes read, 0 at end of file, -1 on a read or decode error
+ */
+int lz4_fread(uint8_t *buffer, int buffer_length)
+{
+    int     byte_count;
+    int     count;
+
+    if ( !compressed )
+        return fat32_fread(buffer, buffer_length);
+
+    byte_count = 0;
+
+    while ( byte_count < buffer_length )
+    {
+        if ( out_position == out_length )
+        {
+            if ( frame_end )
+                break;
+
+            if ( !lz4_next_block() )
+                return -1;
+
+            continue;
+        }
+
+        count = out_length - out_position;
+        if ( count > (buffer_length - byte_count) )
+            count = buffer_length - byte_count;
+
+        memcpy(&buffer[byte_count], &block_out[out_position], count);
+        out_position += count;
+        byte_count += count;
+    }
+
+    return byte_count;
+}
+
+/*------------------------------------------------
+ * lz4_is_compressed()
+ *
+ *  Check if the open file is an LZ4 frame.
+ *
+ *  param:  Nothing
+ *  return: 1- LZ4 frame, 0- read as it is
+ */
+int lz4_is_compressed(void)
+{
+    return compressed;
+}
+
+/*------------------------------------------------
+ * lz4_next_block()
+ *
+ *  Read the next block of the frame into the block buffer,
+ *  and decode it if it is compressed.
+ *  The end mark of the frame ends the file.
+ *
+ *  param:  Nothing
+ *  return: 1=ok, 0=read error or bad block
+ */
+static int lz4_next_block(void)
+{
+    uint32_t    block_size;
+    uint32_t    checksum;
+    int         length;
+
+    out_length = 0;
+    out_position = 0;
+
+    if ( !lz4_read_le32(&block_size) )
+        return 0;
+
+    if ( block_size == 0 )
+    {
+        frame_end = 1;
+        return 1;
+    }
+
+    length = (int)(block_size & ~LZ4_BLOCK_UNCOMPRESSED);
+    if ( length > LZ4_BLOCK_MAX )
+        return 0;
+
+    if ( block_size & LZ4_BLOCK_UNCOMPRESSED )
+    {
+        if ( fat32_fread(block_out, length) != length )
+            return 0;
+
+        out_length = length;
+    }
+    else
+    {
+        if ( fat32_fread(block_in, length) != length )
+            return 0;
+
+        if ( (out_length = lz4_decode_block(block_in, length, block_out, LZ4_BLOCK_MAX)) < 0 )
+        {
+            out_length = 0;
+            return 0;
+        }
+    }
+
+    if ( block_checksum && !lz4_read_le32(&checksum) )
+        return 0;
+
+    return 1;
+}
+
+/*------------------------------------------------
+ * lz4_decode_block()
+ *
+ *  Decode an LZ4 block. A block is a list of sequences, each with
+ *  a token of literal and match lengths, the literals, and a match
+ *  offset back into the decoded bytes. The last sequence has only
+ *  literals. Lengths of 15 continue in bytes that are added up
+ *  until one is less than 255.
+ *
+ *  param:  Compressed block and its length, output buffer and its length
+ *  return: Decoded length, -1 on a bad block
+ */
+static int lz4_decode_block(const uint8_t *in, int in_length, uint8_t *out, int out_max)
+{
+    const uint8_t  *in_end;
+    const uint8_t  *match;
+    uint8_t        *op;
+    uint8_t        *out_end;
+    int             token, length, offset, b;
+
+    in_end = in + in_length;
+    op = out;
+    out_end = out + out_max;
+
+    while ( in < in_end )
+    {
+        token = *in++;
+
+        /* Literals
+         */
+        length = token >> 4;
+        if ( length == 15 )
+        {
+            do
+            {
+                if ( in >= in_end )
+                    return -1;
+                b = *in++;
+                length += b;
+            } while ( b == 255 );
+        }
+
+        if ( length > (in_end - in) || length > (out_end - op) )
+            return -1;
+
+        memcpy(op, in, length);
+        op += length;
+        in += length;
+
+        if ( in == in_end )
+            break;
+
+        /* Match
+         */
+        if ( (in_end - in) < 2 )
+            return -1;
+
+        offset = in[0] | (in[1] << 8);
+        in += 2;
+
+        if ( offset == 0 || offset > (op - out) )
+            return -1;
+
+        length = (token & 0x0f) + LZ4_MIN_MATCH;
+        if ( (token & 0x0f) == 15 )
+        {
+            do
+            {
+                if ( in >= in_end )
+                    return -1;
+                b = *in++;
+                length += b;
+            } while ( b == 255 );
+        }
+
+        if ( length > (out_end - op) )
+            return -1;
+
+        /* A match closer than its length repeats
+         * the bytes it copies, so copy it a byte at a time
+         */
+        match = op - offset;
+        if ( offset >= length )
+        {
+            memcpy(op, match, length);
+            op += length;
+        }
+        else
+        {
+            while ( length-- )
+                *op++ = *match++;
+        }
+    }
+
+    return (int)(op - out);
+}
+
+/*------------------------------------------------
+ * lz4_read_le32()
+ *
+ *  Read a little endian 32-bit value from the file.
+ *
+ *  param:  Pointer to value
+ *  return: 1=ok, 0=end of file or read error
+ */
+static int lz4_read_le32(uint32_t *value)
+{
+    uint8_t     bytes[4];
+
+    if ( fat32_fread(bytes, 4) != 4 )
+        return 0;
+
+    *value = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((uint32_t) bytes[3] << 24);
+
+    return 1;
+}
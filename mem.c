@@ -8,6 +8,7 @@
  *******************************************************************/
 
 #include    "mem.h"
+#include    "pmu.h"
 
 /* -----------------------------------------
    Local definitions
@@ -20,22 +21,28 @@ typedef enum
     MEM_TYPE_IO,
 } memory_flag_t;
 
-typedef struct
-{
-    uint8_t data_byte;
-    memory_flag_t memory_type;
-    io_handler_callback io_handler;
-} memory_t;
-
 /* -----------------------------------------
    Module static functions
 ----------------------------------------- */
-static uint8_t do_nothing_io_handler(uint16_t address, uint8_t data, mem_operation_t op);
+static uint8_t do_nothing_io_handler(uint16_t address, uint8_t data, mem_operation_t op) SECTION_HOT;
+static void    update_page_flags(int addr_start, int addr_end) SECTION_COLD;
 
 /* -----------------------------------------
    Module globals
 ----------------------------------------- */
-static memory_t memory[MEMORY];
+
+/* The memory data bytes are kept in one flat image followed by
+ * the page attribute bytes, so that a CPU core can access RAM directly
+ * and only call mem_read()/mem_write() for pages holding ROM or IO.
+ */
+static struct
+{
+    uint8_t data[MEMORY];
+    uint8_t page_flags[MEM_PAGES];
+} memory CACHE_ALIGNED;
+
+static uint8_t              memory_type[MEMORY] CACHE_ALIGNED;
+static io_handler_callback  io_handler[MEMORY] CACHE_ALIGNED;
 
 /*------------------------------------------------
  * mem_init()
@@ -51,9 +58,14 @@ void mem_init(void)
 
     for ( i = 0; i < MEMORY; i++ )
     {
-        memory[i].data_byte = 0;
-        memory[i].memory_type = MEM_TYPE_RAM;
-        memory[i].io_handler = do_nothing_io_handler;
+        memory.data[i] = 0;
+        memory_type[i] = MEM_TYPE_RAM;
+        io_handler[i] = do_nothing_io_handler;
+    }
+
+    for ( i = 0; i < MEM_PAGES; i++ )
+    {
+        memory.page_flags[i] = 0;
     }
 }
 
@@ -71,16 +83,18 @@ int mem_read(int address)
     if ( address < 0 || address > (MEMORY-1) )
         return MEM_ADD_RANGE;
 
-    if ( memory[address].memory_type == MEM_TYPE_IO &&
-         memory[address].io_handler != do_nothing_io_handler )
+    if ( memory_type[address] == MEM_TYPE_IO &&
+         io_handler[address] != do_nothing_io_handler )
     {
         /* An attempt to read an IO address will trigger
          * the callback that may return an alternative value.
          */
-        memory[address].data_byte = memory[address].io_handler((uint16_t) address, memory[address].data_byte, MEM_READ);
+        PMU_ENTER(PMU_IO);
+        memory.data[address] = io_handler[address]((uint16_t) address, memory.data[address], MEM_READ);
+        PMU_LEAVE();
     }
 
-    return (int)(memory[address].data_byte);
+    return (int)(memory.data[address]);
 }
 
 /*------------------------------------------------
@@ -98,15 +112,17 @@ int mem_write(int address, int data)
     if ( address < 0 || address > (MEMORY-1) )
         return MEM_ADD_RANGE;
 
-    if ( memory[address].memory_type == MEM_TYPE_ROM )
+    if ( memory_type[address] == MEM_TYPE_ROM )
         return MEM_ROM;
 
-    memory[address].data_byte = (uint8_t) data;
+    memory.data[address] = (uint8_t) data;
 
-    if ( memory[address].memory_type == MEM_TYPE_IO &&
-         memory[address].io_handler != do_nothing_io_handler )
+    if ( memory_type[address] == MEM_TYPE_IO &&
+         io_handler[address] != do_nothing_io_handler )
     {
-        memory[address].io_handler((uint16_t) address, (uint8_t)data, MEM_WRITE);
+        PMU_ENTER(PMU_IO);
+        io_handler[address]((uint16_t) address, (uint8_t)data, MEM_WRITE);
+        PMU_LEAVE();
     }
 
     return MEM_OK;
@@ -133,9 +149,11 @@ int  mem_define_rom(int addr_start, int addr_end)
 
     for (i = addr_start; i <= addr_end; i++)
     {
-        memory[i].memory_type = MEM_TYPE_ROM;
+        memory_type[i] = MEM_TYPE_ROM;
     }
 
+    update_page_flags(addr_start, addr_end);
+
     return MEM_OK;
 }
 
@@ -151,7 +169,7 @@ int  mem_define_rom(int addr_start, int addr_end)
  *          '-1' - memory location is out of range
  *          '-3' - Cannot hook IO handler
  */
-int  mem_define_io(int addr_start, int addr_end, io_handler_callback io_handler)
+int  mem_define_io(int addr_start, int addr_end, io_handler_callback io_handler_func)
 {
     int i;
 
@@ -162,11 +180,13 @@ int  mem_define_io(int addr_start, int addr_end, io_handler_callback io_handler)
 
     for (i = addr_start; i <= addr_end; i++)
     {
-        memory[i].memory_type = MEM_TYPE_IO;
-        if ( io_handler != 0L )
-            memory[i].io_handler = io_handler;
+        memory_type[i] = MEM_TYPE_IO;
+        if ( io_handler_func != 0L )
+            io_handler[i] = io_handler_func;
     }
 
+    update_page_flags(addr_start, addr_end);
+
     return MEM_OK;
 }
 
@@ -191,12 +211,59 @@ int mem_load(int addr_start, uint8_t *buffer, int length)
 
     for (i = 0; i < length; i++)
     {
-        memory[(i+addr_start)].data_byte = buffer[i];
+        memory.data[(i+addr_start)] = buffer[i];
     }
 
     return MEM_OK;
 }
 
+/*------------------------------------------------
+ * mem_get_map()
+ *
+ *  Return a pointer to the flat memory image.
+ *  The image is MEMORY bytes long and is directly followed by
+ *  MEM_PAGES page attribute bytes (MEM_PAGE_ROM, MEM_PAGE_IO).
+ *  A CPU core may read and write RAM through this pointer, but must
+ *  use mem_read() and mem_write() for any page with a non-zero attribute.
+ *
+ *  param:  Nothing
+ *  return: Pointer to memory image
+ */
+uint8_t *mem_get_map(void)
+{
+    return memory.data;
+}
+
+/*------------------------------------------------
+ * update_page_flags()
+ *
+ *  Recalculate the page attributes of all pages
+ *  overlapping an address range.
+ *
+ *  param:  Memory address range start and end, inclusive
+ *  return: Nothing
+ */
+static void update_page_flags(int addr_start, int addr_end)
+{
+    int     page, i;
+    uint8_t flags;
+
+    for ( page = (addr_start / MEM_PAGE_SIZE); page <= (addr_end / MEM_PAGE_SIZE); page++ )
+    {
+        flags = 0;
+
+        for ( i = (page * MEM_PAGE_SIZE); i < ((page + 1) * MEM_PAGE_SIZE); i++ )
+        {
+            if ( memory_type[i] == MEM_TYPE_ROM )
+                flags |= MEM_PAGE_ROM;
+            else if ( memory_type[i] == MEM_TYPE_IO )
+                flags |= MEM_PAGE_IO;
+        }
+
+        memory.page_flags[page] = flags;
+    }
+}
+
 /*------------------------------------------------
  * do_nothing_io_handler()
  *
@@ -211,4 +278,3 @@ static uint8_t do_nothing_io_handler(uint16_t address, uint8_t data, mem_operati
     /* TODO generate an exception? */
     return 0;
 }
-
@@ -17,7 +17,10 @@
 #include    "pia.h"
 #include    "sdfat32.h"
 #include    "loader.h"
-#include    "printf.h"
+#include    "lz4.h"
+#include    "log.h"
+#include    "audio.h"
+#include    "printer.h"
 
 /* -----------------------------------------
    Local definitions
@@ -36,7 +39,7 @@
 #define     PIACR_CAB2_SET      0x38
 #define     PIACR_CABS_CLR      0x30
 
-#define     KBD_ROWS            7
+#define     KBD_ROWS            PIA_KBD_ROWS
 
 #define     PIA_VSYNC_INTERVAL  ((uint32_t)(1000000/50))
 
@@ -49,24 +52,31 @@
 #define     AUDIO_MUX_OTHER     3       // Off
 
 #define     MOTOR_ON            0b00001000
-#define     BIT_THRESHOLD_HI    4
-#define     BIT_THRESHOLD_LO    20
+
+#define     TAPE_BIT1_CYCLES    (CPU_CLOCK_HZ / 2400)       // A '1' bit is one 2400Hz cycle
+#define     TAPE_BIT0_CYCLES    (CPU_CLOCK_HZ / 1200)       // A '0' bit is one 1200Hz cycle
 
 #define     SCAN_CODE_F1        58
 
+#define     PRINTER_STROBE      0b00000010  // PIA1 PA1
+#define     PRINTER_BUSY        0b00000001  // PIA1 PB0
+
 /* -----------------------------------------
    Module static functions
 ----------------------------------------- */
-static uint8_t io_handler_pia0_pa(uint16_t address, uint8_t data, mem_operation_t op);
-static uint8_t io_handler_pia0_pb(uint16_t address, uint8_t data, mem_operation_t op);
-static uint8_t io_handler_pia0_cra(uint16_t address, uint8_t data, mem_operation_t op);
-static uint8_t io_handler_pia0_crb(uint16_t address, uint8_t data, mem_operation_t op);
-static uint8_t io_handler_pia1_pa(uint16_t address, uint8_t data, mem_operation_t op);
-static uint8_t io_handler_pia1_pb(uint16_t address, uint8_t data, mem_operation_t op);
-static uint8_t io_handler_pia1_cra(uint16_t address, uint8_t data, mem_operation_t op);
-static uint8_t io_handler_pia1_crb(uint16_t address, uint8_t data, mem_operation_t op);
-
-static uint8_t get_keyboard_row_scan(uint8_t data);
+static uint8_t io_handler_pia0_pa(uint16_t address, uint8_t data, mem_operation_t op) SECTION_HOT;
+static uint8_t io_handler_pia0_pb(uint16_t address, uint8_t data, mem_operation_t op) SECTION_HOT;
+static uint8_t io_handler_pia0_cra(uint16_t address, uint8_t data, mem_operation_t op) SECTION_HOT;
+static uint8_t io_handler_pia0_crb(uint16_t address, uint8_t data, mem_operation_t op) SECTION_HOT;
+static uint8_t io_handler_pia1_pa(uint16_t address, uint8_t data, mem_operation_t op) SECTION_HOT;
+static uint8_t io_handler_pia1_pb(uint16_t address, uint8_t data, mem_operation_t op) SECTION_HOT;
+static uint8_t io_handler_pia1_cra(uint16_t address, uint8_t data, mem_operation_t op) SECTION_HOT;
+static uint8_t io_handler_pia1_crb(uint16_t address, uint8_t data, mem_operation_t op) SECTION_HOT;
+
+static uint8_t get_keyboard_row_scan(uint8_t data) SECTION_HOT;
+static int     tape_input(void) SECTION_HOT;
+static void    tape_next_bit(void) SECTION_HOT;
+static void    tape_motor(int motor_on);
 
 /* -----------------------------------------
    Module globals
@@ -81,8 +91,18 @@ static uint8_t audio_mux_select = AUDIO_MUX_OTHER;
 
 static dir_entry_t  cas_file;
 
+static uint8_t  cas_byte = 0;           // Cassette byte being read and its bits left
+static int      cas_bit_index = 0;
+
+static int      tape_running = 0;       // Motor on and the tape input was read
+static uint32_t tape_bit_start = 0;     // CPU cycle clock at the start of the current bit
+static int      tape_bit_cycles = 0;    // CPU cycles of the current bit
+
 static int     function_key = 0;
 
+static uint8_t printer_data = 0;        // Last PIA0 PB output, the printer data lines
+static uint8_t printer_strobe = 0;      // Last PIA1 PA1 output
+
 /*
     Dragon keyboard map
 
@@ -261,6 +281,77 @@ int pia_function_key(void)
     return key_code;
 }
 
+/*------------------------------------------------
+ * pia_tape_motor()
+ *
+ *  Get the cassette motor state, CA2 of PIA1.
+ *
+ *  param:  Nothing
+ *  return: 1- motor on, 0- motor off
+ */
+int pia_tape_motor(void)
+{
+    return ((pia1_cra & 0b00110000) && (pia1_cra & MOTOR_ON));
+}
+
+/*------------------------------------------------
+ * pia_get_state()
+ *
+ *  Get the state of the PIA devices for a machine snapshot.
+ *  The cassette signal timing is included, the cassette file
+ *  read position is not.
+ *
+ *  param:  Pointer to PIA state data structure
+ *  return: Nothing
+ */
+void pia_get_state(pia_state_t *pia_state)
+{
+    pia_state->pia0_cb1_int_enabled = pia0_cb1_int_enabled;
+    pia_state->pia0_cra = pia0_cra;
+    pia_state->pia0_crb = pia0_crb;
+    pia_state->pia1_cra = pia1_cra;
+    pia_state->pia1_crb = pia1_crb;
+    pia_state->audio_mux_select = audio_mux_select;
+    memcpy(pia_state->keyboard_rows, keyboard_rows, sizeof(keyboard_rows));
+
+    pia_state->cas_byte = cas_byte;
+    pia_state->cas_bit_index = cas_bit_index;
+    pia_state->tape_running = tape_running;
+    pia_state->tape_bit_start = tape_bit_start;
+    pia_state->tape_bit_cycles = tape_bit_cycles;
+}
+
+/*------------------------------------------------
+ * pia_set_state()
+ *
+ *  Set the state of the PIA devices from a state saved
+ *  by pia_get_state(), and select the saved audio multiplexer input.
+ *
+ *  param:  Pointer to PIA state data structure
+ *  return: Nothing
+ */
+void pia_set_state(pia_state_t *pia_state)
+{
+    pia0_cb1_int_enabled = pia_state->pia0_cb1_int_enabled;
+    pia0_cra = pia_state->pia0_cra;
+    pia0_crb = pia_state->pia0_crb;
+    pia1_cra = pia_state->pia1_cra;
+    pia1_crb = pia_state->pia1_crb;
+    audio_mux_select = pia_state->audio_mux_select;
+    memcpy(keyboard_rows, pia_state->keyboard_rows, sizeof(keyboard_rows));
+
+    cas_byte = pia_state->cas_byte;
+    cas_bit_index = pia_state->cas_bit_index;
+    tape_running = pia_state->tape_running;
+    tape_bit_start = pia_state->tape_bit_start;
+    tape_bit_cycles = pia_state->tape_bit_cycles;
+
+    rpi_audio_mux_set((int) audio_mux_select);
+#if (AUDIO_BLEP==1)
+    audio_enable(audio_mux_select == AUDIO_MUX_DAC);
+#endif
+}
+
 /*------------------------------------------------
  * io_handler_pia0_pa()
  *
@@ -281,7 +372,8 @@ static uint8_t io_handler_pia0_pa(uint16_t address, uint8_t data, mem_operation_
 {
     if ( op == MEM_READ )
     {
-        /* Check joystick comparator and button GPIO and set bits
+        /* Check joystick comparator GPIO and the button level
+         * of the last button scan, and set bits
          */
         if ( rpi_joystk_comp() )
             data |= 0x80;
@@ -322,6 +414,10 @@ static uint8_t io_handler_pia0_pb(uint16_t address, uint8_t data, mem_operation_
      */
     if ( op == MEM_WRITE )
     {
+        /* The port is also the printer data latch
+         */
+        printer_data = data;
+
         /* When writing to the port, the ROM code is checking if any
          * key is pressed. So a good opportunity
          * to read the keyboard scan code.
@@ -343,7 +439,7 @@ static uint8_t io_handler_pia0_pb(uint16_t address, uint8_t data, mem_operation_
              */
             if ( (row_index = scan_code_table[(scan_code & 0x7f)][1]) == 255 )
             {
-                printf("io_handler_pia0_pb(): Illegal scan code.\n");
+                LOG1(LOG_PIA_SCAN_CODE, scan_code);
                 rpi_halt();
             }
 
@@ -407,6 +503,9 @@ static uint8_t io_handler_pia0_cra(uint16_t address, uint8_t data, mem_operation
             audio_mux_select &= 0xfe;
 
         rpi_audio_mux_set((int) audio_mux_select);
+#if (AUDIO_BLEP==1)
+        audio_enable(audio_mux_select == AUDIO_MUX_DAC);
+#endif
     }
 
     return pia0_cra;
@@ -440,87 +539,42 @@ static uint8_t io_handler_pia0_crb(uint16_t address, uint8_t data, mem_operation
  * io_handler_pia1_pa()
  *
  *  IO call-back handler 0xFF20 Dir PIA1-A output to 6-bit DAC
- *  Traps and handles writes to PA bit.2 to bit.7
+ *  Traps and handles writes to PA bit.2 to bit.7,
+ *  and the printer strobe on PA bit.1
  *
  *  param:  Call address, data byte for write operation, and operation type
  *  return: Status or data byte
  */
 static uint8_t io_handler_pia1_pa(uint16_t address, uint8_t data, mem_operation_t op)
 {
-    static  uint8_t byte = 0;
-    static  int     bit_index = 0;
-    static  int     bit_timing_threshold = 0;
-    static  int     bit_timing_count = 0;
-
-    int     cas_eof;
     int     dac_output;
 
     if ( op == MEM_WRITE )
     {
         dac_output = (data >> 2) & 0x3f;
+#if (AUDIO_BLEP==1)
+        /* The joystick comparator needs the DAC level right away
+         */
+        if ( audio_mux_select == AUDIO_MUX_DAC )
+            audio_dac_write(dac_output);
+        else
+            rpi_write_dac(dac_output);
+#else
         rpi_write_dac(dac_output);
+#endif
+
+        /* Printer strobe on PA1, one byte on each rising edge
+         */
+        if ( (data & PRINTER_STROBE) && !printer_strobe )
+            printer_write(printer_data);
+        printer_strobe = data & PRINTER_STROBE;
     }
     else
     {
-        /* Reading the cassette tape input bit PIA1-PA0:
-         * 1) Bits are fed into PA0 with LSB first
-         * 2) a '1' bit toggles PA0 to '0' then '1' for BIT_THRESHOLD_HI/2 reads of PA0
-         * 3) a '0' bit toggles PA0 to '0' then '1' for BIT_THRESHOLD_LO/2 reads of PA0
-         * 4) The read count threshold of PA0 that determines the bit state is 18
-         *    according to the Dragon ROM listing
-         * 5) The normal PA0 state is '0'
-         *
-         * This process fakes the bit stream coming from the cassette tape interface
-         * with the advantage that it can synchronize on the bit reads. The interface
-         * can be hacked to speed up the load time by changing the threshold of 18
-         * in Dragon RAM location 0x0092 to a lower number.
-         *
-         */
-        if ( bit_index == 0 )
-        {
-            cas_eof = !fat32_fread(&byte, 1);
-
-            bit_index = 9;
-            bit_timing_threshold = 0;
-            bit_timing_count = 0;
-
-            /* TODO Will we see an EOF because EOF-CAS-block would be read first?
-             *      Not sure how we handle and EOF.
-             *      There is also no need to fat32_fclose() the file.
-             */
-            if ( cas_eof )
-            {
-                byte = 0x55;
-            }
-        }
-
-        if ( bit_timing_count == bit_timing_threshold )
-        {
-            if ( byte & 0b00000001 )
-            {
-                bit_timing_threshold = BIT_THRESHOLD_HI;
-            }
-            else
-            {
-                bit_timing_threshold = BIT_THRESHOLD_LO;
-            }
-
-            bit_timing_count = 0;
-
-            byte = byte >> 1;
-            bit_index--;
-        }
-
-        if ( bit_timing_count < (bit_timing_threshold / 2) )
-        {
-            data &= 0b11111110;
-        }
-        else
-        {
+        if ( tape_input() )
             data |= 0b00000001;
-        }
-
-        bit_timing_count++;
+        else
+            data &= 0b11111110;
     }
 
     return data;
@@ -537,7 +591,7 @@ static uint8_t io_handler_pia1_pa(uint16_t address, uint8_t data, mem_operation_
  *  Bit 3   O   Screen Mode CSS
  *  Bit 2   I   Ram Size (1=16k 0=32/64k), not implemented
  *  Bit 1   I   TODO Single bit sound
- *  Bit 0   I   Rs232 In / Printer Busy, not implemented
+ *  Bit 0   I   Rs232 In / Printer Busy, always ready
  *
  *  param:  Call address, data byte for write operation, and operation type
  *  return: Status or data byte
@@ -546,6 +600,9 @@ static uint8_t io_handler_pia1_pb(uint16_t address, uint8_t data, mem_operation_
 {
     vdg_set_mode_pia(((data >> 3) & 0x1f));
 
+    if ( op == MEM_READ )
+        data &= ~PRINTER_BUSY;
+
     return data;
 }
 
@@ -560,30 +617,15 @@ static uint8_t io_handler_pia1_pb(uint16_t address, uint8_t data, mem_operation_
  */
 static uint8_t io_handler_pia1_cra(uint16_t address, uint8_t data, mem_operation_t op)
 {
+    int     motor_on;
+
     if ( op == MEM_WRITE )
     {
+        motor_on = pia_tape_motor();
         pia1_cra = data;
 
-        if ( data & 0b00110000 )
-        {
-            if ( data & MOTOR_ON )
-            {
-                /* If the motor is turned on then get the mounted
-                 * CAS file and open it. Not checking errors, if the file
-                 * is open then ok as it will never be a directory either.
-                 * Reopening a file does not reset the read pointer so no harm there either.
-                 */
-                if ( loader_mount_cas_file(&cas_file) )
-                {
-                    fat32_fopen(&cas_file);
-                }
-            }
-            else
-            {
-                /* Do nothing with motor-off, not even fat32_fclose()
-                 */
-            }
-        }
+        if ( pia_tape_motor() != motor_on )
+            tape_motor(!motor_on);
     }
 
     return pia1_cra;
@@ -610,6 +652,9 @@ static uint8_t io_handler_pia1_crb(uint16_t address, uint8_t data, mem_operation
             audio_mux_select &= 0xfd;
 
         rpi_audio_mux_set((int) audio_mux_select);
+#if (AUDIO_BLEP==1)
+        audio_enable(audio_mux_select == AUDIO_MUX_DAC);
+#endif
     }
 
     return pia1_crb;
@@ -645,3 +690,97 @@ static uint8_t get_keyboard_row_scan(uint8_t row_scan)
 
     return result;
 }
+
+/*------------------------------------------------
+ * tape_input()
+ *
+ *  Cassette tape input bit PIA1-PA0, generated from the CPU cycle clock.
+ *  Bits are sent LSB first, a '1' bit as one 2400Hz cycle and a '0' bit as
+ *  one 1200Hz cycle. Each cycle is low for its first half and high for
+ *  its second half, and the input is low while the motor is off.
+ *  Loaders that time the signal with their own loops see the timing
+ *  of a real tape, and a faster load needs a faster CPU clock.
+ *  The tape starts moving at the first read after the motor is turned on,
+ *  which stands in for the blank tape before the leader that CAS files
+ *  leave out, and then moves with emulated time whether it is read or not.
+ *
+ *  param:  Nothing
+ *  return: Input level 0 or 1
+ */
+static int tape_input(void)
+{
+    uint32_t    now;
+
+    if ( !pia_tape_motor() )
+        return 0;
+
+    now = cpu_get_cycles();
+
+    if ( !tape_running )
+    {
+        tape_running = 1;
+        tape_bit_start = now;
+        tape_next_bit();
+    }
+
+    while ( (now - tape_bit_start) >= (uint32_t) tape_bit_cycles )
+    {
+        tape_bit_start += tape_bit_cycles;
+        tape_next_bit();
+    }
+
+    return ((now - tape_bit_start) >= (uint32_t)(tape_bit_cycles / 2));
+}
+
+/*------------------------------------------------
+ * tape_next_bit()
+ *
+ *  Start the next bit of the cassette file, and read the next
+ *  byte when all bits of the current one were sent.
+ *  Past the end of the file the tape sends leader bytes.
+ *
+ *  param:  Nothing
+ *  return: Nothing
+ */
+static void tape_next_bit(void)
+{
+    if ( cas_bit_index == 0 )
+    {
+        if ( lz4_fread(&cas_byte, 1) != 1 )
+            cas_byte = 0x55;
+
+        cas_bit_index = 8;
+    }
+
+    if ( cas_byte & 0b00000001 )
+        tape_bit_cycles = TAPE_BIT1_CYCLES;
+    else
+        tape_bit_cycles = TAPE_BIT0_CYCLES;
+
+    cas_byte = cas_byte >> 1;
+    cas_bit_index--;
+}
+
+/*------------------------------------------------
+ * tape_motor()
+ *
+ *  Respond to the cassette motor turning on or off.
+ *  Motor on opens the mounted CAS file, and the tape stops
+ *  at motor off until it is read again.
+ *
+ *  param:  1- motor turned on, 0- motor turned off
+ *  return: Nothing
+ */
+static void tape_motor(int motor_on)
+{
+    tape_running = 0;
+
+    /* Not checking errors, if the file is open then ok as it will
+     * never be a directory either. Reopening a file does not reset
+     * the read pointer, or the block an LZ4 file is decoding, so no
+     * harm there either. The loader closes the file before it opens
+     * any other file.
+     */
+    if ( motor_on && loader_mount_cas_file(&cas_file) )
+        lz4_fopen(&cas_file);
+}
@@ -0,0 +1,376 @@
+/********************************************************************
+ * pmu.c
+ *
+ *  ARM1176 performance monitor unit (PMU) module.
+ *
+ *  The cycle counter and the two event counters are read at every
+ *  phase change, and the differences are added to the phase that
+ *  was running. The counters are 32-bit and free running, so a single
+ *  phase interval must be shorter than 2^32 CPU cycles (~4 seconds).
+ *  Results are printed on the serial console by pmu_report(), and
+ *  pmu_monitor() reads single key commands from the serial console.
+ *
+ *   Resources:
+ *      ARM1176JZF-S Technical Reference Manual, system control coprocessor c15
+ *
+ *  October 19, 2026
+ *
+ *******************************************************************/
+
+#include    <stdint.h>
+
+#include    "auxuart.h"
+#include    "printf.h"
+#include    "pmu.h"
+#include    "boot.h"
+#include    "audit.h"
+
+/* -----------------------------------------
+   Local definitions
+----------------------------------------- */
+#define     PMNC_ENABLE             0x00000001  // Enable all counters
+#define     PMNC_RESET_COUNTERS     0x00000002  // Reset both count registers to zero
+#define     PMNC_RESET_CYCLES       0x00000004  // Reset the cycle counter to zero
+#define     PMNC_OVERFLOW_FLAGS     0x00000700  // Write '1' to clear overflow flags
+#define     PMNC_EVENT1_SHIFT       12
+#define     PMNC_EVENT0_SHIFT       20
+
+#define     PMU_STACK               8           // Phase nesting depth
+
+#define     read_pmnc(v)            __asm__ __volatile__ ("mrc p15, 0, %0, c15, c12, 0" : "=r" (v))
+#define     write_pmnc(v)           __asm__ __volatile__ ("mcr p15, 0, %0, c15, c12, 0" : : "r" (v))
+#define     read_ccnt(v)            __asm__ __volatile__ ("mrc p15, 0, %0, c15, c12, 1" : "=r" (v))
+#define     read_pmn0(v)            __asm__ __volatile__ ("mrc p15, 0, %0, c15, c12, 2" : "=r" (v))
+#define     read_pmn1(v)            __asm__ __volatile__ ("mrc p15, 0, %0, c15, c12, 3" : "=r" (v))
+
+typedef struct
+{
+    uint32_t    entries;
+    uint64_t    cycles;
+    uint64_t    event0;
+    uint64_t    event1;
+} pmu_count_t;
+
+/* Event pairs selected in turn by the 'e' monitor command
+ */
+typedef struct
+{
+    int         event0;
+    int         event1;
+} pmu_events_t;
+
+/* -----------------------------------------
+   Module static functions
+----------------------------------------- */
+static void pmu_sample(void);
+static void pmu_print_count(uint64_t count);
+static const char *pmu_event_name(int event);
+
+/* -----------------------------------------
+   Module globals
+----------------------------------------- */
+static pmu_count_t  pmu_count[PMU_PHASES];
+static int          phase_stack[PMU_STACK];
+static int          depth = 0;
+static int          dropped_nesting = 0;
+
+static uint32_t     last_cycles;
+static uint32_t     last_event0;
+static uint32_t     last_event1;
+
+static int          event0;
+static int          event1;
+static int          event_set = 0;
+
+static const char  *phase_name[PMU_PHASES] = { "other", "cpu", "vdg", "io", "sd" };
+
+static const pmu_events_t event_sets[] = {
+    { PMU_EV_ICACHE_MISS,       PMU_EV_DCACHE_MISS     },
+    { PMU_EV_BRANCH_MISPRED,    PMU_EV_BRANCH          },
+    { PMU_EV_IMICRO_TLB_MISS,   PMU_EV_MAIN_TLB_MISS   },
+    { PMU_EV_INSTRUCTIONS,      PMU_EV_DCACHE_ACCESS   },
+    { PMU_EV_IBUF_STALL,        PMU_EV_DATA_DEP_STALL  },
+};
+
+/*------------------------------------------------
+ * pmu_init()
+ *
+ *  Initialize the PMU with the first event pair:
+ *  instruction cache misses and data cache misses.
+ *
+ *  param:  Nothing
+ *  return: Nothing
+ */
+void pmu_init(void)
+{
+    event_set = 0;
+    pmu_set_events(event_sets[0].event0, event_sets[0].event1);
+}
+
+/*------------------------------------------------
+ * pmu_set_events()
+ *
+ *  Select the events of the two event counters,
+ *  reset all counters and clear the accumulated results.
+ *
+ *  param:  Event numbers PMU_EV_* for counter 0 and 1
+ *  return: Nothing
+ */
+void pmu_set_events(int event_0, int event_1)
+{
+    uint32_t    pmnc;
+
+    event0 = event_0;
+    event1 = event_1;
+
+    pmnc = PMNC_ENABLE | PMNC_RESET_COUNTERS | PMNC_RESET_CYCLES | PMNC_OVERFLOW_FLAGS |
+           ((event0 & 0xff) << PMNC_EVENT0_SHIFT) |
+           ((event1 & 0xff) << PMNC_EVENT1_SHIFT);
+    write_pmnc(pmnc);
+
+    pmu_clear();
+}
+
+/*------------------------------------------------
+ * pmu_clear()
+ *
+ *  Clear the accumulated results.
+ *  The phase stack is kept, so a clear from inside
+ *  a phase continues to charge the same phase.
+ *
+ *  param:  Nothing
+ *  return: Nothing
+ */
+void pmu_clear(void)
+{
+    int     i;
+
+    for ( i = 0; i < PMU_PHASES; i++ )
+    {
+        pmu_count[i].entries = 0;
+        pmu_count[i].cycles = 0;
+        pmu_count[i].event0 = 0;
+        pmu_count[i].event1 = 0;
+    }
+
+    dropped_nesting = 0;
+
+    read_ccnt(last_cycles);
+    read_pmn0(last_event0);
+    read_pmn1(last_event1);
+}
+
+/*------------------------------------------------
+ * pmu_enter()
+ *
+ *  Charge the counters to the running phase,
+ *  and start charging them to a new phase.
+ *
+ *  param:  Phase being entered
+ *  return: Nothing
+ */
+void pmu_enter(pmu_phase_t phase)
+{
+    pmu_sample();
+
+    if ( depth < PMU_STACK )
+    {
+        phase_stack[depth] = phase;
+        pmu_count[phase].entries++;
+    }
+    else
+    {
+        dropped_nesting++;
+    }
+
+    depth++;
+}
+
+/*------------------------------------------------
+ * pmu_leave()
+ *
+ *  Charge the counters to the running phase,
+ *  and return to the phase it was entered from.
+ *
+ *  param:  Nothing
+ *  return: Nothing
+ */
+void pmu_leave(void)
+{
+    if ( depth == 0 )
+        return;
+
+    pmu_sample();
+    depth--;
+}
+
+/*------------------------------------------------
+ * pmu_report()
+ *
+ *  Print the accumulated results per phase.
+ *
+ *  param:  Nothing
+ *  return: Nothing
+ */
+void pmu_report(void)
+{
+    uint64_t    total = 0;
+    int         i;
+
+    for ( i = 0; i < PMU_PHASES; i++ )
+        total += pmu_count[i].cycles;
+
+    printf("PMU events: %s, %s\n", pmu_event_name(event0), pmu_event_name(event1));
+    printf("phase     entries     cycles    %%     event0     event1  ev0/kcyc  ev1/kcyc\n");
+
+    for ( i = 0; i < PMU_PHASES; i++ )
+    {
+        printf("%-6s %10u ", phase_name[i], pmu_count[i].entries);
+        pmu_print_count(pmu_count[i].cycles);
+        printf(" %4u ", total ? (uint32_t)((100 * pmu_count[i].cycles) / total) : 0);
+        pmu_print_count(pmu_count[i].event0);
+        printf(" ");
+        pmu_print_count(pmu_count[i].event1);
+        printf(" %9u %9u\n",
+               pmu_count[i].cycles ? (uint32_t)((1000 * pmu_count[i].event0) / pmu_count[i].cycles) : 0,
+               pmu_count[i].cycles ? (uint32_t)((1000 * pmu_count[i].event1) / pmu_count[i].cycles) : 0);
+    }
+
+    if ( dropped_nesting )
+        printf("PMU phase nesting too deep %d times\n", dropped_nesting);
+}
+
+/*------------------------------------------------
+ * pmu_monitor()
+ *
+ *  Poll the serial console for PMU commands:
+ *      'p' print the results
+ *      'c' clear the results
+ *      'e' select the next event pair and clear the results
+ *      't' print the boot timeline
+ *      'a' print the timing audit
+ *  Call from the emulator main loop.
+ *
+ *  param:  Nothing
+ *  return: Nothing
+ */
+void pmu_monitor(void)
+{
+    if ( !bcm2835_auxuart_ischar() )
+        return;
+
+    switch ( bcm2835_auxuart_getchr() )
+    {
+        case 'p':
+            pmu_report();
+            break;
+
+        case 'c':
+            pmu_clear();
+            printf("PMU cleared\n");
+            break;
+
+        case 'e':
+            event_set++;
+            if ( event_set >= sizeof(event_sets) / sizeof(pmu_events_t) )
+                event_set = 0;
+            pmu_set_events(event_sets[event_set].event0, event_sets[event_set].event1);
+            printf("PMU events: %s, %s\n", pmu_event_name(event0), pmu_event_name(event1));
+            break;
+
+        case 't':
+            boot_report();
+            break;
+
+        case 'a':
+            audit_report();
+            break;
+
+        default:
+            break;
+    }
+}
+
+/*------------------------------------------------
+ * pmu_sample()
+ *
+ *  Read the counters and add the counts since the
+ *  last sample to the running phase.
+ *
+ *  param:  Nothing
+ *  return: Nothing
+ */
+static void pmu_sample(void)
+{
+    uint32_t    cycles, count0, count1;
+    int         phase;
+
+    read_ccnt(cycles);
+    read_pmn0(count0);
+    read_pmn1(count1);
+
+    if ( depth == 0 )
+        phase = PMU_OTHER;
+    else if ( depth <= PMU_STACK )
+        phase = phase_stack[depth - 1];
+    else
+        phase = phase_stack[PMU_STACK - 1];
+
+    pmu_count[phase].cycles += (uint32_t)(cycles - last_cycles);
+    pmu_count[phase].event0 += (uint32_t)(count0 - last_event0);
+    pmu_count[phase].event1 += (uint32_t)(count1 - last_event1);
+
+    last_cycles = cycles;
+    last_event0 = count0;
+    last_event1 = count1;
+}
+
+/*------------------------------------------------
+ * pmu_print_count()
+ *
+ *  Print a 64-bit count in a 10 character column,
+ *  in thousands when it does not fit.
+ *  printf() is built without 'long long' support.
+ *
+ *  param:  Count
+ *  return: Nothing
+ */
+static void pmu_print_count(uint64_t count)
+{
+    if ( count < 1000000000 )
+        printf("%10u", (uint32_t) count);
+    else
+        printf("%9uk", (uint32_t)(count / 1000));
+}
+
+/*------------------------------------------------
+ * pmu_event_name()
+ *
+ *  Return a name for a PMU event number.
+ *
+ *  param:  Event number PMU_EV_*
+ *  return: Pointer to constant name string
+ */
+static const char *pmu_event_name(int event)
+{
+    switch ( event )
+    {
+        case PMU_EV_ICACHE_MISS:        return "I-cache miss";
+        case PMU_EV_IBUF_STALL:         return "I-buffer stall";
+        case PMU_EV_DATA_DEP_STALL:     return "data dependency stall";
+        case PMU_EV_IMICRO_TLB_MISS:    return "I micro-TLB miss";
+        case PMU_EV_DMICRO_TLB_MISS:    return "D micro-TLB miss";
+        case PMU_EV_BRANCH:             return "branch";
+        case PMU_EV_BRANCH_MISPRED:     return "branch mispredict";
+        case PMU_EV_INSTRUCTIONS:       return "instructions";
+        case PMU_EV_DCACHE_ACCESS:      return "D-cache access";
+        case PMU_EV_DCACHE_MISS:        return "D-cache miss";
+        case PMU_EV_DCACHE_WB:          return "D-cache write-back";
+        case PMU_EV_PC_CHANGE:          return "software PC change";
+        case PMU_EV_MAIN_TLB_MISS:      return "main TLB miss";
+        case PMU_EV_EXT_ACCESS:         return "external access";
+        case PMU_EV_LSU_STALL:          return "LSU stall";
+        case PMU_EV_WB_DRAIN:           return "write buffer drain";
+        default:                        return "?";
+    }
+}
@@ -0,0 +1,243 @@
+/********************************************************************
+ * printer.c
+ *
+ *  Parallel printer capture module.
+ *
+ *  The Dragon printer port has its data lines on PIA0 port B, shared
+ *  with the keyboard columns, a strobe on PIA1 PA1 and a busy input
+ *  on PIA1 PB0. pia.c reports the busy line as always ready and calls
+ *  printer_write() with the data byte on every strobe, so LLIST and
+ *  PRINT#-2 run at full emulated speed.
+ *
+ *  The file system driver does not allocate clusters, so the capture
+ *  file is an existing PRINTER.TXT in the root directory of the SD card,
+ *  for example a 1MB file of zeros, which is overwritten from its start
+ *  after every power-on. Output is written in chunks of a cluster, or of
+ *  PRINTER_CHUNK_MAX bytes for large clusters, so a chunk is always
+ *  contiguous on the card. A partial chunk is written when the printer
+ *  is idle and when the loader is entered, and is written again as it
+ *  fills. The rest of the file keeps its old content, so the captured
+ *  text ends at the first 0 byte of a file of zeros.
+ *
+ *  The file is found by the loader, so output is kept in RAM until
+ *  the loader was entered once with a card that has the file.
+ *
+ *  October 19, 2026
+ *
+ *******************************************************************/
+
+#include    <stdint.h>
+#include    <string.h>
+
+#include    "rpi.h"
+#include    "log.h"
+#include    "sdfat32.h"
+#include    "loader.h"
+#include    "printer.h"
+
+/* -----------------------------------------
+   Local definitions
+----------------------------------------- */
+#define     PRINTER_CHUNK_MAX       16384       // Largest write, a power of 2
+#define     PRINTER_BUFFER_SIZE     (2 * PRINTER_CHUNK_MAX)
+#define     PRINTER_IDLE_FRAMES     100         // Write a partial chunk after 2 seconds without output
+#define     PRINTER_SECTOR          512
+
+/* -----------------------------------------
+   Module static functions
+----------------------------------------- */
+static int  printer_attach(void);
+static void printer_write_chunk(int length);
+
+/* -----------------------------------------
+   Module globals
+----------------------------------------- */
+static uint8_t      printer_buffer[PRINTER_BUFFER_SIZE];
+static int          buffer_fill = 0;            // Bytes in the buffer, the first is at file_offset
+static int          buffer_written = 0;         // Buffer bytes already on the card
+static int          idle_frames = 0;
+
+static dir_entry_t  printer_file;
+static int          file_attached = 0;
+static int          file_full = 0;
+static int          chunk_size = 0;
+static uint32_t     file_offset = 0;            // File offset of the buffer
+static uint32_t     cluster = 0;                // Cluster of file_offset
+static int          cluster_offset = 0;         // Offset of file_offset in its cluster
+
+/*------------------------------------------------
+ * printer_init()
+ *
+ *  Initialize the printer capture.
+ *
+ *  param:  Nothing
+ *  return: Nothing
+ */
+void printer_init(void)
+{
+    memset(printer_buffer, 0, sizeof(printer_buffer));
+    buffer_fill = 0;
+    buffer_written = 0;
+    idle_frames = 0;
+
+    file_attached = 0;
+    file_full = 0;
+}
+
+/*------------------------------------------------
+ * printer_write()
+ *
+ *  Add a byte to the printer output.
+ *  Called from the PIA on a printer strobe.
+ *
+ *  param:  Data byte
+ *  return: Nothing
+ */
+void printer_write(uint8_t data)
+{
+    if ( buffer_fill < PRINTER_BUFFER_SIZE )
+        printer_buffer[buffer_fill++] = data;
+
+    idle_frames = 0;
+}
+
+/*------------------------------------------------
+ * printer_frame()
+ *
+ *  Write full chunks of printer output to the card,
+ *  and a partial chunk once the printer is idle.
+ *  Call once per frame from the emulator main loop.
+ *
+ *  param:  Nothing
+ *  return: Nothing
+ */
+void printer_frame(void)
+{
+    if ( buffer_fill == buffer_written )
+        return;
+
+    if ( !file_attached && !printer_attach() )
+        return;
+
+    if ( buffer_fill >= chunk_size )
+    {
+        printer_write_chunk(chunk_size);
+    }
+    else if ( ++idle_frames >= PRINTER_IDLE_FRAMES )
+    {
+        printer_write_chunk(buffer_fill);
+    }
+}
+
+/*------------------------------------------------
+ * printer_flush()
+ *
+ *  Write all printer output to the card, before the
+ *  loader runs or the card is removed.
+ *
+ *  param:  Nothing
+ *  return: Nothing
+ */
+void printer_flush(void)
+{
+    if ( buffer_fill == buffer_written )
+        return;
+
+    if ( !file_attached && !printer_attach() )
+        return;
+
+    while ( buffer_fill >= chunk_size && !file_full )
+        printer_write_chunk(chunk_size);
+
+    if ( buffer_fill > buffer_written && !file_full )
+        printer_write_chunk(buffer_fill);
+}
+
+/*------------------------------------------------
+ * printer_attach()
+ *
+ *  Get the capture file from the loader, and start
+ *  writing at its beginning.
+ *
+ *  param:  Nothing
+ *  return: 1- file attached, 0- no file yet
+ */
+static int printer_attach(void)
+{
+    if ( !loader_mount_printer_file(&printer_file) )
+        return 0;
+
+    chunk_size = fat32_cluster_bytes();
+    if ( chunk_size > PRINTER_CHUNK_MAX )
+        chunk_size = PRINTER_CHUNK_MAX;
+
+    file_offset = 0;
+    cluster = printer_file.cluster_chain_head;
+    cluster_offset = 0;
+    file_full = (cluster == 0 || printer_file.file_size == 0);
+
+    file_attached = 1;
+
+    return 1;
+}
+
+/*------------------------------------------------
+ * printer_write_chunk()
+ *
+ *  Write the first bytes of the buffer to the card in whole sectors.
+ *  A full chunk is moved out of the buffer and the file position
+ *  advances, a partial chunk stays in the buffer to be written again.
+ *  Output past the end of the file is dropped.
+ *
+ *  param:  Byte count, chunk_size or less
+ *  return: Nothing
+ */
+static void printer_write_chunk(int length)
+{
+    uint32_t    lba;
+    sd_error_t  result;
+
+    if ( file_full )
+    {
+        buffer_fill = 0;
+        buffer_written = 0;
+        memset(printer_buffer, 0, sizeof(printer_buffer));
+        return;
+    }
+
+    lba = fat32_cluster_sector(cluster) + (cluster_offset / PRINTER_SECTOR);
+
+    result = rpi_sd_write_block(lba, printer_buffer, ((length + PRINTER_SECTOR - 1) / PRINTER_SECTOR) * PRINTER_SECTOR);
+    if ( result != SD_OK )
+        LOG2(LOG_PRINTER_SD_ERROR, result, lba);
+
+    if ( length < chunk_size )
+    {
+        buffer_written = length;
+        return;
+    }
+
+    /* Move out the chunk, the buffer past its fill level is kept
+     * at 0 to pad partial sectors
+     */
+    memmove(printer_buffer, &printer_buffer[chunk_size], buffer_fill - chunk_size);
+    memset(&printer_buffer[buffer_fill - chunk_size], 0, chunk_size);
+    buffer_fill -= chunk_size;
+    buffer_written = 0;
+
+    file_offset += chunk_size;
+    cluster_offset += chunk_size;
+
+    if ( cluster_offset == fat32_cluster_bytes() )
+    {
+        cluster_offset = 0;
+        if ( file_offset < (uint32_t) printer_file.file_size )
+            cluster = fat32_next_cluster(&printer_file, cluster);
+    }
+
+    if ( file_offset >= (uint32_t) printer_file.file_size || cluster == 0 )
+    {
+        file_full = 1;
+        LOG1(LOG_PRINTER_FULL, file_offset);
+    }
+}
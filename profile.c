@@ -0,0 +1,328 @@
+/********************************************************************
+ * profile.c
+ *
+ *  Per-title performance profiles.
+ *
+ *  PROFILES.TXT is a text file in the directory of the titles it
+ *  describes, with one title per line followed by a ':' and its settings:
+ *
+ *      # Comment
+ *      *:          frameskip=1 speed=1
+ *      ZAXXON.CAS: fastload=1 artifact=1
+ *      GAME.ROM:   hle=0 frameskip=2
+ *
+ *  Title names are not case sensitive. The '*' line sets the defaults
+ *  of the directory, and settings that a title line does not list
+ *  keep their default. The file is read line by line, and a line longer
+ *  than 256 characters is reported and ignored. Settings:
+ *
+ *      fastload=0|1    run without pacing while the cassette motor is on
+ *      hle=0|1         recompiled ROM blocks and native character fetch
+ *      frameskip=1..4  render one of every N frames
+ *      speed=1..8      CPU clock multiplier
+ *      tapespeed=1..20 CPU clock multiplier while the cassette motor is on
+ *      artifact=0..2   PMODE4 artifact colours, off, blue-red, red-blue
+ *
+ *  October 19, 2026
+ *
+ *******************************************************************/
+
+#include    <stdint.h>
+#include    <ctype.h>
+#include    <string.h>
+
+#include    "printf.h"
+#include    "cpu.h"
+#include    "vdg.h"
+#include    "profile.h"
+
+/* -----------------------------------------
+   Local definitions
+----------------------------------------- */
+#define     PROFILE_READ_SIZE       512     // Bytes read from the profile file at a time
+#define     PROFILE_LINE_SIZE       256     // Longest profile line
+
+/* -----------------------------------------
+   Module static functions
+----------------------------------------- */
+static void  profile_defaults(profile_t *profile);
+static void  profile_parse_line(int length, int line_number, char *title);
+static void  profile_parse_settings(char *settings, profile_t *profile);
+static char *profile_trim(char *text);
+static int   profile_value(char *value, int min, int max, int *setting);
+
+/* -----------------------------------------
+   Module globals
+----------------------------------------- */
+static profile_t    current_profile =
+{
+    .fast_load = 0,
+    .rom_blocks = 1,
+    .frame_skip = 1,
+    .speed = 1,
+    .tape_speed = 1,
+    .artifact = VDG_ARTIFACT_OFF,
+};
+
+static char         profile_read[PROFILE_READ_SIZE];
+static char         profile_line[PROFILE_LINE_SIZE + 1];
+static char         title_settings[PROFILE_LINE_SIZE + 1];
+static int          title_found;
+
+/*------------------------------------------------
+ * profile_select()
+ *
+ *  Select the profile of a title from the profile file in
+ *  the title's directory, and apply it. A title that has no
+ *  profile runs with the defaults.
+ *
+ *  param:  Directory list of the title's directory and its length, title file name
+ *  return: Nothing
+ */
+void profile_select(dir_entry_t *directory_list, int list_length, char *title)
+{
+    int     i, j, bytes, length, line_number;
+
+    profile_defaults(&current_profile);
+    title_found = 0;
+
+    for ( i = 0; i < list_length; i++ )
+    {
+        if ( !directory_list[i].is_directory &&
+             fat32_name_match(directory_list[i].lfn, PROFILE_FILE_NAME) )
+        {
+            if ( !fat32_fopen(&directory_list[i]) )
+                break;
+
+            /* Collect lines across reads, a line may span two of them.
+             * 'length' keeps counting past the line buffer so that a long
+             * line is detected and not parsed truncated.
+             */
+            length = 0;
+            line_number = 1;
+
+            while ( (bytes = fat32_fread((uint8_t *) profile_read, PROFILE_READ_SIZE)) > 0 )
+            {
+                for ( j = 0; j < bytes; j++ )
+                {
+                    if ( profile_read[j] == '\n' )
+                    {
+                        profile_parse_line(length, line_number, title);
+                        length = 0;
+                        line_number++;
+                    }
+                    else
+                    {
+                        if ( length < PROFILE_LINE_SIZE )
+                            profile_line[length] = profile_read[j];
+                        length++;
+                    }
+                }
+            }
+
+            fat32_fclose();
+
+            if ( bytes < 0 )
+                printf("Profile %s: read error\n", PROFILE_FILE_NAME);
+            else if ( length > 0 )
+                profile_parse_line(length, line_number, title);
+
+            if ( title_found )
+                profile_parse_settings(title_settings, &current_profile);
+
+            break;
+        }
+    }
+
+    cpu_set_rom_blocks(current_profile.rom_blocks);
+    vdg_set_artifact(current_profile.artifact);
+
+    printf("Profile %s: fastload=%d hle=%d frameskip=%d speed=%d tapespeed=%d artifact=%d\n",
+            title, current_profile.fast_load, current_profile.rom_blocks,
+            current_profile.frame_skip, current_profile.speed, current_profile.tape_speed,
+            current_profile.artifact);
+}
+
+/*------------------------------------------------
+ * profile_get()
+ *
+ *  Get the profile of the loaded title.
+ *
+ *  param:  Nothing
+ *  return: Pointer to the current profile
+ */
+const profile_t *profile_get(void)
+{
+    return &current_profile;
+}
+
+/*------------------------------------------------
+ * profile_defaults()
+ *
+ *  Set a profile to the built-in defaults.
+ *
+ *  param:  Pointer to profile
+ *  return: Nothing
+ */
+static void profile_defaults(profile_t *profile)
+{
+    profile->fast_load = 0;
+    profile->rom_blocks = 1;
+    profile->frame_skip = 1;
+    profile->speed = 1;
+    profile->tape_speed = 1;
+    profile->artifact = VDG_ARTIFACT_OFF;
+}
+
+/*------------------------------------------------
+ * profile_parse_line()
+ *
+ *  Parse a line of the profile file collected in profile_line[].
+ *  The '*' line is applied to the current profile right away, the
+ *  settings of the title line are kept and applied after the last line,
+ *  so the '*' line is applied first wherever it is in the file.
+ *
+ *  param:  Line length, line number, title file name
+ *  return: Nothing
+ */
+static void profile_parse_line(int length, int line_number, char *title)
+{
+    char   *colon;
+
+    if ( length > PROFILE_LINE_SIZE )
+    {
+        printf("Profile %s: line %d longer than %d characters, ignored\n",
+                PROFILE_FILE_NAME, line_number, PROFILE_LINE_SIZE);
+        return;
+    }
+
+    profile_line[length] = 0;
+
+    if ( (colon = strchr(profile_line, ':')) == NULL || profile_line[0] == '#' )
+        return;
+
+    *colon = 0;
+
+    if ( strcmp(profile_trim(profile_line), "*") == 0 )
+    {
+        profile_parse_settings(colon + 1, &current_profile);
+    }
+    else if ( fat32_name_match(profile_trim(profile_line), title) )
+    {
+        strcpy(title_settings, colon + 1);
+        title_found = 1;
+    }
+}
+
+/*------------------------------------------------
+ * profile_parse_settings()
+ *
+ *  Parse the 'key=value' settings of a profile line.
+ *  Unknown keys and values out of range are reported and ignored.
+ *
+ *  param:  Settings text, profile to update
+ *  return: Nothing
+ */
+static void profile_parse_settings(char *settings, profile_t *profile)
+{
+    char   *key, *value;
+    int     valid;
+
+    key = settings;
+
+    while ( *key )
+    {
+        while ( isspace((int) *key) )
+            key++;
+
+        if ( *key == 0 )
+            break;
+
+        for ( value = key; *value && !isspace((int) *value); value++ );
+        if ( *value )
+            *value++ = 0;
+        settings = value;
+
+        if ( (value = strchr(key, '=')) == NULL )
+        {
+            valid = 0;
+        }
+        else
+        {
+            *value++ = 0;
+
+            if ( strcmp(key, "fastload") == 0 )
+                valid = profile_value(value, 0, 1, &profile->fast_load);
+            else if ( strcmp(key, "hle") == 0 )
+                valid = profile_value(value, 0, 1, &profile->rom_blocks);
+            else if ( strcmp(key, "frameskip") == 0 )
+                valid = profile_value(value, 1, PROFILE_MAX_FRAME_SKIP, &profile->frame_skip);
+            else if ( strcmp(key, "speed") == 0 )
+                valid = profile_value(value, 1, PROFILE_MAX_SPEED, &profile->speed);
+            else if ( strcmp(key, "tapespeed") == 0 )
+                valid = profile_value(value, 1, PROFILE_MAX_TAPE_SPEED, &profile->tape_speed);
+            else if ( strcmp(key, "artifact") == 0 )
+                valid = profile_value(value, VDG_ARTIFACT_OFF, VDG_ARTIFACT_RED_BLUE, &profile->artifact);
+            else
+                valid = 0;
+        }
+
+        if ( !valid )
+            printf("profile_parse_settings(): bad setting '%s'\n", key);
+
+        key = settings;
+    }
+}
+
+/*------------------------------------------------
+ * profile_trim()
+ *
+ *  Remove leading and trailing white space.
+ *
+ *  param:  Text
+ *  return: Pointer to trimmed text
+ */
+static char *profile_trim(char *text)
+{
+    char   *end;
+
+    while ( isspace((int) *text) )
+        text++;
+
+    end = text + strlen(text);
+    while ( end > text && isspace((int) *(end - 1)) )
+        end--;
+    *end = 0;
+
+    return text;
+}
+
+/*------------------------------------------------
+ * profile_value()
+ *
+ *  Convert a decimal setting value and check its range.
+ *
+ *  param:  Value text, minimum and maximum, setting to update
+ *  return: 1- valid, 0- not a number or out of range
+ */
+static int profile_value(char *value, int min, int max, int *setting)
+{
+    int     number = 0;
+
+    if ( *value == 0 )
+        return 0;
+
+    for ( ; *value; value++ )
+    {
+        if ( !isdigit((int) *value) || number > max )
+            return 0;
+        number = number * 10 + (*value - '0');
+    }
+
+    if ( number < min || number > max )
+        return 0;
+
+    *setting = number;
+
+    return 1;
+}
@@ -20,6 +20,9 @@
 #include    "irq.h"
 #include    "printf.h"
 #include    "rpi.h"
+#include    "log.h"
+#include    "pmu.h"
+#include    "boot.h"
 
 /* -----------------------------------------
    Local definitions
@@ -50,6 +53,12 @@
 #define     JOYSTK_COMP         RPI_V2_GPIO_P1_26   // Joystick
 #define     JOYSTK_BUTTON       RPI_V2_GPIO_P1_24   // Joystick button
 
+#if (RPI_MODEL_ZERO==1)
+#define     BUTTON_EVENT_MASK   ((1 << JOYSTK_BUTTON) | (1 << EMULATOR_RESET))
+#else
+#define     BUTTON_EVENT_MASK   (1 << JOYSTK_BUTTON)
+#endif
+
 #define     DAC_BIT_MASK        ((1 << DAC_BIT0) | (1 << DAC_BIT1) | (1 << DAC_BIT2) | \
                                  (1 << DAC_BIT3) | (1 << DAC_BIT4) | (1 << DAC_BIT5))
 
@@ -92,6 +101,11 @@
 
 #define     SD_NCR                  10          // Command response time: 0 to 8 bytes for SDC, 1 to 8 bytes for MMC
 #define     SD_TOKEN_START_BLOCK    0xfe        // For CMD17/18/24
+#define     SD_TOKEN_START_MULTI    0xfc        // For CMD25
+#define     SD_TOKEN_STOP_TRAN      0xfd        // Ends CMD25
+
+#define     SD_DATA_RESP_MASK       0x1f
+#define     SD_DATA_ACCEPTED        0x05
 
 #define     SD_R1_READY             0b00000000
 #define     SD_R1_IDLE              0b00000001
@@ -103,6 +117,10 @@
 #define     SD_R1_PARAM_ERROR       0b01000000
 #define     SD_FAILURE              0xff
 
+#define     SD_IF_COND_ARG          0x000001aa  // CMD8 2.7-3.6V and check pattern
+#define     SD_OCR_HCS              0x40000000  // ACMD41 host supports high capacity cards
+#define     SD_OCR_CCS              0x40        // CMD58 OCR first byte, card uses block addressing
+
 #define     SD_BLOCK_SIZE           512         // Bytes
 #define     SD_TIME_OUT             500000      // 500mSec
 #define     SD_SPI_BIT_RATE         100000
@@ -120,16 +138,24 @@ typedef struct
 /* -----------------------------------------
    Module static functions
 ----------------------------------------- */
-static uint8_t   sd_send_cmd(int cmd, uint32_t arg);
-static int       sd_wait_read_token(uint8_t token);
-static int       sd_wait_ready(void);
-static uint8_t   sd_get_crc7(uint8_t *message, int length);
-static uint16_t  sd_get_crc16(const uint8_t *buf, int len );
+static uint8_t   sd_send_cmd(int cmd, uint32_t arg) SECTION_COLD;
+static int       sd_wait_read_token(uint8_t token) SECTION_COLD;
+static int       sd_wait_ready(void) SECTION_COLD;
+static uint8_t   sd_get_crc7(uint8_t *message, int length) SECTION_COLD;
+static uint16_t  sd_get_crc16(const uint8_t *buf, int len ) SECTION_COLD;
+static sd_error_t sd_read_block(uint32_t lba, uint8_t *buffer, uint32_t length) SECTION_COLD;
+static sd_error_t sd_write_block(uint32_t lba, uint8_t *buffer, uint32_t length) SECTION_COLD;
+static int       button_level(int pin, uint32_t events, uint32_t pulse, int last_level);
 
 /* -----------------------------------------
    Module globals
 ----------------------------------------- */
 static var_info_t   var_info;
+static int          sd_block_addressing = 0;    // SDHC/SDXC cards use block, not byte, addresses
+
+static int          rjoystk_button = HIGH;      // Button levels of the last rpi_button_scan(), active low
+static int          reset_button = HIGH;
+static uint32_t     button_pulse = 0;           // Buttons read as pressed for a press and release at the last scan
 
 /* Palette for 8-bpp color depth.
  * The palette is in BGR format, and 'set pixel order' does not affect
@@ -174,7 +200,17 @@ int rpi_gpio_init(void)
     /* Initialize auxiliary UART for console output.
      * Safe to continue with system bring-up even if UART failed?
      */
+#if (ACIA_ENABLE==1)
+    /* The ACIA emulation sends and receives through the
+     * interrupt driven UART buffers
+     */
+    irq_init();
+    bcm2835_auxuart_init(DEFAULT_UART_RATE, 100, 100, AUXUART_ENA_RX_IRQ | AUXUART_ENA_TX_IRQ);
+    enable();
+#else
     bcm2835_auxuart_init(DEFAULT_UART_RATE, 100, 100, AUXUART_DEFAULT);
+#endif
+    boot_mark(BOOT_UART);
 
     /* Initialize SPI0 for AVR keyboard interface
      */
@@ -185,6 +221,7 @@ int rpi_gpio_init(void)
     }
 
     bcm2835_spi0_set_rate(DEFAULT_SPI0_RATE);
+    boot_mark(BOOT_SPI0);
 
     /* Initialize GPIO for AVR reset line
      */
@@ -193,6 +230,7 @@ int rpi_gpio_init(void)
 
     rpi_keyboard_reset();
     bcm2835_st_delay(3000000);
+    boot_mark(BOOT_AVR_RESET);
 
     /* Initialize GPIO for RPi test point
      */
@@ -216,6 +254,8 @@ int rpi_gpio_init(void)
 
     bcm2835_gpio_fsel(JOYSTK_BUTTON, BCM2835_GPIO_FSEL_INPT);
     bcm2835_gpio_set_pud(JOYSTK_BUTTON, BCM2835_GPIO_PUD_UP);
+    bcm2835_gpio_fen(JOYSTK_BUTTON);
+    bcm2835_gpio_ren(JOYSTK_BUTTON);
 
     bcm2835_gpio_fsel(AUDIO_MUX0, BCM2835_GPIO_FSEL_OUTP);
     bcm2835_gpio_fsel(AUDIO_MUX1, BCM2835_GPIO_FSEL_OUTP);
@@ -224,8 +264,14 @@ int rpi_gpio_init(void)
 #if (RPI_MODEL_ZERO==1)
     bcm2835_gpio_fsel(EMULATOR_RESET, BCM2835_GPIO_FSEL_INPT);
     bcm2835_gpio_set_pud(EMULATOR_RESET, BCM2835_GPIO_PUD_UP);
+    bcm2835_gpio_fen(EMULATOR_RESET);
+    bcm2835_gpio_ren(EMULATOR_RESET);
 #endif
 
+    bcm2835_gpio_clr_eds_multi(BUTTON_EVENT_MASK);
+
+    boot_mark(BOOT_GPIO);
+
     return 0;
 }
 
@@ -397,34 +443,100 @@ int rpi_joystk_comp(void)
     return (int) bcm2835_gpio_lev(JOYSTK_COMP);
 }
 
+/*------------------------------------------------
+ * rpi_button_scan()
+ *
+ *  Scan the edge events of the joystick and reset button
+ *  GPIO inputs, and update the button levels returned by
+ *  rpi_rjoystk_button() and rpi_reset_button().
+ *  The GPIO pins are read only when an edge was detected,
+ *  and a press and release between two scans reads as
+ *  pressed for one scan, so it is not missed. The scan after
+ *  that reads the pin again even without an edge.
+ *  Called once per frame.
+ *
+ *  param:  None
+ *  return: None
+ */
+void rpi_button_scan(void)
+{
+    uint32_t    events, pulse;
+
+    events = bcm2835_gpio_eds_multi(BUTTON_EVENT_MASK);
+    if ( events == 0 && button_pulse == 0 )
+        return;
+
+    bcm2835_gpio_clr_eds_multi(events);
+
+    pulse = button_pulse;
+    button_pulse = 0;
+
+    if ( (events | pulse) & (1 << JOYSTK_BUTTON) )
+        rjoystk_button = button_level(JOYSTK_BUTTON, events, pulse, rjoystk_button);
+
+#if (RPI_MODEL_ZERO==1)
+    if ( (events | pulse) & (1 << EMULATOR_RESET) )
+        reset_button = button_level(EMULATOR_RESET, events, pulse, reset_button);
+#endif
+}
+
 /*------------------------------------------------
  * rpi_rjoystk_button()
  *
- *  Read right joystick button GPIO input pin and return its value.
+ *  Right joystick button level of the last rpi_button_scan().
  *
  *  param:  None
  *  return: GPIO joystick button input level
  */
 int rpi_rjoystk_button(void)
 {
-    return (int) bcm2835_gpio_lev(JOYSTK_BUTTON);
+    return rjoystk_button;
 }
 
 /*------------------------------------------------
  * rpi_reset_button()
  *
- *  Emulator reset button GPIO input pin and return its value.
+ *  Emulator reset button level of the last rpi_button_scan().
  *
  *  param:  None
  *  return: GPIO reset button input level
  */
 int rpi_reset_button(void)
 {
-#if (RPI_MODEL_ZERO==1)
-    return (int) bcm2835_gpio_lev(EMULATOR_RESET);
-#else
-    return 1;
-#endif
+    return reset_button;
+}
+
+/*------------------------------------------------
+ * button_level()
+ *
+ *  Button level after an edge event, or after a scan that read
+ *  a press and release. A button with an edge that is released now
+ *  and was released at the last scan was pressed and released in
+ *  between. It reads as pressed for this scan, and is marked in
+ *  'button_pulse' so that the next scan reads it again.
+ *
+ *  param:  GPIO pin of the button, edge events and pulses of the last scan,
+ *          and the button level returned by the last scan
+ *  return: Button level
+ */
+static int button_level(int pin, uint32_t events, uint32_t pulse, int last_level)
+{
+    int     level;
+
+    level = (int) bcm2835_gpio_lev(pin);
+
+    /* A pulse read as pressed, but the button was released
+     */
+    if ( pulse & (1 << pin) )
+        last_level = HIGH;
+
+    if ( (events & (1 << pin)) && level == HIGH && last_level == HIGH )
+    {
+        button_pulse |= (1 << pin);
+        return LOW;
+    }
+
+    return level;
 }
 
 /*------------------------------------------------
@@ -536,25 +648,62 @@ void rpi_testpoint_off(void)
  */
 void rpi_halt(void)
 {
+    log_flush();
     printf("HALT\n");
     for (;;)
     {
     }
 }
 
+/*------------------------------------------------
+ * rpi_uart_write()
+ *
+ *  Write bytes to the serial console for as long as the
+ *  UART accepts them without waiting.
+ *  With the ACIA the line only carries the Dragon's serial
+ *  stream, and the bytes are dropped.
+ *
+ *  param:  Buffer and byte count to send
+ *  return: Byte count sent
+ */
+int rpi_uart_write(uint8_t *buffer, int count)
+{
+#if (ACIA_ENABLE==1)
+    return count;
+#else
+    int     i;
+
+    for ( i = 0; i < count; i++ )
+    {
+        if ( !bcm2835_auxuart_tx_ready() )
+            break;
+
+        bcm2835_auxuart_putchr(buffer[i]);
+    }
+
+    return i;
+#endif
+}
+
 /*------------------------------------------------
  * _putchar()
  *
  *  Low level character output/stream for printf()
+ *  Console output is dropped with the ACIA, so that it does
+ *  not land in the middle of the Dragon's serial stream, and
+ *  with CPUTRACE=2, so that it does not land in the middle of
+ *  a trace record that tools/tracedump.c then cannot decode.
  *
  *  param:  character
  *  return: none
  */
 void _putchar(char character)
 {
+#if (ACIA_ENABLE==0 && CPU_TRACE!=2)
     if ( character == '\n')
         bcm2835_auxuart_putchr('\r');
     bcm2835_auxuart_putchr(character);
+#endif
 }
 
 /* -------------------------------------------------------------
@@ -574,8 +723,11 @@ sd_error_t rpi_sd_init(void)
 sd_error_t rpi_sd_init(void)
 {
     uint8_t     mosi_buffer[10] = {255, 255, 255, 255, 255, 255, 255, 255, 255, 255};
+    uint8_t     r7_ocr[4];
     uint8_t     sd_response;
     uint32_t    start_time;
+    int         sd_version2;
+    int         i;
 
     if ( !bcm2835_spi1_init(SPI1_DEFAULT) )
     {
@@ -609,6 +761,26 @@ sd_error_t rpi_sd_init(void)
       return SD_FAIL;
     }
 
+    /* A v2.0 card answers CMD8 with an R7 response that echoes the check pattern,
+     * a v1.0 card rejects it as an illegal command.
+     */
+    sd_version2 = 0;
+
+    sd_response = sd_send_cmd(SD_SEND_IF_COND, SD_IF_COND_ARG);
+    if ( sd_response == SD_R1_IDLE )
+    {
+        for ( i = 0; i < 4; i++ )
+            r7_ocr[i] = bcm2835_spi1_transfer_byte(SPI_FILL_BYTE);
+
+        if ( (r7_ocr[2] & 0x0f) != 0x01 || r7_ocr[3] != (SD_IF_COND_ARG & 0xff) )
+        {
+          printf("rpi_sd_init(): SD card failed SD_SEND_IF_COND.\n");
+          return SD_FAIL;
+        }
+
+        sd_version2 = 1;
+    }
+
     start_time = bcm2835_st_read();
 
     do
@@ -620,7 +792,7 @@ sd_error_t rpi_sd_init(void)
               return SD_FAIL;
             }
 
-            sd_response = sd_send_cmd(SD_APP_SEND_OP_COND, 0);
+            sd_response = sd_send_cmd(SD_APP_SEND_OP_COND, (sd_version2 ? SD_OCR_HCS : 0));
             if ( sd_response == SD_FAILURE )
             {
               printf("rpi_sd_init(): SD card failed SD_APP_SEND_OP_COND.\n");
@@ -635,6 +807,27 @@ sd_error_t rpi_sd_init(void)
       return SD_TIMEOUT;
     }
 
+    /* The card capacity status (CCS) bit of a v2.0 card's OCR selects
+     * block addressing, which SDHC and SDXC cards use.
+     */
+    sd_block_addressing = 0;
+
+    if ( sd_version2 )
+    {
+        sd_response = sd_send_cmd(SD_READ_OCR, 0);
+        if ( sd_response != SD_R1_READY )
+        {
+          printf("rpi_sd_init(): SD card failed SD_READ_OCR.\n");
+          return SD_FAIL;
+        }
+
+        for ( i = 0; i < 4; i++ )
+            r7_ocr[i] = bcm2835_spi1_transfer_byte(SPI_FILL_BYTE);
+
+        if ( r7_ocr[0] & SD_OCR_CCS )
+            sd_block_addressing = 1;
+    }
+
     sd_response = sd_send_cmd(SD_SET_BLOCKLEN, SD_BLOCK_SIZE);
     if ( sd_response != SD_R1_READY )
     {
@@ -649,75 +842,259 @@ sd_error_t rpi_sd_init(void)
 /* -------------------------------------------------------------
  * rpi_sd_read_block()
  *
- *  Read a block (sector) from the SD card
+ *  Read a block (sector) from the SD card. A buffer length of
+ *  more than one block reads length / 512 consecutive blocks with
+ *  one multiple block read command.
  *
  *  Param:  LBA number, buffer address, and its length
  *  Return: Driver error
  */
-#if (RPI_MODEL_ZERO==0)
 sd_error_t rpi_sd_read_block(uint32_t lba, uint8_t *buffer, uint32_t length)
+{
+    sd_error_t  result;
+
+    PMU_ENTER(PMU_SD);
+    result = sd_read_block(lba, buffer, length);
+    PMU_LEAVE();
+
+    return result;
+}
+
+/* -------------------------------------------------------------
+ * sd_read_block()
+ *
+ *  Read length / SD_BLOCK_SIZE consecutive blocks (sectors)
+ *  from the SD card
+ *
+ *  Param:  LBA number, buffer address, and its length
+ *  Return: Driver error
+ */
+#if (RPI_MODEL_ZERO==0)
+static sd_error_t sd_read_block(uint32_t lba, uint8_t *buffer, uint32_t length)
 {
     return SD_GPIO_FAIL;
 }
 #else
-sd_error_t rpi_sd_read_block(uint32_t lba, uint8_t *buffer, uint32_t length)
+static sd_error_t sd_read_block(uint32_t lba, uint8_t *buffer, uint32_t length)
 {
-    int     i;
-    uint8_t sd_response;
-    uint8_t crc_high, crc_low;
-    uint8_t input_buffer[SD_BLOCK_SIZE+2];  // Data block plus two-byte CRC
+    int         i;
+    uint32_t    block, block_count;
+    uint32_t    address;
+    uint8_t     sd_response;
+    uint8_t     crc_high, crc_low;
+    uint8_t     input_buffer[SD_BLOCK_SIZE+2];  // Data block plus two-byte CRC
+    sd_error_t  result;
 
     if ( length < SD_BLOCK_SIZE )
     {
         return SD_READ_FAIL;
     }
 
-    /* Send read command to SD card
+    block_count = length / SD_BLOCK_SIZE;
+
+    if ( sd_block_addressing )
+        address = lba;
+    else
+        address = lba * SD_BLOCK_SIZE;                      // *** SDSC uses BYTE addressing ***
+
+    /* Send read command to SD card, a multiple block read
+     * transfers consecutive blocks until it is stopped
      */
 
     bcm2835_crude_delay(500);
 
-    sd_response = sd_send_cmd(SD_READ_SINGLE_BLOCK, lba * SD_BLOCK_SIZE);   // *** SDC uses BYTE addressing ***
+    if ( block_count > 1 )
+        sd_response = sd_send_cmd(SD_READ_MULTIPLE_BLOCK, address);
+    else
+        sd_response = sd_send_cmd(SD_READ_SINGLE_BLOCK, address);
+
     if ( sd_response != SD_R1_READY )
     {
         printf("rpi_sd_read_block(): sd_send_cmd() failed %d.\n", sd_response);
         return SD_FAIL;
     }
 
-    /* Wait for start of data token (0xFE)
-     */
+    result = SD_OK;
 
-    if ( sd_wait_read_token(SD_TOKEN_START_BLOCK) == 0 )
+    for ( block = 0; block < block_count; block++ )
     {
-        printf("rpi_sd_read_block(): sd_wait_read_token() failed.\n");
-        return SD_TIMEOUT;
+        /* Wait for start of data token (0xFE)
+         */
+
+        if ( sd_wait_read_token(SD_TOKEN_START_BLOCK) == 0 )
+        {
+            printf("rpi_sd_read_block(): sd_wait_read_token() failed.\n");
+            result = SD_TIMEOUT;
+            break;
+        }
+
+        /* Read a data block (one SD sector)
+         */
+
+        for ( i = 0; i < (SD_BLOCK_SIZE+2); i++ )
+        {
+            input_buffer[i] = bcm2835_spi1_transfer_byte(SPI_FILL_BYTE);
+        }
+
+        /* Check CRC
+         */
+
+        crc_high = input_buffer[SD_BLOCK_SIZE];
+        crc_low = input_buffer[SD_BLOCK_SIZE+1];
+
+        if ( sd_get_crc16(input_buffer, SD_BLOCK_SIZE) != ((crc_high << 8) + crc_low) )
+        {
+            printf("rpi_sd_read_block(): sd_get_crc16() failed.\n");
+            result = SD_BAD_CRC;
+            break;
+        }
+
+        memcpy(&buffer[block * SD_BLOCK_SIZE], input_buffer, SD_BLOCK_SIZE);
     }
 
-    /* Read a data block (one SD sector)
+    /* Stop a multiple block read. The R1 response of CMD12 follows a stuff byte
+     * and the card may then signal busy, so only wait for it to be ready again.
      */
 
-    memset(input_buffer, SPI_FILL_BYTE, (SD_BLOCK_SIZE+2));
+    if ( block_count > 1 )
+    {
+        sd_send_cmd(SD_STOP_TRANSMISSION, 0);
+        sd_wait_ready();
+    }
+
+    return result;
+}
+#endif
 
-    for ( i = 0; i < (SD_BLOCK_SIZE+2); i++ )
+/* -------------------------------------------------------------
+ * rpi_sd_write_block()
+ *
+ *  Write a block (sector) to the SD card. A buffer length of
+ *  more than one block writes length / 512 consecutive blocks with
+ *  one multiple block write command.
+ *
+ *  Param:  LBA number, buffer address, and its length
+ *  Return: Driver error
+ */
+sd_error_t rpi_sd_write_block(uint32_t lba, uint8_t *buffer, uint32_t length)
+{
+    sd_error_t  result;
+
+    PMU_ENTER(PMU_SD);
+    result = sd_write_block(lba, buffer, length);
+    PMU_LEAVE();
+
+    return result;
+}
+
+/* -------------------------------------------------------------
+ * sd_write_block()
+ *
+ *  Write length / SD_BLOCK_SIZE consecutive blocks (sectors)
+ *  to the SD card
+ *
+ *  Param:  LBA number, buffer address, and its length
+ *  Return: Driver error
+ */
+#if (RPI_MODEL_ZERO==0)
+static sd_error_t sd_write_block(uint32_t lba, uint8_t *buffer, uint32_t length)
+{
+    return SD_GPIO_FAIL;
+}
+#else
+static sd_error_t sd_write_block(uint32_t lba, uint8_t *buffer, uint32_t length)
+{
+    int         i;
+    uint32_t    block, block_count;
+    uint32_t    address;
+    uint16_t    crc;
+    uint8_t     sd_response;
+    uint8_t     token;
+    sd_error_t  result;
+
+    if ( length < SD_BLOCK_SIZE )
     {
-        input_buffer[i] = bcm2835_spi1_transfer_byte(SPI_FILL_BYTE);
+        return SD_WRITE_FAIL;
     }
 
-    /* Check CRC
+    block_count = length / SD_BLOCK_SIZE;
+
+    if ( sd_block_addressing )
+        address = lba;
+    else
+        address = lba * SD_BLOCK_SIZE;                      // *** SDSC uses BYTE addressing ***
+
+    /* Send write command to SD card, a multiple block write
+     * takes consecutive blocks until the stop token
      */
 
-    crc_high = input_buffer[SD_BLOCK_SIZE];
-    crc_low = input_buffer[SD_BLOCK_SIZE+1];
+    if ( block_count > 1 )
+    {
+        sd_response = sd_send_cmd(SD_WRITE_MULTIPLE_BLOCK, address);
+        token = SD_TOKEN_START_MULTI;
+    }
+    else
+    {
+        sd_response = sd_send_cmd(SD_WRITE_BLOCK, address);
+        token = SD_TOKEN_START_BLOCK;
+    }
 
-    if ( sd_get_crc16(input_buffer, SD_BLOCK_SIZE) != ((crc_high << 8) + crc_low) )
+    if ( sd_response != SD_R1_READY )
     {
-        printf("rpi_sd_read_block(): sd_get_crc16() failed.\n");
-        return SD_BAD_CRC;
+        printf("rpi_sd_write_block(): sd_send_cmd() failed %d.\n", sd_response);
+        return SD_FAIL;
     }
 
-    memcpy(buffer, input_buffer, SD_BLOCK_SIZE);
+    result = SD_OK;
 
-    return SD_OK;
+    for ( block = 0; block < block_count; block++ )
+    {
+        /* One byte gap, start token, data block (one SD sector) and its CRC
+         */
+
+        bcm2835_spi1_transfer_byte(SPI_FILL_BYTE);
+        bcm2835_spi1_transfer_byte(token);
+
+        for ( i = 0; i < SD_BLOCK_SIZE; i++ )
+        {
+            bcm2835_spi1_transfer_byte(buffer[block * SD_BLOCK_SIZE + i]);
+        }
+
+        crc = sd_get_crc16(&buffer[block * SD_BLOCK_SIZE], SD_BLOCK_SIZE);
+        bcm2835_spi1_transfer_byte((uint8_t)(crc >> 8));
+        bcm2835_spi1_transfer_byte((uint8_t) crc);
+
+        /* Data response, then wait while the card is busy programming
+         */
+
+        sd_response = bcm2835_spi1_transfer_byte(SPI_FILL_BYTE);
+        if ( (sd_response & SD_DATA_RESP_MASK) != SD_DATA_ACCEPTED )
+        {
+            printf("rpi_sd_write_block(): data rejected %d.\n", sd_response);
+            result = SD_WRITE_FAIL;
+            break;
+        }
+
+        if ( sd_wait_ready() == 0 )
+        {
+            printf("rpi_sd_write_block(): sd_wait_ready() failed.\n");
+            result = SD_TIMEOUT;
+            break;
+        }
+    }
+
+    /* Stop a multiple block write, also after an error,
+     * and wait for the card to program the last block
+     */
+
+    if ( block_count > 1 )
+    {
+        bcm2835_spi1_transfer_byte(SD_TOKEN_STOP_TRAN);
+        bcm2835_spi1_transfer_byte(SPI_FILL_BYTE);
+        sd_wait_ready();
+    }
+
+    return result;
 }
 #endif
 
@@ -9,6 +9,7 @@
  *******************************************************************/
 
 #include    <stdint.h>
+#include    <string.h>
 
 #include    "mem.h"
 #include    "sam.h"
@@ -21,21 +22,13 @@
 /* -----------------------------------------
    Module static functions
 ----------------------------------------- */
-static uint8_t io_handler_vector_redirect(uint16_t address, uint8_t data, mem_operation_t op);
-static uint8_t io_handler_sam_write(uint16_t address, uint8_t data, mem_operation_t op);
+static uint8_t io_handler_vector_redirect(uint16_t address, uint8_t data, mem_operation_t op) SECTION_HOT;
+static uint8_t io_handler_sam_write(uint16_t address, uint8_t data, mem_operation_t op) SECTION_HOT;
 
 /* -----------------------------------------
    Module globals
 ----------------------------------------- */
-static struct sam_reg_t
-{
-    uint8_t vdg_mode;
-    uint8_t vdg_display_offset;
-    uint8_t page;
-    uint8_t mpu_rate;
-    uint8_t memory_size;
-    uint8_t memory_map_type;
-} sam_registers;
+static sam_state_t sam_registers;
 
 /*------------------------------------------------
  * sam_init()
@@ -58,6 +51,33 @@ void sam_init(void)
     sam_registers.memory_map_type = 0;      // For compatibility maybe future Dragon 64 emulation, not used
 }
 
+/*------------------------------------------------
+ * sam_get_state()
+ *
+ *  Get the SAM registers for a machine snapshot.
+ *
+ *  param:  Pointer to SAM state data structure
+ *  return: Nothing
+ */
+void sam_get_state(sam_state_t *sam_state)
+{
+    memcpy(sam_state, &sam_registers, sizeof(sam_state_t));
+}
+
+/*------------------------------------------------
+ * sam_set_state()
+ *
+ *  Set the SAM registers from a state saved by sam_get_state().
+ *  The VDG mode and display offset are part of the VDG state.
+ *
+ *  param:  Pointer to SAM state data structure
+ *  return: Nothing
+ */
+void sam_set_state(sam_state_t *sam_state)
+{
+    memcpy(&sam_registers, sam_state, sizeof(sam_state_t));
+}
+
 /*------------------------------------------------
  * io_handler_vector_redirect()
  *
@@ -2,17 +2,24 @@
  * sdfat32.c
  *
  *  SPI SD card reader that implements a minimal read-only driver
- *  for FAT32 file system, and an interface to read CAS and ROM
+ *  for FAT32 and exFAT file systems, and an interface to read CAS and ROM
  *  files into emulator memory.
  *
- *  This is a minimal implementation, FAT32, read only, v1.0 SD card
- *  compliant driver. The goal is functionality not performance.
+ *  This is a minimal implementation, FAT32 and exFAT, read only, SD card
+ *  driver. The goal is functionality not performance, except that
+ *  exFAT files flagged as contiguous (NoFatChain) are read by sector
+ *  arithmetic with multiple block reads, without walking the FAT.
+ *  The file system structures are never written. Modules that write
+ *  a file, like the printer capture, overwrite the sectors of an existing
+ *  file in place, which they locate with fat32_cluster_sector() and
+ *  fat32_next_cluster().
  *
  *  May 9, 2021
  *
  *******************************************************************/
 
 #include    <string.h>
+#include    <ctype.h>
 
 #include    "printf.h"
 #include    "rpi.h"
@@ -24,7 +31,23 @@
 
 #define     FAT32_SEC_SIZE          512         // Bytes
 #define     FAT32_MAX_SEC_PER_CLUS  16          // *** 1, 2, 4, 8, 16, 32, 64, 128
-#define     FAT32_END_OF_CHAIN      0x0ffffff8
+#define     FAT32_END_OF_CHAIN      0x0ffffff8  // exFAT end of chain is 0xffffffff
+
+#define     PART_TYPE_FAT32_LBA     0x0c
+#define     PART_TYPE_EXFAT         0x07
+
+#define     EXFAT_NAME              "EXFAT   "
+#define     EXFAT_SEC_SIZE_SHIFT    9           // Only 512 byte sectors are supported
+#define     EXFAT_MAX_DEPTH         16          // Directory levels for '..' navigation
+
+#define     EXFAT_ENTRY_END         0x00
+#define     EXFAT_ENTRY_IN_USE      0x80
+#define     EXFAT_ENTRY_SECONDARY   0x40
+#define     EXFAT_ENTRY_FILE        0x85
+#define     EXFAT_ENTRY_STREAM      0xc0
+#define     EXFAT_ENTRY_NAME        0xc1
+#define     EXFAT_NO_FAT_CHAIN      0x02        // Stream extension flag, file clusters are contiguous
+#define     EXFAT_NAME_CHARS        15          // UTF-16 characters per file name entry
 
 #define     FILE_ATTR_READ_ONLY     0b00000001
 #define     FILE_ATTR_HIDDEN        0b00000010
@@ -79,6 +102,30 @@ typedef struct
         // ... there is more.
     } __attribute__ ((packed)) bpb_t;
 
+/* exFAT boot sector
+ * https://learn.microsoft.com/en-us/windows/win32/fileio/exfat-specification#31-main-and-backup-boot-sector-sub-regions
+ */
+typedef struct
+    {
+        uint8_t   jump_boot[3];
+        char      file_system_name[8];
+        uint8_t   must_be_zero[53];
+        uint64_t  partition_offset;
+        uint64_t  volume_length;
+        uint32_t  fat_offset;
+        uint32_t  fat_length;
+        uint32_t  cluster_heap_offset;
+        uint32_t  cluster_count;
+        uint32_t  first_cluster_of_root_directory;
+        uint32_t  volume_serial_number;
+        uint16_t  file_system_revision;
+        uint16_t  volume_flags;
+        uint8_t   bytes_per_sector_shift;
+        uint8_t   sectors_per_cluster_shift;
+        uint8_t   number_of_fats;
+        // ... there is more.
+    } __attribute__ ((packed)) exfat_boot_t;
+
 typedef struct
 {
     char        short_dos_name[8];
@@ -96,11 +143,48 @@ typedef struct
     uint32_t    file_size_bytes;
 } __attribute__ ((packed)) dir_record_t;
 
+/* exFAT directory entries, all 32 bytes long.
+ * A file is a set of a File entry, followed by a Stream Extension
+ * entry and one or more File Name entries.
+ */
+typedef struct
+{
+    uint8_t     entry_type;
+    uint8_t     secondary_count;
+    uint16_t    set_checksum;
+    uint16_t    file_attributes;
+    uint8_t     reserved[26];
+} __attribute__ ((packed)) exfat_file_t;
+
+typedef struct
+{
+    uint8_t     entry_type;
+    uint8_t     flags;
+    uint8_t     reserved1;
+    uint8_t     name_length;
+    uint16_t    name_hash;
+    uint16_t    reserved2;
+    uint64_t    valid_data_length;
+    uint32_t    reserved3;
+    uint32_t    first_cluster;
+    uint64_t    data_length;
+} __attribute__ ((packed)) exfat_stream_t;
+
+typedef struct
+{
+    uint8_t     entry_type;
+    uint8_t     flags;
+    uint16_t    file_name[EXFAT_NAME_CHARS];
+} __attribute__ ((packed)) exfat_name_t;
+
 /* -----------------------------------------
    Module functions
 ----------------------------------------- */
+static int         fat32_parse_fat32_dir(uint32_t start_cluster, dir_entry_t *directory_list, int dir_list_length);
+static int         fat32_parse_exfat_dir(dir_entry_t *directory, dir_entry_t *directory_list, int dir_list_length);
 static fat_error_t fat32_read_cluster(uint8_t *buffer, int buffer_len, uint32_t cluster_num);
 static uint32_t    fat32_get_next_cluster_num(uint32_t cluster_num);
+static uint32_t    fat32_cluster_lba(uint32_t cluster_num);
 
 static int         dir_get_sfn(dir_record_t *dir_record, char *name, int name_length);
 static int         dir_get_lfn(dir_record_t *dir_record, char *name, int name_length);
@@ -108,10 +192,11 @@ static int         dir_get_lfn(dir_record_t *dir_record, char *name, int name_le
 /* -----------------------------------------
    Module globals
 ----------------------------------------- */
-static uint8_t  cluster_buffer[FAT32_MAX_SEC_PER_CLUS*FAT32_SEC_SIZE];
+static uint8_t  sector_buffer[FAT32_SEC_SIZE];
 
 static struct fat_param_t
 {
+    int         is_exfat;           // Volume is exFAT, otherwise FAT32
     uint32_t    first_lba;
     uint32_t    fat_begin_lba;
     uint32_t    cluster_begin_lba;
@@ -122,17 +207,25 @@ static struct fat_param_t
 static struct file_param_t
 {
     int         file_is_open;       // File open flag
+    int         is_contiguous;      // File clusters are contiguous, no FAT chain to follow
     uint32_t    file_start_cluster; // Cluster number of the first cluster of the file
     int         current_position;   // Current byte position of read pointer
-    uint32_t    current_cluster;    // Current cluster to read
+    uint32_t    current_cluster;    // Current cluster to read, not used for contiguous files
     int         file_size;          // File size in bytes
-    uint32_t    cached_cluster;     // The last successful cluster that was read, 0 is none
+    uint32_t    cached_sector;      // LBA of the sector in sector_buffer, 0 is none
 } file_parameters;
 
+/* exFAT directories have no '..' entries, so the path
+ * from the root to the current directory is kept here
+ */
+static dir_entry_t  exfat_path[EXFAT_MAX_DEPTH];
+static int          exfat_depth;
+
 /* -------------------------------------------------------------
  * fat32_init()
  *
- *  Initialize FAT32 module
+ *  Initialize FAT32 module for a FAT32 or an exFAT volume
+ *  in the first partition
  *
  *  Param:  None
  *  Return: Driver error
@@ -143,6 +236,7 @@ fat_error_t fat32_init(void)
     uint8_t    *sector;
     partition_t partitions[4];
     bpb_t       bpb;
+    exfat_boot_t exfat_boot;
 
     /* Read data block
      */
@@ -162,7 +256,8 @@ fat_error_t fat32_init(void)
     /* Read file system
      */
 
-    if ( partitions[0].type != 0x0c )
+    if ( partitions[0].type != PART_TYPE_FAT32_LBA &&
+         partitions[0].type != PART_TYPE_EXFAT )
     {
         return FAT_BAD_PARTITION_TYPE;
     }
@@ -172,27 +267,59 @@ fat_error_t fat32_init(void)
     if ( rpi_sd_read_block(fat32_parameters.first_lba, data_block_buffer, FAT32_SEC_SIZE) != SD_OK )
         return FAT_SD_FAIL;
 
-    /* Analyze BPB of first partition
-     */
     sector = data_block_buffer;
-    memcpy(&bpb, &sector[11], sizeof(bpb_t));
 
     if ( sector[510] != 0x55 || sector[511] != 0xaa )
     {
         return FAT_BAD_SECTOR_SIG;
     }
 
-    if ( bpb.sectors_per_cluster > FAT32_MAX_SEC_PER_CLUS )
+    if ( memcmp(&sector[3], EXFAT_NAME, 8) == 0 )
+    {
+        /* Analyze exFAT boot sector, the partition type 0x07
+         * is shared with NTFS so the file system name is what counts
+         */
+        memcpy(&exfat_boot, sector, sizeof(exfat_boot_t));
+
+        if ( exfat_boot.bytes_per_sector_shift != EXFAT_SEC_SIZE_SHIFT )
+        {
+            return FAT_BAD_SECTOR_SIZE;
+        }
+
+        /* Required exFAT parsing parameters.
+         * Clusters are read by sector, so there is no limit on the cluster size.
+         */
+        fat32_parameters.is_exfat = 1;
+        fat32_parameters.fat_begin_lba = fat32_parameters.first_lba + exfat_boot.fat_offset;
+        fat32_parameters.cluster_begin_lba = fat32_parameters.first_lba + exfat_boot.cluster_heap_offset;
+        fat32_parameters.sectors_per_cluster = 1 << exfat_boot.sectors_per_cluster_shift;
+        fat32_parameters.root_dir_first_cluster = exfat_boot.first_cluster_of_root_directory;
+    }
+    else if ( partitions[0].type == PART_TYPE_FAT32_LBA )
+    {
+        /* Analyze BPB of first partition
+         */
+        memcpy(&bpb, &sector[11], sizeof(bpb_t));
+
+        if ( bpb.sectors_per_cluster > FAT32_MAX_SEC_PER_CLUS )
+        {
+            return FAT_BAD_SECTOR_PER_CLUS;
+        }
+
+        /* Required FAT32 parsing parameters
+         */
+        fat32_parameters.is_exfat = 0;
+        fat32_parameters.fat_begin_lba = fat32_parameters.first_lba + bpb.reserved_sectors;
+        fat32_parameters.cluster_begin_lba = fat32_parameters.fat_begin_lba + (bpb.fat_count * bpb.logical_sectors_per_fat);
+        fat32_parameters.sectors_per_cluster = bpb.sectors_per_cluster;
+        fat32_parameters.root_dir_first_cluster = bpb.cluster_number_root_dir;
+    }
+    else
     {
-        return FAT_BAD_SECTOR_PER_CLUS;
+        return FAT_BAD_PARTITION_TYPE;
     }
 
-    /* Required FAT32 parsing parameters
-     */
-    fat32_parameters.fat_begin_lba = fat32_parameters.first_lba + bpb.reserved_sectors;
-    fat32_parameters.cluster_begin_lba = fat32_parameters.fat_begin_lba + (bpb.fat_count * bpb.logical_sectors_per_fat);
-    fat32_parameters.sectors_per_cluster = bpb.sectors_per_cluster;
-    fat32_parameters.root_dir_first_cluster = bpb.cluster_number_root_dir;
+    exfat_depth = 0;
 
     /* Clear file descriptor
      */
@@ -204,13 +331,72 @@ fat_error_t fat32_init(void)
 /* -------------------------------------------------------------
  * fat32_parse_dir()
  *
- *  Parse directory listing from input cluster into
+ *  Parse directory listing of a directory entry into
+ *  directory caching array. The directory entry may be
+ *  an element of the caching array.
+ *
+ *  Param:  Directory entry or NULL for the root directory, pointer to directory caching array and its length
+ *  Return: Count of parsed items, '-1'=error
+ */
+int fat32_parse_dir(dir_entry_t *directory, dir_entry_t *directory_list, int dir_list_length)
+{
+    dir_entry_t     parent;
+
+    if ( fat32_parameters.is_exfat == 0 )
+    {
+        if ( directory == 0 || directory->cluster_chain_head == 0 )
+            return fat32_parse_fat32_dir(fat32_parameters.root_dir_first_cluster, directory_list, dir_list_length);
+
+        return fat32_parse_fat32_dir(directory->cluster_chain_head, directory_list, dir_list_length);
+    }
+
+    /* Track the exFAT path, with a '..' entry going
+     * back to the directory before the current one
+     */
+    if ( directory == 0 )
+    {
+        exfat_depth = 0;
+    }
+    else if ( strcmp(directory->lfn, "..") == 0 )
+    {
+        if ( exfat_depth > 0 )
+            exfat_depth--;
+    }
+    else if ( exfat_depth < EXFAT_MAX_DEPTH )
+    {
+        exfat_path[exfat_depth] = *directory;
+        exfat_depth++;
+    }
+    else
+    {
+        printf("fat32_parse_dir(): exFAT directory depth exceeds %d.\n", EXFAT_MAX_DEPTH);
+        return -1;
+    }
+
+    if ( exfat_depth == 0 )
+    {
+        memset(&parent, 0, sizeof(dir_entry_t));
+        parent.is_directory = 1;
+        parent.cluster_chain_head = fat32_parameters.root_dir_first_cluster;
+    }
+    else
+    {
+        parent = exfat_path[(exfat_depth - 1)];
+    }
+
+    return fat32_parse_exfat_dir(&parent, directory_list, dir_list_length);
+}
+
+/* -------------------------------------------------------------
+ * fat32_parse_fat32_dir()
+ *
+ *  Parse FAT32 directory listing from input cluster into
  *  directory caching array
  *
  *  Param:  Directory's first cluster number, pointer to directory caching array and its length
  *  Return: Count of parsed items, '-1'=error
  */
-int fat32_parse_dir(uint32_t start_cluster, dir_entry_t *directory_list, int dir_list_length)
+static int fat32_parse_fat32_dir(uint32_t start_cluster, dir_entry_t *directory_list, int dir_list_length)
 {
     static uint8_t  cluster_buffer[FAT32_MAX_SEC_PER_CLUS*FAT32_SEC_SIZE];
 
@@ -288,15 +474,12 @@ int fat32_parse_dir(uint32_t start_cluster, dir_entry_t *directory_list, int dir
                        directory_list[cached_dir_records].sfn, FAT32_DOS_FILE_NAME);
             }
 
-            directory_list[cached_dir_records].cluster_chain_head = ((uint32_t)dir_record->fat32_high_cluster << 16) + dir_record->fat32_low_cluster;
-            /* This adjustment seems necessary because I noticed that
-             * the first sub-directory level has a '..' file with a
-             * '0' cluster number.
+            /* The '..' entry of a first level sub-directory has a '0'
+             * cluster number, which fat32_parse_dir() takes as the root directory.
              */
-            if ( directory_list[cached_dir_records].cluster_chain_head == 0 )
-                directory_list[cached_dir_records].cluster_chain_head = 2;
-
+            directory_list[cached_dir_records].cluster_chain_head = ((uint32_t)dir_record->fat32_high_cluster << 16) + dir_record->fat32_low_cluster;
             directory_list[cached_dir_records].file_size = dir_record->file_size_bytes;
+            directory_list[cached_dir_records].is_contiguous = 0;
 
             cached_dir_records++;
 
@@ -317,6 +500,160 @@ int fat32_parse_dir(uint32_t start_cluster, dir_entry_t *directory_list, int dir
     return cached_dir_records;
 }
 
+/* -------------------------------------------------------------
+ * fat32_parse_exfat_dir()
+ *
+ *  Parse exFAT directory listing into directory caching array.
+ *  The directory is read one sector at a time because exFAT clusters
+ *  can be much larger than FAT32 clusters. A '..' entry is added
+ *  ahead of the listing of any directory other than the root.
+ *  File names are converted to ASCII, with '?' for other characters.
+ *
+ *  Param:  Directory entry, pointer to directory caching array and its length
+ *  Return: Count of parsed items, '-1'=error
+ */
+static int fat32_parse_exfat_dir(dir_entry_t *directory, dir_entry_t *directory_list, int dir_list_length)
+{
+    static uint8_t  dir_sector_buffer[FAT32_SEC_SIZE];
+
+    uint8_t        *entry;
+    exfat_stream_t *stream;
+    exfat_name_t   *name;
+    dir_entry_t    *list_entry;
+    uint32_t        dir_cluster;
+    uint32_t        dir_sector;
+    uint32_t        dir_bytes;
+    int             secondary_count;
+    int             name_length;
+    int             name_index;
+    int             cached_dir_records;
+    int             i, c;
+
+    cached_dir_records = 0;
+    list_entry = 0;
+    secondary_count = 0;
+    name_length = 0;
+    name_index = 0;
+
+    if ( directory->cluster_chain_head != fat32_parameters.root_dir_first_cluster &&
+         dir_list_length > 0 )
+    {
+        memset(&directory_list[0], 0, sizeof(dir_entry_t));
+        directory_list[0].is_directory = 1;
+        strcpy(directory_list[0].lfn, "..");
+        strcpy(directory_list[0].sfn, "..");
+        cached_dir_records = 1;
+    }
+
+    dir_cluster = directory->cluster_chain_head;
+    dir_sector = 0;
+    dir_bytes = 0;
+
+    while ( cached_dir_records < dir_list_length )
+    {
+        if ( rpi_sd_read_block(fat32_cluster_lba(dir_cluster) + dir_sector, dir_sector_buffer, FAT32_SEC_SIZE) != SD_OK )
+            return -1;
+
+        for ( i = 0; i < FAT32_SEC_SIZE && cached_dir_records < dir_list_length; i += 32 )
+        {
+            entry = &dir_sector_buffer[i];
+
+            // Done
+            if ( entry[0] == EXFAT_ENTRY_END )
+                return cached_dir_records;
+
+            // Skip deleted entries, and abandon a file entry set they interrupt
+            if ( (entry[0] & EXFAT_ENTRY_IN_USE) == 0 )
+            {
+                secondary_count = 0;
+                continue;
+            }
+
+            if ( entry[0] == EXFAT_ENTRY_FILE )
+            {
+                list_entry = &directory_list[cached_dir_records];
+                memset(list_entry, 0, sizeof(dir_entry_t));
+                list_entry->is_directory = ((((exfat_file_t *) entry)->file_attributes & FILE_ATTR_DIRECTORY) ? 1 : 0);
+
+                secondary_count = ((exfat_file_t *) entry)->secondary_count;
+                name_length = 0;
+                name_index = 0;
+                continue;
+            }
+
+            // Skip volume label, allocation bitmap, up-case table and stray secondary entries
+            if ( secondary_count == 0 || (entry[0] & EXFAT_ENTRY_SECONDARY) == 0 )
+                continue;
+
+            if ( entry[0] == EXFAT_ENTRY_STREAM )
+            {
+                stream = (exfat_stream_t *) entry;
+
+                list_entry->cluster_chain_head = stream->first_cluster;
+                list_entry->is_contiguous = ((stream->flags & EXFAT_NO_FAT_CHAIN) ? 1 : 0);
+
+                if ( list_entry->is_directory )
+                    list_entry->file_size = (int) stream->data_length;
+                else if ( stream->valid_data_length > 0x7fffffff )
+                    list_entry->file_size = 0x7fffffff;
+                else
+                    list_entry->file_size = (int) stream->valid_data_length;
+
+                name_length = stream->name_length;
+                if ( name_length > (FAT32_LONG_FILE_NAME - 1) )
+                    name_length = FAT32_LONG_FILE_NAME - 1;
+            }
+            else if ( entry[0] == EXFAT_ENTRY_NAME )
+            {
+                name = (exfat_name_t *) entry;
+
+                for ( c = 0; c < EXFAT_NAME_CHARS && name_index < name_length; c++, name_index++ )
+                {
+                    if ( name->file_name[c] < 0x20 || name->file_name[c] > 0x7e )
+                        list_entry->lfn[name_index] = '?';
+                    else
+                        list_entry->lfn[name_index] = (char) name->file_name[c];
+                }
+            }
+
+            /* The file entry set is complete after its last secondary entry,
+             * exFAT has no short names so the short name is the truncated long name
+             */
+            secondary_count--;
+            if ( secondary_count == 0 )
+            {
+                list_entry->lfn[name_index] = 0;
+                for ( c = 0; c < (FAT32_DOS_FILE_NAME - 1) && list_entry->lfn[c]; c++ )
+                    list_entry->sfn[c] = list_entry->lfn[c];
+                cached_dir_records++;
+            }
+        }
+
+        /* Move to the next sector of the directory, a directory with
+         * a contiguous cluster run ends at its data length
+         */
+        dir_bytes += FAT32_SEC_SIZE;
+        if ( directory->is_contiguous && dir_bytes >= (uint32_t) directory->file_size )
+            break;
+
+        dir_sector++;
+        if ( dir_sector == fat32_parameters.sectors_per_cluster )
+        {
+            dir_sector = 0;
+
+            if ( directory->is_contiguous )
+                dir_cluster++;
+            else
+                dir_cluster = fat32_get_next_cluster_num(dir_cluster);
+
+            if ( dir_cluster >= FAT32_END_OF_CHAIN )
+                break;
+        }
+    }
+
+    return cached_dir_records;
+}
+
 /* -------------------------------------------------------------
  * fat32_fopen()
  *
@@ -333,6 +670,7 @@ int fat32_fopen(dir_entry_t *directory_entry)
         return 0;
 
     file_parameters.file_is_open = 1;
+    file_parameters.is_contiguous = directory_entry->is_contiguous;
     file_parameters.file_start_cluster = directory_entry->cluster_chain_head;
     file_parameters.current_cluster = file_parameters.file_start_cluster;
     file_parameters.current_position = 0;
@@ -351,11 +689,12 @@ int fat32_fopen(dir_entry_t *directory_entry)
 void fat32_fclose(void)
 {
     file_parameters.file_is_open = 0;
+    file_parameters.is_contiguous = 0;
     file_parameters.file_start_cluster = 0;
     file_parameters.current_cluster = 0;
     file_parameters.current_position = 0;
     file_parameters.file_size = 0;
-    file_parameters.cached_cluster = 0;
+    file_parameters.cached_sector = 0;
 }
 
 /* -------------------------------------------------------------
@@ -375,13 +714,17 @@ int fat32_fseek(int byte_position)
     if ( file_parameters.file_is_open == 0 )
         return 0;
 
-    file_parameters.cached_cluster = 0; // Invalidate read cache
-
     if ( byte_position >= file_parameters.file_size )
         return 0;
 
     file_parameters.current_position = byte_position;
 
+    /* A contiguous file is read by sector arithmetic
+     * and has no current cluster to update
+     */
+    if ( file_parameters.is_contiguous )
+        return 1;
+
     /* Update current cluster that holds the byte position
      */
     current_cluster_num = file_parameters.file_start_cluster;
@@ -407,77 +750,105 @@ int fat32_fseek(int byte_position)
  *  Read stops at end-of-file or when buffer is full.
  *  If buffer is full, then another read will continue fron
  *  the byte after the last position tht was read.
+ *  Whole sectors are read directly into the buffer, as many as the
+ *  request allows in one SD read: up to the end of the current cluster
+ *  for a file with a FAT chain, or without limit for a contiguous file.
+ *  Partial sectors go through a one sector cache.
  *
  *  Param:  Buffer for file data and the buffer length
  *  Return: Byte count read, 0=no more data (reached EOF)
  */
 int fat32_fread(uint8_t *buffer, int buffer_length)
 {
-    int         i;
     int         byte_count;
-    uint32_t    file_next_cluster;  // Actual cluster number
-    uint32_t    current_offset;     // Byte index within a cluster
+    int         remaining;
+    int         count;
+    uint32_t    bytes_per_cluster;
+    uint32_t    cluster_offset;     // Byte index within a cluster
+    uint32_t    sector_offset;      // Byte index within a sector
+    uint32_t    sector_count;
+    uint32_t    lba;
 
     if ( file_parameters.file_is_open == 0 )
         return 0;
 
-    /* Read clusters and move data into the read buffer until the buffer
+    /* Read sectors and move data into the read buffer until the buffer
      * if full of reached end of file. Update file position and current
      * cluster as we progress.
      */
     byte_count = 0;
-    current_offset = file_parameters.current_position % (fat32_parameters.sectors_per_cluster * FAT32_SEC_SIZE);
-    file_next_cluster = file_parameters.current_cluster;
+    bytes_per_cluster = fat32_parameters.sectors_per_cluster * FAT32_SEC_SIZE;
 
-    for (;;)
+    while ( byte_count < buffer_length &&
+            file_parameters.current_position < file_parameters.file_size )
     {
-        /* Read exit conditions
-         */
-        if ( byte_count == buffer_length ||
-             byte_count == file_parameters.file_size ||
-             file_parameters.current_position == file_parameters.file_size )
-        {
-            break;
-        }
+        cluster_offset = file_parameters.current_position % bytes_per_cluster;
+        sector_offset = file_parameters.current_position % FAT32_SEC_SIZE;
 
-        /* Read cluster into cache
-         */
-        if ( file_parameters.cached_cluster == 0 )
+        if ( file_parameters.is_contiguous )
+            lba = fat32_cluster_lba(file_parameters.file_start_cluster) + file_parameters.current_position / FAT32_SEC_SIZE;
+        else
+            lba = fat32_cluster_lba(file_parameters.current_cluster) + cluster_offset / FAT32_SEC_SIZE;
+
+        remaining = buffer_length - byte_count;
+        if ( remaining > (file_parameters.file_size - file_parameters.current_position) )
+            remaining = file_parameters.file_size - file_parameters.current_position;
+
+        if ( sector_offset == 0 && remaining >= FAT32_SEC_SIZE )
         {
-            if ( fat32_read_cluster(cluster_buffer, sizeof(cluster_buffer), file_next_cluster) != FAT_OK )
+            /* Read whole sectors straight into the user buffer
+             */
+            sector_count = remaining / FAT32_SEC_SIZE;
+
+            if ( file_parameters.is_contiguous == 0 &&
+                 sector_count > (bytes_per_cluster - cluster_offset) / FAT32_SEC_SIZE )
+            {
+                sector_count = (bytes_per_cluster - cluster_offset) / FAT32_SEC_SIZE;
+            }
+
+            if ( rpi_sd_read_block(lba, &buffer[byte_count], sector_count * FAT32_SEC_SIZE) != SD_OK )
             {
-                file_parameters.cached_cluster = 0;
                 byte_count = -1;
                 break;
             }
-            else
+
+            count = sector_count * FAT32_SEC_SIZE;
+        }
+        else
+        {
+            /* Read a partial sector through the sector cache
+             */
+            if ( file_parameters.cached_sector != lba )
             {
-                file_parameters.cached_cluster = file_next_cluster;
+                if ( rpi_sd_read_block(lba, sector_buffer, FAT32_SEC_SIZE) != SD_OK )
+                {
+                    file_parameters.cached_sector = 0;
+                    byte_count = -1;
+                    break;
+                }
+
+                file_parameters.cached_sector = lba;
             }
-        }
 
-        /* Fill user buffer
-         */
-        for ( i = 0; i                                < (fat32_parameters.sectors_per_cluster * FAT32_SEC_SIZE) &&
-                     byte_count                       < buffer_length &&
-                     file_parameters.current_position < file_parameters.file_size; i++ )
-        {
-            buffer[byte_count] = cluster_buffer[(i + current_offset)];
+            count = FAT32_SEC_SIZE - sector_offset;
+            if ( count > remaining )
+                count = remaining;
 
-            byte_count++;
-            file_parameters.current_position++;
+            memcpy(&buffer[byte_count], &sector_buffer[sector_offset], count);
         }
 
+        byte_count += count;
+        file_parameters.current_position += count;
+
         /* We need to prepare for getting the next cluster if we have more bytes to read
          * and we finished reading the current cluster.
          */
-        if ( file_parameters.current_position < file_parameters.file_size &&
-             (file_parameters.current_position % (fat32_parameters.sectors_per_cluster * FAT32_SEC_SIZE)) == 0 )
+        if ( file_parameters.is_contiguous == 0 &&
+             file_parameters.current_position < file_parameters.file_size &&
+             (file_parameters.current_position % bytes_per_cluster) == 0 )
         {
-            file_next_cluster = fat32_get_next_cluster_num(file_next_cluster);
-            file_parameters.current_cluster = file_next_cluster;
-            file_parameters.cached_cluster = 0;
-            if ( file_next_cluster >= FAT32_END_OF_CHAIN )
+            file_parameters.current_cluster = fat32_get_next_cluster_num(file_parameters.current_cluster);
+            if ( file_parameters.current_cluster >= FAT32_END_OF_CHAIN )
                 break;
         }
     }
@@ -517,6 +888,100 @@ int fat32_ftell(void)
     return -1;
 }
 
+/* -------------------------------------------------------------
+ * fat32_name_match()
+ *
+ *  Compare a file name to a name without case, as FAT and exFAT
+ *  file names are not case sensitive.
+ *
+ *  Param:  File name, name to match
+ *  Return: 1- match, 0- no match
+ */
+int fat32_name_match(char *name, char *match)
+{
+    while ( *name && toupper((int) *name) == toupper((int) *match) )
+    {
+        name++;
+        match++;
+    }
+
+    return (*name == 0 && *match == 0);
+}
+
+/* -------------------------------------------------------------
+ * fat32_chain_length()
+ *
+ *  Follow a FAT chain to its end and count its clusters.
+ *  Used to measure the cost of walking the FAT.
+ *
+ *  Param:  First cluster of the chain
+ *  Return: Cluster count
+ */
+int fat32_chain_length(uint32_t start_cluster)
+{
+    int         count;
+    uint32_t    cluster_num;
+
+    count = 0;
+
+    for ( cluster_num = start_cluster;
+          cluster_num >= 2 && cluster_num < FAT32_END_OF_CHAIN;
+          cluster_num = fat32_get_next_cluster_num(cluster_num) )
+    {
+        count++;
+    }
+
+    return count;
+}
+
+/* -------------------------------------------------------------
+ * fat32_cluster_bytes()
+ *
+ *  Get the cluster size of the volume.
+ *
+ *  Param:  None
+ *  Return: Cluster size in bytes
+ */
+int fat32_cluster_bytes(void)
+{
+    return fat32_parameters.sectors_per_cluster * FAT32_SEC_SIZE;
+}
+
+/* -------------------------------------------------------------
+ * fat32_cluster_sector()
+ *
+ *  Get the LBA of the first sector of a cluster, for
+ *  modules that read or write a file's sectors directly.
+ *
+ *  Param:  Cluster number
+ *  Return: LBA of the first sector of the cluster
+ */
+uint32_t fat32_cluster_sector(uint32_t cluster_num)
+{
+    return fat32_cluster_lba(cluster_num);
+}
+
+/* -------------------------------------------------------------
+ * fat32_next_cluster()
+ *
+ *  Get the cluster that follows a cluster of a file,
+ *  from the FAT, or by arithmetic for a contiguous file.
+ *
+ *  Param:  File directory entry, cluster number
+ *  Return: Next cluster number, 0=end of chain
+ */
+uint32_t fat32_next_cluster(dir_entry_t *directory_entry, uint32_t cluster_num)
+{
+    if ( directory_entry->is_contiguous )
+        return (cluster_num + 1);
+
+    cluster_num = fat32_get_next_cluster_num(cluster_num);
+    if ( cluster_num < 2 || cluster_num >= FAT32_END_OF_CHAIN )
+        return 0;
+
+    return cluster_num;
+}
+
 /* -------------------------------------------------------------
  * fat32_read_cluster()
  *
@@ -532,7 +997,7 @@ static fat_error_t fat32_read_cluster(uint8_t *buffer, int buffer_len, uint32_t
     int         buffer_index;
     uint32_t    base_cluster_lba;
 
-    base_cluster_lba = fat32_parameters.cluster_begin_lba + (cluster_num - 2) * fat32_parameters.sectors_per_cluster;
+    base_cluster_lba = fat32_cluster_lba(cluster_num);
 
     for ( i = 0, buffer_index = 0; i < fat32_parameters.sectors_per_cluster; i++, buffer_index += FAT32_SEC_SIZE )
     {
@@ -546,14 +1011,30 @@ static fat_error_t fat32_read_cluster(uint8_t *buffer, int buffer_len, uint32_t
     return FAT_OK;
 }
 
+/* -------------------------------------------------------------
+ * fat32_cluster_lba()
+ *
+ *  Convert a cluster number to the LBA of its first sector.
+ *  Clusters of a contiguous file follow each other, so any sector
+ *  of the file is at an offset from its first cluster's LBA.
+ *
+ *  Param:  Cluster number
+ *  Return: LBA of the first sector of the cluster
+ */
+static uint32_t fat32_cluster_lba(uint32_t cluster_num)
+{
+    return fat32_parameters.cluster_begin_lba + (cluster_num - 2) * fat32_parameters.sectors_per_cluster;
+}
+
 /* -------------------------------------------------------------
  * fat32_get_next_cluster_num()
  *
  *  Given a cluster number, scan the FAT32 table and find
- *  the next cluster number in the chain.
+ *  the next cluster number in the chain. The exFAT table has
+ *  the same 32-bit entries.
  *
  *  Param:  Cluster number to start scan
- *  Return: Next cluster number, or 0x0ffffff8 for end
+ *  Return: Next cluster number, or 0x0ffffff8 or higher for end
  */
 static uint32_t fat32_get_next_cluster_num(uint32_t cluster_num)
 {
@@ -0,0 +1,74 @@
+/********************************************************************
+ * snapshot.c
+ *
+ *  Machine snapshot module.
+ *  Saves and restores the emulated machine state between CPU blocks.
+ *  The snapshot is a fixed size structure that is copied as-is, so it
+ *  is only valid for the emulator build that saved it.
+ *
+ *  October 19, 2026
+ *
+ *******************************************************************/
+
+#include    <stdint.h>
+#include    <string.h>
+
+#include    "snapshot.h"
+
+/*------------------------------------------------
+ * snapshot_save()
+ *
+ *  Save the machine state into a snapshot.
+ *
+ *  param:  Pointer to snapshot
+ *  return: Nothing
+ */
+void snapshot_save(snapshot_t *snapshot)
+{
+    uint8_t    *memory;
+
+    memory = mem_get_map();
+
+    snapshot->magic = SNAPSHOT_MAGIC;
+    snapshot->version = SNAPSHOT_VERSION;
+
+    cpu_get_state(&snapshot->cpu);
+    sam_get_state(&snapshot->sam);
+    pia_get_state(&snapshot->pia);
+    vdg_get_state(&snapshot->vdg);
+
+    memcpy(snapshot->io_page, &memory[SNAPSHOT_IO_PAGE], MEM_PAGE_SIZE);
+    memcpy(snapshot->ram, memory, SNAPSHOT_RAM_SIZE);
+}
+
+/*------------------------------------------------
+ * snapshot_restore()
+ *
+ *  Restore the machine state from a snapshot.
+ *  The IO page is copied into the memory image without
+ *  calling the IO handlers.
+ *
+ *  param:  Pointer to snapshot
+ *  return: SNAPSHOT_OK, or SNAPSHOT_BAD_HEADER if the snapshot
+ *          was not saved by this snapshot version
+ */
+int snapshot_restore(snapshot_t *snapshot)
+{
+    uint8_t    *memory;
+
+    if ( snapshot->magic != SNAPSHOT_MAGIC ||
+         snapshot->version != SNAPSHOT_VERSION )
+        return SNAPSHOT_BAD_HEADER;
+
+    memory = mem_get_map();
+
+    memcpy(memory, snapshot->ram, SNAPSHOT_RAM_SIZE);
+    memcpy(&memory[SNAPSHOT_IO_PAGE], snapshot->io_page, MEM_PAGE_SIZE);
+
+    sam_set_state(&snapshot->sam);
+    pia_set_state(&snapshot->pia);
+    vdg_set_state(&snapshot->vdg);
+    cpu_set_state(&snapshot->cpu);
+
+    return SNAPSHOT_OK;
+}
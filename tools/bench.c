@@ -0,0 +1,246 @@
+/********************************************************************
+ * bench.c
+ *
+ *  Host driver for the benchmarks of bench.c.
+ *
+ *  The storage benchmark runs the SD card file system on a disk image
+ *  file in place of the SD card, for example an image of the card made
+ *  with dd. Block reads are image file reads, so the results show the
+ *  file system and FAT walking costs without the SPI transfers.
+ *
+ *  The VDG benchmark renders into a frame buffer in host memory, and its
+ *  times are host times, which are useful to compare two versions of
+ *  the render code on the same host.
+ *
+ *  Usage: bench -s image [file] | -v
+ *          -s  Run the storage benchmark on a disk image, reading a file
+ *              of the root directory, or the largest one if none is named
+ *          -v  Run the VDG render benchmark
+ *
+ *  October 19, 2026
+ *
+ *******************************************************************/
+
+#include    <stdio.h>
+#include    <stdlib.h>
+#include    <string.h>
+#include    <time.h>
+
+#include    "rpi.h"
+#include    "sdfat32.h"
+#include    "mem.h"
+#include    "vdg.h"
+#include    "bench.h"
+
+/* -----------------------------------------
+   Local definitions
+----------------------------------------- */
+#define     SECTOR_SIZE             512
+#define     DIR_ENTRIES             256
+#define     FB_WIDTH                256         // Largest VDG resolution
+#define     FB_HEIGHT               192
+
+/* -----------------------------------------
+   Module static functions
+----------------------------------------- */
+static int  storage(char *image_name, char *file_name);
+static void usage(void);
+
+/* -----------------------------------------
+   Module globals
+----------------------------------------- */
+static FILE        *image = NULL;
+static dir_entry_t  directory_list[DIR_ENTRIES];
+static uint8_t      frame_buffer[FB_WIDTH * FB_HEIGHT];
+
+/*------------------------------------------------
+ * main()
+ *
+ */
+int main(int argc, char *argv[])
+{
+    if ( argc >= 3 && strcmp(argv[1], "-s") == 0 )
+        return storage(argv[2], (argc >= 4 ? argv[3] : NULL));
+
+    if ( argc == 2 && strcmp(argv[1], "-v") == 0 )
+    {
+        mem_init();
+        vdg_init();
+        bench_vdg();
+        return 0;
+    }
+
+    usage();
+
+    return 1;
+}
+
+/*------------------------------------------------
+ * storage()
+ *
+ *  Mount the disk image, find the file and run
+ *  the storage benchmark.
+ *
+ *  param:  Disk image file name, file to read or NULL for the largest file
+ *  return: Exit status
+ */
+static int storage(char *image_name, char *file_name)
+{
+    dir_entry_t *file;
+    int         count, i, result;
+
+    if ( (image = fopen(image_name, "rb")) == NULL )
+    {
+        perror(image_name);
+        return 1;
+    }
+
+    if ( (result = fat32_init()) != FAT_OK )
+    {
+        fprintf(stderr, "bench: fat32_init() failed (%d)\n", result);
+        return 1;
+    }
+
+    if ( (count = fat32_parse_dir(NULL, directory_list, DIR_ENTRIES)) <= 0 )
+    {
+        fprintf(stderr, "bench: empty or unreadable root directory\n");
+        return 1;
+    }
+
+    file = NULL;
+
+    for ( i = 0; i < count; i++ )
+    {
+        if ( directory_list[i].is_directory )
+            continue;
+
+        if ( file_name )
+        {
+            if ( strcmp(directory_list[i].lfn, file_name) == 0 )
+                file = &directory_list[i];
+        }
+        else if ( file == NULL || directory_list[i].file_size > file->file_size )
+        {
+            file = &directory_list[i];
+        }
+    }
+
+    if ( file == NULL )
+    {
+        fprintf(stderr, "bench: file not found\n");
+        return 1;
+    }
+
+    bench_storage(file);
+
+    fclose(image);
+
+    return 0;
+}
+
+/*------------------------------------------------
+ * usage()
+ *
+ */
+static void usage(void)
+{
+    fprintf(stderr, "Usage: bench -s image [file] | -v\n");
+    fprintf(stderr, "        -s  Storage benchmark on a disk image\n");
+    fprintf(stderr, "        -v  VDG render benchmark\n");
+}
+
+/*------------------------------------------------
+ * rpi_system_timer()
+ *
+ *  Host micro-second time for the benchmarks.
+ *
+ *  param:  Nothing
+ *  return: Time in micro-seconds
+ */
+uint32_t rpi_system_timer(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint32_t)(now.tv_sec * 1000000 + now.tv_nsec / 1000);
+}
+
+/*------------------------------------------------
+ * rpi_sd_read_block()
+ *
+ *  Read length / 512 consecutive blocks from the disk image.
+ *
+ *  param:  LBA number, buffer address, and its length
+ *  return: Driver error
+ */
+sd_error_t rpi_sd_read_block(uint32_t lba, uint8_t *buffer, uint32_t length)
+{
+    uint32_t    blocks;
+
+    if ( length < SECTOR_SIZE )
+        return SD_READ_FAIL;
+
+    blocks = length / SECTOR_SIZE;
+
+    if ( fseek(image, (long) lba * SECTOR_SIZE, SEEK_SET) != 0 ||
+         fread(buffer, SECTOR_SIZE, blocks, image) != blocks )
+    {
+        return SD_READ_FAIL;
+    }
+
+    return SD_OK;
+}
+
+/*------------------------------------------------
+ * rpi_fb_init()
+ *
+ *  Host frame buffer for vdg_render().
+ *
+ *  param:  Horizontal and vertical pixels
+ *  return: Frame buffer
+ */
+uint8_t *rpi_fb_init(int h, int v)
+{
+    return frame_buffer;
+}
+
+/*------------------------------------------------
+ * rpi_fb_resolution()
+ *
+ *  All VDG resolutions fit the host frame buffer.
+ *
+ *  param:  Horizontal and vertical pixels
+ *  return: Frame buffer
+ */
+uint8_t *rpi_fb_resolution(int h, int v)
+{
+    return frame_buffer;
+}
+
+/*------------------------------------------------
+ * rpi_halt()
+ *
+ *  The emulation modules stop on a fatal error.
+ *
+ *  param:  Nothing
+ *  return: Nothing
+ */
+void rpi_halt(void)
+{
+    fprintf(stderr, "bench: rpi_halt()\n");
+    exit(2);
+}
+
+/*------------------------------------------------
+ * _putchar()
+ *
+ *  Output for printf() of the benchmark modules.
+ *
+ *  param:  Character
+ *  return: Nothing
+ */
+void _putchar(char character)
+{
+    putchar(character);
+}
@@ -0,0 +1,94 @@
+/********************************************************************
+ * blepgen.c
+ *
+ *  Host build tool that generates the polyphase band-limited step
+ *  kernel used by audio.c (AUDIO_BLEP=1).
+ *
+ *  Each phase is a Blackman windowed sinc impulse, delayed by
+ *  AUDIO_TAPS/2 samples plus the phase fraction of a sample, with a
+ *  cut-off just below the Nyquist frequency of AUDIO_SAMPLE_RATE.
+ *  audio.c adds the impulse of a DAC step into a delta buffer and
+ *  integrates the buffer into PCM samples, which turns the impulse
+ *  into a band-limited step. The taps of every phase are rounded to
+ *  sum to exactly 1 << AUDIO_KERNEL_BITS, so steps do not drift the
+ *  output level.
+ *
+ *  Usage: blepgen > blep.h
+ *
+ *  October 19, 2026
+ *
+ *******************************************************************/
+
+#include    <stdio.h>
+#include    <math.h>
+
+#include    "audio.h"
+
+/* -----------------------------------------
+   Local definitions
+----------------------------------------- */
+#define     CUTOFF                  0.45        // Fraction of the sample rate
+
+/*------------------------------------------------
+ * main()
+ *
+ */
+int main(int argc, char *argv[])
+{
+    double  impulse[AUDIO_TAPS];
+    int     taps[AUDIO_TAPS];
+    double  x, window, sum;
+    int     phase, i, total, center;
+
+    printf("/* Generated by tools/blepgen.c, do not edit.\n");
+    printf(" * %d phases of %d taps, phase sum %d\n", AUDIO_PHASES, AUDIO_TAPS, 1 << AUDIO_KERNEL_BITS);
+    printf(" */\n");
+    printf("static const int16_t blep_kernel[AUDIO_PHASES][AUDIO_TAPS] = {\n");
+
+    for ( phase = 0; phase < AUDIO_PHASES; phase++ )
+    {
+        sum = 0.0;
+
+        for ( i = 0; i < AUDIO_TAPS; i++ )
+        {
+            /* Distance in samples from the step position,
+             * and the Blackman window over the kernel span
+             */
+            x = (double)(i - AUDIO_TAPS / 2) - (double) phase / AUDIO_PHASES;
+            window = 0.42 + 0.5 * cos(M_PI * x / (AUDIO_TAPS / 2)) + 0.08 * cos(2.0 * M_PI * x / (AUDIO_TAPS / 2));
+            if ( fabs(x) >= AUDIO_TAPS / 2 )
+                window = 0.0;
+
+            if ( x == 0.0 )
+                impulse[i] = 2.0 * CUTOFF;
+            else
+                impulse[i] = sin(2.0 * M_PI * CUTOFF * x) / (M_PI * x);
+
+            impulse[i] *= window;
+            sum += impulse[i];
+        }
+
+        /* Normalize and round, then put the rounding error
+         * into the largest tap
+         */
+        total = 0;
+        center = 0;
+        for ( i = 0; i < AUDIO_TAPS; i++ )
+        {
+            taps[i] = (int) lround(impulse[i] / sum * (1 << AUDIO_KERNEL_BITS));
+            total += taps[i];
+            if ( taps[i] > taps[center] )
+                center = i;
+        }
+        taps[center] += (1 << AUDIO_KERNEL_BITS) - total;
+
+        printf("    {");
+        for ( i = 0; i < AUDIO_TAPS; i++ )
+            printf(" %6d%s", taps[i], (i < AUDIO_TAPS - 1) ? "," : "");
+        printf(" },\n");
+    }
+
+    printf("};\n");
+
+    return 0;
+}
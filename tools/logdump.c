@@ -0,0 +1,213 @@
+/********************************************************************
+ * logdump.c
+ *
+ *  Host tool that decodes the binary log of a LOG_BINARY=1 build
+ *  (see log.h) back into text.
+ *
+ *  The format table is built from the same message catalogue,
+ *  logmsg.h, that the emulator is built with. Bytes outside of
+ *  messages, such as printf() console text, are copied to the output.
+ *
+ *  Usage: logdump [-n] [-q] [log_file]
+ *          -n  Prefix messages with their message ID name
+ *          -q  Do not copy console text, print log messages only
+ *
+ *  October 19, 2026
+ *
+ *******************************************************************/
+
+#include    <stdio.h>
+#include    <stdlib.h>
+#include    <string.h>
+#include    <unistd.h>
+
+#include    "log.h"
+
+/* -----------------------------------------
+   Local definitions
+----------------------------------------- */
+#define     FORMAT_SPEC_MAX         16
+
+/* -----------------------------------------
+   Module static functions
+----------------------------------------- */
+static int  read_word(FILE *fp, uint32_t *word);
+static void print_message(int id, uint32_t *args, int count);
+
+/* -----------------------------------------
+   Module globals
+----------------------------------------- */
+static const char  *log_format[LOG_MESSAGES] = {
+#define     LOG_MESSAGE(id, format)     format,
+#include    "logmsg.h"
+#undef      LOG_MESSAGE
+};
+
+static const char  *log_name[LOG_MESSAGES] = {
+#define     LOG_MESSAGE(id, format)     #id,
+#include    "logmsg.h"
+#undef      LOG_MESSAGE
+};
+
+static long         bad_messages = 0;
+
+/*------------------------------------------------
+ * main()
+ *
+ */
+int main(int argc, char *argv[])
+{
+    FILE       *fp = stdin;
+    uint32_t    args[LOG_ARGS_MAX];
+    int         c, i, id, count, names = 0, text = 1;
+
+    while ( (c = getopt(argc, argv, "nq")) != -1 )
+    {
+        switch ( c )
+        {
+            case 'n':
+                names = 1;
+                break;
+
+            case 'q':
+                text = 0;
+                break;
+
+            default:
+                fprintf(stderr, "Usage: logdump [-n] [-q] [log_file]\n");
+                return 1;
+        }
+    }
+
+    if ( optind < argc )
+    {
+        fp = fopen(argv[optind], "rb");
+        if ( fp == NULL )
+        {
+            fprintf(stderr, "logdump: cannot open '%s'\n", argv[optind]);
+            return 1;
+        }
+    }
+
+    while ( (c = fgetc(fp)) != EOF )
+    {
+        if ( c != LOG_SYNC )
+        {
+            /* Console text, dropping the '\r' of "\r\n"
+             */
+            if ( text && c != '\r' )
+                putchar(c);
+            continue;
+        }
+
+        count = fgetc(fp);
+        id = fgetc(fp);
+        id += fgetc(fp) << 8;
+
+        if ( count < 0 || count > LOG_ARGS_MAX || id < 0 || id >= LOG_MESSAGES )
+        {
+            bad_messages++;
+            continue;
+        }
+
+        for ( i = 0; i < count; i++ )
+        {
+            if ( !read_word(fp, &args[i]) )
+                break;
+        }
+
+        if ( i < count )
+            break;
+
+        if ( names )
+            printf("%s: ", log_name[id]);
+
+        print_message(id, args, count);
+    }
+
+    if ( fp != stdin )
+        fclose(fp);
+
+    if ( bad_messages )
+        fprintf(stderr, "logdump: %ld bad message headers\n", bad_messages);
+
+    return 0;
+}
+
+/*------------------------------------------------
+ * read_word()
+ *
+ *  Read a little endian 32-bit word.
+ *
+ *  param:  Input stream and word output
+ *  return: 1- word read, 0- end of input
+ */
+static int read_word(FILE *fp, uint32_t *word)
+{
+    uint8_t bytes[4];
+
+    if ( fread(bytes, 1, 4, fp) != 4 )
+        return 0;
+
+    *word = bytes[0] + (bytes[1] << 8) + (bytes[2] << 16) + ((uint32_t) bytes[3] << 24);
+
+    return 1;
+}
+
+/*------------------------------------------------
+ * print_message()
+ *
+ *  Print a message from its format and raw arguments.
+ *  Each conversion is printed on its own, so that a signed
+ *  conversion gets a signed argument.
+ *
+ *  param:  Message ID, arguments and argument count
+ *  return: Nothing
+ */
+static void print_message(int id, uint32_t *args, int count)
+{
+    const char *format = log_format[id];
+    char        spec[FORMAT_SPEC_MAX];
+    int         i, arg = 0;
+
+    while ( *format )
+    {
+        if ( *format != '%' )
+        {
+            putchar(*format++);
+            continue;
+        }
+
+        if ( format[1] == '%' )
+        {
+            putchar('%');
+            format += 2;
+            continue;
+        }
+
+        /* Copy the conversion up to and including its type
+         */
+        i = 0;
+        do
+        {
+            spec[i++] = *format++;
+        }
+        while ( *format && i < FORMAT_SPEC_MAX - 2 && strchr("diuxXoc", *format) == NULL );
+
+        spec[i++] = *format;
+        spec[i] = 0;
+        if ( *format )
+            format++;
+
+        if ( arg >= count )
+        {
+            printf("<missing>");
+            continue;
+        }
+
+        if ( spec[i - 1] == 'd' || spec[i - 1] == 'i' )
+            printf(spec, (int32_t) args[arg++]);
+        else
+            printf(spec, args[arg++]);
+    }
+}
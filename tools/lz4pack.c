@@ -0,0 +1,536 @@
+/********************************************************************
+ * lz4pack.c
+ *
+ *  Host tool that compresses ROM and CAS images to LZ4 frames
+ *  for the SD card, see lz4.h.
+ *
+ *  Each file is written next to it with a .LZ4 extension added, as a
+ *  frame of independent 64K byte blocks without checksums. Blocks are
+ *  compressed with a hash chain search for the longest match, which is
+ *  slow to compress and as fast to decode as any LZ4 block. A block
+ *  that does not compress is stored as it is.
+ *
+ *  Every frame is read back with the reader of the emulator, lz4.c,
+ *  through the FAT32 read calls of this tool, and compared with the
+ *  original file before the next file is compressed.
+ *
+ *  Usage: lz4pack file ... | -d file.lz4 output
+ *          -d  Decompress a frame with lz4.c
+ *
+ *  October 19, 2026
+ *
+ *******************************************************************/
+
+#include    <stdio.h>
+#include    <stdlib.h>
+#include    <stdint.h>
+#include    <string.h>
+
+#include    "sdfat32.h"
+#include    "lz4.h"
+
+/* -----------------------------------------
+   Local definitions
+----------------------------------------- */
+#define     FILE_SIZE_MAX           (16 * 1024 * 1024)
+
+#define     FRAME_FLG               0x60        // Version 01, independent blocks
+#define     FRAME_BD                0x40        // 64K byte blocks
+#define     BLOCK_UNCOMPRESSED      0x80000000
+
+#define     MIN_MATCH               4
+#define     LAST_LITERALS           5           // A block ends with at least 5 literals
+#define     MATCH_LIMIT             12          // and its last match starts 12 bytes before its end
+#define     MAX_OFFSET              65535
+#define     CHAIN_DEPTH             256         // Match candidates tried at each position
+
+#define     HASH_BITS               16
+#define     HASH_SIZE               (1 << HASH_BITS)
+
+#define     XXH_PRIME1              2654435761U
+#define     XXH_PRIME2              2246822519U
+#define     XXH_PRIME3              3266489917U
+#define     XXH_PRIME5              374761393U
+
+/* -----------------------------------------
+   Module static functions
+----------------------------------------- */
+static int      pack(char *file_name);
+static int      unpack(char *file_name, char *output_name);
+static int      frame_write(FILE *output, uint8_t *data, int length);
+static int      block_compress(uint8_t *in, int length, uint8_t *out);
+static uint8_t *sequence_write(uint8_t *op, uint8_t *literals, int literal_length, int offset, int match_length);
+static uint8_t *length_write(uint8_t *op, int length);
+static uint32_t hash4(uint8_t *p);
+static uint32_t xxh32_short(uint8_t *data, int length);
+static void     le32_write(FILE *output, uint32_t value);
+static uint8_t *file_load(char *file_name, int *length);
+static void     usage(void);
+
+/* -----------------------------------------
+   Module globals
+----------------------------------------- */
+static FILE    *read_file = NULL;               // File of the fat32_ calls of lz4.c
+static int      read_file_open = 0;
+
+static int      hash_head[HASH_SIZE];
+static int      chain[LZ4_BLOCK_MAX];
+static uint8_t  block_out[LZ4_BLOCK_MAX + LZ4_BLOCK_MAX / 255 + 16];
+
+/*------------------------------------------------
+ * main()
+ *
+ */
+int main(int argc, char *argv[])
+{
+    int     i;
+
+    if ( argc == 4 && strcmp(argv[1], "-d") == 0 )
+        return unpack(argv[2], argv[3]);
+
+    if ( argc < 2 || argv[1][0] == '-' )
+    {
+        usage();
+        return 1;
+    }
+
+    for ( i = 1; i < argc; i++ )
+    {
+        if ( !pack(argv[i]) )
+            return 1;
+    }
+
+    return 0;
+}
+
+/*------------------------------------------------
+ * pack()
+ *
+ *  Compress a file to an LZ4 frame, and check that
+ *  lz4.c reads the frame back as the file.
+ *
+ *  param:  File name
+ *  return: 1- ok, 0- failed
+ */
+static int pack(char *file_name)
+{
+    FILE       *output;
+    uint8_t    *data, *check;
+    char       *frame_name;
+    int         length, frame_length, check_length;
+    dir_entry_t entry;
+
+    if ( (data = file_load(file_name, &length)) == NULL )
+        return 0;
+
+    frame_name = malloc(strlen(file_name) + 5);
+    sprintf(frame_name, "%s.LZ4", file_name);
+
+    if ( (output = fopen(frame_name, "wb")) == NULL )
+    {
+        perror(frame_name);
+        return 0;
+    }
+
+    frame_length = frame_write(output, data, length);
+    fclose(output);
+
+    /* Read the frame back with the emulator's reader
+     */
+    check = malloc(length + 1);
+    if ( (read_file = fopen(frame_name, "rb")) == NULL || !lz4_fopen(&entry) )
+    {
+        fprintf(stderr, "lz4pack: %s: cannot read back\n", frame_name);
+        return 0;
+    }
+
+    check_length = lz4_fread(check, length + 1);
+    lz4_fclose();
+
+    if ( check_length != length || memcmp(check, data, length) != 0 )
+    {
+        fprintf(stderr, "lz4pack: %s: does not read back as %s\n", frame_name, file_name);
+        return 0;
+    }
+
+    printf("%s: %d to %d bytes, %d%%\n", frame_name, length, frame_length,
+            (length ? (100 * frame_length) / length : 100));
+
+    free(check);
+    free(data);
+    free(frame_name);
+
+    return 1;
+}
+
+/*------------------------------------------------
+ * unpack()
+ *
+ *  Decompress an LZ4 frame with lz4.c.
+ *
+ *  param:  Frame file name, output file name
+ *  return: Exit status
+ */
+static int unpack(char *file_name, char *output_name)
+{
+    FILE       *output;
+    uint8_t     buffer[LZ4_BLOCK_MAX];
+    int         count;
+    dir_entry_t entry;
+
+    if ( (read_file = fopen(file_name, "rb")) == NULL )
+    {
+        perror(file_name);
+        return 1;
+    }
+
+    if ( !lz4_fopen(&entry) || !lz4_is_compressed() )
+    {
+        fprintf(stderr, "lz4pack: %s: not a supported LZ4 frame\n", file_name);
+        return 1;
+    }
+
+    if ( (output = fopen(output_name, "wb")) == NULL )
+    {
+        perror(output_name);
+        return 1;
+    }
+
+    while ( (count = lz4_fread(buffer, sizeof(buffer))) > 0 )
+        fwrite(buffer, 1, count, output);
+
+    fclose(output);
+    lz4_fclose();
+
+    if ( count < 0 )
+    {
+        fprintf(stderr, "lz4pack: %s: bad block\n", file_name);
+        return 1;
+    }
+
+    return 0;
+}
+
+/*------------------------------------------------
+ * frame_write()
+ *
+ *  Write data as an LZ4 frame.
+ *
+ *  param:  Output file, data and its length
+ *  return: Frame length in bytes
+ */
+static int frame_write(FILE *output, uint8_t *data, int length)
+{
+    uint8_t     descriptor[2] = { FRAME_FLG, FRAME_BD };
+    int         frame_length, position, block_length, compressed_length;
+
+    le32_write(output, LZ4_MAGIC);
+    fwrite(descriptor, 1, 2, output);
+    fputc((xxh32_short(descriptor, 2) >> 8) & 0xff, output);
+    frame_length = 7;
+
+    for ( position = 0; position < length; position += block_length )
+    {
+        block_length = length - position;
+        if ( block_length > LZ4_BLOCK_MAX )
+            block_length = LZ4_BLOCK_MAX;
+
+        compressed_length = block_compress(&data[position], block_length, block_out);
+
+        if ( compressed_length < block_length )
+        {
+            le32_write(output, compressed_length);
+            fwrite(block_out, 1, compressed_length, output);
+            frame_length += 4 + compressed_length;
+        }
+        else
+        {
+            le32_write(output, block_length | BLOCK_UNCOMPRESSED);
+            fwrite(&data[position], 1, block_length, output);
+            frame_length += 4 + block_length;
+        }
+    }
+
+    le32_write(output, 0);
+
+    return frame_length + 4;
+}
+
+/*------------------------------------------------
+ * block_compress()
+ *
+ *  Compress a block. Positions with the same hash of their
+ *  next 4 bytes are linked in a chain, and at each position the
+ *  longest match of up to CHAIN_DEPTH candidates is taken.
+ *
+ *  param:  Block and its length, output buffer
+ *  return: Compressed length
+ */
+static int block_compress(uint8_t *in, int length, uint8_t *out)
+{
+    uint8_t    *op;
+    uint32_t    hash;
+    int         anchor, position, candidate, depth;
+    int         match_length, match_offset, best_length, best_offset;
+    int         match_end, i;
+
+    for ( i = 0; i < HASH_SIZE; i++ )
+        hash_head[i] = -1;
+
+    op = out;
+    anchor = 0;
+    position = 0;
+    match_end = length - LAST_LITERALS;
+
+    while ( position < (length - MATCH_LIMIT) )
+    {
+        best_length = 0;
+        best_offset = 0;
+
+        hash = hash4(&in[position]);
+        candidate = hash_head[hash];
+
+        for ( depth = 0; candidate >= 0 && depth < CHAIN_DEPTH; depth++ )
+        {
+            match_offset = position - candidate;
+            if ( match_offset > MAX_OFFSET )
+                break;
+
+            for ( match_length = 0;
+                  (position + match_length) < match_end && in[candidate + match_length] == in[position + match_length];
+                  match_length++ );
+
+            if ( match_length > best_length )
+            {
+                best_length = match_length;
+                best_offset = match_offset;
+            }
+
+            candidate = chain[candidate];
+        }
+
+        if ( best_length < MIN_MATCH )
+        {
+            chain[position] = hash_head[hash];
+            hash_head[hash] = position;
+            position++;
+            continue;
+        }
+
+        op = sequence_write(op, &in[anchor], position - anchor, best_offset, best_length);
+
+        for ( i = 0; i < best_length && (position + i) < (length - MATCH_LIMIT); i++ )
+        {
+            hash = hash4(&in[position + i]);
+            chain[position + i] = hash_head[hash];
+            hash_head[hash] = position + i;
+        }
+
+        position += best_length;
+        anchor = position;
+    }
+
+    /* Last literals
+     */
+    op = sequence_write(op, &in[anchor], length - anchor, 0, 0);
+
+    return (int)(op - out);
+}
+
+/*------------------------------------------------
+ * sequence_write()
+ *
+ *  Write a sequence of literals and a match,
+ *  or the last literals of a block when there is no match.
+ *
+ *  param:  Output position, literals and their length, match offset and length
+ *  return: Next output position
+ */
+static uint8_t *sequence_write(uint8_t *op, uint8_t *literals, int literal_length, int offset, int match_length)
+{
+    uint8_t    *token;
+
+    token = op++;
+    *token = (literal_length < 15 ? literal_length : 15) << 4;
+
+    if ( literal_length >= 15 )
+        op = length_write(op, literal_length - 15);
+
+    memcpy(op, literals, literal_length);
+    op += literal_length;
+
+    if ( match_length == 0 )
+        return op;
+
+    *op++ = offset & 0xff;
+    *op++ = offset >> 8;
+
+    match_length -= MIN_MATCH;
+    *token |= (match_length < 15 ? match_length : 15);
+
+    if ( match_length >= 15 )
+        op = length_write(op, match_length - 15);
+
+    return op;
+}
+
+/*------------------------------------------------
+ * length_write()
+ *
+ *  Write the continuation bytes of a length of 15 or more.
+ *
+ *  param:  Output position, length minus 15
+ *  return: Next output position
+ */
+static uint8_t *length_write(uint8_t *op, int length)
+{
+    while ( length >= 255 )
+    {
+        *op++ = 255;
+        length -= 255;
+    }
+
+    *op++ = (uint8_t) length;
+
+    return op;
+}
+
+/*------------------------------------------------
+ * hash4()
+ *
+ *  Hash of the 4 bytes at a position.
+ *
+ *  param:  Pointer to bytes
+ *  return: Hash, HASH_BITS wide
+ */
+static uint32_t hash4(uint8_t *p)
+{
+    uint32_t    value;
+
+    value = p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t) p[3] << 24);
+
+    return (value * XXH_PRIME1) >> (32 - HASH_BITS);
+}
+
+/*------------------------------------------------
+ * xxh32_short()
+ *
+ *  xxHash32 with seed 0 of less than 4 bytes, for the
+ *  frame header checksum.
+ *
+ *  param:  Data and its length
+ *  return: Hash
+ */
+static uint32_t xxh32_short(uint8_t *data, int length)
+{
+    uint32_t    hash;
+    int         i;
+
+    hash = XXH_PRIME5 + (uint32_t) length;
+
+    for ( i = 0; i < length; i++ )
+    {
+        hash += data[i] * XXH_PRIME5;
+        hash = ((hash << 11) | (hash >> 21)) * XXH_PRIME1;
+    }
+
+    hash ^= hash >> 15;
+    hash *= XXH_PRIME2;
+    hash ^= hash >> 13;
+    hash *= XXH_PRIME3;
+    hash ^= hash >> 16;
+
+    return hash;
+}
+
+/*------------------------------------------------
+ * le32_write()
+ *
+ *  Write a little endian 32-bit value.
+ *
+ *  param:  Output file, value
+ *  return: Nothing
+ */
+static void le32_write(FILE *output, uint32_t value)
+{
+    fputc(value & 0xff, output);
+    fputc((value >> 8) & 0xff, output);
+    fputc((value >> 16) & 0xff, output);
+    fputc((value >> 24) & 0xff, output);
+}
+
+/*------------------------------------------------
+ * file_load()
+ *
+ *  Read a file into memory.
+ *
+ *  param:  File name, pointer to its length
+ *  return: File data, NULL on error
+ */
+static uint8_t *file_load(char *file_name, int *length)
+{
+    FILE       *input;
+    uint8_t    *data;
+
+    if ( (input = fopen(file_name, "rb")) == NULL )
+    {
+        perror(file_name);
+        return NULL;
+    }
+
+    data = malloc(FILE_SIZE_MAX);
+    *length = (int) fread(data, 1, FILE_SIZE_MAX, input);
+    fclose(input);
+
+    if ( *length == FILE_SIZE_MAX )
+    {
+        fprintf(stderr, "lz4pack: %s: larger than %d bytes\n", file_name, FILE_SIZE_MAX);
+        return NULL;
+    }
+
+    return data;
+}
+
+/*------------------------------------------------
+ * usage()
+ *
+ */
+static void usage(void)
+{
+    fprintf(stderr, "Usage: lz4pack file ... | -d file.lz4 output\n");
+    fprintf(stderr, "        Compress files to file.LZ4\n");
+    fprintf(stderr, "        -d  Decompress a frame with lz4.c\n");
+}
+
+/********************************************************************
+ *  FAT32 read calls of lz4.c, on the host file 'read_file'
+ */
+
+int fat32_fopen(dir_entry_t *directory_entry)
+{
+    if ( read_file == NULL || read_file_open )
+        return 0;
+
+    read_file_open = 1;
+
+    return 1;
+}
+
+void fat32_fclose(void)
+{
+    if ( read_file )
+        fclose(read_file);
+
+    read_file = NULL;
+    read_file_open = 0;
+}
+
+int fat32_fseek(int byte_position)
+{
+    return (fseek(read_file, byte_position, SEEK_SET) == 0);
+}
+
+int fat32_fread(uint8_t *buffer, int buffer_length)
+{
+    return (int) fread(buffer, 1, buffer_length, read_file);
+}
@@ -0,0 +1,178 @@
+/********************************************************************
+ * pixcheck.c
+ *
+ *  Host tool that verifies the pixel expansion kernels of pixel.c
+ *  against a pixel by pixel reference, for every video byte value,
+ *  every color pair or palette, and both horizontal scales.
+ *
+ *  Build with -DPIXEL_PORTABLE to check the portable kernel on a host
+ *  that has ARMv6 SIMD. The ARMv6 kernel itself can only be checked
+ *  by building this tool for an ARMv6 target.
+ *
+ *  Usage: pixcheck
+ *
+ *  October 19, 2026
+ *
+ *******************************************************************/
+
+#include    <stdio.h>
+#include    <stdlib.h>
+#include    <string.h>
+
+#include    "pixel.h"
+
+/* -----------------------------------------
+   Local definitions
+----------------------------------------- */
+#define     COLORS                  16          // 8-bit palette entries used by the VDG
+#define     VIDEO_BYTES             256         // All video byte values
+#define     FB_BYTES                (VIDEO_BYTES * 8 * PIXEL_SCALE_MAX)
+
+/* -----------------------------------------
+   Module static functions
+----------------------------------------- */
+static void ref_expand_1bpp(uint8_t *dst, const uint8_t *src, int count, int fg_color, int bg_color, int scale);
+static void ref_expand_2bpp(uint8_t *dst, const uint8_t *src, int count, const int *palette, int scale);
+static int  compare(const char *kernel, const uint8_t *expected, const uint8_t *result, int length);
+
+/* -----------------------------------------
+   Module globals
+----------------------------------------- */
+static uint8_t  video[VIDEO_BYTES];
+static uint32_t fb_expected[FB_BYTES / 4];
+static uint32_t fb_result[FB_BYTES / 4];
+
+static long     checks = 0;
+static long     errors = 0;
+
+/*------------------------------------------------
+ * main()
+ *
+ */
+int main(int argc, char *argv[])
+{
+    int     palette[4];
+    int     fg, bg, scale, i;
+
+    for ( i = 0; i < VIDEO_BYTES; i++ )
+        video[i] = (uint8_t) i;
+
+    for ( scale = 1; scale <= PIXEL_SCALE_MAX; scale++ )
+    {
+        for ( fg = 0; fg < COLORS; fg++ )
+        {
+            for ( bg = 0; bg < COLORS; bg++ )
+            {
+                memset(fb_expected, 0, sizeof(fb_expected));
+                memset(fb_result, 0, sizeof(fb_result));
+
+                ref_expand_1bpp((uint8_t *) fb_expected, video, VIDEO_BYTES, fg, bg, scale);
+                pixel_expand_1bpp((uint8_t *) fb_result, video, VIDEO_BYTES, fg, bg, scale);
+
+                compare("pixel_expand_1bpp", (uint8_t *) fb_expected, (uint8_t *) fb_result, VIDEO_BYTES * 8 * scale);
+            }
+        }
+
+        for ( i = 0; i < COLORS * COLORS; i++ )
+        {
+            palette[0] = i % COLORS;
+            palette[1] = i / COLORS;
+            palette[2] = (i * 7 + 3) % COLORS;
+            palette[3] = (i * 11 + 5) % COLORS;
+
+            memset(fb_expected, 0, sizeof(fb_expected));
+            memset(fb_result, 0, sizeof(fb_result));
+
+            ref_expand_2bpp((uint8_t *) fb_expected, video, VIDEO_BYTES, palette, scale);
+            pixel_expand_2bpp((uint8_t *) fb_result, video, VIDEO_BYTES, palette, scale);
+
+            compare("pixel_expand_2bpp", (uint8_t *) fb_expected, (uint8_t *) fb_result, VIDEO_BYTES * 4 * scale);
+        }
+    }
+
+    printf("pixcheck: %s kernel, %ld checks, %ld errors\n", pixel_kernel_name(), checks, errors);
+
+    return (errors != 0);
+}
+
+/*------------------------------------------------
+ * ref_expand_1bpp()
+ *
+ *  Reference 1 bit per pixel expansion, one pixel at a time.
+ *
+ *  param:  Same as pixel_expand_1bpp()
+ *  return: Nothing
+ */
+static void ref_expand_1bpp(uint8_t *dst, const uint8_t *src, int count, int fg_color, int bg_color, int scale)
+{
+    int     i, element, s;
+    int     color;
+
+    for ( i = 0; i < count; i++ )
+    {
+        for ( element = 0; element < 8; element++ )
+        {
+            if ( (src[i] >> (7 - element)) & 0x01 )
+                color = fg_color;
+            else
+                color = bg_color;
+
+            for ( s = 0; s < scale; s++ )
+                *dst++ = (uint8_t) color;
+        }
+    }
+}
+
+/*------------------------------------------------
+ * ref_expand_2bpp()
+ *
+ *  Reference 2 bits per pixel expansion, one pixel at a time.
+ *
+ *  param:  Same as pixel_expand_2bpp()
+ *  return: Nothing
+ */
+static void ref_expand_2bpp(uint8_t *dst, const uint8_t *src, int count, const int *palette, int scale)
+{
+    int     i, element, s;
+    int     color;
+
+    for ( i = 0; i < count; i++ )
+    {
+        for ( element = 0; element < 4; element++ )
+        {
+            color = palette[(src[i] >> (2 * (3 - element))) & 0x03];
+
+            for ( s = 0; s < scale; s++ )
+                *dst++ = (uint8_t) color;
+        }
+    }
+}
+
+/*------------------------------------------------
+ * compare()
+ *
+ *  Compare kernel output to the reference and report
+ *  the first mismatch.
+ *
+ *  param:  Kernel name, reference and kernel output, length in bytes
+ *  return: 1- match, 0- mismatch
+ */
+static int compare(const char *kernel, const uint8_t *expected, const uint8_t *result, int length)
+{
+    int     i;
+
+    checks++;
+
+    for ( i = 0; i < length; i++ )
+    {
+        if ( expected[i] != result[i] )
+        {
+            if ( errors == 0 )
+                printf("%s: byte %d expected %02x got %02x\n", kernel, i, expected[i], result[i]);
+            errors++;
+            return 0;
+        }
+    }
+
+    return 1;
+}
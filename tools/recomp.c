@@ -0,0 +1,761 @@
+/********************************************************************
+ * recomp.c
+ *
+ *  Host build tool that statically recompiles the Dragon 32 BASIC ROM
+ *  into C functions, one function per basic block.
+ *
+ *  The ROM image is taken from dragon/dragon.h and op-code attributes
+ *  from mc6809e.h. Code is discovered by recursive descent from the
+ *  ROM jump table at 0x8000, the ROM interrupt vectors and any entry
+ *  addresses given on the command line, followed by a sweep of the
+ *  remaining ROM bytes for instruction sequences that end in a control
+ *  transfer. Every decoded instruction is
+ *  emitted as a 'case' label of its block's switch-case so that a block
+ *  can be entered at any instruction, and is added to a PC lookup table.
+ *
+ *  The output is included by cpu.c when built with CPU_ROM_RECOMP=1,
+ *  and the generated code relies on cpu.c module static functions:
+ *  each instruction resolves its effective address as get_eff_addr()
+ *  would, with operands and cycle counts fixed at build time, and then
+ *  calls exec_op_code() with a constant op-code.
+ *
+ *  Usage: recomp [-n] [entry_address ...] > recomp.h
+ *          -n  Recursive descent only, no sweep of the remaining ROM
+ *
+ *  October 18, 2026
+ *
+ *******************************************************************/
+
+#include    <stdio.h>
+#include    <stdlib.h>
+#include    <string.h>
+
+#include    "mc6809e.h"
+#include    "dragon/dragon.h"
+
+/* -----------------------------------------
+   Local definitions
+----------------------------------------- */
+#define     ROM_BASE                0x8000
+#define     ROM_SIZE                0x4000
+#define     ROM_END                 (ROM_BASE + ROM_SIZE - 1)
+
+#define     ROM_VECTORS             0xbff2      // SWI3 to RESET vectors at the top of the ROM
+#define     ROM_JUMP_TABLE          0x8000      // ROM entry points table of 'JMP' op-codes
+
+#define     OP_JMP_EXTENDED         0x7e
+
+#define     SWEEP_MAX_INSTR         32          // Sweep sequence length to reach a control transfer
+
+/* Instruction flow attributes
+ */
+#define     FLOW_NEXT               0x01        // Execution may continue with next instruction
+#define     FLOW_TARGET             0x02        // Instruction has a static branch/jump target
+#define     FLOW_END                0x04        // Instruction ends a block
+#define     FLOW_CHECK              0x08        // Instruction may require cpu_run() before the next one
+
+#define     IO_PAGE                 0xff00      // Start of IO address range
+
+/* Indexed addressing post-byte bit fields, as in cpu.c
+ */
+#define     INDX_POST_5BIT_OFF      0x80
+#define     INDX_POST_REG           0x60
+#define     INDX_POST_INDIRECT      0x10
+#define     INDX_POST_MODE          0x0f
+
+typedef struct
+{
+    int     address;
+    int     prefix;         // 0, 0x10 or 0x11
+    int     op_code;
+    int     table_index;    // Index into machine_code[]
+    int     length;         // Byte count including prefix and operands
+    int     cycles;         // Table cycles plus static indexed addressing cycles
+    int     operand;        // Operand bytes after op-code and post-byte
+    int     post_byte;
+    int     target;         // Static branch/jump target
+    int     flow;
+} instruction_t;
+
+/* -----------------------------------------
+   Module static functions
+----------------------------------------- */
+static int  rom_byte(int address);
+static int  decode(int address, instruction_t *instr);
+static void discover(int address);
+static void descend(void);
+static int  is_code(int address);
+static int  next_in_block(instruction_t *instr);
+static void emit_block(int address);
+static void emit_indexed(instruction_t *instr);
+
+/* -----------------------------------------
+   Module globals
+----------------------------------------- */
+static instruction_t    instructions[ROM_SIZE];
+static int              decoded[ROM_SIZE];
+static int              covered[ROM_SIZE];      // ROM bytes of decoded instructions
+static int              fall_in[ROM_SIZE];      // Count of instructions falling through into address
+static int              block_head[ROM_SIZE];   // Block function containing the instruction
+
+static int              work_list[ROM_SIZE];
+static int              work_count = 0;
+
+static const char      *index_reg_name[] = { "cpu.x", "cpu.y", "cpu.u", "cpu.s" };
+
+/*------------------------------------------------
+ * main()
+ *
+ */
+int main(int argc, char *argv[])
+{
+    int     i, address, block_count = 0, instr_count = 0, sweep = 1;
+
+    if ( sizeof(code) / sizeof(int) < ROM_SIZE || LOAD_ADDRESS != ROM_BASE )
+    {
+        fprintf(stderr, "recomp: ROM image in dragon.h is not a 16K image at 0x%04x\n", ROM_BASE);
+        return 1;
+    }
+
+    /* Entry points: ROM jump table, interrupt vectors, command line
+     */
+    for ( address = ROM_JUMP_TABLE; rom_byte(address) == OP_JMP_EXTENDED; address += 3 )
+        discover(address);
+
+    for ( address = ROM_VECTORS; address < ROM_END; address += 2 )
+        discover((rom_byte(address) << 8) + rom_byte(address + 1));
+
+    for ( i = 1; i < argc; i++ )
+    {
+        if ( strcmp(argv[i], "-n") == 0 )
+        {
+            sweep = 0;
+            continue;
+        }
+
+        address = (int) strtol(argv[i], NULL, 16);
+        if ( address < ROM_BASE || address > ROM_END )
+        {
+            fprintf(stderr, "recomp: entry address '%s' is outside the ROM\n", argv[i]);
+            return 1;
+        }
+        discover(address);
+    }
+
+    descend();
+
+    /* Code that is only reached through computed jumps, such as the BASIC
+     * command dispatch tables and the RAM interrupt hooks, is found by a
+     * sweep of the remaining ROM bytes. A wrong guess only costs code size,
+     * since a block entered at any address executes the same ROM bytes
+     * cpu_run() would.
+     */
+    if ( sweep )
+    {
+        for ( address = ROM_BASE; address <= ROM_END; address++ )
+        {
+            if ( !covered[address - ROM_BASE] && is_code(address) )
+            {
+                discover(address);
+                descend();
+            }
+        }
+    }
+
+    /* An instruction opens a new block unless it is the only fall-through
+     * destination of the previous instruction in the block.
+     */
+    for ( address = ROM_BASE; address <= ROM_END; address++ )
+    {
+        instruction_t  *instr = &instructions[address - ROM_BASE];
+
+        if ( decoded[address - ROM_BASE] && !(instr->flow & FLOW_END) &&
+             (address + instr->length) <= ROM_END && decoded[address + instr->length - ROM_BASE] )
+        {
+            fall_in[address + instr->length - ROM_BASE]++;
+        }
+    }
+
+    printf("/********************************************************************\n");
+    printf(" * recomp.h\n");
+    printf(" *\n");
+    printf(" * Generated by tools/recomp from dragon.h, do not edit.\n");
+    printf(" *\n");
+    printf(" * Statically recompiled ROM blocks, included by cpu.c when\n");
+    printf(" * built with CPU_ROM_RECOMP=1.\n");
+    printf(" *\n");
+    printf(" *******************************************************************/\n\n");
+    printf("#define     ROM_RECOMP_BASE     0x%04x\n", ROM_BASE);
+    printf("#define     ROM_RECOMP_SIZE     0x%04x\n\n", ROM_SIZE);
+
+    for ( address = ROM_BASE; address <= ROM_END; address++ )
+    {
+        int     head = address - ROM_BASE;
+
+        if ( !decoded[head] || fall_in[head] == 1 )
+            continue;
+
+        emit_block(address);
+        block_count++;
+    }
+
+    printf("static const rom_block_t rom_block_table[ROM_RECOMP_SIZE] =\n{\n");
+    for ( address = ROM_BASE; address <= ROM_END; address++ )
+    {
+        if ( !decoded[address - ROM_BASE] )
+            continue;
+
+        printf("    [0x%04x] = rom_block_%04x,\n", address - ROM_BASE, block_head[address - ROM_BASE]);
+        instr_count++;
+    }
+    printf("};\n");
+
+    fprintf(stderr, "recomp: %d instructions in %d blocks\n", instr_count, block_count);
+
+    return 0;
+}
+
+/*------------------------------------------------
+ * rom_byte()
+ *
+ *  Read a ROM byte.
+ *
+ *  param:  Address in ROM
+ *  return: Byte value, -1 if address is outside the ROM
+ */
+static int rom_byte(int address)
+{
+    if ( address < ROM_BASE || address > ROM_END )
+        return -1;
+
+    return code[address - ROM_BASE] & 0xff;
+}
+
+/*------------------------------------------------
+ * decode()
+ *
+ *  Decode an instruction and classify its control flow.
+ *  Op-codes and indexing modes that cpu_run() would flag as
+ *  illegal are not recompiled and are left to cpu_run().
+ *
+ *  param:  Instruction address, pointer to instruction record
+ *  return: 1- decoded, 0- illegal or extends past the ROM
+ */
+static int decode(int address, instruction_t *instr)
+{
+    int     pc, i, first, last, mode;
+
+    memset(instr, 0, sizeof(instruction_t));
+    instr->address = address;
+
+    pc = address;
+    instr->op_code = rom_byte(pc++);
+
+    if ( instr->op_code == 0x10 || instr->op_code == 0x11 )
+    {
+        instr->prefix = instr->op_code;
+        instr->op_code = rom_byte(pc++);
+
+        first = (instr->prefix == 0x10) ? OP_CODE10 : OP_CODE11;
+        last = (instr->prefix == 0x10) ? OP_CODE11 : (int)(sizeof(machine_code) / sizeof(machine_code_t));
+
+        for ( i = first; i < last; i++ )
+            if ( machine_code[i].op == instr->op_code )
+                break;
+
+        if ( i == last )
+            return 0;
+
+        instr->table_index = i;
+    }
+    else
+    {
+        instr->table_index = instr->op_code;
+    }
+
+    if ( instr->op_code < 0 )
+        return 0;
+
+    mode = machine_code[instr->table_index].mode;
+    instr->cycles = machine_code[instr->table_index].cycles;
+
+    switch ( mode )
+    {
+        case ADDR_INHERENT:
+            break;
+
+        case ADDR_DIRECT:
+        case ADDR_IMMEDIATE:
+            instr->operand = rom_byte(pc++);
+            break;
+
+        case ADDR_RELATIVE:
+            instr->operand = rom_byte(pc++);
+            instr->target = (pc + (int8_t) instr->operand) & 0xffff;
+            break;
+
+        case ADDR_LRELATIVE:
+            instr->operand = (rom_byte(pc) << 8) + rom_byte(pc + 1);
+            pc += 2;
+            instr->target = (pc + instr->operand) & 0xffff;
+            break;
+
+        case ADDR_EXTENDED:
+        case ADDR_LIMMEDIATE:
+            instr->operand = (rom_byte(pc) << 8) + rom_byte(pc + 1);
+            pc += 2;
+            break;
+
+        case ADDR_INDEXED:
+            instr->post_byte = rom_byte(pc++);
+
+            if ( !(instr->post_byte & INDX_POST_5BIT_OFF) )
+            {
+                instr->cycles += 1;
+                break;
+            }
+
+            switch ( instr->post_byte & INDX_POST_MODE )
+            {
+                case 0:
+                case 2:
+                    instr->cycles += 2;
+                    break;
+
+                case 1:
+                case 3:
+                    instr->cycles += (instr->post_byte & INDX_POST_INDIRECT) ? 6 : 3;
+                    break;
+
+                case 4:
+                    instr->cycles += (instr->post_byte & INDX_POST_INDIRECT) ? 3 : 0;
+                    break;
+
+                case 5:
+                case 6:
+                    instr->cycles += (instr->post_byte & INDX_POST_INDIRECT) ? 4 : 1;
+                    break;
+
+                case 8:
+                case 12:
+                    instr->operand = rom_byte(pc++);
+                    instr->cycles += (instr->post_byte & INDX_POST_INDIRECT) ? 4 : 1;
+                    break;
+
+                case 9:
+                    instr->operand = (rom_byte(pc) << 8) + rom_byte(pc + 1);
+                    pc += 2;
+                    instr->cycles += (instr->post_byte & INDX_POST_INDIRECT) ? 7 : 4;
+                    break;
+
+                case 11:
+                    instr->cycles += (instr->post_byte & INDX_POST_INDIRECT) ? 7 : 4;
+                    break;
+
+                case 13:
+                    instr->operand = (rom_byte(pc) << 8) + rom_byte(pc + 1);
+                    pc += 2;
+                    instr->cycles += (instr->post_byte & INDX_POST_INDIRECT) ? 8 : 5;
+                    break;
+
+                case 15:
+                    instr->operand = (rom_byte(pc) << 8) + rom_byte(pc + 1);
+                    pc += 2;
+                    instr->cycles += 5;
+                    break;
+
+                default:
+                    return 0;
+            }
+            break;
+
+        default:
+            return 0;
+    }
+
+    instr->length = pc - address;
+
+    if ( (pc - 1) > ROM_END || instr->operand < 0 || instr->post_byte < 0 )
+        return 0;
+
+    /* Control flow.
+     * A memory access may reach an IO handler that changes interrupt lines,
+     * other instructions that need a check change CC or the CPU state.
+     */
+    instr->flow = FLOW_NEXT;
+
+    if ( mode == ADDR_DIRECT || mode == ADDR_INDEXED ||
+         (mode == ADDR_EXTENDED && (instr->operand + 1) >= IO_PAGE) )
+        instr->flow |= FLOW_CHECK;
+
+    if ( instr->prefix == 0 )
+    {
+        switch ( instr->op_code )
+        {
+            case 0x20:  // BRA
+            case 0x16:  // LBRA
+                instr->flow = FLOW_TARGET | FLOW_END;
+                break;
+
+            case 0x22 ... 0x2f: // Short conditional branches
+            case 0x8d:  // BSR
+            case 0x17:  // LBSR
+                instr->flow = FLOW_NEXT | FLOW_TARGET | FLOW_END;
+                break;
+
+            case 0x7e:  // JMP extended
+                instr->target = instr->operand;
+                instr->flow = FLOW_TARGET | FLOW_END;
+                break;
+
+            case 0xbd:  // JSR extended
+                instr->target = instr->operand;
+                instr->flow = FLOW_NEXT | FLOW_TARGET | FLOW_END;
+                break;
+
+            case 0x0e:  // JMP direct and indexed
+            case 0x6e:
+            case 0x39:  // RTS
+            case 0x3b:  // RTI
+                instr->flow = FLOW_END;
+                break;
+
+            case 0x9d:  // JSR direct and indexed
+            case 0xad:
+            case 0x3f:  // SWI
+            case 0x3c:  // CWAI
+            case 0x13:  // SYNC
+                instr->flow = FLOW_NEXT | FLOW_END;
+                break;
+
+            case 0x35:  // PULS/PULU with PC
+            case 0x37:
+                if ( instr->operand & 0x80 )
+                    instr->flow = FLOW_END;
+                else
+                    instr->flow |= FLOW_CHECK;
+                break;
+
+            case 0x34:  // PSHS/PSHU
+            case 0x36:
+            case 0x1c:  // ANDCC
+                instr->flow |= FLOW_CHECK;
+                break;
+
+            case 0x1e:  // EXG/TFR with PC
+            case 0x1f:
+                if ( (instr->operand & 0x0f) == 5 ||
+                     (instr->op_code == 0x1e && (instr->operand & 0xf0) == 0x50) )
+                    instr->flow = FLOW_END;
+                else
+                    instr->flow |= FLOW_CHECK;
+                break;
+        }
+    }
+    else if ( instr->prefix == 0x10 && instr->op_code >= 0x22 && instr->op_code <= 0x2f )
+    {
+        instr->flow = FLOW_NEXT | FLOW_TARGET | FLOW_END;
+    }
+    else if ( instr->op_code == 0x3f )
+    {
+        instr->flow = FLOW_NEXT | FLOW_END;
+    }
+
+    return 1;
+}
+
+/*------------------------------------------------
+ * discover()
+ *
+ *  Queue an address for decoding if it is in the ROM.
+ *
+ *  param:  Instruction address
+ *  return: Nothing
+ */
+static void discover(int address)
+{
+    if ( address < ROM_BASE || address > ROM_END || decoded[address - ROM_BASE] )
+        return;
+
+    if ( work_count < ROM_SIZE )
+        work_list[work_count++] = address;
+}
+
+/*------------------------------------------------
+ * descend()
+ *
+ *  Decode queued addresses and follow static control flow
+ *  until the work list is empty.
+ *
+ *  param:  Nothing
+ *  return: Nothing
+ */
+static void descend(void)
+{
+    instruction_t  *instr;
+    int             address, i;
+
+    while ( work_count )
+    {
+        address = work_list[--work_count];
+        instr = &instructions[address - ROM_BASE];
+
+        if ( decoded[address - ROM_BASE] || !decode(address, instr) )
+            continue;
+
+        decoded[address - ROM_BASE] = 1;
+        for ( i = 0; i < instr->length; i++ )
+            covered[address + i - ROM_BASE] = 1;
+
+        if ( instr->flow & FLOW_TARGET )
+            discover(instr->target);
+
+        if ( instr->flow & FLOW_NEXT )
+            discover(address + instr->length);
+    }
+}
+
+/*------------------------------------------------
+ * is_code()
+ *
+ *  Check if ROM bytes at an address decode into a sequence of
+ *  instructions that ends in a control transfer, or joins an already
+ *  decoded instruction, without overlapping other decoded instructions.
+ *
+ *  param:  Start address
+ *  return: 1- likely code, 0- not code
+ */
+static int is_code(int address)
+{
+    instruction_t   instr;
+    int             i, count;
+
+    for ( count = 0; count < SWEEP_MAX_INSTR; count++ )
+    {
+        if ( address > ROM_END )
+            return 0;
+
+        if ( decoded[address - ROM_BASE] )
+            return (count > 0);
+
+        if ( !decode(address, &instr) )
+            return 0;
+
+        for ( i = 0; i < instr.length; i++ )
+            if ( covered[address + i - ROM_BASE] )
+                return 0;
+
+        if ( instr.flow & FLOW_END )
+            return 1;
+
+        address += instr.length;
+    }
+
+    return 0;
+}
+
+/*------------------------------------------------
+ * next_in_block()
+ *
+ *  Find the instruction that continues a block.
+ *  The block follows fall-through instructions until a control
+ *  transfer or an instruction that other instructions fall into.
+ *
+ *  param:  Pointer to instruction record
+ *  return: Address of next instruction in the block, 0 if the block ends
+ */
+static int next_in_block(instruction_t *instr)
+{
+    int     next = instr->address + instr->length;
+
+    if ( (instr->flow & FLOW_END) || next > ROM_END ||
+         !decoded[next - ROM_BASE] || fall_in[next - ROM_BASE] != 1 )
+        return 0;
+
+    return next;
+}
+
+/*------------------------------------------------
+ * emit_block()
+ *
+ *  Output a block function starting at address.
+ *  After every instruction the block returns to the caller if an interrupt,
+ *  reset, halt or CPU state change requires cpu_run().
+ *
+ *  param:  Block start address
+ *  return: Nothing
+ */
+static void emit_block(int address)
+{
+    instruction_t  *instr;
+    const char     *exec;
+    int             next, indexed = 0;
+
+    /* Check for indexed addressing to declare 'ea'
+     */
+    for ( next = address; next; next = next_in_block(instr) )
+    {
+        instr = &instructions[next - ROM_BASE];
+        indexed |= (machine_code[instr->table_index].mode == ADDR_INDEXED);
+    }
+
+    printf("static int rom_block_%04x(int *cycles)\n{\n", address);
+    printf("    int         executed = 0;\n");
+    if ( indexed )
+        printf("    uint16_t    ea;\n");
+    printf("\n    switch ( cpu.pc )\n    {\n");
+
+    for ( next = address; next; )
+    {
+        instr = &instructions[next - ROM_BASE];
+        block_head[next - ROM_BASE] = address;
+
+        if ( instr->prefix == 0x10 )
+            exec = "exec_op_code10";
+        else if ( instr->prefix == 0x11 )
+            exec = "exec_op_code11";
+        else
+            exec = "exec_op_code";
+
+        printf("        case 0x%04x:     // %s\n", next, machine_code[instr->table_index].mnem);
+        printf("            cpu.pc = 0x%04x;\n", (next + instr->length) & 0xffff);
+
+        switch ( machine_code[instr->table_index].mode )
+        {
+            case ADDR_INHERENT:
+                printf("            *cycles += %d;\n", instr->cycles);
+                printf("            %s(0x%02x, 0, cycles);\n", exec, instr->op_code);
+                break;
+
+            case ADDR_DIRECT:
+                printf("            *cycles += %d;\n", instr->cycles);
+                printf("            %s(0x%02x, (cpu.dp << 8) + 0x%02x, cycles);\n", exec, instr->op_code, instr->operand);
+                break;
+
+            case ADDR_RELATIVE:
+            case ADDR_LRELATIVE:
+                printf("            *cycles += %d;\n", instr->cycles);
+                printf("            %s(0x%02x, 0x%04x, cycles);\n", exec, instr->op_code, instr->target);
+                break;
+
+            case ADDR_EXTENDED:
+                printf("            *cycles += %d;\n", instr->cycles);
+                printf("            %s(0x%02x, 0x%04x, cycles);\n", exec, instr->op_code, instr->operand);
+                break;
+
+            case ADDR_IMMEDIATE:
+            case ADDR_LIMMEDIATE:
+                printf("            *cycles += %d;\n", instr->cycles);
+                printf("            %s(0x%02x, 0x%04x, cycles);\n", exec, instr->op_code,
+                       next + instr->length - (machine_code[instr->table_index].mode == ADDR_IMMEDIATE ? 1 : 2));
+                break;
+
+            case ADDR_INDEXED:
+                emit_indexed(instr);
+                printf("            *cycles += %d;\n", instr->cycles);
+                printf("            %s(0x%02x, ea, cycles);\n", exec, instr->op_code);
+                break;
+        }
+
+        printf("            executed++;\n");
+
+        next = next_in_block(instr);
+        if ( !next )
+            break;
+
+        if ( instr->flow & FLOW_CHECK )
+        {
+            printf("            if ( cpu_run_required() )\n");
+            printf("                break;\n");
+        }
+    }
+
+    printf("    }\n\n    return executed;\n}\n\n");
+}
+
+/*------------------------------------------------
+ * emit_indexed()
+ *
+ *  Output effective address calculation into 'ea'
+ *  for an indexed addressing mode, as get_eff_addr() does.
+ *
+ *  param:  Pointer to instruction record
+ *  return: Nothing
+ */
+static void emit_indexed(instruction_t *instr)
+{
+    const char *reg = index_reg_name[(instr->post_byte & INDX_POST_REG) >> 5];
+    int         post_pc = (instr->address + instr->length) & 0xffff;
+    int         offset;
+
+    if ( !(instr->post_byte & INDX_POST_5BIT_OFF) )
+    {
+        offset = instr->post_byte & 0x1f;
+        if ( offset & 0x10 )
+            offset |= 0xfff0;
+        printf("            ea = %s + 0x%04x;\n", reg, offset);
+        return;
+    }
+
+    switch ( instr->post_byte & INDX_POST_MODE )
+    {
+        case 0:
+            printf("            ea = %s;\n", reg);
+            printf("            %s += 1;\n", reg);
+            break;
+
+        case 1:
+            printf("            ea = %s;\n", reg);
+            printf("            %s += 2;\n", reg);
+            break;
+
+        case 2:
+            printf("            %s -= 1;\n", reg);
+            printf("            ea = %s;\n", reg);
+            break;
+
+        case 3:
+            printf("            %s -= 2;\n", reg);
+            printf("            ea = %s;\n", reg);
+            break;
+
+        case 4:
+            printf("            ea = %s;\n", reg);
+            break;
+
+        case 5:
+            printf("            ea = %s + SIG_EXTEND(cpu.b);\n", reg);
+            break;
+
+        case 6:
+            printf("            ea = %s + SIG_EXTEND(cpu.a);\n", reg);
+            break;
+
+        case 8:
+            printf("            ea = %s + 0x%04x;\n", reg, (uint16_t)(int8_t) instr->operand);
+            break;
+
+        case 9:
+            printf("            ea = %s + 0x%04x;\n", reg, instr->operand);
+            break;
+
+        case 11:
+            printf("            ea = %s + d;\n", reg);
+            break;
+
+        case 12:
+            printf("            ea = 0x%04x;\n", (post_pc + (int8_t) instr->operand) & 0xffff);
+            break;
+
+        case 13:
+            printf("            ea = 0x%04x;\n", (post_pc + instr->operand) & 0xffff);
+            break;
+
+        case 15:
+            printf("            ea = 0x%04x;\n", instr->operand);
+            break;
+    }
+
+    if ( instr->post_byte & INDX_POST_INDIRECT )
+        printf("            ea = (mem_read(ea) << 8) + mem_read(ea + 1);\n");
+}
@@ -0,0 +1,1050 @@
+/********************************************************************
+ * scenario.c
+ *
+ *  Headless scenario runner for automated tests of the emulator.
+ *
+ *  The emulation modules run on the host with libretro/host.c, as they
+ *  do in the libretro core, and a scenario script drives the machine:
+ *  type text, press keys, mount a cassette image, run frames until a
+ *  condition holds, and check the screen or memory. Frames are run as
+ *  fast as the host can, there is no real-time pacing, and the VDG frame
+ *  buffer is only rendered when a frame hash is needed.
+ *
+ *  Each script runs on a freshly booted machine. The runner prints one
+ *  PASS or FAIL line per script with its emulated frames and host time,
+ *  and exits with 0 when all scripts passed.
+ *
+ *  Script lines, '#' starts a comment. Numbers are decimal, or hex
+ *  with a '$' or '0x' prefix. Text is in double quotes, with the \n
+ *  (ENTER), \" and \\ escapes:
+ *
+ *      boot                        Cold boot the machine
+ *      reset                       Warm reset, as the reset button
+ *      mount file.cas              Mount a cassette image
+ *      type "text"                 Type text on the keyboard
+ *      key name|scan-code          Press and release a key, ENTER BREAK CLEAR
+ *                                  SPACE SHIFT UP DOWN LEFT RIGHT, or a scan code
+ *      joystick x y button         Set the right joystick, 0 to 63 and 0 or 1
+ *      wait frames                 Run a number of frames
+ *      until pc addr [frames]      Run until PC is at an address between CPU blocks
+ *      until mem addr value [frames]   Run until a memory byte has a value
+ *      until text "text" [frames]  Run until the screen shows text
+ *      expect pc addr              Fail unless PC is at an address
+ *      expect mem addr value       Fail unless a memory byte has a value
+ *      expect text "text"          Fail unless the screen shows text
+ *      expect hash value           Fail unless the rendered frame has a hash
+ *      hash                        Print the hash of the rendered frame
+ *      screen                      Print the text screen
+ *      snapshot file               Save the machine state to a file
+ *      restore file                Restore the machine state from a file
+ *      mark label                  Print the frames and host time so far
+ *
+ *  'until' fails when the condition does not hold within the frame limit,
+ *  UNTIL_FRAMES by default. The text screen is the 32x16 alpha video RAM
+ *  at the VDG display offset, inverse video letters read as lower case
+ *  and semigraphics as '#'. File names are relative to the script.
+ *  BASIC ignores a key that is down when it first reads the keyboard
+ *  after boot, so wait a frame after the boot "OK" before typing.
+ *
+ *  Usage: scenario script ...
+ *
+ *  October 19, 2026
+ *
+ *******************************************************************/
+
+#include    <stdio.h>
+#include    <stdlib.h>
+#include    <stdint.h>
+#include    <string.h>
+#include    <ctype.h>
+#include    <time.h>
+
+#include    "mem.h"
+#include    "cpu.h"
+#include    "sam.h"
+#include    "vdg.h"
+#include    "pia.h"
+#include    "audio.h"
+#include    "snapshot.h"
+
+#include    "host.h"
+
+/* -----------------------------------------
+   Dragon 32 ROM image
+----------------------------------------- */
+#include    "dragon/dragon.h"
+
+/* -----------------------------------------
+   Local definitions
+----------------------------------------- */
+#define     DRAGON_ROM_START        0x8000
+#define     DRAGON_ROM_END          0xfeff
+
+#define     FRAME_CYCLES            (CPU_CLOCK_HZ / VDG_REFRESH_RATE)
+#define     FRAME_CYCLES_REM        (CPU_CLOCK_HZ % VDG_REFRESH_RATE)
+#define     FRAME_USEC              (1000000 / VDG_REFRESH_RATE)
+
+#define     CPU_MIN_CYCLES          2           // Fewest cycles of an instruction
+
+#define     KEY_HOLD_FRAMES         3           // Frames a key is held down, and released after
+#define     KEY_SHIFT               42
+#define     UNTIL_FRAMES            3000        // Default 'until' limit, one minute of emulated time
+
+#define     SCREEN_COLS             32
+#define     SCREEN_ROWS             16
+
+#define     LINE_LENGTH             256
+#define     CAS_LENGTH_MAX          (1024 * 1024)
+
+#define     FNV_OFFSET              2166136261U
+#define     FNV_PRIME               16777619U
+
+/* Machine state of a 'snapshot' file, the machine snapshot,
+ * the host state and the frame timing of the runner
+ */
+typedef struct
+{
+    snapshot_t      machine;
+    host_state_t    host;
+    int32_t         frame_cycles;
+    int32_t         frame_cycles_frac;
+} scenario_state_t;
+
+typedef enum
+{
+    UNTIL_NONE,
+    UNTIL_PC,
+    UNTIL_MEM,
+    UNTIL_TEXT,
+} until_t;
+
+/* -----------------------------------------
+   Module static functions
+----------------------------------------- */
+static int      script_run(char *script_name);
+static int      command(char *line);
+static char    *token_next(char **line);
+static int      token_number(char **line, long *value);
+static int      token_text(char **line, char *text, int length);
+static void     path_name(char *file_name, char *path, int length);
+
+static void     machine_init(void);
+static void     run_frame(void);
+static int      run_until(until_t until, long address, long value, char *text, long frames);
+static void     frame_undo(void);
+static void     key_press(int scan_code, int shift);
+static int      key_type(char *text);
+static int      key_name(char *name);
+
+static void     screen_text(char *text);
+static uint32_t frame_hash(void);
+static int      state_save(char *file_name);
+static int      state_restore(char *file_name);
+
+static double   host_msec(void);
+static void     usage(void);
+
+/* -----------------------------------------
+   Module globals
+----------------------------------------- */
+static int          frame_cycles = 0;           // Cycles run past the end of the last frame
+static int          frame_cycles_frac = 0;      // Frame cycle remainder, in 1/VDG_REFRESH_RATE cycles
+static int          reset_asserted = 0;
+
+static long         frames = 0;                 // Frames run by the current script
+static double       start_msec;
+
+static char        *script_path;
+static int          script_line;
+
+static uint8_t     *cas_image = 0;
+static int          cas_length = 0;
+
+static scenario_state_t state;
+
+/* Keys by name, and the characters that can be typed
+ * with the scan code of their key and the shift key
+ */
+static const struct
+{
+    char       *name;
+    uint8_t     scan_code;
+} key_names[] =
+{
+    { "ENTER",  28 },
+    { "BREAK",  1  },
+    { "CLEAR",  14 },
+    { "SPACE",  57 },
+    { "SHIFT",  42 },
+    { "UP",     72 },
+    { "DOWN",   80 },
+    { "LEFT",   75 },
+    { "RIGHT",  77 },
+};
+
+static const struct
+{
+    char        character;
+    uint8_t     scan_code;
+    uint8_t     shift;
+} key_chars[] =
+{
+    { '1', 2,  0 }, { '!', 2,  1 },
+    { '2', 3,  0 }, { '"', 3,  1 },
+    { '3', 4,  0 }, { '#', 4,  1 },
+    { '4', 5,  0 }, { '$', 5,  1 },
+    { '5', 6,  0 }, { '%', 6,  1 },
+    { '6', 7,  0 }, { '&', 7,  1 },
+    { '7', 8,  0 }, { '\'', 8, 1 },
+    { '8', 9,  0 }, { '(', 9,  1 },
+    { '9', 10, 0 }, { ')', 10, 1 },
+    { '0', 11, 0 },
+    { '-', 12, 0 }, { '=', 12, 1 },
+    { ':', 13, 0 }, { '*', 13, 1 },
+    { 'Q', 16, 0 }, { 'W', 17, 0 }, { 'E', 18, 0 }, { 'R', 19, 0 },
+    { 'T', 20, 0 }, { 'Y', 21, 0 }, { 'U', 22, 0 }, { 'I', 23, 0 },
+    { 'O', 24, 0 }, { 'P', 25, 0 },
+    { '@', 26, 0 },
+    { '\n', 28, 0 },
+    { 'A', 30, 0 }, { 'S', 31, 0 }, { 'D', 32, 0 }, { 'F', 33, 0 },
+    { 'G', 34, 0 }, { 'H', 35, 0 }, { 'J', 36, 0 }, { 'K', 37, 0 },
+    { 'L', 38, 0 },
+    { ';', 39, 0 }, { '+', 39, 1 },
+    { 'Z', 44, 0 }, { 'X', 45, 0 }, { 'C', 46, 0 }, { 'V', 47, 0 },
+    { 'B', 48, 0 }, { 'N', 49, 0 }, { 'M', 50, 0 },
+    { ',', 51, 0 }, { '<', 51, 1 },
+    { '.', 52, 0 }, { '>', 52, 1 },
+    { '/', 53, 0 }, { '?', 53, 1 },
+    { ' ', 57, 0 },
+};
+
+/*------------------------------------------------
+ * main()
+ *
+ */
+int main(int argc, char *argv[])
+{
+    int     i, failed;
+
+    if ( argc < 2 )
+    {
+        usage();
+        return 2;
+    }
+
+    /* Keep the results in order with the error messages
+     */
+    setvbuf(stdout, NULL, _IOLBF, 0);
+
+    failed = 0;
+
+    for ( i = 1; i < argc; i++ )
+    {
+        if ( !script_run(argv[i]) )
+            failed++;
+    }
+
+    printf("%d of %d scenarios passed\n", argc - 1 - failed, argc - 1);
+
+    return (failed ? 1 : 0);
+}
+
+/*------------------------------------------------
+ * script_run()
+ *
+ *  Boot the machine and run a scenario script,
+ *  then print its result and timing.
+ *
+ *  param:  Script file name
+ *  return: 1- passed, 0- failed
+ */
+static int script_run(char *script_name)
+{
+    FILE   *script;
+    char    line[LINE_LENGTH];
+    int     passed;
+    double  msec;
+
+    if ( (script = fopen(script_name, "r")) == NULL )
+    {
+        perror(script_name);
+        return 0;
+    }
+
+    script_path = script_name;
+    script_line = 0;
+
+    machine_init();
+
+    frames = 0;
+    start_msec = host_msec();
+    passed = 1;
+
+    while ( passed && fgets(line, sizeof(line), script) )
+    {
+        script_line++;
+        passed = command(line);
+
+        if ( host_halted() )
+        {
+            fprintf(stderr, "%s:%d: emulation halted\n", script_path, script_line);
+            passed = 0;
+        }
+    }
+
+    fclose(script);
+
+    msec = host_msec() - start_msec;
+
+    printf("%s %s  frames %ld  emulated %.2fs  host %.0fms  x%.0f\n",
+            (passed ? "PASS" : "FAIL"), script_name, frames,
+            (double) frames / VDG_REFRESH_RATE, msec,
+            (msec > 0 ? (frames * 1000.0 / VDG_REFRESH_RATE) / msec : 0));
+
+    host_cas_unmount();
+    free(cas_image);
+    cas_image = 0;
+
+    return passed;
+}
+
+/*------------------------------------------------
+ * command()
+ *
+ *  Execute one script line.
+ *
+ *  param:  Script line
+ *  return: 1- continue, 0- failed
+ */
+static int command(char *line)
+{
+    char    text[LINE_LENGTH];
+    char   *name, *argument;
+    long    address, value, limit, x, y, button;
+    int     ok;
+    cpu_state_t cpu_state;
+
+    if ( (name = token_next(&line)) == NULL || *name == '#' )
+        return 1;
+
+    ok = 1;
+    limit = UNTIL_FRAMES;
+
+    if ( strcmp(name, "boot") == 0 )
+    {
+        machine_init();
+        if ( cas_image )
+            host_cas_mount(cas_image, cas_length);
+    }
+    else if ( strcmp(name, "reset") == 0 )
+    {
+        cpu_reset(1);
+        reset_asserted = 1;
+    }
+    else if ( strcmp(name, "mount") == 0 )
+    {
+        FILE   *cas;
+
+        if ( (argument = token_next(&line)) == NULL )
+        {
+            ok = 0;
+        }
+        else
+        {
+            path_name(argument, text, sizeof(text));
+
+            free(cas_image);
+            if ( (cas_image = malloc(CAS_LENGTH_MAX)) == NULL || (cas = fopen(text, "rb")) == NULL )
+            {
+                fprintf(stderr, "%s:%d: cannot read '%s'\n", script_path, script_line, text);
+                return 0;
+            }
+            cas_length = (int) fread(cas_image, 1, CAS_LENGTH_MAX, cas);
+            fclose(cas);
+
+            if ( !host_cas_mount(cas_image, cas_length) )
+            {
+                fprintf(stderr, "%s:%d: bad cassette image '%s'\n", script_path, script_line, text);
+                return 0;
+            }
+        }
+    }
+    else if ( strcmp(name, "type") == 0 )
+    {
+        ok = token_text(&line, text, sizeof(text)) && key_type(text);
+    }
+    else if ( strcmp(name, "key") == 0 )
+    {
+        if ( (argument = token_next(&line)) == NULL )
+            ok = 0;
+        else if ( isdigit((int) *argument) )
+            key_press((int) strtol(argument, NULL, 0), 0);
+        else if ( (ok = key_name(argument)) )
+            key_press(ok, 0);
+    }
+    else if ( strcmp(name, "joystick") == 0 )
+    {
+        ok = token_number(&line, &x) && token_number(&line, &y) && token_number(&line, &button);
+        if ( ok )
+            host_joystick_set((int) x, (int) y, (int) button);
+    }
+    else if ( strcmp(name, "wait") == 0 )
+    {
+        ok = token_number(&line, &value);
+        if ( ok )
+            run_until(UNTIL_NONE, 0, 0, NULL, value);
+    }
+    else if ( strcmp(name, "until") == 0 )
+    {
+        argument = token_next(&line);
+
+        if ( argument == NULL )
+        {
+            ok = 0;
+        }
+        else if ( strcmp(argument, "pc") == 0 )
+        {
+            ok = token_number(&line, &address);
+            token_number(&line, &limit);
+            if ( ok && !run_until(UNTIL_PC, address, 0, NULL, limit) )
+            {
+                fprintf(stderr, "%s:%d: PC not at $%04lx in %ld frames\n", script_path, script_line, address, limit);
+                return 0;
+            }
+        }
+        else if ( strcmp(argument, "mem") == 0 )
+        {
+            ok = token_number(&line, &address) && token_number(&line, &value);
+            token_number(&line, &limit);
+            if ( ok && !run_until(UNTIL_MEM, address, value, NULL, limit) )
+            {
+                fprintf(stderr, "%s:%d: $%04lx not $%02lx in %ld frames\n", script_path, script_line, address, value, limit);
+                return 0;
+            }
+        }
+        else if ( strcmp(argument, "text") == 0 )
+        {
+            ok = token_text(&line, text, sizeof(text));
+            token_number(&line, &limit);
+            if ( ok && !run_until(UNTIL_TEXT, 0, 0, text, limit) )
+            {
+                fprintf(stderr, "%s:%d: no \"%s\" on the screen in %ld frames\n", script_path, script_line, text, limit);
+                return 0;
+            }
+        }
+        else
+        {
+            ok = 0;
+        }
+    }
+    else if ( strcmp(name, "expect") == 0 )
+    {
+        argument = token_next(&line);
+
+        if ( argument == NULL )
+        {
+            ok = 0;
+        }
+        else if ( strcmp(argument, "pc") == 0 )
+        {
+            ok = token_number(&line, &address);
+            cpu_get_state(&cpu_state);
+            if ( ok && cpu_state.pc != address )
+            {
+                fprintf(stderr, "%s:%d: PC is $%04x, not $%04lx\n", script_path, script_line, cpu_state.pc, address);
+                return 0;
+            }
+        }
+        else if ( strcmp(argument, "mem") == 0 )
+        {
+            ok = token_number(&line, &address) && token_number(&line, &value);
+            if ( ok && mem_read((int) address) != value )
+            {
+                fprintf(stderr, "%s:%d: $%04lx is $%02x, not $%02lx\n", script_path, script_line, address, mem_read((int) address), value);
+                return 0;
+            }
+        }
+        else if ( strcmp(argument, "text") == 0 )
+        {
+            ok = token_text(&line, text, sizeof(text));
+            if ( ok && !run_until(UNTIL_TEXT, 0, 0, text, 0) )
+            {
+                fprintf(stderr, "%s:%d: no \"%s\" on the screen\n", script_path, script_line, text);
+                return 0;
+            }
+        }
+        else if ( strcmp(argument, "hash") == 0 )
+        {
+            ok = token_number(&line, &value);
+            if ( ok && frame_hash() != (uint32_t) value )
+            {
+                fprintf(stderr, "%s:%d: frame hash is 0x%08x, not 0x%08lx\n", script_path, script_line, frame_hash(), value);
+                return 0;
+            }
+        }
+        else
+        {
+            ok = 0;
+        }
+    }
+    else if ( strcmp(name, "hash") == 0 )
+    {
+        printf("%s:%d: frame hash 0x%08x\n", script_path, script_line, frame_hash());
+    }
+    else if ( strcmp(name, "screen") == 0 )
+    {
+        char    screen[SCREEN_ROWS * SCREEN_COLS + 1];
+        int     row;
+
+        screen_text(screen);
+        for ( row = 0; row < SCREEN_ROWS; row++ )
+            printf("|%.*s|\n", SCREEN_COLS, &screen[row * SCREEN_COLS]);
+    }
+    else if ( strcmp(name, "snapshot") == 0 )
+    {
+        ok = ((argument = token_next(&line)) != NULL);
+        if ( ok )
+        {
+            path_name(argument, text, sizeof(text));
+            if ( !state_save(text) )
+                return 0;
+        }
+    }
+    else if ( strcmp(name, "restore") == 0 )
+    {
+        ok = ((argument = token_next(&line)) != NULL);
+        if ( ok )
+        {
+            path_name(argument, text, sizeof(text));
+            if ( !state_restore(text) )
+                return 0;
+        }
+    }
+    else if ( strcmp(name, "mark") == 0 )
+    {
+        argument = token_next(&line);
+        printf("%s:%d: %s  frames %ld  host %.0fms\n", script_path, script_line,
+                (argument ? argument : ""), frames, host_msec() - start_msec);
+    }
+    else
+    {
+        fprintf(stderr, "%s:%d: unknown command '%s'\n", script_path, script_line, name);
+        return 0;
+    }
+
+    if ( !ok )
+        fprintf(stderr, "%s:%d: bad '%s' command\n", script_path, script_line, name);
+
+    return (ok != 0);
+}
+
+/*------------------------------------------------
+ * token_next()
+ *
+ *  Get the next white space separated token of a line.
+ *
+ *  param:  Pointer to line position, moved past the token
+ *  return: Token or NULL at the end of the line
+ */
+static char *token_next(char **line)
+{
+    char   *token;
+
+    for ( token = *line; isspace((int) *token); token++ );
+    if ( *token == 0 )
+        return NULL;
+
+    for ( *line = token; **line && !isspace((int) **line); (*line)++ );
+    if ( **line )
+        *(*line)++ = 0;
+
+    return token;
+}
+
+/*------------------------------------------------
+ * token_number()
+ *
+ *  Get the next token of a line as a number,
+ *  decimal, or hex with a '$' or '0x' prefix.
+ *
+ *  param:  Pointer to line position, pointer to number
+ *  return: 1- number, 0- no number, the number is not changed
+ */
+static int token_number(char **line, long *value)
+{
+    char   *token, *end;
+    long    number;
+
+    if ( (token = token_next(line)) == NULL )
+        return 0;
+
+    if ( *token == '$' )
+        number = strtol(token + 1, &end, 16);
+    else
+        number = strtol(token, &end, 0);
+
+    if ( *end != 0 || end == token )
+        return 0;
+
+    *value = number;
+
+    return 1;
+}
+
+/*------------------------------------------------
+ * token_text()
+ *
+ *  Get the next double quoted text of a line, with
+ *  the \n, \" and \\ escapes.
+ *
+ *  param:  Pointer to line position, text buffer and its length
+ *  return: 1- text, 0- no text or not terminated
+ */
+static int token_text(char **line, char *text, int length)
+{
+    char   *c;
+    int     i;
+
+    for ( c = *line; isspace((int) *c); c++ );
+    if ( *c++ != '"' )
+        return 0;
+
+    for ( i = 0; *c && *c != '"' && i < (length - 1); c++ )
+    {
+        if ( *c == '\\' && c[1] )
+        {
+            c++;
+            text[i++] = (*c == 'n') ? '\n' : *c;
+        }
+        else
+        {
+            text[i++] = *c;
+        }
+    }
+
+    text[i] = 0;
+
+    if ( *c != '"' )
+        return 0;
+
+    *line = c + 1;
+
+    return 1;
+}
+
+/*------------------------------------------------
+ * path_name()
+ *
+ *  Make a file name relative to the directory of the script.
+ *
+ *  param:  File name, path buffer and its length
+ *  return: Nothing
+ */
+static void path_name(char *file_name, char *path, int length)
+{
+    char   *slash;
+
+    slash = strrchr(script_path, '/');
+
+    if ( *file_name == '/' || slash == NULL )
+        snprintf(path, length, "%s", file_name);
+    else
+        snprintf(path, length, "%.*s/%s", (int)(slash - script_path), script_path, file_name);
+}
+
+/*------------------------------------------------
+ * machine_init()
+ *
+ *  Load the ROM and initialize the emulation modules,
+ *  in the same order as the bare-metal main().
+ *
+ *  param:  Nothing
+ *  return: Nothing
+ */
+static void machine_init(void)
+{
+    int     i;
+
+    host_init();
+    mem_init();
+
+    i = 0;
+    while ( code[i] != -1 )
+    {
+        mem_write(i + LOAD_ADDRESS, code[i]);
+        i++;
+    }
+
+    mem_define_rom(DRAGON_ROM_START, DRAGON_ROM_END);
+
+    sam_init();
+    pia_init();
+    vdg_init();
+
+    cpu_init(RUN_ADDRESS);
+
+    frame_cycles = 0;
+    frame_cycles_frac = 0;
+
+    cpu_reset(1);
+    reset_asserted = 1;
+}
+
+/*------------------------------------------------
+ * run_frame()
+ *
+ *  Run one video frame of emulation, as run_frame() of the
+ *  libretro core, without rendering the VDG frame buffer.
+ *
+ *  param:  Nothing
+ *  return: Nothing
+ */
+static void run_frame(void)
+{
+    run_until(UNTIL_NONE, 0, 0, NULL, 1);
+}
+
+/*------------------------------------------------
+ * run_until()
+ *
+ *  Run frames until a condition holds or for a number of frames.
+ *  PC and memory conditions are checked between CPU blocks, and
+ *  stop the frame there, the next run continues the same frame.
+ *  The screen text condition is checked between frames. The condition is
+ *  checked before the first frame, so a limit of 0 frames only
+ *  checks it.
+ *
+ *  param:  Condition, its address, value and text, and the frame limit
+ *  return: 1- condition holds or UNTIL_NONE, 0- frame limit reached
+ */
+static int run_until(until_t until, long address, long value, char *text, long limit)
+{
+    char        screen[SCREEN_ROWS * SCREEN_COLS + 1];
+    cpu_state_t cpu_state;
+    int         budget, cycles;
+    long        frame;
+
+    for ( frame = 0; ; frame++ )
+    {
+        if ( until == UNTIL_TEXT )
+        {
+            screen_text(screen);
+            if ( strstr(screen, text) )
+                return 1;
+        }
+
+        if ( frame == limit || host_halted() )
+            break;
+
+        budget = FRAME_CYCLES;
+        frame_cycles_frac += FRAME_CYCLES_REM;
+        if ( frame_cycles_frac >= VDG_REFRESH_RATE )
+        {
+            frame_cycles_frac -= VDG_REFRESH_RATE;
+            budget++;
+        }
+
+        while ( frame_cycles < budget && !host_halted() )
+        {
+            cpu_run_block((budget - frame_cycles) / CPU_MIN_CYCLES);
+            cycles = cpu_get_block_cycles();
+            frame_cycles += cycles;
+
+            /* Release reset after one block, as the
+             * bare-metal main loop does
+             */
+            if ( reset_asserted )
+            {
+                cpu_reset(0);
+                reset_asserted = 0;
+            }
+
+            if ( until == UNTIL_PC )
+            {
+                cpu_get_state(&cpu_state);
+                if ( cpu_state.pc == address )
+                {
+                    frame_undo();
+                    return 1;
+                }
+            }
+            else if ( until == UNTIL_MEM && mem_read((int) address) == value )
+            {
+                frame_undo();
+                return 1;
+            }
+        }
+
+        if ( frame_cycles >= budget )
+            frame_cycles -= budget;
+        else
+            frame_cycles = 0;
+
+        pia_function_key();
+        pia_vsync_irq();
+
+        host_timer_advance(FRAME_USEC);
+
+        frames++;
+    }
+
+    return (until == UNTIL_NONE);
+}
+
+/*------------------------------------------------
+ * frame_undo()
+ *
+ *  Take back the cycle remainder of a frame that stopped before
+ *  its end, it is added again when the frame continues.
+ *
+ *  param:  Nothing
+ *  return: Nothing
+ */
+static void frame_undo(void)
+{
+    frame_cycles_frac -= FRAME_CYCLES_REM;
+    if ( frame_cycles_frac < 0 )
+        frame_cycles_frac += VDG_REFRESH_RATE;
+}
+
+/*------------------------------------------------
+ * key_press()
+ *
+ *  Press a key for KEY_HOLD_FRAMES frames and release it for as
+ *  many, so that the ROM keyboard scan and debounce see it once.
+ *
+ *  param:  Scan code, and 1 to hold the shift key with it
+ *  return: Nothing
+ */
+static void key_press(int scan_code, int shift)
+{
+    int     i;
+
+    if ( shift )
+        host_keyboard_event(KEY_SHIFT);
+    host_keyboard_event(scan_code);
+
+    for ( i = 0; i < KEY_HOLD_FRAMES; i++ )
+        run_frame();
+
+    host_keyboard_event(scan_code | 0x80);
+    if ( shift )
+        host_keyboard_event(KEY_SHIFT | 0x80);
+
+    for ( i = 0; i < KEY_HOLD_FRAMES; i++ )
+        run_frame();
+}
+
+/*------------------------------------------------
+ * key_type()
+ *
+ *  Type text on the keyboard. Lower case letters
+ *  are typed as upper case.
+ *
+ *  param:  Text
+ *  return: 1- typed, 0- a character has no key
+ */
+static int key_type(char *text)
+{
+    int     i, c;
+
+    for ( ; *text; text++ )
+    {
+        c = toupper((int) *text);
+
+        for ( i = 0; i < (int)(sizeof(key_chars) / sizeof(key_chars[0])); i++ )
+        {
+            if ( key_chars[i].character == c )
+                break;
+        }
+
+        if ( i == (int)(sizeof(key_chars) / sizeof(key_chars[0])) )
+        {
+            fprintf(stderr, "%s:%d: no key for '%c'\n", script_path, script_line, *text);
+            return 0;
+        }
+
+        key_press(key_chars[i].scan_code, key_chars[i].shift);
+    }
+
+    return 1;
+}
+
+/*------------------------------------------------
+ * key_name()
+ *
+ *  Get the scan code of a key name.
+ *
+ *  param:  Key name
+ *  return: Scan code, 0 if not a key name
+ */
+static int key_name(char *name)
+{
+    int     i;
+
+    for ( i = 0; i < (int)(sizeof(key_names) / sizeof(key_names[0])); i++ )
+    {
+        if ( strcmp(key_names[i].name, name) == 0 )
+            return key_names[i].scan_code;
+    }
+
+    return 0;
+}
+
+/*------------------------------------------------
+ * screen_text()
+ *
+ *  Decode the alpha video RAM at the VDG display offset
+ *  to SCREEN_ROWS lines of SCREEN_COLS characters.
+ *  Inverse video letters are lower case, and
+ *  semigraphics are '#'.
+ *
+ *  param:  Text buffer of SCREEN_ROWS * SCREEN_COLS + 1 characters
+ *  return: Nothing
+ */
+static void screen_text(char *text)
+{
+    vdg_state_t vdg_state;
+    uint8_t    *video_ram;
+    int         i, c;
+
+    vdg_get_state(&vdg_state);
+    video_ram = mem_get_map() + (vdg_state.video_ram_offset << 9);
+
+    for ( i = 0; i < SCREEN_ROWS * SCREEN_COLS; i++ )
+    {
+        c = video_ram[i];
+
+        if ( c & 0x80 )
+            text[i] = '#';
+        else if ( (c & 0x3f) < 0x20 )
+            text[i] = (char)((c & 0x3f) + ((c & 0x40) ? 0x40 : 0x60));
+        else
+            text[i] = (char)(c & 0x3f);
+    }
+
+    text[i] = 0;
+}
+
+/*------------------------------------------------
+ * frame_hash()
+ *
+ *  Render the VDG frame buffer and hash its palette
+ *  indices and resolution with 32-bit FNV-1a.
+ *
+ *  param:  Nothing
+ *  return: Frame hash
+ */
+static uint32_t frame_hash(void)
+{
+    uint8_t    *fb;
+    uint32_t    hash;
+    int         width, height, i;
+
+    vdg_render();
+    fb = host_fb_get(&width, &height);
+
+    hash = FNV_OFFSET;
+    hash = (hash ^ (uint32_t) width) * FNV_PRIME;
+    hash = (hash ^ (uint32_t) height) * FNV_PRIME;
+
+    for ( i = 0; i < width * height; i++ )
+        hash = (hash ^ fb[i]) * FNV_PRIME;
+
+    return hash;
+}
+
+/*------------------------------------------------
+ * state_save()
+ *
+ *  Save the machine snapshot, the host state and
+ *  the frame timing to a file.
+ *
+ *  param:  File name
+ *  return: 1- saved, 0- failed
+ */
+static int state_save(char *file_name)
+{
+    FILE   *file;
+    int     ok;
+
+    snapshot_save(&state.machine);
+    host_get_state(&state.host);
+    state.frame_cycles = frame_cycles;
+    state.frame_cycles_frac = frame_cycles_frac;
+
+    if ( (file = fopen(file_name, "wb")) == NULL )
+    {
+        perror(file_name);
+        return 0;
+    }
+
+    ok = (fwrite(&state, sizeof(state), 1, file) == 1);
+    fclose(file);
+
+    if ( !ok )
+        fprintf(stderr, "%s:%d: cannot write '%s'\n", script_path, script_line, file_name);
+
+    return ok;
+}
+
+/*------------------------------------------------
+ * state_restore()
+ *
+ *  Restore a state saved by state_save().
+ *
+ *  param:  File name
+ *  return: 1- restored, 0- failed
+ */
+static int state_restore(char *file_name)
+{
+    FILE   *file;
+    int     ok;
+
+    if ( (file = fopen(file_name, "rb")) == NULL )
+    {
+        perror(file_name);
+        return 0;
+    }
+
+    ok = (fread(&state, sizeof(state), 1, file) == 1);
+    fclose(file);
+
+    if ( !ok || snapshot_restore(&state.machine) != SNAPSHOT_OK )
+    {
+        fprintf(stderr, "%s:%d: '%s' is not a snapshot of this version\n", script_path, script_line, file_name);
+        return 0;
+    }
+
+    host_set_state(&state.host);
+    frame_cycles = state.frame_cycles;
+    frame_cycles_frac = state.frame_cycles_frac;
+
+    return 1;
+}
+
+/*------------------------------------------------
+ * host_msec()
+ *
+ *  Host time for the scenario timing.
+ *
+ *  param:  Nothing
+ *  return: Time in milli-seconds
+ */
+static double host_msec(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec * 1000.0 + now.tv_nsec / 1000000.0;
+}
+
+/*------------------------------------------------
+ * usage()
+ *
+ */
+static void usage(void)
+{
+    fprintf(stderr, "Usage: scenario script ...\n");
+}
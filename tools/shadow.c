@@ -0,0 +1,621 @@
+/********************************************************************
+ * shadow.c
+ *
+ *  Host validation tool that runs the optimized CPU execution path,
+ *  cpu_run_block(), in lockstep with the reference cpu_run().
+ *
+ *  Before every cpu_run_block() call the CPU state, the memory image and
+ *  the IO state are saved. After the block the state is restored and the
+ *  same number of instructions is executed by cpu_run(). Registers, CC,
+ *  CPU state, cycle counts, memory and the sequence of IO writes of both
+ *  engines are compared, and the tool stops with a divergence report on
+ *  the first difference. The reference run then continues the emulation.
+ *
+ *  The tool emulates a minimal Dragon 32: the BASIC ROM from dragon/dragon.h,
+ *  an optional cartridge ROM image at 0xC000, the PIA0 keyboard matrix
+ *  and field sync IRQ, and the vector redirect into the ROM.
+ *  Other IO addresses act as RAM, and their writes are logged.
+ *  Keyboard input is scripted so that real software can be exercised.
+ *
+ *  Usage: shadow [-k keys] [-c rom_file] [-n cycles] [-i instructions] [-v]
+ *          -k  Keys to type after boot, '\n' for ENTER, '\b' for BREAK, '\c' for CLEAR
+ *          -c  Cartridge ROM image to load at 0xC000 (start it with "EXEC 49152\n")
+ *          -n  CPU cycles to run, default 100000000
+ *          -i  Instructions per cpu_run_block() call, default 1000
+ *          -v  Print progress every 10M cycles
+ *
+ *  October 19, 2026
+ *
+ *******************************************************************/
+
+#include    <stdio.h>
+#include    <stdlib.h>
+#include    <string.h>
+#include    <unistd.h>
+
+#include    "mem.h"
+#include    "cpu.h"
+
+#include    "dragon/dragon.h"
+
+/* -----------------------------------------
+   Local definitions
+----------------------------------------- */
+#define     DRAGON_ROM_START        0x8000
+#define     DRAGON_ROM_END          0xfeff
+#define     CARTRIDGE_ROM_BASE      0xc000
+#define     CARTRIDGE_ROM_SIZE      (16*1024)
+
+#define     IO_PAGE                 0xff00
+#define     PIA0_PA                 0xff00
+#define     PIA0_PB                 0xff02
+#define     PIA0_CRB                0xff03
+#define     VECTORS                 0xfff0
+#define     ROM_VECTORS             0xbff0
+
+#define     FIELD_SYNC_CYCLES       17800       // 50Hz field sync at 0.89MHz
+#define     BOOT_CYCLES             2000000     // Wait for BASIC to boot before typing
+#define     KEY_CYCLES              60000       // Key press and key release duration
+
+#define     IO_LOG_MAX              4096
+#define     HISTORY                 16          // Block start addresses kept for the report
+#define     MEM_DIFF_MAX            32          // Memory differences listed in the report
+
+#define     KEY_ENTER               '\n'
+#define     KEY_BREAK               '\b'
+#define     KEY_CLEAR               '\f'
+
+/* Emulated IO state, saved and restored with the machine state
+ */
+typedef struct
+{
+    uint8_t     io_data[MEMORY - IO_PAGE];
+    int         pia0_pb;                    // Keyboard column strobe
+    int         pia0_crb;
+    int         field_sync_flag;
+    int         key;
+    int         shift;
+    int         io_log_count;
+    uint32_t    io_log[IO_LOG_MAX];         // Address in bits 23..8, data in bits 7..0
+} io_state_t;
+
+/* Machine state snapshot
+ */
+typedef struct
+{
+    cpu_state_t cpu;
+    uint8_t     memory[MEMORY];
+    io_state_t  io;
+    int         cycles;                     // Cycles of executed instructions
+    int         instructions;
+} machine_t;
+
+/* -----------------------------------------
+   Module static functions
+----------------------------------------- */
+static uint8_t io_handler_pia0(uint16_t address, uint8_t data, mem_operation_t op);
+static uint8_t io_handler_generic(uint16_t address, uint8_t data, mem_operation_t op);
+static uint8_t io_handler_vector_redirect(uint16_t address, uint8_t data, mem_operation_t op);
+
+static void    machine_save(machine_t *machine);
+static void    machine_restore(machine_t *machine);
+static int     machine_compare(machine_t *reference, machine_t *optimized);
+static void    divergence_report(machine_t *start, machine_t *reference, machine_t *optimized);
+static void    key_parse(const char *text);
+static void    key_schedule(long long cycles);
+static int     load_cartridge(const char *file_name);
+
+/* -----------------------------------------
+   Module globals
+----------------------------------------- */
+static io_state_t   io;
+
+static machine_t    start;
+static machine_t    reference;
+static machine_t    optimized;
+
+static char         key_buffer[4096];
+static const char  *keys = key_buffer;
+static long long    next_key_cycles = BOOT_CYCLES;
+static int          key_down = 0;
+
+static int          history[HISTORY];
+static int          history_index = 0;
+
+/* Dragon keyboard matrix, row strings indexed by column
+ */
+static const char  *key_rows[7] = {
+        "01234567",
+        "89:;,-./",
+        "@ABCDEFG",
+        "HIJKLMNO",
+        "PQRSTUVW",
+        "XYZ\x01\x02\x03\x04 ",     // Up, Down, Left and Right are not scripted
+        "\n\f\b",
+};
+
+/* Shifted characters and their un-shifted keys
+ */
+static const char  *shift_chars = "!\"#$%&'()*=+<>?";
+static const char  *shift_keys  = "123456789:-;,./";
+
+/*------------------------------------------------
+ * main()
+ *
+ */
+int main(int argc, char *argv[])
+{
+    long long   cycles = 0, max_cycles = 100000000LL, next_field_sync = FIELD_SYNC_CYCLES;
+    long long   instructions = 0, blocks = 0, next_progress = 10000000LL;
+    int         block_size = 1000, verbose = 0;
+    int         i, n, opt;
+
+    mem_init();
+
+    while ( (opt = getopt(argc, argv, "k:c:n:i:v")) != -1 )
+    {
+        switch ( opt )
+        {
+            case 'k':
+                key_parse(optarg);
+                break;
+
+            case 'c':
+                if ( load_cartridge(optarg) )
+                    return 1;
+                break;
+
+            case 'n':
+                max_cycles = atoll(optarg);
+                break;
+
+            case 'i':
+                block_size = atoi(optarg);
+                break;
+
+            case 'v':
+                verbose = 1;
+                break;
+
+            default:
+                fprintf(stderr, "Usage: %s [-k keys] [-c rom_file] [-n cycles] [-i instructions] [-v]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    /* Machine setup, the cartridge image was loaded by load_cartridge()
+     * into the memory image before the ROM area is write protected.
+     */
+    for ( i = 0; code[i] != -1; i++ )
+        mem_write(i + LOAD_ADDRESS, code[i]);
+
+    mem_define_rom(DRAGON_ROM_START, DRAGON_ROM_END);
+    mem_define_io(IO_PAGE, VECTORS - 1, io_handler_generic);
+    mem_define_io(PIA0_PA, PIA0_CRB, io_handler_pia0);
+    mem_define_io(VECTORS, MEMORY - 1, io_handler_vector_redirect);
+
+    cpu_init(0);
+    cpu_reset(1);
+    cpu_run();
+    cpu_reset(0);
+
+    /* Lockstep execution
+     */
+    while ( cycles < max_cycles )
+    {
+        if ( cycles >= next_field_sync )
+        {
+            next_field_sync += FIELD_SYNC_CYCLES;
+            io.field_sync_flag = 1;
+            if ( io.pia0_crb & 0x01 )
+                cpu_irq(1);
+        }
+
+        key_schedule(cycles);
+
+        io.io_log_count = 0;
+        machine_save(&start);
+        history[history_index] = start.cpu.pc;
+        history_index = (history_index + 1) % HISTORY;
+
+        /* Optimized path
+         */
+        n = cpu_run_block(block_size);
+        machine_save(&optimized);
+        optimized.cycles = optimized.cpu.last_opcode_cycles;
+        optimized.instructions = n;
+
+        /* Reference path from the same starting state
+         */
+        machine_restore(&start);
+        reference.cycles = 0;
+        for ( i = 0; i < n; i++ )
+        {
+            cpu_run();
+            cpu_get_state(&reference.cpu);
+            reference.cycles += reference.cpu.last_opcode_cycles;
+        }
+        machine_save(&reference);
+        reference.instructions = n;
+
+        if ( machine_compare(&reference, &optimized) )
+        {
+            divergence_report(&start, &reference, &optimized);
+            return 2;
+        }
+
+        cycles += reference.cycles;
+        instructions += n;
+        blocks++;
+
+        if ( verbose && cycles >= next_progress )
+        {
+            next_progress += 10000000LL;
+            printf("%lld cycles, %lld instructions, %lld blocks\n", cycles, instructions, blocks);
+        }
+    }
+
+    printf("No divergence: %lld cycles, %lld instructions in %lld blocks (%.2f instructions per block)\n",
+            cycles, instructions, blocks, (double) instructions / blocks);
+
+    printf("Text screen:\n");
+    for ( i = 0; i < 512; i++ )
+    {
+        n = mem_get_map()[0x400 + i] & 0x3f;
+        putchar(n < 0x20 ? n + 0x40 : n);
+        if ( (i % 32) == 31 )
+            putchar('\n');
+    }
+
+    return 0;
+}
+
+/*------------------------------------------------
+ * io_handler_pia0()
+ *
+ *  PIA0 keyboard matrix and field sync interrupt flag.
+ *
+ *  param:  Address, data, and read or write operation
+ *  return: Data read
+ */
+static uint8_t io_handler_pia0(uint16_t address, uint8_t data, mem_operation_t op)
+{
+    const char *key_position;
+    int         row;
+
+    if ( op == MEM_WRITE && io.io_log_count < IO_LOG_MAX )
+        io.io_log[io.io_log_count++] = (address << 8) | data;
+
+    switch ( address )
+    {
+        case PIA0_PA:
+            if ( op == MEM_READ )
+            {
+                data = 0x7f;
+                for ( row = 0; row < 7 && io.key; row++ )
+                {
+                    key_position = strchr(key_rows[row], io.key);
+                    if ( key_position && !(io.pia0_pb & (1 << (key_position - key_rows[row]))) )
+                        data &= ~(1 << row);
+                }
+                if ( io.shift && !(io.pia0_pb & 0x80) )
+                    data &= ~(1 << 6);
+            }
+            break;
+
+        case PIA0_PB:
+            if ( op == MEM_WRITE )
+            {
+                io.pia0_pb = data;
+            }
+            else
+            {
+                io.field_sync_flag = 0;
+                cpu_irq(0);
+            }
+            break;
+
+        case PIA0_CRB:
+            if ( op == MEM_WRITE )
+                io.pia0_crb = data;
+            else
+                data = (io.pia0_crb & 0x3f) | (io.field_sync_flag ? 0x80 : 0);
+            break;
+
+        default:
+            if ( op == MEM_WRITE )
+                io.io_data[address - IO_PAGE] = data;
+            else
+                data = io.io_data[address - IO_PAGE];
+    }
+
+    return data;
+}
+
+/*------------------------------------------------
+ * io_handler_generic()
+ *
+ *  IO addresses without emulation act as RAM, writes are logged.
+ *
+ *  param:  Address, data, and read or write operation
+ *  return: Data read
+ */
+static uint8_t io_handler_generic(uint16_t address, uint8_t data, mem_operation_t op)
+{
+    if ( op == MEM_WRITE )
+    {
+        if ( io.io_log_count < IO_LOG_MAX )
+            io.io_log[io.io_log_count++] = (address << 8) | data;
+
+        io.io_data[address - IO_PAGE] = data;
+    }
+
+    return io.io_data[address - IO_PAGE];
+}
+
+/*------------------------------------------------
+ * io_handler_vector_redirect()
+ *
+ *  Redirect CPU vector reads to the top of the BASIC ROM.
+ *
+ *  param:  Address, data, and read or write operation
+ *  return: Data read
+ */
+static uint8_t io_handler_vector_redirect(uint16_t address, uint8_t data, mem_operation_t op)
+{
+    if ( op == MEM_READ )
+        data = mem_get_map()[ROM_VECTORS + (address - VECTORS)];
+
+    return data;
+}
+
+/*------------------------------------------------
+ * machine_save()
+ *
+ *  Save CPU, memory and IO state.
+ *
+ *  param:  Pointer to machine state
+ *  return: Nothing
+ */
+static void machine_save(machine_t *machine)
+{
+    cpu_get_state(&machine->cpu);
+    memcpy(machine->memory, mem_get_map(), MEMORY);
+    memcpy(&machine->io, &io, sizeof(io_state_t));
+}
+
+/*------------------------------------------------
+ * machine_restore()
+ *
+ *  Restore CPU, memory and IO state.
+ *
+ *  param:  Pointer to machine state
+ *  return: Nothing
+ */
+static void machine_restore(machine_t *machine)
+{
+    cpu_set_state(&machine->cpu);
+    memcpy(mem_get_map(), machine->memory, MEMORY);
+    memcpy(&io, &machine->io, sizeof(io_state_t));
+}
+
+/*------------------------------------------------
+ * machine_compare()
+ *
+ *  Compare reference and optimized machine states.
+ *
+ *  param:  Pointers to reference and optimized machine states
+ *  return: 0- identical, 1- divergence
+ */
+static int machine_compare(machine_t *reference, machine_t *optimized)
+{
+    cpu_state_t *r = &reference->cpu;
+    cpu_state_t *o = &optimized->cpu;
+
+    if ( r->pc != o->pc || r->a != o->a || r->b != o->b || r->dp != o->dp || r->cc != o->cc ||
+         r->x != o->x || r->y != o->y || r->u != o->u || r->s != o->s ||
+         r->cpu_state != o->cpu_state || r->nmi_armed != o->nmi_armed ||
+         r->irq_asserted != o->irq_asserted || r->firq_asserted != o->firq_asserted )
+        return 1;
+
+    if ( reference->cycles != optimized->cycles )
+        return 1;
+
+    if ( memcmp(reference->memory, optimized->memory, MEMORY) )
+        return 1;
+
+    if ( memcmp(&reference->io, &optimized->io, sizeof(io_state_t)) )
+        return 1;
+
+    return 0;
+}
+
+/*------------------------------------------------
+ * divergence_report()
+ *
+ *  Print the state of both engines, the differences in memory and IO writes,
+ *  the preceding block addresses, and a reference trace of the block.
+ *
+ *  param:  Pointers to start, reference and optimized machine states
+ *  return: Nothing
+ */
+static void divergence_report(machine_t *start, machine_t *reference, machine_t *optimized)
+{
+    cpu_state_t *r = &reference->cpu;
+    cpu_state_t *o = &optimized->cpu;
+    int          i, count;
+
+    printf("Divergence in block at %04x (%s), %d instructions\n\n",
+            start->cpu.pc, cpu_get_menmonic(start->cpu.pc), reference->instructions);
+
+    printf("           PC   A  B  X    Y    U    S    DP CC  state cycles\n");
+    printf("start      %04x %02x %02x %04x %04x %04x %04x %02x %02x  %d\n",
+            start->cpu.pc, start->cpu.a, start->cpu.b, start->cpu.x, start->cpu.y,
+            start->cpu.u, start->cpu.s, start->cpu.dp, start->cpu.cc, start->cpu.cpu_state);
+    printf("reference  %04x %02x %02x %04x %04x %04x %04x %02x %02x  %d     %d\n",
+            r->pc, r->a, r->b, r->x, r->y, r->u, r->s, r->dp, r->cc, r->cpu_state, reference->cycles);
+    printf("optimized  %04x %02x %02x %04x %04x %04x %04x %02x %02x  %d     %d\n\n",
+            o->pc, o->a, o->b, o->x, o->y, o->u, o->s, o->dp, o->cc, o->cpu_state, optimized->cycles);
+
+    if ( r->nmi_armed != o->nmi_armed || r->irq_asserted != o->irq_asserted || r->firq_asserted != o->firq_asserted )
+        printf("interrupts reference nmi_armed=%d irq=%d firq=%d, optimized nmi_armed=%d irq=%d firq=%d\n\n",
+                r->nmi_armed, r->irq_asserted, r->firq_asserted, o->nmi_armed, o->irq_asserted, o->firq_asserted);
+
+    for ( i = 0, count = 0; i < MEMORY; i++ )
+    {
+        if ( reference->memory[i] == optimized->memory[i] )
+            continue;
+
+        if ( count == 0 )
+            printf("memory     addr start reference optimized\n");
+
+        if ( count < MEM_DIFF_MAX )
+            printf("           %04x %02x    %02x        %02x\n",
+                    i, start->memory[i], reference->memory[i], optimized->memory[i]);
+        count++;
+    }
+    if ( count )
+        printf("           %d differences\n\n", count);
+
+    if ( reference->io.io_log_count != optimized->io.io_log_count ||
+         memcmp(reference->io.io_log, optimized->io.io_log, reference->io.io_log_count * sizeof(uint32_t)) )
+    {
+        printf("IO writes  reference:");
+        for ( i = 0; i < reference->io.io_log_count && i < MEM_DIFF_MAX; i++ )
+            printf(" %04x=%02x", reference->io.io_log[i] >> 8, reference->io.io_log[i] & 0xff);
+        printf("\n           optimized:");
+        for ( i = 0; i < optimized->io.io_log_count && i < MEM_DIFF_MAX; i++ )
+            printf(" %04x=%02x", optimized->io.io_log[i] >> 8, optimized->io.io_log[i] & 0xff);
+        printf("\n\n");
+    }
+
+    printf("Preceding blocks:");
+    for ( i = 1; i <= HISTORY; i++ )
+        printf(" %04x", history[(history_index + i - 1) % HISTORY]);
+    printf("\n\n");
+
+    /* Reference trace of the diverging block
+     */
+    printf("Reference trace:\n");
+    machine_restore(start);
+    for ( i = 0; i < reference->instructions; i++ )
+    {
+        cpu_state_t state;
+        uint16_t    pc;
+
+        cpu_get_state(&state);
+        pc = state.pc;
+        cpu_run();
+        cpu_get_state(&state);
+        printf("  %04x %-5s -> PC=%04x A=%02x B=%02x X=%04x Y=%04x U=%04x S=%04x DP=%02x CC=%02x cycles=%d\n",
+                pc, cpu_get_menmonic(pc), state.pc, state.a, state.b, state.x, state.y,
+                state.u, state.s, state.dp, state.cc, state.last_opcode_cycles);
+    }
+}
+
+/*------------------------------------------------
+ * key_parse()
+ *
+ *  Convert the key script, with '\n', '\b' and '\c' escapes,
+ *  into upper case key codes.
+ *
+ *  param:  Key script text
+ *  return: Nothing
+ */
+static void key_parse(const char *text)
+{
+    int     i = 0;
+    char    c;
+
+    while ( *text && i < (int)(sizeof(key_buffer) - 1) )
+    {
+        c = *text++;
+
+        if ( c == '\\' && *text )
+        {
+            c = *text++;
+            if ( c == 'n' || c == 'r' )
+                c = KEY_ENTER;
+            else if ( c == 'b' )
+                c = KEY_BREAK;
+            else if ( c == 'c' )
+                c = KEY_CLEAR;
+        }
+        else if ( c == '\r' )
+        {
+            c = KEY_ENTER;
+        }
+        else if ( c >= 'a' && c <= 'z' )
+        {
+            c -= 0x20;
+        }
+
+        key_buffer[i++] = c;
+    }
+
+    key_buffer[i] = 0;
+}
+
+/*------------------------------------------------
+ * key_schedule()
+ *
+ *  Press and release the scripted keys.
+ *  Keys are timed by CPU cycles so the schedule is the same for every run.
+ *
+ *  param:  Current CPU cycle count
+ *  return: Nothing
+ */
+static void key_schedule(long long cycles)
+{
+    const char *shifted;
+    char        c;
+
+    if ( cycles < next_key_cycles || *keys == 0 )
+        return;
+
+    next_key_cycles = cycles + KEY_CYCLES;
+
+    if ( key_down )
+    {
+        io.key = 0;
+        io.shift = 0;
+        key_down = 0;
+        keys++;
+        return;
+    }
+
+    c = *keys;
+    shifted = strchr(shift_chars, c);
+    io.shift = (shifted != NULL);
+    io.key = io.shift ? shift_keys[shifted - shift_chars] : c;
+    key_down = 1;
+}
+
+/*------------------------------------------------
+ * load_cartridge()
+ *
+ *  Load a cartridge ROM image at 0xC000.
+ *
+ *  param:  File name
+ *  return: 0- loaded, 1- error
+ */
+static int load_cartridge(const char *file_name)
+{
+    static uint8_t  buffer[CARTRIDGE_ROM_SIZE];
+    FILE           *rom;
+    int             rom_bytes;
+
+    rom = fopen(file_name, "rb");
+    if ( rom == NULL )
+    {
+        fprintf(stderr, "Cannot open '%s'\n", file_name);
+        return 1;
+    }
+
+    rom_bytes = fread(buffer, 1, CARTRIDGE_ROM_SIZE, rom);
+    fclose(rom);
+
+    mem_load(CARTRIDGE_ROM_BASE, buffer, rom_bytes);
+
+    return 0;
+}
@@ -0,0 +1,224 @@
+/********************************************************************
+ * shmgrab.c
+ *
+ *  Reader of the shared memory frame export of the libretro core,
+ *  and an example of the reader side of libretro/shmfb.h.
+ *
+ *  Waits for the next frame that the core publishes and writes it
+ *  as a binary PPM image, or prints the frame rate that the core
+ *  publishes at.
+ *
+ *  Usage: shmgrab -p file.ppm | -r seconds
+ *          -p  Write the next frame to a PPM image file
+ *          -r  Count published and intact frames for a number of seconds
+ *
+ *  October 19, 2026
+ *
+ *******************************************************************/
+
+#include    <stdio.h>
+#include    <stdlib.h>
+#include    <stdint.h>
+#include    <string.h>
+#include    <fcntl.h>
+#include    <unistd.h>
+#include    <time.h>
+#include    <sys/mman.h>
+
+#include    "shmfb.h"
+
+/* -----------------------------------------
+   Local definitions
+----------------------------------------- */
+#define     POLL_USEC               1000
+
+/* -----------------------------------------
+   Module static functions
+----------------------------------------- */
+static int  frame_read(uint32_t after, shmfb_slot_t *copy);
+static int  ppm_write(char *file_name, shmfb_slot_t *copy);
+static int  rate(int seconds);
+static void usage(void);
+
+/* -----------------------------------------
+   Module globals
+----------------------------------------- */
+static const shmfb_t   *shmfb;
+static shmfb_slot_t     frame_copy;
+
+/*------------------------------------------------
+ * main()
+ *
+ */
+int main(int argc, char *argv[])
+{
+    void   *map;
+    int     fd;
+
+    if ( argc != 3 || (strcmp(argv[1], "-p") != 0 && strcmp(argv[1], "-r") != 0) )
+    {
+        usage();
+        return 1;
+    }
+
+    if ( (fd = shm_open(SHMFB_NAME, O_RDONLY, 0)) == -1 )
+    {
+        perror(SHMFB_NAME);
+        return 1;
+    }
+
+    map = mmap(0, sizeof(shmfb_t), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if ( map == MAP_FAILED )
+    {
+        perror("mmap");
+        return 1;
+    }
+
+    shmfb = map;
+
+    if ( __atomic_load_n(&shmfb->magic, __ATOMIC_ACQUIRE) != SHMFB_MAGIC ||
+         shmfb->version != SHMFB_VERSION || shmfb->slot_size != sizeof(shmfb_slot_t) )
+    {
+        fprintf(stderr, "shmgrab: unknown shared memory layout\n");
+        return 1;
+    }
+
+    if ( strcmp(argv[1], "-p") == 0 )
+    {
+        if ( frame_read(__atomic_load_n(&shmfb->frame, __ATOMIC_ACQUIRE), &frame_copy) == 0 )
+            return 1;
+
+        return ppm_write(argv[2], &frame_copy);
+    }
+
+    return rate(atoi(argv[2]));
+}
+
+/*------------------------------------------------
+ * frame_read()
+ *
+ *  Wait for a frame newer than a frame number and copy it.
+ *  A frame that the core overwrote during the copy is
+ *  dropped, and the newest frame is read instead.
+ *
+ *  param:  Frame number to wait past, and slot copy
+ *  return: Frame number, 0 if no new frame for a second
+ */
+static int frame_read(uint32_t after, shmfb_slot_t *copy)
+{
+    const shmfb_slot_t *slot;
+    uint32_t            frame, sequence;
+    int                 wait;
+
+    for ( wait = 0; wait < 1000000; wait += POLL_USEC )
+    {
+        frame = __atomic_load_n(&shmfb->frame, __ATOMIC_ACQUIRE);
+        if ( frame == 0 || frame == after )
+        {
+            usleep(POLL_USEC);
+            continue;
+        }
+
+        slot = &shmfb->slot[frame % SHMFB_SLOTS];
+
+        sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+        if ( sequence & 1 )
+            continue;
+
+        memcpy(copy, slot, sizeof(shmfb_slot_t));
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if ( __atomic_load_n(&slot->sequence, __ATOMIC_RELAXED) == sequence && copy->frame == frame )
+            return frame;
+    }
+
+    fprintf(stderr, "shmgrab: no new frame\n");
+
+    return 0;
+}
+
+/*------------------------------------------------
+ * ppm_write()
+ *
+ *  Write a frame as a binary PPM image.
+ *
+ *  param:  File name and frame
+ *  return: Exit status
+ */
+static int ppm_write(char *file_name, shmfb_slot_t *copy)
+{
+    FILE       *ppm;
+    uint32_t    pixel;
+    int         i;
+
+    if ( (ppm = fopen(file_name, "wb")) == NULL )
+    {
+        perror(file_name);
+        return 1;
+    }
+
+    fprintf(ppm, "P6\n%u %u\n255\n", copy->width, copy->height);
+
+    for ( i = 0; i < (int)(copy->width * copy->height); i++ )
+    {
+        pixel = copy->pixels[i];
+        fputc((pixel >> 16) & 0xff, ppm);
+        fputc((pixel >> 8) & 0xff, ppm);
+        fputc(pixel & 0xff, ppm);
+    }
+
+    fclose(ppm);
+
+    printf("Frame %u, %ux%u, PIA mode 0x%02x, SAM mode %u\n",
+            copy->frame, copy->width, copy->height, copy->pia_video_mode, copy->sam_video_mode);
+
+    return 0;
+}
+
+/*------------------------------------------------
+ * rate()
+ *
+ *  Read frames for a number of seconds and print the rate
+ *  at which the core published them and the number read intact.
+ *
+ *  param:  Seconds
+ *  return: Exit status
+ */
+static int rate(int seconds)
+{
+    uint32_t    first, last;
+    time_t      end;
+    int         frames;
+
+    if ( (first = frame_read(0, &frame_copy)) == 0 )
+        return 1;
+
+    last = first;
+    frames = 0;
+    end = time(NULL) + seconds;
+
+    while ( time(NULL) < end )
+    {
+        if ( (last = frame_read(last, &frame_copy)) == 0 )
+            return 1;
+        frames++;
+    }
+
+    printf("Published %u frames, read %d, %.1f frames per second\n",
+            last - first, frames, (double)(last - first) / (seconds > 0 ? seconds : 1));
+
+    return 0;
+}
+
+/*------------------------------------------------
+ * usage()
+ *
+ */
+static void usage(void)
+{
+    fprintf(stderr, "Usage: shmgrab -p file.ppm | -r seconds\n");
+    fprintf(stderr, "        -p  Write the next frame to a PPM image\n");
+    fprintf(stderr, "        -r  Frame rate for a number of seconds\n");
+}
@@ -0,0 +1,892 @@
+/********************************************************************
+ * tracedump.c
+ *
+ *  Host tool that decodes the binary CPU trace of a CPU_TRACE=2 build
+ *  (see trace.h) into a disassembly listing and a per-routine cycle
+ *  summary.
+ *
+ *  Each record holds the instruction bytes, the registers before the
+ *  instruction, the effective address and the cycle count, so the
+ *  listing is made without a memory image. Records are found by their
+ *  sync byte, so console text captured with the trace is skipped.
+ *
+ *  Routines are tracked with a call stack: JSR, BSR, LBSR, SWI and
+ *  serviced interrupts enter a routine; RTS, RTI and PULS/PULU PC, or
+ *  S moving above the entry stack pointer, leave it. The summary lists
+ *  calls, instructions, own (self) cycles and cycles including callees.
+ *
+ *  Symbols are the ROM interrupt vectors from dragon/dragon.h and any
+ *  address lists given with '-s', one symbol per line as
+ *  "ADDR NAME", "$ADDR NAME" or "NAME EQU $ADDR".
+ *
+ *  Usage: tracedump [-s sym_file] [-a addr[-addr]] [-r routine] [-m mnemonic]
+ *                   [-f first] [-l lines] [-b] [-q] [-S] [-t top] [trace_file]
+ *          -s  Load symbols from an address list, may be repeated
+ *          -a  List only instructions in the address range
+ *          -r  List only instructions executed inside a routine (name or address)
+ *          -m  List only instructions with this mnemonic
+ *          -f  Skip the first records
+ *          -l  Stop listing after this many lines
+ *          -b  Brief listing, without registers
+ *          -q  No listing, print the routine summary only
+ *          -S  Print the routine summary after the listing
+ *          -t  Routines in the summary, default 30
+ *
+ *  October 19, 2026
+ *
+ *******************************************************************/
+
+#include    <stdio.h>
+#include    <stdlib.h>
+#include    <string.h>
+#include    <strings.h>
+#include    <ctype.h>
+#include    <unistd.h>
+
+#include    "mc6809e.h"
+#include    "trace.h"
+#include    "dragon/dragon.h"
+
+/* -----------------------------------------
+   Local definitions
+----------------------------------------- */
+#define     RECORD_BYTES            24          // Size of trace_record_t on the RPi
+#define     ADDRESS_SPACE           65536
+#define     CALL_STACK_MAX          256
+#define     TOP_ROUTINES            30
+
+#define     ROM_VECTORS             0xbff2      // SWI3 to RESET vectors at the top of the ROM
+
+/* Indexed addressing post-byte bit fields, as in cpu.c
+ */
+#define     INDX_POST_5BIT_OFF      0x80
+#define     INDX_POST_REG           0x60
+#define     INDX_POST_INDIRECT      0x10
+#define     INDX_POST_MODE          0x0f
+
+/* Op-codes that enter and leave routines
+ */
+#define     OP_BSR                  0x8d
+#define     OP_LBSR                 0x17
+#define     OP_JSR_DIRECT           0x9d
+#define     OP_JSR_INDEXED          0xad
+#define     OP_JSR_EXTENDED         0xbd
+#define     OP_SWI                  0x3f
+#define     OP_RTS                  0x39
+#define     OP_RTI                  0x3b
+#define     OP_PULS                 0x35
+#define     OP_PULU                 0x37
+#define     PUL_PC                  0x80
+
+typedef struct
+{
+    int     entry;                  // Routine entry address
+    int     s;                      // S before the call
+    long    start_cycles;           // Total cycles at entry
+} frame_t;
+
+typedef struct
+{
+    long    calls;
+    long    instructions;
+    long    self_cycles;
+    long    total_cycles;
+} routine_t;
+
+typedef struct
+{
+    int     index;                  // Into machine_code[]
+    int     length;                 // Byte count including prefix and operands
+    char    text[48];               // Mnemonic and operands
+    int     target;                 // Call target, or -1
+    int     call;
+    int     ret;
+} disasm_t;
+
+/* -----------------------------------------
+   Module static functions
+----------------------------------------- */
+static int   read_record(FILE *fp, trace_record_t *record);
+static void  disassemble(trace_record_t *record, disasm_t *instr);
+static int   format_indexed(trace_record_t *record, int offset, int next_pc, char *text);
+static void  format_address(int address, char *text);
+static void  format_registers(char *text, int post_byte, int push_pull);
+static void  load_symbols(char *file_name);
+static void  rom_symbols(void);
+static int   parse_address(char *text, int *address);
+static int   find_symbol(char *name);
+static void  enter_routine(int entry, int s, int delta_s);
+static void  leave_routine(void);
+static int   in_routine(int entry);
+static void  print_summary(int top);
+static int   compare_routines(const void *a, const void *b);
+
+/* -----------------------------------------
+   Module globals
+----------------------------------------- */
+static char        *symbol[ADDRESS_SPACE];
+static routine_t    routine[ADDRESS_SPACE];
+
+static frame_t      call_stack[CALL_STACK_MAX];
+static int          depth = 0;
+static long         total_cycles = 0;
+static long         total_instructions = 0;
+static long         skipped_bytes = 0;
+
+static const char  *index_reg[] = { "x", "y", "u", "s" };
+static const char  *tfr_reg[] = { "d", "x", "y", "u", "s", "pc", "?", "?",
+                                  "a", "b", "cc", "dp", "?", "?", "?", "?" };
+
+/*------------------------------------------------
+ * main()
+ *
+ */
+int main(int argc, char *argv[])
+{
+    FILE           *fp = stdin;
+    trace_record_t  record;
+    disasm_t        instr;
+    char            line[160];
+    char           *mnemonic = 0;
+    int             c, i, start, end;
+    int             range_start = 0, range_end = ADDRESS_SPACE - 1;
+    int             routine_entry = -1;
+    int             listing = 1, summary = 0, brief = 0, top = TOP_ROUTINES;
+    int             swi_entry = 0;
+    long            first = 0, lines = -1, listed = 0;
+
+    rom_symbols();
+
+    while ( (c = getopt(argc, argv, "s:a:r:m:f:l:bqSt:")) != -1 )
+    {
+        switch ( c )
+        {
+            case 's':
+                load_symbols(optarg);
+                break;
+
+            case 'a':
+                if ( sscanf(optarg, "%x-%x", &start, &end) == 2 )
+                {
+                    range_start = start;
+                    range_end = end;
+                }
+                else if ( sscanf(optarg, "%x", &start) == 1 )
+                {
+                    range_start = start;
+                    range_end = start;
+                }
+                else
+                {
+                    fprintf(stderr, "tracedump: bad address range '%s'\n", optarg);
+                    return 1;
+                }
+                break;
+
+            case 'r':
+                routine_entry = find_symbol(optarg);
+                if ( routine_entry == -1 && !parse_address(optarg, &routine_entry) )
+                {
+                    fprintf(stderr, "tracedump: unknown routine '%s'\n", optarg);
+                    return 1;
+                }
+                break;
+
+            case 'm':
+                mnemonic = optarg;
+                break;
+
+            case 'f':
+                first = atol(optarg);
+                break;
+
+            case 'l':
+                lines = atol(optarg);
+                break;
+
+            case 'b':
+                brief = 1;
+                break;
+
+            case 'q':
+                listing = 0;
+                summary = 1;
+                break;
+
+            case 'S':
+                summary = 1;
+                break;
+
+            case 't':
+                top = atoi(optarg);
+                break;
+
+            default:
+                fprintf(stderr, "Usage: tracedump [-s sym_file] [-a addr[-addr]] [-r routine] [-m mnemonic]\n"
+                                "                 [-f first] [-l lines] [-b] [-q] [-S] [-t top] [trace_file]\n");
+                return 1;
+        }
+    }
+
+    if ( optind < argc )
+    {
+        fp = fopen(argv[optind], "rb");
+        if ( fp == NULL )
+        {
+            fprintf(stderr, "tracedump: cannot open '%s'\n", argv[optind]);
+            return 1;
+        }
+    }
+
+    while ( read_record(fp, &record) )
+    {
+        disassemble(&record, &instr);
+
+        /* Interrupts enter their service routine before the instruction,
+         * and S above the entry stack pointer leaves routines
+         * that did not return with RTS or RTI.
+         */
+        if ( record.flags & TRACE_FLAG_NMI )
+            enter_routine(record.pc, record.s, 12);
+        else if ( record.flags & TRACE_FLAG_FIRQ )
+            enter_routine(record.pc, record.s, 3);
+        else if ( record.flags & TRACE_FLAG_IRQ )
+            enter_routine(record.pc, record.s, 12);
+        else if ( swi_entry )
+            enter_routine(record.pc, record.s, 12);
+        else if ( depth == 0 )
+            enter_routine(record.pc, record.s, 0);
+
+        swi_entry = 0;
+
+        while ( depth > 1 && record.s > call_stack[depth - 1].s )
+            leave_routine();
+
+        routine[call_stack[depth - 1].entry].instructions++;
+        routine[call_stack[depth - 1].entry].self_cycles += record.cycles;
+
+        if ( listing &&
+             total_instructions >= first &&
+             (lines < 0 || listed < lines) &&
+             record.pc >= range_start && record.pc <= range_end &&
+             (routine_entry == -1 || in_routine(routine_entry)) &&
+             (mnemonic == 0 || strcmp(mnemonic, machine_code[instr.index].mnem) == 0) )
+        {
+            if ( record.flags & TRACE_FLAG_NMI )
+                printf("*** NMI\n");
+            if ( record.flags & TRACE_FLAG_FIRQ )
+                printf("*** FIRQ\n");
+            if ( record.flags & TRACE_FLAG_IRQ )
+                printf("*** IRQ\n");
+            if ( symbol[record.pc] )
+                printf("%s:\n", symbol[record.pc]);
+
+            c = sprintf(line, "%9ld  %04x  ", total_instructions, record.pc);
+            for ( i = 0; i < TRACE_CODE_BYTES; i++ )
+            {
+                if ( i < instr.length )
+                    c += sprintf(&line[c], "%02x ", record.code[i]);
+                else
+                    c += sprintf(&line[c], "   ");
+            }
+            c += sprintf(&line[c], " %-24s", instr.text);
+
+            switch ( machine_code[instr.index].mode )
+            {
+                case ADDR_DIRECT:
+                case ADDR_INDEXED:
+                case ADDR_EXTENDED:
+                    c += sprintf(&line[c], " ea=%04x", record.eff_addr);
+                    break;
+
+                default:
+                    c += sprintf(&line[c], "        ");
+            }
+
+            if ( !brief )
+                c += sprintf(&line[c], "  a=%02x b=%02x x=%04x y=%04x u=%04x s=%04x dp=%02x cc=%02x",
+                             record.a, record.b, record.x, record.y, record.u, record.s, record.dp, record.cc);
+
+            sprintf(&line[c], "  %2d%s", record.cycles,
+                    (record.flags & TRACE_FLAG_EXCEPTION) ? "  EXCEPTION" : "");
+
+            printf("%s\n", line);
+            listed++;
+        }
+
+        total_instructions++;
+        total_cycles += record.cycles;
+
+        if ( instr.call && instr.target == -1 )
+            swi_entry = 1;
+        else if ( instr.call )
+            enter_routine(instr.target, record.s, 0);
+        else if ( instr.ret && depth > 1 )
+            leave_routine();
+    }
+
+    if ( fp != stdin )
+        fclose(fp);
+
+    while ( depth > 0 )
+        leave_routine();
+
+    if ( skipped_bytes )
+        fprintf(stderr, "tracedump: skipped %ld bytes between records\n", skipped_bytes);
+
+    if ( summary )
+        print_summary(top);
+
+    return 0;
+}
+
+/*------------------------------------------------
+ * read_record()
+ *
+ *  Read the next trace record, skipping bytes up to a sync byte.
+ *  Fields are little endian as written by the RPi.
+ *
+ *  param:  Input stream and record to fill
+ *  return: 1- record read, 0- end of input
+ */
+static int read_record(FILE *fp, trace_record_t *record)
+{
+    uint8_t buffer[RECORD_BYTES];
+    int     c;
+
+    do
+    {
+        c = fgetc(fp);
+        if ( c == EOF )
+            return 0;
+        if ( c != TRACE_SYNC )
+            skipped_bytes++;
+    }
+    while ( c != TRACE_SYNC );
+
+    buffer[0] = c;
+    if ( fread(&buffer[1], 1, RECORD_BYTES - 1, fp) != RECORD_BYTES - 1 )
+        return 0;
+
+    record->sync = buffer[0];
+    record->flags = buffer[1];
+    record->pc = buffer[2] + (buffer[3] << 8);
+    memcpy(record->code, &buffer[4], TRACE_CODE_BYTES);
+    record->cycles = buffer[9];
+    record->eff_addr = buffer[10] + (buffer[11] << 8);
+    record->a = buffer[12];
+    record->b = buffer[13];
+    record->dp = buffer[14];
+    record->cc = buffer[15];
+    record->x = buffer[16] + (buffer[17] << 8);
+    record->y = buffer[18] + (buffer[19] << 8);
+    record->u = buffer[20] + (buffer[21] << 8);
+    record->s = buffer[22] + (buffer[23] << 8);
+
+    return 1;
+}
+
+/*------------------------------------------------
+ * disassemble()
+ *
+ *  Disassemble the instruction of a trace record.
+ *  Op-codes are looked up in machine_code[] the same way cpu_run() does.
+ *
+ *  param:  Trace record and disassembly output
+ *  return: Nothing
+ */
+static void disassemble(trace_record_t *record, disasm_t *instr)
+{
+    const uint8_t  *code = record->code;
+    char           *text;
+    int             op_code, prefix = 0, offset, operand, next_pc;
+
+    op_code = code[0];
+    offset = 1;
+    instr->index = op_code;
+
+    if ( op_code == 0x10 || op_code == 0x11 )
+    {
+        prefix = op_code;
+        op_code = code[1];
+        offset = 2;
+
+        /* An op-code not in the table decodes as illegal
+         */
+        instr->index = 0x01;
+        for ( operand = (prefix == 0x10) ? OP_CODE10 : OP_CODE11;
+              operand < ((prefix == 0x10) ? OP_CODE11 : sizeof(machine_code)/sizeof(machine_code_t));
+              operand++ )
+        {
+            if ( machine_code[operand].op == op_code )
+            {
+                instr->index = operand;
+                break;
+            }
+        }
+    }
+
+    instr->length = machine_code[instr->index].bytes;
+    if ( instr->length < offset )
+        instr->length = offset;
+    instr->target = -1;
+    instr->call = 0;
+    instr->ret = 0;
+
+    text = instr->text;
+    text += sprintf(text, "%-6s", machine_code[instr->index].mnem);
+    next_pc = (record->pc + instr->length) & 0xffff;
+
+    switch ( machine_code[instr->index].mode )
+    {
+        case ADDR_DIRECT:
+            sprintf(text, "<$%02x", code[offset]);
+            instr->target = record->eff_addr;
+            break;
+
+        case ADDR_EXTENDED:
+            format_address((code[offset] << 8) + code[offset + 1], text);
+            instr->target = (code[offset] << 8) + code[offset + 1];
+            break;
+
+        case ADDR_IMMEDIATE:
+            if ( prefix == 0 && (op_code >= 0x34 && op_code <= 0x37) )
+                format_registers(text, code[offset], op_code);
+            else if ( prefix == 0 && (op_code == 0x1e || op_code == 0x1f) )
+                sprintf(text, "%s,%s", tfr_reg[code[offset] >> 4], tfr_reg[code[offset] & 0x0f]);
+            else
+                sprintf(text, "#$%02x", code[offset]);
+            break;
+
+        case ADDR_LIMMEDIATE:
+            sprintf(text, "#$%04x", (code[offset] << 8) + code[offset + 1]);
+            break;
+
+        case ADDR_RELATIVE:
+            instr->target = (next_pc + (int8_t) code[offset]) & 0xffff;
+            format_address(instr->target, text);
+            break;
+
+        case ADDR_LRELATIVE:
+            instr->target = (next_pc + (code[offset] << 8) + code[offset + 1]) & 0xffff;
+            format_address(instr->target, text);
+            break;
+
+        case ADDR_INDEXED:
+            instr->length += format_indexed(record, offset, next_pc, text);
+            instr->target = record->eff_addr;
+            break;
+
+        case ADDR_INHERENT:
+            if ( op_code == 0x3c )
+                sprintf(text, "#$%02x", code[offset]);
+            break;
+
+        default:
+            break;
+    }
+
+    /* Routine entry and exit, SWI enters the routine
+     * at the next record's PC
+     */
+    if ( prefix == 0 )
+    {
+        instr->call = (op_code == OP_BSR || op_code == OP_LBSR ||
+                       op_code == OP_JSR_DIRECT || op_code == OP_JSR_INDEXED || op_code == OP_JSR_EXTENDED);
+        instr->ret = (op_code == OP_RTS || op_code == OP_RTI ||
+                      ((op_code == OP_PULS || op_code == OP_PULU) && (code[offset] & PUL_PC)));
+    }
+
+    if ( op_code == OP_SWI && machine_code[instr->index].mode == ADDR_INHERENT )
+    {
+        instr->call = 1;
+        instr->target = -1;
+    }
+}
+
+/*------------------------------------------------
+ * format_indexed()
+ *
+ *  Format an indexed addressing post-byte and its offset bytes.
+ *
+ *  param:  Trace record, post-byte offset, address of next instruction, output text
+ *  return: Count of offset bytes after the post-byte
+ */
+static int format_indexed(trace_record_t *record, int offset, int next_pc, char *text)
+{
+    const uint8_t  *code = record->code;
+    const char     *reg;
+    char            operand[24];
+    int             post_byte, extra = 0, value;
+
+    post_byte = code[offset];
+    reg = index_reg[(post_byte & INDX_POST_REG) >> 5];
+
+    if ( !(post_byte & INDX_POST_5BIT_OFF) )
+    {
+        value = post_byte & 0x1f;
+        if ( value & 0x10 )
+            value -= 32;
+        sprintf(text, "%d,%s", value, reg);
+        return 0;
+    }
+
+    switch ( post_byte & INDX_POST_MODE )
+    {
+        case 0:
+            sprintf(operand, ",%s+", reg);
+            break;
+        case 1:
+            sprintf(operand, ",%s++", reg);
+            break;
+        case 2:
+            sprintf(operand, ",-%s", reg);
+            break;
+        case 3:
+            sprintf(operand, ",--%s", reg);
+            break;
+        case 4:
+            sprintf(operand, ",%s", reg);
+            break;
+        case 5:
+            sprintf(operand, "b,%s", reg);
+            break;
+        case 6:
+            sprintf(operand, "a,%s", reg);
+            break;
+        case 8:
+            sprintf(operand, "%d,%s", (int8_t) code[offset + 1], reg);
+            extra = 1;
+            break;
+        case 9:
+            sprintf(operand, "$%04x,%s", (code[offset + 1] << 8) + code[offset + 2], reg);
+            extra = 2;
+            break;
+        case 11:
+            sprintf(operand, "d,%s", reg);
+            break;
+        case 12:
+            value = (next_pc + 1 + (int8_t) code[offset + 1]) & 0xffff;
+            sprintf(operand, "$%04x,pcr", value);
+            extra = 1;
+            break;
+        case 13:
+            value = (next_pc + 2 + (code[offset + 1] << 8) + code[offset + 2]) & 0xffff;
+            sprintf(operand, "$%04x,pcr", value);
+            extra = 2;
+            break;
+        case 15:
+            format_address((code[offset + 1] << 8) + code[offset + 2], operand);
+            extra = 2;
+            break;
+        default:
+            sprintf(operand, "???");
+    }
+
+    if ( post_byte & INDX_POST_INDIRECT )
+        sprintf(text, "[%s]", operand);
+    else
+        sprintf(text, "%s", operand);
+
+    return extra;
+}
+
+/*------------------------------------------------
+ * format_address()
+ *
+ *  Format an address as a symbol name if one is defined.
+ *
+ *  param:  Address and output text
+ *  return: Nothing
+ */
+static void format_address(int address, char *text)
+{
+    if ( symbol[address] )
+        sprintf(text, "%.20s", symbol[address]);
+    else
+        sprintf(text, "$%04x", address);
+}
+
+/*------------------------------------------------
+ * format_registers()
+ *
+ *  Format the register list of PSHS, PULS, PSHU and PULU.
+ *
+ *  param:  Output text, post-byte and op-code
+ *  return: Nothing
+ */
+static void format_registers(char *text, int post_byte, int push_pull)
+{
+    static const char  *reg_s[] = { "cc", "a", "b", "dp", "x", "y", "u", "pc" };
+    int                 bit;
+
+    text[0] = 0;
+    for ( bit = 0; bit < 8; bit++ )
+    {
+        if ( post_byte & (1 << bit) )
+        {
+            if ( text[0] )
+                strcat(text, ",");
+            /* PSHU/PULU use S in place of U
+             */
+            if ( bit == 6 && (push_pull == 0x36 || push_pull == 0x37) )
+                strcat(text, "s");
+            else
+                strcat(text, reg_s[bit]);
+        }
+    }
+}
+
+/*------------------------------------------------
+ * load_symbols()
+ *
+ *  Load symbols from an address list file with lines of
+ *  "ADDR NAME", "$ADDR NAME", "0xADDR NAME", "NAME EQU $ADDR" or "NAME = $ADDR".
+ *  Empty lines and lines starting with ';', '*' or '#' are ignored.
+ *
+ *  param:  File name
+ *  return: Nothing
+ */
+static void load_symbols(char *file_name)
+{
+    FILE   *fp;
+    char    line[256], first[64], second[64], third[64];
+    char   *name;
+    int     tokens, address, count = 0;
+
+    fp = fopen(file_name, "r");
+    if ( fp == NULL )
+    {
+        fprintf(stderr, "tracedump: cannot open symbol file '%s'\n", file_name);
+        exit(1);
+    }
+
+    while ( fgets(line, sizeof(line), fp) )
+    {
+        if ( line[0] == ';' || line[0] == '*' || line[0] == '#' )
+            continue;
+
+        tokens = sscanf(line, "%63s %63s %63s", first, second, third);
+        if ( tokens < 2 )
+            continue;
+
+        name = 0;
+        if ( tokens == 3 &&
+             (strcasecmp(second, "equ") == 0 || strcmp(second, "=") == 0) &&
+             parse_address(third, &address) )
+        {
+            name = first;
+            if ( name[strlen(name) - 1] == ':' )
+                name[strlen(name) - 1] = 0;
+        }
+        else if ( parse_address(first, &address) )
+        {
+            name = second;
+        }
+
+        if ( name )
+        {
+            free(symbol[address]);
+            symbol[address] = strdup(name);
+            count++;
+        }
+    }
+
+    fclose(fp);
+
+    if ( count == 0 )
+        fprintf(stderr, "tracedump: no symbols in '%s'\n", file_name);
+}
+
+/*------------------------------------------------
+ * rom_symbols()
+ *
+ *  Name the service routines of the ROM interrupt vectors.
+ *
+ *  param:  Nothing
+ *  return: Nothing
+ */
+static void rom_symbols(void)
+{
+    static const char  *vector_name[] = { "SWI3", "SWI2", "FIRQ", "IRQ", "SWI", "NMI", "RESET" };
+    int                 i, vector, address;
+
+    for ( i = 0; i < 7; i++ )
+    {
+        vector = ROM_VECTORS + 2 * i - LOAD_ADDRESS;
+        if ( vector + 1 >= sizeof(code) / sizeof(int) )
+            return;
+
+        address = (code[vector] << 8) + code[vector + 1];
+        if ( symbol[address] == 0 )
+            symbol[address] = strdup(vector_name[i]);
+    }
+}
+
+/*------------------------------------------------
+ * parse_address()
+ *
+ *  Parse a hex address with an optional '$' or '0x' prefix.
+ *
+ *  param:  Text and address output
+ *  return: 1- valid 16-bit address, 0- otherwise
+ */
+static int parse_address(char *text, int *address)
+{
+    char   *end;
+    long    value;
+
+    if ( text[0] == '$' )
+        text++;
+    else if ( text[0] == '0' && (text[1] == 'x' || text[1] == 'X') )
+        text += 2;
+
+    if ( !isxdigit((int) text[0]) )
+        return 0;
+
+    value = strtol(text, &end, 16);
+    if ( *end != 0 || value < 0 || value >= ADDRESS_SPACE )
+        return 0;
+
+    *address = value;
+
+    return 1;
+}
+
+/*------------------------------------------------
+ * find_symbol()
+ *
+ *  Find the address of a symbol.
+ *
+ *  param:  Symbol name
+ *  return: Address, or -1 if not found
+ */
+static int find_symbol(char *name)
+{
+    int     address;
+
+    for ( address = 0; address < ADDRESS_SPACE; address++ )
+    {
+        if ( symbol[address] && strcmp(symbol[address], name) == 0 )
+            return address;
+    }
+
+    return -1;
+}
+
+/*------------------------------------------------
+ * enter_routine()
+ *
+ *  Push a routine on the call stack.
+ *
+ *  param:  Routine entry address, S register, bytes the
+ *          interrupt pushed before S was recorded
+ *  return: Nothing
+ */
+static void enter_routine(int entry, int s, int delta_s)
+{
+    if ( depth == CALL_STACK_MAX )
+    {
+        /* Deep recursion or a lost return, drop the oldest frame
+         */
+        memmove(&call_stack[0], &call_stack[1], sizeof(frame_t) * (CALL_STACK_MAX - 1));
+        depth--;
+    }
+
+    call_stack[depth].entry = entry;
+    call_stack[depth].s = s + delta_s;
+    call_stack[depth].start_cycles = total_cycles;
+    depth++;
+
+    routine[entry].calls++;
+}
+
+/*------------------------------------------------
+ * leave_routine()
+ *
+ *  Pop the call stack and account the cycles of the routine
+ *  including its callees.
+ *
+ *  param:  Nothing
+ *  return: Nothing
+ */
+static void leave_routine(void)
+{
+    depth--;
+    routine[call_stack[depth].entry].total_cycles += total_cycles - call_stack[depth].start_cycles;
+}
+
+/*------------------------------------------------
+ * in_routine()
+ *
+ *  Check if a routine is on the call stack.
+ *
+ *  param:  Routine entry address
+ *  return: 1- executing inside the routine, 0- otherwise
+ */
+static int in_routine(int entry)
+{
+    int     i;
+
+    for ( i = 0; i < depth; i++ )
+    {
+        if ( call_stack[i].entry == entry )
+            return 1;
+    }
+
+    return 0;
+}
+
+/*------------------------------------------------
+ * print_summary()
+ *
+ *  Print routines sorted by their own cycle count.
+ *
+ *  param:  Number of routines to print
+ *  return: Nothing
+ */
+static void print_summary(int top)
+{
+    static int  order[ADDRESS_SPACE];
+    char        name[32];
+    int         i, count = 0;
+
+    for ( i = 0; i < ADDRESS_SPACE; i++ )
+    {
+        if ( routine[i].instructions || routine[i].calls )
+            order[count++] = i;
+    }
+
+    qsort(order, count, sizeof(int), compare_routines);
+
+    printf("\n%ld instructions, %ld cycles, %d routines\n\n", total_instructions, total_cycles, count);
+    printf("routine                  calls  instructions   self cycles      %%  total cycles\n");
+
+    for ( i = 0; i < count && i < top; i++ )
+    {
+        if ( symbol[order[i]] )
+            snprintf(name, sizeof(name), "%s", symbol[order[i]]);
+        else
+            snprintf(name, sizeof(name), "sub_%04x", order[i]);
+
+        printf("%-20.20s %9ld %13ld %13ld %6.2f %13ld\n",
+               name, routine[order[i]].calls, routine[order[i]].instructions,
+               routine[order[i]].self_cycles,
+               total_cycles ? (100.0 * routine[order[i]].self_cycles / total_cycles) : 0.0,
+               routine[order[i]].total_cycles);
+    }
+}
+
+/*------------------------------------------------
+ * compare_routines()
+ *
+ *  qsort() compare function, by descending self cycles.
+ *
+ */
+static int compare_routines(const void *a, const void *b)
+{
+    long    self_a = routine[*(const int*) a].self_cycles;
+    long    self_b = routine[*(const int*) b].self_cycles;
+
+    return (self_a < self_b) - (self_a > self_b);
+}
@@ -0,0 +1,113 @@
+/********************************************************************
+ * trace.c
+ *
+ *  Binary CPU trace module (CPU_TRACE=2).
+ *
+ *  Trace records written by cpu_run() are queued in a RAM ring buffer
+ *  and sent to the serial console without waiting on the UART.
+ *  All formatting is done on the host by tools/tracedump.c.
+ *
+ *  October 19, 2026
+ *
+ *******************************************************************/
+
+#include    <stdint.h>
+
+#include    "rpi.h"
+#include    "trace.h"
+
+/* -----------------------------------------
+   Local definitions
+----------------------------------------- */
+#define     TRACE_RECORDS           16384       // Ring buffer size, a power of 2
+#define     TRACE_MASK              (TRACE_RECORDS - 1)
+
+/* -----------------------------------------
+   Module static functions
+----------------------------------------- */
+
+/* -----------------------------------------
+   Module globals
+----------------------------------------- */
+static trace_record_t   trace_buffer[TRACE_RECORDS];
+static int              trace_head = 0;         // Next record to write
+static int              trace_tail = 0;         // Next record to send
+static int              trace_offset = 0;       // Bytes of the tail record already sent
+
+/*------------------------------------------------
+ * trace_init()
+ *
+ *  Initialize the trace ring buffer
+ *
+ *  param:  Nothing
+ *  return: Nothing
+ */
+void trace_init(void)
+{
+    trace_head = 0;
+    trace_tail = 0;
+    trace_offset = 0;
+}
+
+/*------------------------------------------------
+ * trace_write()
+ *
+ *  Queue a trace record.
+ *  The caller must check trace_full() and drain the buffer,
+ *  a record written to a full buffer is dropped.
+ *
+ *  param:  Pointer to trace record
+ *  return: Nothing
+ */
+void trace_write(trace_record_t *record)
+{
+    if ( trace_full() )
+        return;
+
+    trace_buffer[trace_head & TRACE_MASK] = *record;
+    trace_head++;
+}
+
+/*------------------------------------------------
+ * trace_drain()
+ *
+ *  Send queued trace records to the serial console
+ *  for as long as the UART accepts bytes without waiting.
+ *
+ *  param:  Nothing
+ *  return: Number of records still queued
+ */
+int trace_drain(void)
+{
+    uint8_t    *record;
+    int         sent;
+
+    while ( trace_tail != trace_head )
+    {
+        record = (uint8_t*) &trace_buffer[trace_tail & TRACE_MASK];
+
+        sent = rpi_uart_write(&record[trace_offset], sizeof(trace_record_t) - trace_offset);
+        trace_offset += sent;
+
+        if ( trace_offset < sizeof(trace_record_t) )
+            break;
+
+        trace_offset = 0;
+        trace_tail++;
+    }
+
+    return (trace_head - trace_tail);
+}
+
+/*------------------------------------------------
+ * trace_full()
+ *
+ *  Check if the trace ring buffer is full
+ *
+ *  param:  Nothing
+ *  return: 1- buffer is full, 0- otherwise
+ */
+int trace_full(void)
+{
+    return ((trace_head - trace_tail) >= TRACE_RECORDS);
+}
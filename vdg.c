@@ -12,12 +12,15 @@
  *******************************************************************/
 
 #include    <stdint.h>
+#include    <string.h>
 
 #include    "cpu.h"
 #include    "mem.h"
 #include    "vdg.h"
 #include    "rpi.h"
 #include    "printf.h"
+#include    "log.h"
+#include    "pixel.h"
 
 #include    "dragon/font.h"
 #include    "dragon/semigraph.h"
@@ -70,6 +73,8 @@
 #define     RES_VERT_PIX            1
 #define     RES_MEM                 2
 
+#define     VIDEO_MEM_MAX           6144    // Largest video RAM of a mode
+
 typedef enum
 {                       // Colors   Res.     Bytes BASIC
     ALPHA_INTERNAL = 0, // 2 color  32x16    512   Default
@@ -91,13 +96,17 @@ typedef enum
     UNDEFINED,          // Undefined
 } video_mode_t;
 
+/* The VDG mode log messages are one per video_mode_t mode, in order
+ */
+_Static_assert((LOG_VDG_MODE_DMA - LOG_VDG_MODE_ALPHA_INT) == DMA, "VDG mode log messages do not match video_mode_t");
+
 /* -----------------------------------------
    Module static functions
 ----------------------------------------- */
-static void vdg_draw_char(int c, int col, int row);
-static void vdg_draw_semig6(int c, int col, int row);
-static void vdg_draw_semig_ext(video_mode_t mode, int video_mem_base, int text_buffer_length);
-static video_mode_t vdg_get_mode(void);
+static void vdg_draw_char(int c, int col, int row) SECTION_HOT;
+static void vdg_draw_semig6(int c, int col, int row) SECTION_HOT;
+static void vdg_draw_semig_ext(video_mode_t mode, int video_mem_base, int text_buffer_length) SECTION_HOT;
+static video_mode_t vdg_get_mode(void) SECTION_HOT;
 
 /* -----------------------------------------
    Module globals
@@ -110,7 +119,12 @@ static video_mode_t prev_mode;
 
 static uint8_t *fbp;
 
-static int const resolution[][3] = {
+static int      artifact_mode = VDG_ARTIFACT_OFF;
+static int      mode_log = 1;
+
+static uint8_t  video_wrap[VIDEO_MEM_MAX];  // Video RAM that wraps past the end of memory
+
+static int const resolution[][3] SECTION_HOT_RODATA = {
     { SCREEN_WIDTH_PIX, SCREEN_HEIGHT_PIX, 512  },  // ALPHA_INTERNAL, 2 color 32x16 512B Default
     { SCREEN_WIDTH_PIX, SCREEN_HEIGHT_PIX, 512  },  // ALPHA_EXTERNAL, 4 color 32x16 512B
     { SCREEN_WIDTH_PIX, SCREEN_HEIGHT_PIX, 512  },  // SEMI_GRAPHICS_4, 8 color 64x32 512B
@@ -129,26 +143,7 @@ static int const resolution[][3] = {
     { 256, 192, 6144                            },  // DMA, 2 color 256x192 6144B
 };
 
-static char* const mode_name[] = {
-    "ALPHA_INT",  // ALPHA_INTERNAL, 2 color 32x16 512B Default
-    "ALPHA_EXT",  // ALPHA_EXTERNAL, 4 color 32x16 512B
-    "SEMI_GR4 ",  // SEMI_GRAPHICS_4, 8 color 64x32 512B
-    "SEMI_GR6 ",  // SEMI_GRAPHICS_6, 8 color 64x48 512B
-    "SEMI_GR8 ",  // SEMI_GRAPHICS_8, 8 color 64x64 2048B
-    "SEMI_GR12",  // SEMI_GRAPHICS_12, 8 color 64x96 3072B
-    "SEMI_GR24",  // SEMI_GRAPHICS_24, 8 color 64x192 6144B
-    "GRAPH_1C ",  // GRAPHICS_1C, 4 color 64x64 1024B
-    "GRAPH_1R ",  // GRAPHICS_1R, 2 color 128x64 1024B
-    "GRAPH_2C ",  // GRAPHICS_2C, 4 color 128x64 2048B
-    "GRAPH_2R ",  // GRAPHICS_2R, 2 color 128x96 1536B PMODE 0
-    "GRAPH_3C ",  // GRAPHICS_3C, 4 color 128x96 3072B PMODE 1
-    "GRAPH_3R ",  // GRAPHICS_3R, 2 color 128x192 3072B PMODE 2
-    "GRAPH_6C ",  // GRAPHICS_6C, 4 color 128x192 6144B PMODE 3
-    "GRAPH_6R ",  // GRAPHICS_6R, 2 color 256x192 6144B PMODE 4
-    "DMA      ",  // DMA, 2 color 256x192 6144B
-};
-
-static int const colors[] = {
+static int const colors[] SECTION_HOT_RODATA = {
         FB_LIGHT_GREEN,
         FB_YELLOW,
         FB_LIGHT_BLUE,
@@ -159,6 +154,16 @@ static int const colors[] = {
         FB_BROWN,
 };
 
+/* PMODE4 artifact colours of pixel pairs, 00, 01, 10, 11,
+ * for the two colour phases and the two colour sets
+ */
+static int const artifact_colors[] SECTION_HOT_RODATA = {
+        FB_BLACK, FB_BLUE, FB_BROWN, FB_LIGHT_GREEN,            // Blue-red, CSS 0
+        FB_BLACK, FB_LIGHT_BLUE, FB_LIGHT_RED, FB_WHITE,        // Blue-red, CSS 1
+        FB_BLACK, FB_BROWN, FB_BLUE, FB_LIGHT_GREEN,            // Red-blue, CSS 0
+        FB_BLACK, FB_LIGHT_RED, FB_LIGHT_BLUE, FB_WHITE,        // Red-blue, CSS 1
+};
+
 /*------------------------------------------------
  * vdg_init()
  *
@@ -200,12 +205,10 @@ void vdg_render(void)
 {
     int     col, row, c;
 
-    uint8_t vdg_data;
     int     color;
-    int     element;
     int     vdg_mem_base;
-    int     vdg_mem_offset;
-    int     fb_offset = 0;
+    int     video_bytes;
+    uint8_t *video_mem;
 
     /* VDG/SAM mode settings
      */
@@ -215,19 +218,39 @@ void vdg_render(void)
         fbp = rpi_fb_resolution(resolution[current_mode][RES_HORZ_PIX], resolution[current_mode][RES_VERT_PIX]);
         if ( fbp == 0L )
         {
-            printf("vdg_render(): Frame buffer error.\n");
+            LOG0(LOG_VDG_FB_ERROR);
             rpi_halt();
         }
 
         prev_mode = current_mode;
 
-        printf("VDG mode: %s\n", mode_name[current_mode]);
+        if ( mode_log )
+        {
+            if ( current_mode >= ALPHA_INTERNAL && current_mode <= DMA )
+                LOG0(LOG_VDG_MODE_ALPHA_INT + current_mode);
+            else
+                LOG1(LOG_VDG_MODE, current_mode);
+        }
     }
 
     /* Render screen content to RPi frame buffer
      */
     vdg_mem_base = video_ram_offset << 9;
 
+    /* Graphics modes read video RAM directly from the memory image.
+     * The SAM video address counter wraps at 16 bits, so video RAM that
+     * runs past the end of memory is copied and wrapped to address 0.
+     */
+    video_mem = mem_get_map() + vdg_mem_base;
+    video_bytes = resolution[current_mode][RES_MEM];
+
+    if ( (vdg_mem_base + video_bytes) > MEMORY )
+    {
+        memcpy(video_wrap, video_mem, MEMORY - vdg_mem_base);
+        memcpy(&video_wrap[MEMORY - vdg_mem_base], mem_get_map(), video_bytes - (MEMORY - vdg_mem_base));
+        video_mem = video_wrap;
+    }
+
     switch ( current_mode )
     {
         case ALPHA_INTERNAL:
@@ -257,62 +280,33 @@ void vdg_render(void)
         case GRAPHICS_2C:
         case GRAPHICS_3C:
         case GRAPHICS_6C:
-            for ( vdg_mem_offset = 0; vdg_mem_offset < resolution[current_mode][RES_MEM]; vdg_mem_offset++)
-            {
-                vdg_data = mem_read(vdg_mem_base + vdg_mem_offset);
+            pixel_expand_2bpp(fbp, video_mem, video_bytes,
+                              &colors[4 * (pia_video_mode & PIA_COLOR_SET)],
+                              (current_mode == GRAPHICS_6C) ? 2 : 1);
+            break;
 
-                for ( element = 0; element < 4; element++)
-                {
-                    color = (int)((vdg_data >> (2 * (3 - element))) & 0x03) + (4 * (pia_video_mode & PIA_COLOR_SET));
-                    color = colors[color];
-                    *((uint8_t*)(fbp + fb_offset)) = (uint8_t) color;
-                    fb_offset++;
-
-                    if ( current_mode == GRAPHICS_6C )
-                    {
-                        *((uint8_t*)(fbp + fb_offset)) = (uint8_t) color;
-                        fb_offset++;
-                    }
-                }
+        case GRAPHICS_6R:
+            /* NTSC artifact colours: each pixel pair is one
+             * coloured pixel of double width
+             */
+            if ( artifact_mode != VDG_ARTIFACT_OFF )
+            {
+                pixel_expand_2bpp(fbp, video_mem, video_bytes,
+                                  &artifact_colors[8 * (artifact_mode - 1) + 4 * (pia_video_mode & PIA_COLOR_SET)], 2);
+                break;
             }
-            break;
+            /* no break */
 
         case GRAPHICS_1R:
         case GRAPHICS_2R:
         case GRAPHICS_3R:
-        case GRAPHICS_6R:
-            for ( vdg_mem_offset = 0; vdg_mem_offset < resolution[current_mode][RES_MEM]; vdg_mem_offset++)
-            {
-                vdg_data = mem_read(vdg_mem_base + vdg_mem_offset);
+            if ( pia_video_mode & PIA_COLOR_SET )
+                color = colors[DEF_COLOR_CSS_1];
+            else
+                color = colors[DEF_COLOR_CSS_0];
 
-                for ( element = 0; element < 8; element++)
-                {
-                    if ( (vdg_data >> (7 - element)) & 0x01 )
-                    {
-                        if ( pia_video_mode & PIA_COLOR_SET )
-                        {
-                            color = colors[DEF_COLOR_CSS_1];
-                        }
-                        else
-                        {
-                            color = colors[DEF_COLOR_CSS_0];
-                        }
-                    }
-                    else
-                    {
-                        color = FB_BLACK;
-                    }
-
-                    *((uint8_t*)(fbp + fb_offset)) = (uint8_t) color;
-                    fb_offset++;
-
-                    if ( current_mode == GRAPHICS_3R )
-                    {
-                        *((uint8_t*)(fbp + fb_offset)) = (uint8_t) color;
-                        fb_offset++;
-                    }
-                }
-            }
+            pixel_expand_1bpp(fbp, video_mem, video_bytes,
+                              color, FB_BLACK, (current_mode == GRAPHICS_3R) ? 2 : 1);
             break;
 
         case SEMI_GRAPHICS_8:
@@ -323,13 +317,13 @@ void vdg_render(void)
         case SEMI_GRAPHICS_24:
         case ALPHA_EXTERNAL:
         case DMA:
-            printf("vdg_render(): Mode not supported %d\n", current_mode);
+            LOG1(LOG_VDG_MODE_UNSUPPORTED, current_mode);
             rpi_halt();
             break;
 
         default:
             {
-                printf("vdg_render(): Illegal mode.\n");
+                LOG1(LOG_VDG_MODE_ILLEGAL, current_mode);
                 rpi_halt();
             }
     }
@@ -391,6 +385,66 @@ void vdg_set_mode_pia(uint8_t pia_mode)
     pia_video_mode = pia_mode;
 }
 
+/*------------------------------------------------
+ * vdg_set_artifact()
+ *
+ *  Select PMODE4 (G6R) artifact colours, which NTSC
+ *  games use for four colour graphics in the 2 colour mode.
+ *
+ *  param:  VDG_ARTIFACT_OFF, VDG_ARTIFACT_BLUE_RED or VDG_ARTIFACT_RED_BLUE
+ *  return: Nothing
+ */
+void vdg_set_artifact(int artifact)
+{
+    artifact_mode = artifact;
+}
+
+/*------------------------------------------------
+ * vdg_set_mode_log()
+ *
+ *  Enable or disable the log message of a video mode change,
+ *  for the VDG benchmark that changes modes while it prints.
+ *
+ *  param:  1- log mode changes, 0- do not log
+ *  return: Nothing
+ */
+void vdg_set_mode_log(int enable)
+{
+    mode_log = enable;
+}
+
+/*------------------------------------------------
+ * vdg_get_state()
+ *
+ *  Get the VDG mode and video RAM offset for a machine snapshot.
+ *
+ *  param:  Pointer to VDG state data structure
+ *  return: Nothing
+ */
+void vdg_get_state(vdg_state_t *vdg_state)
+{
+    vdg_state->video_ram_offset = video_ram_offset;
+    vdg_state->pia_video_mode = pia_video_mode;
+    vdg_state->sam_video_mode = sam_video_mode;
+}
+
+/*------------------------------------------------
+ * vdg_set_state()
+ *
+ *  Set the VDG mode and video RAM offset from a state saved
+ *  by vdg_get_state(). The frame buffer resolution follows
+ *  on the next vdg_render().
+ *
+ *  param:  Pointer to VDG state data structure
+ *  return: Nothing
+ */
+void vdg_set_state(vdg_state_t *vdg_state)
+{
+    video_ram_offset = vdg_state->video_ram_offset;
+    pia_video_mode = vdg_state->pia_video_mode;
+    sam_video_mode = vdg_state->sam_video_mode;
+}
+
 /*------------------------------------------------
  * vdg_draw_char()
  *
@@ -413,22 +467,15 @@ void vdg_set_mode_pia(uint8_t pia_mode)
  */
 void vdg_draw_char(int c, int col, int row)
 {
-    uint8_t         pix_pos, bit_pattern;
-    int             px, py;
-    int             char_row, char_col, char_index;
+    int             char_row, char_index;
     uint32_t        fg_color, bg_color;
 
     const uint8_t  *bit_pattern_array;
-    uint32_t        byte_position;
     uint32_t        frame_buffer_index;
-    register        uint32_t    pixel_group;
 
     /* Common initialization
      */
-    byte_position = 0;
-    pixel_group = 0;
-    px = col * FONT_WIDTH;
-    py = row * FONT_HEIGHT;
+    frame_buffer_index = col * FONT_WIDTH + row * FONT_HEIGHT * SCREEN_WIDTH_PIX;
     bg_color = FB_BLACK;
 
     /* Mode dependent initializations
@@ -461,47 +508,12 @@ void vdg_draw_char(int c, int col, int row)
         bit_pattern_array = &font_img5x7[char_index][0];
     }
 
-    /* Output characters
+    /* Output characters, one 8 pixel scan line at a time
      */
-    for ( char_row = 0; char_row < FONT_HEIGHT; char_row++, py++ )
+    for ( char_row = 0; char_row < FONT_HEIGHT; char_row++ )
     {
-        bit_pattern = bit_pattern_array[char_row];
-
-        pix_pos = 0x80;
-
-        for ( char_col = 0; char_col < FONT_WIDTH; char_col++ )
-        {
-            /* Bit is set in Font, print pixel(s) in text color
-             */
-            if ( (bit_pattern & pix_pos) )
-            {
-                pixel_group += fg_color << byte_position;
-            }
-            /* Bit is cleared in Font
-             */
-            else
-            {
-                pixel_group += bg_color << byte_position;
-            }
-
-            /* Move to the next pixel position
-             */
-            pix_pos = pix_pos >> 1;
-
-            /* Render four pixels at once
-             */
-            if ( byte_position == 24 )
-            {
-                frame_buffer_index = px + py * SCREEN_WIDTH_PIX + char_col - 3;
-                *((uint32_t *)(fbp + frame_buffer_index)) = pixel_group;
-                byte_position = 0;
-                pixel_group = 0;
-            }
-            else
-            {
-                byte_position += 8;
-            }
-        }
+        pixel_expand_1bpp(fbp + frame_buffer_index, &bit_pattern_array[char_row], 1, fg_color, bg_color, 1);
+        frame_buffer_index += SCREEN_WIDTH_PIX;
     }
 }
 
@@ -520,23 +532,15 @@ void vdg_draw_char(int c, int col, int row)
  */
 static void vdg_draw_semig6(int c, int col, int row)
 {
-    uint8_t     pix_pos, bit_pattern;
-    int         px, py;
-    int         char_row, char_col, char_index;
+    int         char_row, char_index;
     int         fg_color, bg_color;
 
-    uint32_t    byte_position;
     uint32_t    frame_buffer_index;
-    register    uint32_t    pixel_group;
-
-    byte_position = 0;
-    pixel_group = 0;
 
     /* Convert text column and row to pixel positions
      * and adjust for non-semigraphics
      */
-    px = col * FONT_WIDTH;
-    py = row * FONT_HEIGHT;
+    frame_buffer_index = col * FONT_WIDTH + row * FONT_HEIGHT * SCREEN_WIDTH_PIX;
 
     /* Determine colors
      */
@@ -547,45 +551,10 @@ static void vdg_draw_semig6(int c, int col, int row)
      */
     char_index = (int)(((uint8_t) c) & SEMI_GRAPH6_MASK);
 
-    for ( char_row = 0; char_row < FONT_HEIGHT; char_row++, py++ )
+    for ( char_row = 0; char_row < FONT_HEIGHT; char_row++ )
     {
-        bit_pattern = semi_graph_6[char_index][char_row];
-
-        pix_pos = 0x80;
-
-        for ( char_col = 0; char_col < FONT_WIDTH; char_col++ )
-        {
-            /* Bit is set in Font, print pixel(s) in text color
-             */
-            if ( (bit_pattern & pix_pos) )
-            {
-                pixel_group += fg_color << byte_position;
-            }
-            /* Bit is cleared in Font
-             */
-            else
-            {
-                pixel_group += bg_color << byte_position;
-            }
-
-            /* Move to the next pixel position
-             */
-            pix_pos = pix_pos >> 1;
-
-            /* Render four pixels at once
-             */
-            if ( byte_position == 24 )
-            {
-                frame_buffer_index = px + py * SCREEN_WIDTH_PIX + char_col - 3;
-                *((uint32_t *)(fbp + frame_buffer_index)) = pixel_group;
-                byte_position = 0;
-                pixel_group = 0;
-            }
-            else
-            {
-                byte_position += 8;
-            }
-        }
+        pixel_expand_1bpp(fbp + frame_buffer_index, &semi_graph_6[char_index][char_row], 1, fg_color, bg_color, 1);
+        frame_buffer_index += SCREEN_WIDTH_PIX;
     }
 }
 
@@ -602,24 +571,16 @@ static void vdg_draw_semig6(int c, int col, int row)
  */
 static void vdg_draw_semig_ext(video_mode_t mode, int video_mem_base, int text_buffer_length)
 {
-    int             i;
     uint8_t         c;
-    uint8_t         pix_pos;
-    uint8_t         bit_pattern[SEMIG8_SEG_HEIGHT];
     uint32_t        px, py, text_buff_index;
-    int             char_row, char_col, char_index, char_row_index, segment_height;
+    int             char_row, char_index, char_row_index, segment_height;
     uint32_t        fg_color, bg_color;
 
     const uint8_t  *bit_pattern_array;
-    uint32_t        byte_position;
-    uint32_t        frame_buffer_index;
-    register        uint32_t    pixel_group;
 
     /* Common initialization
      */
     char_row_index = 0;
-    byte_position = 0;
-    pixel_group = 0;
 
     if ( mode == SEMI_GRAPHICS_8 )
         segment_height = SEMIG8_SEG_HEIGHT;
@@ -672,54 +633,12 @@ static void vdg_draw_semig_ext(video_mode_t mode, int video_mem_base, int text_b
         px = (text_buff_index & 0x1f) * FONT_WIDTH;
         py = (text_buff_index >> 5) * segment_height * SCREEN_WIDTH_PIX;
 
-        /* Get 3, 2 or 1 scan line of the alpha or semi4 character.
-         */
-        for ( i = 0; i < segment_height; i++ )
-        {
-            bit_pattern[i] = bit_pattern_array[i];
-        }
-
-        /* Render segment of alpha or semi4 character.
+        /* Render the 3, 2 or 1 scan line segment of the alpha or semi4 character.
          */
         for ( char_row = 0; char_row < segment_height; char_row++ )
         {
-            pix_pos = 0x80;
-
-            for ( char_col = 0; char_col < FONT_WIDTH; char_col++ )
-            {
-                /* Bit is set in Font, print pixel(s) in text color
-                 */
-                if ( bit_pattern[char_row] & pix_pos )
-                {
-                    pixel_group += fg_color << byte_position;
-                }
-                /* Bit is cleared in Font
-                 */
-                else
-                {
-                    pixel_group += bg_color << byte_position;
-                }
-
-                /* Move to the next pixel position
-                 */
-                pix_pos = pix_pos >> 1;
-
-                /* Render four pixels at once
-                 */
-                if ( byte_position == 24 )
-                {
-                    frame_buffer_index = (px + char_col - 3) + (py + (char_row * SCREEN_WIDTH_PIX));
-                    //printf("px %u, py %u, frame_buffer_index %u, char_col %d, char_row %d\n", px, py, frame_buffer_index, char_col, char_row);
-                    *((uint32_t *)(fbp + frame_buffer_index)) = pixel_group;
-                    byte_position = 0;
-                    pixel_group = 0;
-                }
-                else
-                {
-                    byte_position += 8;
-                }
-            }
-        } /* End of render loop */
+            pixel_expand_1bpp(fbp + px + py + char_row * SCREEN_WIDTH_PIX, &bit_pattern_array[char_row], 1, fg_color, bg_color, 1);
+        }
 
         /* Move to next character segment at the end of a 32 bytes row
          * or back to top of segment after completing character height
@@ -813,7 +732,7 @@ static video_mode_t vdg_get_mode(void)
     }
     else
     {
-        printf("vdg_get_mode(): Cannot resolve mode.\n");
+        LOG2(LOG_VDG_MODE_UNRESOLVED, sam_video_mode, pia_video_mode);
         rpi_halt();
     }
 